@@ -10,11 +10,17 @@ inline float3 inverse_HLG(float3 rgb)
     return rgb;
 }
 
-inline float3 HLGtoLinear(float3 rgb)
+inline float3 HLG_OOTF(float3 rgb)
 {
-    rgb = inverse_HLG(rgb);
     float3 ootf_2020 = float3(0.2627, 0.6780, 0.0593);
     float ootf_ys = 2000.0f * dot(ootf_2020, rgb);
     rgb *= pow(ootf_ys, 0.2f);
     return rgb;
 }
+
+inline float3 HLGtoLinear(float3 rgb)
+{
+    rgb = inverse_HLG(rgb);
+    rgb = HLG_OOTF(rgb);
+    return rgb;
+}
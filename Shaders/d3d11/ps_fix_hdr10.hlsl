@@ -18,7 +18,7 @@ cbuffer HDR10ParamsCB : register(b0)
     float maxFALL;
     float displayMaxNits; // <- lowercase to match uses
     uint  selection;      // <- lowercase to match uses
-    float reserved1;
+    float scenePeakNits;  // the smoothed peak of the scene, 0 - static metadata only
     float reserved2;
 }
 
@@ -111,6 +111,9 @@ float4 main(PS_INPUT input) : SV_Target {
     if (maxCLL > 100.0f && maxCLL <= masteringMaxLuminanceNits) {
         effectiveMaxLum = maxCLL;
     }
+    if (scenePeakNits > 0.0f) {
+        effectiveMaxLum = scenePeakNits; // already limited by the renderer
+    }
     
     // Normalize to [0,1] range for tone mapping
     linearColor.rgb /= effectiveMaxLum;
@@ -0,0 +1,1055 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "stdafx.h"
+#include <emmintrin.h>
+#include <cfloat>
+#include <atomic>
+#include <thread>
+#include "Helper.h"
+#include "Shaders.h"
+#include "ColorLut.h"
+
+// same values as in st2084.hlsl
+static const double ST2084_m1 =  2610.0 / (4096.0 * 4.0);
+static const double ST2084_m2 = (2523.0 / 4096.0) * 128.0;
+static const double ST2084_c1 =  3424.0 / 4096.0;
+static const double ST2084_c2 = (2413.0 / 4096.0) * 32.0;
+static const double ST2084_c3 = (2392.0 / 4096.0) * 32.0;
+
+// same values as in hlg.hlsl
+static const double B67_a = 0.17883277;
+static const double B67_b = 0.28466892;
+static const double B67_c = 0.55991073;
+
+static const double ootf_2020[3] = { 0.2627, 0.6780, 0.0593 };
+
+void GetColorChain(
+	ColorChain_t& chain,
+	const DXVA2_ExtendedFormat exFmt,
+	const mp_cmat& cmatrix,
+	const int convertType,
+	const float luminanceScale)
+{
+	chain = {};
+	chain.cmatrix = cmatrix;
+	chain.LuminanceScale = luminanceScale;
+
+	const bool bBT2020Primaries = (exFmt.VideoPrimaries == MFVideoPrimaries_BT2020);
+	chain.bConvertHDRtoSDR = (convertType == SHADER_CONVERT_TO_SDR && (exFmt.VideoTransferFunction == MFVideoTransFunc_2084 || exFmt.VideoTransferFunction == MFVideoTransFunc_HLG));
+	chain.bApplyHLG = (exFmt.VideoTransferFunction == MFVideoTransFunc_HLG);
+	chain.bConvertHLGtoPQ = (convertType == SHADER_CONVERT_TO_PQ && chain.bApplyHLG);
+
+	if (bBT2020Primaries || chain.bConvertHDRtoSDR) {
+		GetColorspaceGamutConversionMatrix(chain.matrix_conv_prim, MP_CSP_PRIM_BT_2020, MP_CSP_PRIM_BT_709);
+	}
+
+	if (!chain.bConvertHDRtoSDR && !chain.bConvertHLGtoPQ && bBT2020Primaries) {
+		switch (exFmt.VideoTransferFunction) {
+		case DXVA2_VideoTransFunc_10:   chain.gammaToLinear = 1.0f; break;
+		case DXVA2_VideoTransFunc_18:   chain.gammaToLinear = 1.8f; break;
+		case DXVA2_VideoTransFunc_20:   chain.gammaToLinear = 2.0f; break;
+		case MFVideoTransFunc_HLG: // HLG compatible with SDR
+		case DXVA2_VideoTransFunc_22:
+		case DXVA2_VideoTransFunc_709:
+		case DXVA2_VideoTransFunc_240M:
+		case DXVA2_VideoTransFunc_sRGB: chain.gammaToLinear = 2.2f; break;
+		case DXVA2_VideoTransFunc_28:   chain.gammaToLinear = 2.8f; break;
+		case MFVideoTransFunc_26:       chain.gammaToLinear = 2.6f; break;
+		}
+	}
+
+	chain.bLinearToGamma = chain.bConvertHDRtoSDR || chain.gammaToLinear > 0.0f;
+	chain.bOutputPQ = chain.bConvertHLGtoPQ || (!chain.bConvertHDRtoSDR && exFmt.VideoTransferFunction == MFVideoTransFunc_2084);
+}
+
+void SetColorChainHDR10(
+	ColorChain_t& chain,
+	float masteringMaxLuminanceNits,
+	float maxCLL,
+	float displayMaxNits,
+	int toneMappingType)
+{
+	if (masteringMaxLuminanceNits <= 0) masteringMaxLuminanceNits = 1000.0f;
+	if (maxCLL <= 0) maxCLL = 1000.0f;
+	if (displayMaxNits < 1.0f || displayMaxNits > 10000.0f) displayMaxNits = 1000.0f;
+	if (toneMappingType < 1 || toneMappingType > 5) toneMappingType = 1;
+
+	chain.hdr10.bEnable          = true;
+	chain.hdr10.masteringMaxNits = masteringMaxLuminanceNits;
+	chain.hdr10.maxCLL           = maxCLL;
+	chain.hdr10.displayMaxNits   = displayMaxNits;
+	chain.hdr10.toneMappingType  = toneMappingType;
+	chain.bOutputPQ = true;
+}
+
+static float GetHDR10EffectiveMaxLum(const ColorChain_t& chain)
+{
+	float effectiveMaxLum = std::max(chain.hdr10.masteringMaxNits, 1000.0f);
+	if (chain.hdr10.maxCLL > 100.0f && chain.hdr10.maxCLL <= chain.hdr10.masteringMaxNits) {
+		effectiveMaxLum = chain.hdr10.maxCLL;
+	}
+	if (chain.hdr10.scenePeakNits > 0.0f) {
+		effectiveMaxLum = chain.hdr10.scenePeakNits;
+	}
+	return effectiveMaxLum;
+}
+
+//
+// Analytic reference
+//
+
+static inline double saturate(const double x)
+{
+	return std::clamp(x, 0.0, 1.0);
+}
+
+static inline double ST2084ToLinear(double x, const double factor)
+{
+	x = pow(x, 1.0 / ST2084_m2);
+	x = std::max(x - ST2084_c1, 0.0) / (ST2084_c2 - ST2084_c3 * x);
+	x = pow(x, 1.0 / ST2084_m1);
+	return x * factor;
+}
+
+static inline double LinearToST2084(double x, const double divider)
+{
+	x /= divider;
+	x = pow(x, ST2084_m1);
+	x = (ST2084_c1 + ST2084_c2 * x) / (1.0 + ST2084_c3 * x);
+	return pow(x, ST2084_m2);
+}
+
+static inline void HLGtoLinear(double c[3])
+{
+	for (int i = 0; i < 3; i++) {
+		c[i] = (c[i] <= 0.5) ? c[i] * c[i] * 4.0 : exp((c[i] - B67_c) / B67_a) + B67_b;
+	}
+	const double ootf_ys = 2000.0 * (ootf_2020[0] * c[0] + ootf_2020[1] * c[1] + ootf_2020[2] * c[2]);
+	const double k = pow(ootf_ys, 0.2);
+	for (int i = 0; i < 3; i++) {
+		c[i] *= k;
+	}
+}
+
+static inline double hable(const double x)
+{
+	const double A = 0.15, B = 0.50, C = 0.10, D = 0.20, E = 0.02, F = 0.30;
+	return ((x * (A * x + (C * B)) + (D * E)) / (x * (A * x + B) + (D * F))) - E / F;
+}
+
+static inline void mul_matrix(const float (&m)[3][3], double c[3])
+{
+	const double r = m[0][0] * c[0] + m[0][1] * c[1] + m[0][2] * c[2];
+	const double g = m[1][0] * c[0] + m[1][1] * c[1] + m[1][2] * c[2];
+	const double b = m[2][0] * c[0] + m[2][1] * c[1] + m[2][2] * c[2];
+	c[0] = r; c[1] = g; c[2] = b;
+}
+
+static void FixHDR10(const ColorChain_t& chain, double c[3])
+{
+	// ps_fix_hdr10.hlsl outputs debug colours for NaN, here the input is clamped to the valid PQ range instead
+	for (int i = 0; i < 3; i++) {
+		c[i] = std::max(ST2084ToLinear(saturate(c[i]), 10000.0), 0.0) / GetHDR10EffectiveMaxLum(chain);
+	}
+
+	const double maxComponent = std::max({ c[0], c[1], c[2] });
+	if (maxComponent > 1.0) {
+		const double rolloff = 1.0 / (1.0 + (maxComponent - 1.0) * 0.5);
+		for (int i = 0; i < 3; i++) {
+			c[i] *= rolloff;
+		}
+	}
+
+	const double maxL = std::max(chain.hdr10.displayMaxNits, 100.0f);
+
+	switch (chain.hdr10.toneMappingType) {
+	default:
+	case 1: // ACES
+		for (int i = 0; i < 3; i++) {
+			const double x = c[i];
+			c[i] = saturate((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14));
+		}
+		break;
+	case 2: // Reinhard
+		for (int i = 0; i < 3; i++) {
+			c[i] = c[i] / (1.0 + c[i]);
+		}
+		break;
+	case 3: // Hable
+		for (int i = 0; i < 3; i++) {
+			c[i] = hable(c[i]);
+		}
+		break;
+	case 4: // Mobius
+		for (int i = 0; i < 3; i++) {
+			c[i] = c[i] / (1.0 + c[i] / (maxL + 1e-6));
+		}
+		break;
+	case 5: // Enhanced ACES
+		for (int i = 0; i < 3; i++) {
+			const double x = c[i] * 0.6;
+			c[i] = (x * (2.8 * x + 0.01)) / (x * (2.2 * x + 0.7) + 0.08);
+		}
+		{
+			const double max_c = std::max({ c[0], c[1], c[2] });
+			for (int i = 0; i < 3; i++) {
+				if (max_c > 1.0) {
+					c[i] /= max_c;
+				}
+				c[i] = saturate(c[i]);
+			}
+		}
+		break;
+	}
+
+	const bool bScale = (chain.hdr10.toneMappingType != 4);
+	bool bAnyPositive = false;
+	for (int i = 0; i < 3; i++) {
+		if (bScale) {
+			c[i] *= maxL;
+		}
+		c[i] = std::max(c[i], 0.0);
+		bAnyPositive |= c[i] > 0.0;
+	}
+
+	if (bAnyPositive) {
+		for (int i = 0; i < 3; i++) {
+			c[i] = LinearToST2084(c[i], 10000.0);
+		}
+	}
+}
+
+static void EvalColorChain(const ColorChain_t& chain, const double in[3], double c[3])
+{
+	const auto& m = chain.cmatrix.m;
+	for (int i = 0; i < 3; i++) {
+		c[i] = m[i][0] * in[0] + m[i][1] * in[1] + m[i][2] * in[2] + chain.cmatrix.c[i];
+	}
+
+	if (chain.bConvertHDRtoSDR) {
+		if (chain.bApplyHLG) {
+			for (int i = 0; i < 3; i++) {
+				c[i] = saturate(c[i]);
+			}
+			HLGtoLinear(c);
+			for (int i = 0; i < 3; i++) {
+				c[i] = LinearToST2084(c[i], 1000.0);
+			}
+		}
+		for (int i = 0; i < 3; i++) {
+			c[i] = ST2084ToLinear(saturate(c[i]), chain.LuminanceScale);
+			c[i] = hable(c[i]) / hable(4.8);
+		}
+		mul_matrix(chain.matrix_conv_prim, c);
+	}
+	else if (chain.bConvertHLGtoPQ) {
+		for (int i = 0; i < 3; i++) {
+			c[i] = saturate(c[i]);
+		}
+		HLGtoLinear(c);
+		for (int i = 0; i < 3; i++) {
+			c[i] = LinearToST2084(c[i], 1000.0);
+		}
+	}
+	else if (chain.gammaToLinear > 0.0f) {
+		for (int i = 0; i < 3; i++) {
+			c[i] = pow(saturate(c[i]), (double)chain.gammaToLinear);
+		}
+		mul_matrix(chain.matrix_conv_prim, c);
+	}
+
+	if (chain.bLinearToGamma) {
+		for (int i = 0; i < 3; i++) {
+			c[i] = pow(saturate(c[i]), 1.0 / 2.2);
+		}
+	}
+
+	if (chain.hdr10.bEnable) {
+		FixHDR10(chain, c);
+	}
+}
+
+void EvalColorChain(const ColorChain_t& chain, const float in[3], float out[3])
+{
+	const double din[3] = { in[0], in[1], in[2] };
+	double dout[3];
+	EvalColorChain(chain, din, dout);
+	for (int i = 0; i < 3; i++) {
+		out[i] = (float)dout[i];
+	}
+}
+
+//
+// SSE2 evaluation
+//
+
+// natural logarithm for x > 0, Cephes polynomial
+static inline __m128 log_ps(__m128 x)
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	const __m128i xi = _mm_castps_si128(x);
+	__m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(xi, 23), _mm_set1_epi32(126)));
+	x = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(xi, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f000000))); // [0.5, 1)
+
+	const __m128 mask = _mm_cmplt_ps(x, _mm_set1_ps(0.707106781186547524f));
+	const __m128 tmp = _mm_and_ps(x, mask);
+	x = _mm_sub_ps(x, one);
+	e = _mm_sub_ps(e, _mm_and_ps(one, mask));
+	x = _mm_add_ps(x, tmp);
+
+	const __m128 z = _mm_mul_ps(x, x);
+	__m128 y = _mm_set1_ps(7.0376836292E-2f);
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.1514610310E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.1676998740E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.2420140846E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.4249322787E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.6668057665E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(2.0000714765E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-2.4999993993E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(3.3333331174E-1f));
+	y = _mm_mul_ps(_mm_mul_ps(y, x), z);
+
+	y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+	y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+	x = _mm_add_ps(x, y);
+	x = _mm_add_ps(x, _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+
+	return x;
+}
+
+// exponent, Cephes polynomial
+static inline __m128 exp_ps(__m128 x)
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	x = _mm_min_ps(x, _mm_set1_ps(88.3762626647949f));
+	x = _mm_max_ps(x, _mm_set1_ps(-88.3762626647949f));
+
+	// fx = floor(x * log2(e) + 0.5)
+	__m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+	const __m128 tmp = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+	fx = _mm_sub_ps(tmp, _mm_and_ps(_mm_cmpgt_ps(tmp, fx), one));
+
+	x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(0.693359375f)));
+	x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+
+	const __m128 z = _mm_mul_ps(x, x);
+	__m128 y = _mm_set1_ps(1.9875691500E-4f);
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507E-3f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073E-3f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894E-2f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459E-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201E-1f));
+	y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), one);
+
+	const __m128i pow2n = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(127)), 23);
+
+	return _mm_mul_ps(y, _mm_castsi128_ps(pow2n));
+}
+
+// x^y for x >= 0, 0^y = 0
+static inline __m128 pow_ps(const __m128 x, const __m128 y)
+{
+	const __m128 valid = _mm_cmpge_ps(x, _mm_set1_ps(FLT_MIN));
+	const __m128 r = exp_ps(_mm_mul_ps(y, log_ps(_mm_max_ps(x, _mm_set1_ps(FLT_MIN)))));
+	return _mm_and_ps(r, valid);
+}
+
+static inline __m128 pow_ps(const __m128 x, const float y)
+{
+	return pow_ps(x, _mm_set1_ps(y));
+}
+
+static inline __m128 saturate_ps(const __m128 x)
+{
+	return _mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+
+static inline __m128 select_ps(const __m128 mask, const __m128 a, const __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128 ST2084ToLinear_ps(__m128 x, const float factor)
+{
+	x = pow_ps(x, (float)(1.0 / ST2084_m2));
+	x = _mm_div_ps(_mm_max_ps(_mm_sub_ps(x, _mm_set1_ps((float)ST2084_c1)), _mm_setzero_ps()),
+		_mm_sub_ps(_mm_set1_ps((float)ST2084_c2), _mm_mul_ps(_mm_set1_ps((float)ST2084_c3), x)));
+	x = pow_ps(x, (float)(1.0 / ST2084_m1));
+	return _mm_mul_ps(x, _mm_set1_ps(factor));
+}
+
+static inline __m128 LinearToST2084_ps(__m128 x, const float divider)
+{
+	x = _mm_div_ps(x, _mm_set1_ps(divider));
+	x = pow_ps(x, (float)ST2084_m1);
+	x = _mm_div_ps(_mm_add_ps(_mm_set1_ps((float)ST2084_c1), _mm_mul_ps(_mm_set1_ps((float)ST2084_c2), x)),
+		_mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps((float)ST2084_c3), x)));
+	return pow_ps(x, (float)ST2084_m2);
+}
+
+static inline void HLGtoLinear_ps(__m128 c[3])
+{
+	for (int i = 0; i < 3; i++) {
+		const __m128 lo = _mm_mul_ps(_mm_mul_ps(c[i], c[i]), _mm_set1_ps(4.0f));
+		const __m128 hi = _mm_add_ps(exp_ps(_mm_div_ps(_mm_sub_ps(c[i], _mm_set1_ps((float)B67_c)), _mm_set1_ps((float)B67_a))), _mm_set1_ps((float)B67_b));
+		c[i] = select_ps(_mm_cmple_ps(c[i], _mm_set1_ps(0.5f)), lo, hi);
+	}
+	__m128 ootf_ys = _mm_mul_ps(c[0], _mm_set1_ps((float)ootf_2020[0]));
+	ootf_ys = _mm_add_ps(ootf_ys, _mm_mul_ps(c[1], _mm_set1_ps((float)ootf_2020[1])));
+	ootf_ys = _mm_add_ps(ootf_ys, _mm_mul_ps(c[2], _mm_set1_ps((float)ootf_2020[2])));
+	const __m128 k = pow_ps(_mm_mul_ps(ootf_ys, _mm_set1_ps(2000.0f)), 0.2f);
+	for (int i = 0; i < 3; i++) {
+		c[i] = _mm_mul_ps(c[i], k);
+	}
+}
+
+static inline __m128 hable_ps(const __m128 x)
+{
+	const float A = 0.15f, B = 0.50f, C = 0.10f, D = 0.20f, E = 0.02f, F = 0.30f;
+	const __m128 num = _mm_add_ps(_mm_mul_ps(x, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A), x), _mm_set1_ps(C * B))), _mm_set1_ps(D * E));
+	const __m128 den = _mm_add_ps(_mm_mul_ps(x, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A), x), _mm_set1_ps(B))), _mm_set1_ps(D * F));
+	return _mm_sub_ps(_mm_div_ps(num, den), _mm_set1_ps(E / F));
+}
+
+// (x * (a * x + b)) / (x * (c * x + d) + e)
+static inline __m128 rational_ps(const __m128 x, const float a, const float b, const float c, const float d, const float e)
+{
+	const __m128 num = _mm_mul_ps(x, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a), x), _mm_set1_ps(b)));
+	const __m128 den = _mm_add_ps(_mm_mul_ps(x, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(c), x), _mm_set1_ps(d))), _mm_set1_ps(e));
+	return _mm_div_ps(num, den);
+}
+
+static inline void mul_matrix_ps(const float (&m)[3][3], __m128 c[3])
+{
+	__m128 out[3];
+	for (int i = 0; i < 3; i++) {
+		out[i] = _mm_mul_ps(c[0], _mm_set1_ps(m[i][0]));
+		out[i] = _mm_add_ps(out[i], _mm_mul_ps(c[1], _mm_set1_ps(m[i][1])));
+		out[i] = _mm_add_ps(out[i], _mm_mul_ps(c[2], _mm_set1_ps(m[i][2])));
+	}
+	c[0] = out[0]; c[1] = out[1]; c[2] = out[2];
+}
+
+static void FixHDR10_ps(const ColorChain_t& chain, __m128 c[3])
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 effectiveMaxLum = _mm_set1_ps(GetHDR10EffectiveMaxLum(chain));
+
+	for (int i = 0; i < 3; i++) {
+		c[i] = _mm_div_ps(_mm_max_ps(ST2084ToLinear_ps(saturate_ps(c[i]), 10000.0f), zero), effectiveMaxLum);
+	}
+
+	const __m128 maxComponent = _mm_max_ps(_mm_max_ps(c[0], c[1]), c[2]);
+	const __m128 rolloff = _mm_div_ps(one, _mm_add_ps(one, _mm_mul_ps(_mm_sub_ps(maxComponent, one), _mm_set1_ps(0.5f))));
+	const __m128 bRolloff = _mm_cmpgt_ps(maxComponent, one);
+	for (int i = 0; i < 3; i++) {
+		c[i] = select_ps(bRolloff, _mm_mul_ps(c[i], rolloff), c[i]);
+	}
+
+	const float maxL = std::max(chain.hdr10.displayMaxNits, 100.0f);
+
+	switch (chain.hdr10.toneMappingType) {
+	default:
+	case 1: // ACES
+		for (int i = 0; i < 3; i++) {
+			c[i] = saturate_ps(rational_ps(c[i], 2.51f, 0.03f, 2.43f, 0.59f, 0.14f));
+		}
+		break;
+	case 2: // Reinhard
+		for (int i = 0; i < 3; i++) {
+			c[i] = _mm_div_ps(c[i], _mm_add_ps(one, c[i]));
+		}
+		break;
+	case 3: // Hable
+		for (int i = 0; i < 3; i++) {
+			c[i] = hable_ps(c[i]);
+		}
+		break;
+	case 4: // Mobius
+		for (int i = 0; i < 3; i++) {
+			c[i] = _mm_div_ps(c[i], _mm_add_ps(one, _mm_div_ps(c[i], _mm_set1_ps(maxL + 1e-6f))));
+		}
+		break;
+	case 5: // Enhanced ACES
+		for (int i = 0; i < 3; i++) {
+			c[i] = rational_ps(_mm_mul_ps(c[i], _mm_set1_ps(0.6f)), 2.8f, 0.01f, 2.2f, 0.7f, 0.08f);
+		}
+		{
+			const __m128 max_c = _mm_max_ps(_mm_max_ps(c[0], c[1]), c[2]);
+			const __m128 bNormalize = _mm_cmpgt_ps(max_c, one);
+			for (int i = 0; i < 3; i++) {
+				c[i] = saturate_ps(select_ps(bNormalize, _mm_div_ps(c[i], max_c), c[i]));
+			}
+		}
+		break;
+	}
+
+	const __m128 scale = _mm_set1_ps(chain.hdr10.toneMappingType != 4 ? maxL : 1.0f);
+	__m128 bAnyPositive = zero;
+	for (int i = 0; i < 3; i++) {
+		c[i] = _mm_max_ps(_mm_mul_ps(c[i], scale), zero);
+		bAnyPositive = _mm_or_ps(bAnyPositive, _mm_cmpgt_ps(c[i], zero));
+	}
+
+	for (int i = 0; i < 3; i++) {
+		c[i] = select_ps(bAnyPositive, LinearToST2084_ps(c[i], 10000.0f), c[i]);
+	}
+}
+
+static void EvalColorChain_ps(const ColorChain_t& chain, const __m128 in[3], __m128 c[3])
+{
+	const auto& m = chain.cmatrix.m;
+	for (int i = 0; i < 3; i++) {
+		c[i] = _mm_mul_ps(in[0], _mm_set1_ps(m[i][0]));
+		c[i] = _mm_add_ps(c[i], _mm_mul_ps(in[1], _mm_set1_ps(m[i][1])));
+		c[i] = _mm_add_ps(c[i], _mm_mul_ps(in[2], _mm_set1_ps(m[i][2])));
+		c[i] = _mm_add_ps(c[i], _mm_set1_ps(chain.cmatrix.c[i]));
+	}
+
+	if (chain.bConvertHDRtoSDR) {
+		if (chain.bApplyHLG) {
+			for (int i = 0; i < 3; i++) {
+				c[i] = saturate_ps(c[i]);
+			}
+			HLGtoLinear_ps(c);
+			for (int i = 0; i < 3; i++) {
+				c[i] = LinearToST2084_ps(c[i], 1000.0f);
+			}
+		}
+		const __m128 hable_div = _mm_set1_ps((float)hable(4.8));
+		for (int i = 0; i < 3; i++) {
+			c[i] = ST2084ToLinear_ps(saturate_ps(c[i]), chain.LuminanceScale);
+			c[i] = _mm_div_ps(hable_ps(c[i]), hable_div);
+		}
+		mul_matrix_ps(chain.matrix_conv_prim, c);
+	}
+	else if (chain.bConvertHLGtoPQ) {
+		for (int i = 0; i < 3; i++) {
+			c[i] = saturate_ps(c[i]);
+		}
+		HLGtoLinear_ps(c);
+		for (int i = 0; i < 3; i++) {
+			c[i] = LinearToST2084_ps(c[i], 1000.0f);
+		}
+	}
+	else if (chain.gammaToLinear > 0.0f) {
+		for (int i = 0; i < 3; i++) {
+			c[i] = saturate_ps(c[i]);
+			if (chain.gammaToLinear != 1.0f) {
+				c[i] = pow_ps(c[i], chain.gammaToLinear);
+			}
+		}
+		mul_matrix_ps(chain.matrix_conv_prim, c);
+	}
+
+	if (chain.bLinearToGamma) {
+		for (int i = 0; i < 3; i++) {
+			c[i] = pow_ps(saturate_ps(c[i]), 1.0f / 2.2f);
+		}
+	}
+
+	if (chain.hdr10.bEnable) {
+		FixHDR10_ps(chain, c);
+	}
+}
+
+// float to half with round to nearest even, the result is in the low 16 bits of each 32-bit lane
+static inline __m128i FloatToHalf_ps(const __m128 f)
+{
+	const __m128 sign = _mm_and_ps(f, _mm_set1_ps(-0.0f));
+	const __m128 absf = _mm_xor_ps(f, sign);
+	const __m128i absf_int = _mm_castps_si128(absf);
+
+	const __m128i b_isnan = _mm_castps_si128(_mm_cmpunord_ps(absf, absf));
+	const __m128i b_isregular = _mm_cmpgt_epi32(_mm_set1_epi32((127 + 16) << 23), absf_int);
+	const __m128i inf_or_nan = _mm_or_si128(_mm_and_si128(b_isnan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+
+	// subnormal result
+	const __m128i c_subnorm_magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+	const __m128i b_issub = _mm_cmpgt_epi32(_mm_set1_epi32((127 - 14) << 23), absf_int);
+	const __m128 subnorm1 = _mm_add_ps(absf, _mm_castsi128_ps(c_subnorm_magic));
+	const __m128i subnorm2 = _mm_sub_epi32(_mm_castps_si128(subnorm1), c_subnorm_magic);
+
+	// normal result, rebias the exponent and round the mantissa
+	const __m128i mantodd = _mm_srai_epi32(_mm_slli_epi32(absf_int, 31 - 13), 31);
+	const __m128i round1 = _mm_add_epi32(absf_int, _mm_set1_epi32(0xfff - ((127 - 15) << 23)));
+	const __m128i normal = _mm_srli_epi32(_mm_sub_epi32(round1, mantodd), 13);
+
+	const __m128i nonspecial = _mm_or_si128(_mm_and_si128(subnorm2, b_issub), _mm_andnot_si128(b_issub, normal));
+	const __m128i joined = _mm_or_si128(_mm_and_si128(nonspecial, b_isregular), _mm_andnot_si128(b_isregular, inf_or_nan));
+
+	return _mm_or_si128(joined, _mm_srli_epi32(_mm_castps_si128(sign), 16));
+}
+
+static inline float HalfToFloat(const uint16_t h)
+{
+	const uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+	const uint32_t exp = (h >> 10) & 0x1f;
+	const uint32_t mant = h & 0x3ff;
+
+	float f;
+	if (exp == 0) {
+		f = mant * (1.0f / (1 << 24)); // subnormal
+		uint32_t u;
+		memcpy(&u, &f, 4);
+		u |= sign;
+		memcpy(&f, &u, 4);
+	}
+	else {
+		const uint32_t u = sign | (exp == 31 ? (0xffu << 23) | (mant << 13) : ((exp + 112) << 23) | (mant << 13));
+		memcpy(&f, &u, 4);
+	}
+	return f;
+}
+
+static void BakeColorLut3DSlice(const ColorChain_t& chain, const UINT size, const UINT z, uint16_t* dst)
+{
+	const float scale = 1.0f / (size - 1);
+	const __m128i alpha = _mm_set1_epi32(0x3c00 << 16); // 1.0 in the high half
+	alignas(16) uint16_t tail[4 * 4];
+
+	__m128 in[3];
+	in[2] = _mm_set1_ps(z * scale);
+
+	for (UINT y = 0; y < size; y++) {
+		in[1] = _mm_set1_ps(y * scale);
+
+		for (UINT x = 0; x < size; x += 4) {
+			const UINT x1 = std::min(x + 1, size - 1);
+			const UINT x2 = std::min(x + 2, size - 1);
+			const UINT x3 = std::min(x + 3, size - 1);
+			in[0] = _mm_mul_ps(_mm_setr_ps((float)x, (float)x1, (float)x2, (float)x3), _mm_set1_ps(scale));
+
+			__m128 c[3];
+			EvalColorChain_ps(chain, in, c);
+
+			const __m128i r = FloatToHalf_ps(c[0]);
+			const __m128i g = FloatToHalf_ps(c[1]);
+			const __m128i b = FloatToHalf_ps(c[2]);
+
+			// the halves fit in 16 bits, interleave them to RGBA
+			const __m128i rg = _mm_or_si128(r, _mm_slli_epi32(g, 16));
+			const __m128i ba = _mm_or_si128(b, alpha);
+			const __m128i px01 = _mm_unpacklo_epi32(rg, ba);
+			const __m128i px23 = _mm_unpackhi_epi32(rg, ba);
+
+			if (x + 4 <= size) {
+				_mm_storeu_si128((__m128i*)dst, px01);
+				_mm_storeu_si128((__m128i*)(dst + 8), px23);
+				dst += 16;
+			}
+			else {
+				_mm_store_si128((__m128i*)tail, px01);
+				_mm_store_si128((__m128i*)(tail + 8), px23);
+				const UINT n = size - x;
+				memcpy(dst, tail, n * 4 * sizeof(uint16_t));
+				dst += n * 4;
+			}
+		}
+	}
+}
+
+HRESULT BakeColorLut3D(const ColorChain_t& chain, const UINT size, std::vector<uint16_t>& lut, UINT threads)
+{
+	if (size < COLOR_LUT3D_SIZE_MIN || size > COLOR_LUT3D_SIZE_MAX) {
+		return E_INVALIDARG;
+	}
+
+	const size_t sliceSize = (size_t)size * size * 4;
+	lut.resize(sliceSize * size);
+
+	if (!threads) {
+		threads = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+	}
+	threads = std::min(threads, size);
+
+	std::atomic<UINT> nextSlice = 0;
+	auto worker = [&]() {
+		for (UINT z = nextSlice++; z < size; z = nextSlice++) {
+			BakeColorLut3DSlice(chain, size, z, &lut[sliceSize * z]);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	workers.reserve(threads - 1);
+	for (UINT i = 1; i < threads; i++) {
+		workers.emplace_back(worker);
+	}
+	worker();
+	for (auto& t : workers) {
+		t.join();
+	}
+
+	return S_OK;
+}
+
+//
+// Sampling and accuracy
+//
+
+void SampleColorLut3D(const uint16_t* lut, const UINT size, const float in[3], float out[3])
+{
+	const int last = size - 1;
+	int i0[3];
+	float d[3];
+	for (int i = 0; i < 3; i++) {
+		const float f = std::clamp(in[i], 0.0f, 1.0f) * last;
+		i0[i] = std::min((int)f, last - 1);
+		d[i] = f - i0[i];
+	}
+
+	auto vertex = [&](const int dx, const int dy, const int dz, float v[3]) {
+		const uint16_t* p = lut + (((size_t)(i0[2] + dz) * size + (i0[1] + dy)) * size + (i0[0] + dx)) * 4;
+		v[0] = HalfToFloat(p[0]);
+		v[1] = HalfToFloat(p[1]);
+		v[2] = HalfToFloat(p[2]);
+	};
+
+	// walk from the (0,0,0) to the (1,1,1) corner along the edges of the tetrahedron containing the point
+	int order[3];
+	if (d[0] > d[1]) {
+		if (d[1] > d[2])      { order[0] = 0; order[1] = 1; order[2] = 2; }
+		else if (d[0] > d[2]) { order[0] = 0; order[1] = 2; order[2] = 1; }
+		else                  { order[0] = 2; order[1] = 0; order[2] = 1; }
+	}
+	else {
+		if (d[2] > d[1])      { order[0] = 2; order[1] = 1; order[2] = 0; }
+		else if (d[2] > d[0]) { order[0] = 1; order[1] = 2; order[2] = 0; }
+		else                  { order[0] = 1; order[1] = 0; order[2] = 2; }
+	}
+
+	int corner[3] = {};
+	float prev[3];
+	vertex(0, 0, 0, prev);
+	out[0] = prev[0]; out[1] = prev[1]; out[2] = prev[2];
+
+	for (int k = 0; k < 3; k++) {
+		corner[order[k]] = 1;
+		float next[3];
+		vertex(corner[0], corner[1], corner[2], next);
+		const float w = d[order[k]];
+		for (int i = 0; i < 3; i++) {
+			out[i] += w * (next[i] - prev[i]);
+			prev[i] = next[i];
+		}
+	}
+}
+
+static void GammaRGBtoLab(const float (&rgb2xyz)[3][3], const float rgb[3], double lab[3])
+{
+	double lin[3];
+	for (int i = 0; i < 3; i++) {
+		lin[i] = pow(std::clamp((double)rgb[i], 0.0, 1.0), 2.2);
+	}
+
+	double f[3];
+	for (int i = 0; i < 3; i++) {
+		const double white = (double)rgb2xyz[i][0] + rgb2xyz[i][1] + rgb2xyz[i][2];
+		const double t = (rgb2xyz[i][0] * lin[0] + rgb2xyz[i][1] * lin[1] + rgb2xyz[i][2] * lin[2]) / white;
+		f[i] = (t > 216.0 / 24389.0) ? cbrt(t) : t * (24389.0 / 27.0 / 116.0) + 16.0 / 116.0;
+	}
+
+	lab[0] = 116.0 * f[1] - 16.0;
+	lab[1] = 500.0 * (f[0] - f[1]);
+	lab[2] = 200.0 * (f[1] - f[2]);
+}
+
+static double DeltaE2000(const double lab1[3], const double lab2[3])
+{
+	const double pi = acos(-1.0);
+	const double deg = 180.0 / pi;
+	const double pow25_7 = 6103515625.0; // 25^7
+
+	const double C1 = hypot(lab1[1], lab1[2]);
+	const double C2 = hypot(lab2[1], lab2[2]);
+	const double Cm7 = pow((C1 + C2) / 2, 7);
+	const double G = 0.5 * (1.0 - sqrt(Cm7 / (Cm7 + pow25_7)));
+
+	const double a1p = (1.0 + G) * lab1[1];
+	const double a2p = (1.0 + G) * lab2[1];
+	const double C1p = hypot(a1p, lab1[2]);
+	const double C2p = hypot(a2p, lab2[2]);
+
+	auto hue = [&](const double b, const double ap) {
+		if (b == 0.0 && ap == 0.0) {
+			return 0.0;
+		}
+		const double h = atan2(b, ap) * deg;
+		return h < 0.0 ? h + 360.0 : h;
+	};
+	const double h1p = hue(lab1[2], a1p);
+	const double h2p = hue(lab2[2], a2p);
+
+	const double dLp = lab2[0] - lab1[0];
+	const double dCp = C2p - C1p;
+
+	double dhp = 0.0;
+	if (C1p * C2p != 0.0) {
+		dhp = h2p - h1p;
+		if (dhp > 180.0) {
+			dhp -= 360.0;
+		}
+		else if (dhp < -180.0) {
+			dhp += 360.0;
+		}
+	}
+	const double dHp = 2.0 * sqrt(C1p * C2p) * sin(dhp / deg / 2.0);
+
+	const double Lpm = (lab1[0] + lab2[0]) / 2.0;
+	const double Cpm = (C1p + C2p) / 2.0;
+
+	double hpm = h1p + h2p;
+	if (C1p * C2p != 0.0) {
+		if (fabs(h1p - h2p) <= 180.0) {
+			hpm /= 2.0;
+		}
+		else {
+			hpm = (hpm < 360.0) ? (hpm + 360.0) / 2.0 : (hpm - 360.0) / 2.0;
+		}
+	}
+
+	const double T = 1.0
+		- 0.17 * cos((hpm - 30.0) / deg)
+		+ 0.24 * cos((2.0 * hpm) / deg)
+		+ 0.32 * cos((3.0 * hpm + 6.0) / deg)
+		- 0.20 * cos((4.0 * hpm - 63.0) / deg);
+
+	const double dTheta = 30.0 * exp(-((hpm - 275.0) / 25.0) * ((hpm - 275.0) / 25.0));
+	const double Cpm7 = pow(Cpm, 7);
+	const double Rc = 2.0 * sqrt(Cpm7 / (Cpm7 + pow25_7));
+	const double Lpm50 = (Lpm - 50.0) * (Lpm - 50.0);
+	const double Sl = 1.0 + 0.015 * Lpm50 / sqrt(20.0 + Lpm50);
+	const double Sc = 1.0 + 0.045 * Cpm;
+	const double Sh = 1.0 + 0.015 * Cpm * T;
+	const double Rt = -sin(2.0 * dTheta / deg) * Rc;
+
+	const double l = dLp / Sl;
+	const double c = dCp / Sc;
+	const double h = dHp / Sh;
+
+	return sqrt(l * l + c * c + h * h + Rt * c * h);
+}
+
+static void PQtoICtCp(const float pq[3], double ictcp[3])
+{
+	double rgb[3];
+	for (int i = 0; i < 3; i++) {
+		rgb[i] = ST2084ToLinear(std::clamp((double)pq[i], 0.0, 1.0), 1.0);
+	}
+
+	// BT.2100 RGB to LMS
+	double lms[3] = {
+		(1688.0 * rgb[0] + 2146.0 * rgb[1] +  262.0 * rgb[2]) / 4096.0,
+		( 683.0 * rgb[0] + 2951.0 * rgb[1] +  462.0 * rgb[2]) / 4096.0,
+		(  99.0 * rgb[0] +  309.0 * rgb[1] + 3688.0 * rgb[2]) / 4096.0,
+	};
+	for (int i = 0; i < 3; i++) {
+		lms[i] = LinearToST2084(lms[i], 1.0);
+	}
+
+	ictcp[0] = 0.5 * lms[0] + 0.5 * lms[1];
+	ictcp[1] = ( 6610.0 * lms[0] - 13613.0 * lms[1] + 7003.0 * lms[2]) / 4096.0;
+	ictcp[2] = (17933.0 * lms[0] - 17390.0 * lms[1] -  543.0 * lms[2]) / 4096.0;
+}
+
+static double DeltaEITP(const double ictcp1[3], const double ictcp2[3])
+{
+	const double dI = ictcp1[0] - ictcp2[0];
+	const double dT = (ictcp1[1] - ictcp2[1]) * 0.5;
+	const double dP = ictcp1[2] - ictcp2[2];
+
+	return 720.0 * sqrt(dI * dI + dT * dT + dP * dP);
+}
+
+ColorLutAccuracy_t MeasureColorLut3D(const ColorChain_t& chain, const uint16_t* lut, const UINT size, const UINT samples)
+{
+	ColorLutAccuracy_t report;
+	report.bDeltaEITP = chain.bOutputPQ;
+
+	float rgb2xyz[3][3];
+	mp_get_rgb2xyz_matrix(mp_get_csp_primaries(MP_CSP_PRIM_BT_709), rgb2xyz);
+
+	double sumDE = 0.0;
+
+	auto measure = [&](const float in[3]) {
+		float ref[3], out[3];
+		EvalColorChain(chain, in, ref);
+		SampleColorLut3D(lut, size, in, out);
+
+		double v1[3], v2[3];
+		double dE;
+		if (report.bDeltaEITP) {
+			PQtoICtCp(ref, v1);
+			PQtoICtCp(out, v2);
+			dE = DeltaEITP(v1, v2);
+		} else {
+			GammaRGBtoLab(rgb2xyz, ref, v1);
+			GammaRGBtoLab(rgb2xyz, out, v2);
+			dE = DeltaE2000(v1, v2);
+		}
+
+		sumDE += dE;
+		report.samples++;
+		if (dE > report.maxDE) {
+			report.maxDE = dE;
+			report.maxDEInput[0] = in[0];
+			report.maxDEInput[1] = in[1];
+			report.maxDEInput[2] = in[2];
+		}
+	};
+
+	// lattice cell centres, where the interpolation error is the largest
+	const UINT cells = size - 1;
+	const UINT step = std::max(1u, cells / 16);
+	for (UINT z = 0; z < cells; z += step) {
+		for (UINT y = 0; y < cells; y += step) {
+			for (UINT x = 0; x < cells; x += step) {
+				const float in[3] = { (x + 0.5f) / cells, (y + 0.5f) / cells, (z + 0.5f) / cells };
+				measure(in);
+			}
+		}
+	}
+
+	// reproducible pseudo-random inputs
+	uint32_t seed = 0x9e3779b9u;
+	auto rand01 = [&]() {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		return (seed >> 8) * (1.0f / (1 << 24));
+	};
+	for (UINT i = 0; i < samples; i++) {
+		const float in[3] = { rand01(), rand01(), rand01() };
+		measure(in);
+	}
+
+	report.meanDE = report.samples ? sumDE / report.samples : 0.0;
+
+	DLog(L"MeasureColorLut3D() : {}^3 lattice, {} samples, {} max {:.4f} at ({:.4f}, {:.4f}, {:.4f}), mean {:.4f}",
+		size, report.samples, report.bDeltaEITP ? L"dE ITP" : L"dE 2000",
+		report.maxDE, report.maxDEInput[0], report.maxDEInput[1], report.maxDEInput[2], report.meanDE);
+
+	return report;
+}
+
+//
+// 1D transfer function tables
+//
+
+HRESULT BakeTrcLut1D(const mp_csp_trc trc, const UINT size, std::vector<float>& lut)
+{
+	if (!mp_trc_has_linearize(trc) || size < 2) {
+		return E_INVALIDARG;
+	}
+
+	lut.resize(size);
+	for (UINT i = 0; i < size; i++) {
+		lut[i] = (float)mp_trc_linearize(trc, (double)i / (size - 1));
+	}
+
+	return S_OK;
+}
+
+float SampleTrcLut1D(const float* lut, const UINT size, const float x)
+{
+	const float pos = std::clamp(x, 0.0f, 1.0f) * (size - 1);
+	const int i = std::min((int)pos, (int)size - 2);
+	const float f = pos - i;
+
+	return lut[i] + f * (lut[i + 1] - lut[i]);
+}
+
+double GetTrcLut1DErrorBound(const mp_csp_trc trc, const UINT size)
+{
+	if (!mp_trc_has_linearize(trc) || size < 2) {
+		return DBL_MAX;
+	}
+
+	const UINT points = 64;
+	double maxErr = 0.0;
+	double maxValue = 0.0;
+
+	double x0 = 0.0;
+	double y0 = mp_trc_linearize(trc, x0);
+	for (UINT i = 1; i < size; i++) {
+		const double x1 = (double)i / (size - 1);
+		const double y1 = mp_trc_linearize(trc, x1);
+		for (UINT k = 1; k < points; k++) {
+			const double t = (double)k / points;
+			const double err = fabs(mp_trc_linearize(trc, x0 + t * (x1 - x0)) - (y0 + t * (y1 - y0)));
+			maxErr = std::max(maxErr, err);
+		}
+		maxValue = std::max(maxValue, fabs(y1));
+		x0 = x1;
+		y0 = y1;
+	}
+
+	// the samples are rounded to float, the interpolation adds up to three roundings
+	// and the input position is rounded with the error of one sample step times FLT_EPSILON
+	const double slope = (mp_trc_linearize(trc, 1.0) - mp_trc_linearize(trc, 1.0 - 1.0 / (size - 1))) * (size - 1);
+	const double rounding = 4.0 * maxValue * FLT_EPSILON + fabs(slope) * FLT_EPSILON;
+
+	return maxErr * (1.0 + 1.0 / points) + rounding;
+}
+
+TrcLutAccuracy_t MeasureTrcLut1D(const mp_csp_trc trc, const float* lut, const UINT size, const UINT samples)
+{
+	TrcLutAccuracy_t report;
+	report.errBound = GetTrcLut1DErrorBound(trc, size);
+
+	const double minRef = fabs(mp_trc_linearize(trc, 1.0)) / 10000.0;
+
+	auto measure = [&](const float x) {
+		const double ref = mp_trc_linearize(trc, x);
+		const double err = fabs(SampleTrcLut1D(lut, size, x) - ref);
+
+		report.samples++;
+		if (err > report.maxErr) {
+			report.maxErr = err;
+			report.maxErrInput = x;
+		}
+		if (fabs(ref) > minRef) {
+			report.maxRelErr = std::max(report.maxRelErr, err / fabs(ref));
+		}
+	};
+
+	// cell centres, where the interpolation error is the largest for convex and concave curves
+	for (UINT i = 0; i < size - 1; i++) {
+		measure((i + 0.5f) / (size - 1));
+	}
+
+	// reproducible pseudo-random inputs
+	uint32_t seed = 0x9e3779b9u;
+	for (UINT i = 0; i < samples; i++) {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		measure((seed >> 8) * (1.0f / (1 << 24)));
+	}
+
+	DLog(L"MeasureTrcLut1D() : trc {}, {} samples, {} inputs, max error {:.3e} at {:.6f} (bound {:.3e}), max relative error {:.3e}",
+		(int)trc, size, report.samples, report.maxErr, report.maxErrInput, report.errBound, report.maxRelErr);
+
+	return report;
+}
@@ -0,0 +1,114 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+
+#include "csputils.h"
+
+#define COLOR_LUT3D_SIZE_DEF 65
+#define COLOR_LUT3D_SIZE_MIN 2
+#define COLOR_LUT3D_SIZE_MAX 129
+
+#define TRC_LUT1D_SIZE 4096
+
+// The colour chain of the conversion shader built by GetShaderConvertColor() (without Dolby Vision),
+// optionally followed by the HDR10 tone mapping pass (ps_fix_hdr10.hlsl, SetHDR10ShaderParams).
+struct ColorChain_t {
+	mp_cmat cmatrix = {};              // as uploaded to PS_COLOR_TRANSFORM, texture values -> RGB
+	bool  bConvertHDRtoSDR  = false;
+	bool  bApplyHLG         = false;
+	bool  bConvertHLGtoPQ   = false;
+	float gammaToLinear     = 0.0f;    // BT.2020 SDR linearisation exponent, 0 - disabled
+	float LuminanceScale    = 1.0f;    // 10000 / SDR display nits
+	float matrix_conv_prim[3][3] = {}; // BT.2020 -> BT.709
+	bool  bLinearToGamma    = false;   // linear light is encoded back with gamma 2.2
+
+	struct {
+		bool  bEnable           = false;
+		float masteringMaxNits  = 1000.0f;
+		float maxCLL            = 1000.0f;
+		float displayMaxNits    = 1000.0f;
+		float scenePeakNits     = 0.0f; // see GetHdrSceneAdaptedPeak(), 0 - static metadata only
+		int   toneMappingType   = 1; // 1=ACES, 2=Reinhard, 3=Hable, 4=Mobius, 5=Enhanced ACES
+	} hdr10;
+
+	bool  bOutputPQ         = false; // output is ST 2084 with BT.2020 primaries, otherwise gamma 2.2 BT.709
+};
+
+struct ColorLutAccuracy_t {
+	double maxDE   = 0.0;
+	double meanDE  = 0.0;
+	float  maxDEInput[3] = {};
+	UINT   samples = 0;
+	bool   bDeltaEITP = false; // dE ITP (BT.2124) for PQ output, otherwise CIEDE2000
+};
+
+// Fills the chain the same way GetShaderConvertColor() selects its stages.
+void GetColorChain(
+	ColorChain_t& chain,
+	const DXVA2_ExtendedFormat exFmt,
+	const mp_cmat& cmatrix,
+	const int convertType,
+	const float luminanceScale);
+
+// Adds the ps_fix_hdr10.hlsl pass with the parameters sanitized as in SetHDR10ShaderParams().
+void SetColorChainHDR10(
+	ColorChain_t& chain,
+	float masteringMaxLuminanceNits,
+	float maxCLL,
+	float displayMaxNits,
+	int toneMappingType);
+
+// Analytic reference in double precision. Input and output are texture values in the 0..1 range.
+void EvalColorChain(const ColorChain_t& chain, const float in[3], float out[3]);
+
+// Bakes the chain into a size^3 lattice of RGBA half floats (DXGI_FORMAT_R16G16B16A16_FLOAT).
+// The first input component is the fastest changing axis (Texture3D width), the third one is the depth.
+HRESULT BakeColorLut3D(const ColorChain_t& chain, const UINT size, std::vector<uint16_t>& lut, UINT threads = 0);
+
+// Tetrahedral interpolation of a baked lattice, the same as the sampling shader would do.
+void SampleColorLut3D(const uint16_t* lut, const UINT size, const float in[3], float out[3]);
+
+// Compares the baked lattice against EvalColorChain() on lattice cell centres and pseudo-random inputs.
+// Does not need a device and can run headless.
+ColorLutAccuracy_t MeasureColorLut3D(const ColorChain_t& chain, const uint16_t* lut, const UINT size, const UINT samples = 100000);
+
+struct TrcLutAccuracy_t {
+	double maxErr      = 0.0; // absolute, in the units of mp_trc_linearize()
+	double maxRelErr   = 0.0; // relative to the reference, for references above 1/10000 of the peak
+	float  maxErrInput = 0.0f;
+	double errBound    = 0.0; // GetTrcLut1DErrorBound()
+	UINT   samples     = 0;
+};
+
+// Bakes mp_trc_linearize() into size float samples, sample i is the signal value i / (size - 1).
+HRESULT BakeTrcLut1D(const mp_csp_trc trc, const UINT size, std::vector<float>& lut);
+
+// Linear interpolation between the two nearest samples in single precision,
+// the same as the conversion shader does with two point loads (see ShaderTrcLut()).
+float SampleTrcLut1D(const float* lut, const UINT size, const float x);
+
+// The interpolation error of the baked table: the largest error found on 64 points of each cell
+// in double precision, plus the rounding of the samples to float and of the interpolation.
+double GetTrcLut1DErrorBound(const mp_csp_trc trc, const UINT size);
+
+// Compares SampleTrcLut1D() against mp_trc_linearize() on cell centres and pseudo-random inputs.
+// Does not need a device and can run headless.
+TrcLutAccuracy_t MeasureTrcLut1D(const mp_csp_trc trc, const float* lut, const UINT size, const UINT samples = 100000);
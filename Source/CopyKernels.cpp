@@ -0,0 +1,1933 @@
+/*
+* (C) 2018-2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+#include "stdafx.h"
+#include <memory>
+#include <immintrin.h>
+#include "Utils/CPUInfo.h"
+#include "Utils/gpu_memcpy_sse4.h"
+#include "Utils/gpu_memcpy_avx2.h"
+#include "Helper.h"
+
+// Copies a line with non-temporal stores. The head and the tail that do not fill
+// an aligned 16-byte block are written with ordinary stores.
+static inline void StreamLine(BYTE* dst, const BYTE* src, size_t size)
+{
+	const size_t head = std::min(size, (size_t)(-(intptr_t)dst & 15));
+	memcpy(dst, src, head);
+	dst += head;
+	src += head;
+	size -= head;
+
+	const size_t size64 = size & ~(size_t)63;
+	size_t i = 0;
+	for (; i < size64; i += 64) {
+		const __m128i v0 = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i v1 = _mm_loadu_si128((const __m128i*)(src + i + 16));
+		const __m128i v2 = _mm_loadu_si128((const __m128i*)(src + i + 32));
+		const __m128i v3 = _mm_loadu_si128((const __m128i*)(src + i + 48));
+		_mm_stream_si128((__m128i*)(dst + i),      v0);
+		_mm_stream_si128((__m128i*)(dst + i + 16), v1);
+		_mm_stream_si128((__m128i*)(dst + i + 32), v2);
+		_mm_stream_si128((__m128i*)(dst + i + 48), v3);
+	}
+	for (; i + 16 <= size; i += 16) {
+		_mm_stream_si128((__m128i*)(dst + i), _mm_loadu_si128((const __m128i*)(src + i)));
+	}
+	memcpy(dst + i, src + i, size - i);
+}
+
+void CopyPlaneAsIs_Stream(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	if (dst_pitch == src_pitch) {
+		StreamLine(dst, src, (size_t)dst_pitch * lines);
+	} else {
+		const UINT linesize = std::min((UINT)abs(src_pitch), dst_pitch);
+
+		for (UINT y = 0; y < lines; ++y) {
+			StreamLine(dst, src, linesize);
+			src += src_pitch;
+			dst += dst_pitch;
+		}
+	}
+	_mm_sfence();
+}
+
+// Runs a conversion kernel into a small cached buffer, a few lines at a time,
+// and streams the result to dst. The kernel reads abs(src_pitch) / src_bpp pixels
+// of a line and writes dst_bpp bytes for each of them.
+template <CopyFrameDataFn fn, UINT src_bpp, UINT dst_bpp>
+static void CopyFrame_Stream(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	constexpr UINT bufferSize = 32 * 1024; // fits in L1 or L2 cache
+
+	const UINT linesize = std::min((UINT)abs(src_pitch) / src_bpp * dst_bpp, dst_pitch);
+	const UINT bufPitch = ALIGN(linesize, 64);
+	const UINT bufLines = std::max(bufferSize / bufPitch, 1u);
+
+	thread_local std::unique_ptr<BYTE[]> buffer;
+	thread_local size_t allocated = 0;
+	const size_t size = (size_t)bufLines * bufPitch + 63;
+	if (allocated < size) {
+		buffer.reset(new(std::nothrow) BYTE[size]);
+		allocated = buffer ? size : 0;
+		if (!buffer) {
+			fn(lines, dst, dst_pitch, src, src_pitch);
+			return;
+		}
+	}
+	BYTE* buf = (BYTE*)ALIGN((uintptr_t)buffer.get(), 64);
+
+	for (UINT y = 0; y < lines; ) {
+		const UINT count = std::min(bufLines, lines - y);
+		fn(count, buf, bufPitch, src, src_pitch);
+		for (UINT i = 0; i < count; i++) {
+			StreamLine(dst, buf + (size_t)bufPitch * i, linesize);
+			dst += dst_pitch;
+		}
+		src += (ptrdiff_t)src_pitch * count;
+		y += count;
+	}
+	_mm_sfence();
+}
+
+// Copy kernels for the upload surfaces. The variants of a format are listed from the fastest to the scalar one,
+// the first variant that the processor supports is used. CF_NONE is any other format.
+// The upload surfaces and textures are D3DUSAGE_DYNAMIC or D3D11_USAGE_DYNAMIC, their memory is usually
+// write-combined. Non-temporal stores do not read it into the cache and do not evict the decoder data.
+#define COPY_KERNEL(cformat, vp, features, align, kernel, src_bpp, dst_bpp) \
+	{ cformat, vp, features, align, _CRT_WIDE(#kernel), CopyFrame_Stream<kernel, src_bpp, dst_bpp>, kernel }
+#define PLANAR_KERNEL(cformat, VP11Format, features, fn) \
+	{ cformat, VP_D3D11, features, 1, _CRT_WIDE(#fn), nullptr, nullptr, VP11Format, fn }
+#define PLANAR_KERNELS(cformat, VP11Format, fn) \
+	PLANAR_KERNEL(cformat, VP11Format, CPUInfo::CPU_SSE2, fn##_SSE2), \
+	PLANAR_KERNEL(cformat, VP11Format, 0,                 fn)
+#define COPY_KERNELS_10TO16(cformat) \
+	COPY_KERNEL(cformat,   0, CPUInfo::CPU_AVX2,   1, CopyPlane10to16_AVX2,  2, 2), \
+	COPY_KERNEL(cformat,   0, CPUInfo::CPU_SSE2,   1, CopyPlane10to16_SSE2,  2, 2), \
+	COPY_KERNEL(cformat,   0, 0,                   1, CopyPlane10to16,       2, 2)
+
+static const CopyKernel_t s_CopyKernels[] = {
+	// CopyFrameYV12 copies the whole frame, the lines of the chroma planes are not in the source order
+	{ CF_YV12, VP_DXVA2, 0, 1, L"CopyFrameYV12", CopyFrameYV12, CopyFrameYV12 },
+
+	COPY_KERNELS_10TO16(CF_YUV420P10),
+	COPY_KERNELS_10TO16(CF_YUV422P10),
+	COPY_KERNELS_10TO16(CF_YUV444P10),
+	COPY_KERNELS_10TO16(CF_GBRP10),
+	COPY_KERNELS_10TO16(CF_Y10),
+
+	COPY_KERNEL(CF_RGB24,  0, CPUInfo::CPU_SSSE3, 16, CopyFrameRGB24_SSSE3,  3, 4),
+	COPY_KERNEL(CF_RGB24,  0, 0,                   1, CopyFrameRGB24,        3, 4),
+
+	COPY_KERNEL(CF_r210,   0, CPUInfo::CPU_AVX2,   1, CopyFrameR210_AVX2,    4, 4),
+	COPY_KERNEL(CF_r210,   0, CPUInfo::CPU_SSE2,   1, CopyFrameR210_SSE2,    4, 4),
+	COPY_KERNEL(CF_r210,   0, 0,                   1, CopyFrameR210,         4, 4),
+
+	COPY_KERNEL(CF_RGB48,  0, CPUInfo::CPU_AVX2,   1, CopyFrameRGB48_AVX2,   6, 8),
+	COPY_KERNEL(CF_RGB48,  0, CPUInfo::CPU_SSSE3,  1, CopyFrameRGB48_SSSE3,  6, 8),
+	COPY_KERNEL(CF_RGB48,  0, 0,                   1, CopyFrameRGB48,        6, 8),
+
+	COPY_KERNEL(CF_BGR48,  0, CPUInfo::CPU_AVX2,   1, CopyFrameBGR48_AVX2,   6, 8),
+	COPY_KERNEL(CF_BGR48,  0, CPUInfo::CPU_SSSE3,  1, CopyFrameBGR48_SSSE3,  6, 8),
+	COPY_KERNEL(CF_BGR48,  0, 0,                   1, CopyFrameBGR48,        6, 8),
+
+	COPY_KERNEL(CF_BGRA64, 0, CPUInfo::CPU_AVX2,   1, CopyFrameBGRA64_AVX2,  8, 8),
+	COPY_KERNEL(CF_BGRA64, 0, CPUInfo::CPU_SSSE3,  1, CopyFrameBGRA64_SSSE3, 8, 8),
+	COPY_KERNEL(CF_BGRA64, 0, 0,                   1, CopyFrameBGRA64,       8, 8),
+
+	COPY_KERNEL(CF_B64A,   0, CPUInfo::CPU_AVX2,   1, CopyFrameB64A_AVX2,    8, 8),
+	COPY_KERNEL(CF_B64A,   0, CPUInfo::CPU_SSSE3,  1, CopyFrameB64A_SSSE3,   8, 8),
+	COPY_KERNEL(CF_B64A,   0, 0,                   1, CopyFrameB64A,         8, 8),
+
+	// the planes are interleaved into the semiplanar or packed input format of the D3D11 video processor
+	PLANAR_KERNELS(CF_YV12,      DXGI_FORMAT_NV12, ConvertYUV420P8toNV12),
+	PLANAR_KERNELS(CF_YUV420P8,  DXGI_FORMAT_NV12, ConvertYUV420P8toNV12),
+	PLANAR_KERNELS(CF_YUV420P10, DXGI_FORMAT_P010, ConvertYUV420P10toP010),
+	PLANAR_KERNELS(CF_YUV420P16, DXGI_FORMAT_P016, ConvertYUV420P16toP016),
+	PLANAR_KERNELS(CF_YV16,      DXGI_FORMAT_YUY2, ConvertYUV422P8toYUY2),
+	PLANAR_KERNELS(CF_YUV422P8,  DXGI_FORMAT_YUY2, ConvertYUV422P8toYUY2),
+	PLANAR_KERNELS(CF_YUV422P10, DXGI_FORMAT_Y210, ConvertYUV422P10toY210),
+	PLANAR_KERNELS(CF_YUV422P16, DXGI_FORMAT_Y216, ConvertYUV422P16toY216),
+
+	{ CF_NONE, 0, CPUInfo::CPU_SSE2, 1, L"CopyPlaneAsIs_Stream", CopyPlaneAsIs_Stream, CopyPlaneAsIs },
+	{ CF_NONE, 0, 0,                 1, L"CopyPlaneAsIs",        CopyPlaneAsIs,        CopyPlaneAsIs },
+};
+
+#undef COPY_KERNELS_10TO16
+#undef PLANAR_KERNELS
+#undef PLANAR_KERNEL
+#undef COPY_KERNEL
+
+std::span<const CopyKernel_t> GetCopyKernels()
+{
+	return s_CopyKernels;
+}
+
+static bool IsCopyKernelFor(const CopyKernel_t& item, const ColorFormat_t cformat, const int vp)
+{
+	return item.cformat == cformat && (item.vp == 0 || item.vp == vp) && !item.convert;
+}
+
+const CopyKernel_t& GetCopyPlaneKernel(const FmtConvParams_t& params, const int vp, const UINT srcAlign)
+{
+	const int features = CPUInfo::GetFeatures();
+
+	for (const ColorFormat_t cformat : { params.cformat, CF_NONE }) {
+		for (const auto& item : s_CopyKernels) {
+			if (IsCopyKernelFor(item, cformat, vp) && (item.features & features) == item.features && item.align <= srcAlign) {
+				return item;
+			}
+		}
+	}
+
+	return s_CopyKernels[std::size(s_CopyKernels) - 1];
+}
+
+CopyFrameDataFn GetCopyPlaneFunction(const FmtConvParams_t& params, const int vp, const UINT srcAlign)
+{
+	return GetCopyPlaneKernel(params, vp, srcAlign).fn;
+}
+
+CopyFrameDataFn GetConvertR10G10B10A2Function(const UINT dib_bitdepth)
+{
+	switch (dib_bitdepth) {
+	case 48:
+		if (CPUInfo::HaveAVX2()) {
+			return ConvertR10G10B10A2toBGR48_AVX2;
+		} else if (CPUInfo::HaveSSSE3()) {
+			return ConvertR10G10B10A2toBGR48_SSSE3;
+		} else {
+			return ConvertR10G10B10A2toBGR48;
+		}
+	case 64:
+		return CPUInfo::HaveAVX2() ? ConvertR10G10B10A2toBGR64_AVX2 : ConvertR10G10B10A2toBGR64_SSE2;
+	}
+
+	return CPUInfo::HaveAVX2() ? ConvertR10G10B10A2toBGR32_AVX2 : ConvertR10G10B10A2toBGR32_SSE2;
+}
+
+DXGI_FORMAT GetPlanarVP11Format(const ColorFormat_t cformat)
+{
+	for (const auto& item : s_CopyKernels) {
+		if (item.cformat == cformat && item.convert) {
+			return item.VP11Format;
+		}
+	}
+	return DXGI_FORMAT_UNKNOWN;
+}
+
+ConvertPlanarFn GetConvertPlanarFunction(const ColorFormat_t cformat, const wchar_t** ppName)
+{
+	const int features = CPUInfo::GetFeatures();
+
+	for (const auto& item : s_CopyKernels) {
+		if (item.cformat == cformat && item.convert && (item.features & features) == item.features) {
+			if (ppName) {
+				*ppName = item.name;
+			}
+			return item.convert;
+		}
+	}
+	return nullptr;
+}
+
+#define UNPACK_KERNEL(cformat, features, fn) { cformat, features, fn, _CRT_WIDE(#fn) }
+
+// the variants of a format from the fastest to the scalar one, as in s_CopyKernels
+static const UnpackKernel_t s_UnpackKernels[] = {
+	UNPACK_KERNEL(CF_V210, CPUInfo::CPU_AVX2,  UnpackV210toP210_AVX2),
+	UNPACK_KERNEL(CF_V210, CPUInfo::CPU_SSSE3, UnpackV210toP210_SSSE3),
+	UNPACK_KERNEL(CF_V210, 0,                  UnpackV210toP210),
+	UNPACK_KERNEL(CF_Y210, CPUInfo::CPU_AVX2,  UnpackY21xtoP21x_AVX2),
+	UNPACK_KERNEL(CF_Y210, CPUInfo::CPU_SSE2,  UnpackY21xtoP21x_SSE2),
+	UNPACK_KERNEL(CF_Y210, 0,                  UnpackY21xtoP21x),
+	UNPACK_KERNEL(CF_Y216, CPUInfo::CPU_AVX2,  UnpackY21xtoP21x_AVX2),
+	UNPACK_KERNEL(CF_Y216, CPUInfo::CPU_SSE2,  UnpackY21xtoP21x_SSE2),
+	UNPACK_KERNEL(CF_Y216, 0,                  UnpackY21xtoP21x),
+};
+
+#undef UNPACK_KERNEL
+
+std::span<const UnpackKernel_t> GetUnpackKernels()
+{
+	return s_UnpackKernels;
+}
+
+UnpackPackedFn GetUnpackPackedFunction(const ColorFormat_t cformat, const wchar_t** ppName)
+{
+	const int features = CPUInfo::GetFeatures();
+
+	for (const auto& item : s_UnpackKernels) {
+		if (item.cformat == cformat && (item.features & features) == item.features) {
+			if (ppName) {
+				*ppName = item.name;
+			}
+			return item.fn;
+		}
+	}
+	return nullptr;
+}
+
+void CopyPlaneAsIs(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	if (dst_pitch == src_pitch) {
+		memcpy(dst, src, dst_pitch * lines);
+		return;
+	}
+
+	const UINT linesize = std::min((UINT)abs(src_pitch), dst_pitch);
+
+	for (UINT y = 0; y < lines; ++y) {
+		memcpy(dst, src, linesize);
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyGpuFrame_SSE41(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	if (dst_pitch == src_pitch) {
+		gpu_memcpy(dst, src, dst_pitch * lines);
+		return;
+	}
+
+	const UINT linesize = std::min((UINT)abs(src_pitch), dst_pitch);
+
+	for (UINT y = 0; y < lines; ++y) {
+		gpu_memcpy(dst, src, linesize);
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyGpuFrame_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	if (dst_pitch == src_pitch) {
+		gpu_memcpy_avx2(dst, src, dst_pitch * lines);
+		return;
+	}
+
+	const UINT linesize = std::min((UINT)abs(src_pitch), dst_pitch);
+
+	for (UINT y = 0; y < lines; ++y) {
+		gpu_memcpy_avx2(dst, src, linesize);
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyFrameRGB24(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels  = abs(src_pitch) / 3;
+	UINT line_pixels4 = line_pixels & ~(4u - 1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		uint32_t* src32 = (uint32_t*)src;
+		uint32_t* dst32 = (uint32_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels4; i += 4) {
+			uint32_t sa = *src32++;
+			uint32_t sb = *src32++;
+			uint32_t sc = *src32++;
+
+			*dst32++ = sa & 0x00ffffff;
+			*dst32++ = ((sa >> 24) | (sb << 8)) & 0x00ffffff;
+			*dst32++ = ((sb >> 16) | (sc << 16)) & 0x00ffffff;
+			*dst32++ = sc >> 8;
+		}
+
+		if (i < line_pixels) {
+			if (line_pixels & 1) {
+				*dst32 = *src32 & 0x00ffffff;
+			} else {
+				uint32_t sa = *src32++;
+				uint32_t sb = *src32;
+
+				*dst32++ = sa & 0x00ffffff;
+				*dst32 = ((sa >> 24) | (sb << 8)) & 0x00ffffff;
+			}
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyFrameRGB24_SSSE3(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels   = abs(src_pitch) / 3;
+	UINT line_pixels4  = line_pixels & ~(4u - 1);
+	UINT line_pixels16 = line_pixels & ~(16u - 1);
+	__m128i mask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		__m128i *src128 = (__m128i*)src;
+		__m128i *dst128 = (__m128i*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels16; i += 16) {
+			__m128i sa = _mm_load_si128(src128++);
+			__m128i sb = _mm_load_si128(src128++);
+			__m128i sc = _mm_load_si128(src128++);
+
+			__m128i val = _mm_shuffle_epi8(sa, mask);
+			_mm_store_si128(dst128++, val);
+			val = _mm_shuffle_epi8(_mm_alignr_epi8(sb, sa, 12), mask);
+			_mm_store_si128(dst128++, val);
+			val = _mm_shuffle_epi8(_mm_alignr_epi8(sc, sb, 8), mask);
+			_mm_store_si128(dst128++, val);
+			val = _mm_shuffle_epi8(_mm_alignr_epi8(sc, sc, 4), mask);
+			_mm_store_si128(dst128++, val);
+		}
+
+		uint32_t* src32 = (uint32_t*)src128;
+		uint32_t* dst32 = (uint32_t*)dst128;
+		for (; i < line_pixels4; i += 4) {
+			uint32_t sa = *src32++;
+			uint32_t sb = *src32++;
+			uint32_t sc = *src32++;
+
+			*dst32++ = sa & 0x00ffffff;
+			*dst32++ = ((sa >> 24) | (sb << 8)) & 0x00ffffff;
+			*dst32++ = ((sb >> 16) | (sc << 16)) & 0x00ffffff;
+			*dst32++ = sc >> 8;
+		}
+
+		if (i < line_pixels) {
+			if (line_pixels & 1) {
+				*dst32 = *src32 & 0x00ffffff;
+			} else {
+				uint32_t sa = *src32++;
+				uint32_t sb = *src32;
+
+				*dst32++ = sa & 0x00ffffff;
+				*dst32 = ((sa >> 24) | (sb << 8)) & 0x00ffffff;
+			}
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+static inline uint64_t RGB48toRGBA64(const uint16_t* p)
+{
+	return (uint64_t)p[0] | ((uint64_t)p[1] << 16) | ((uint64_t)p[2] << 32);
+}
+
+// the last pixels that do not make a group of four
+static inline void CopyLineRGB48_Tail(uint64_t* dst64, const BYTE* src, UINT i, const UINT line_pixels)
+{
+	const uint16_t* src16 = (const uint16_t*)src + (size_t)i * 3;
+	for (; i < line_pixels; i++) {
+		dst64[i] = RGB48toRGBA64(src16);
+		src16 += 3;
+	}
+}
+
+void CopyFrameRGB48(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels  = abs(src_pitch) / 6;
+	UINT line_pixels4 = line_pixels & ~(4u - 1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		uint64_t* src64 = (uint64_t*)src;
+		uint64_t* dst64 = (uint64_t*)dst;
+		for (UINT i = 0; i < line_pixels4; i += 4) {
+			uint64_t sa = src64[0];
+			uint64_t sb = src64[1];
+			uint64_t sc = src64[2];
+
+			dst64[i + 0] = sa;
+			dst64[i + 1] = (sa >> 48) | (sb << 16);
+			dst64[i + 2] = (sb >> 32) | (sc << 32);
+			dst64[i + 3] = sc >> 16;
+
+			src64 += 3;
+		}
+		CopyLineRGB48_Tail(dst64, src, line_pixels4, line_pixels);
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyFrameRGB48_SSSE3(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	// bit-identical to CopyFrameRGB48(), the alpha of the first three pixels of each group is taken from the next pixel
+	UINT line_pixels  = abs(src_pitch) / 6;
+	UINT line_pixels4 = line_pixels & ~(4u - 1);
+	UINT line_pixels8 = line_pixels & ~(8u - 1);
+
+	const __m128i mask1 = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 6, 7, 8, 9, 10, 11, 12, 13);
+	const __m128i mask2 = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 6, 7, 8, 9, 10, 11, -1, -1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const __m128i* src128 = (const __m128i*)src;
+		__m128i* dst128 = (__m128i*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels8; i += 8) {
+			__m128i sa = _mm_loadu_si128(src128);
+			__m128i sb = _mm_loadu_si128(src128 + 1);
+			__m128i sc = _mm_loadu_si128(src128 + 2);
+
+			_mm_storeu_si128(dst128,     _mm_shuffle_epi8(sa, mask1));
+			_mm_storeu_si128(dst128 + 1, _mm_shuffle_epi8(_mm_alignr_epi8(sb, sa, 12), mask2));
+			_mm_storeu_si128(dst128 + 2, _mm_shuffle_epi8(_mm_alignr_epi8(sc, sb, 8), mask1));
+			_mm_storeu_si128(dst128 + 3, _mm_shuffle_epi8(_mm_alignr_epi8(sc, sc, 4), mask2));
+
+			src128 += 3;
+			dst128 += 4;
+		}
+		if (i < line_pixels4) {
+			const uint64_t* src64 = (const uint64_t*)src128;
+			uint64_t* dst64 = (uint64_t*)dst128;
+			uint64_t sa = src64[0];
+			uint64_t sb = src64[1];
+			uint64_t sc = src64[2];
+
+			dst64[0] = sa;
+			dst64[1] = (sa >> 48) | (sb << 16);
+			dst64[2] = (sb >> 32) | (sc << 32);
+			dst64[3] = sc >> 16;
+		}
+		CopyLineRGB48_Tail((uint64_t*)dst, src, line_pixels4, line_pixels);
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyFrameRGB48_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	// bit-identical to CopyFrameRGB48(), the alpha of the first three pixels of each group is taken from the next pixel
+	UINT line_pixels  = abs(src_pitch) / 6;
+	UINT line_pixels4 = line_pixels & ~(4u - 1);
+	UINT line_pixels8 = line_pixels & ~(8u - 1);
+
+	const __m256i mask = _mm256_setr_epi8(
+		0, 1, 2, 3, 4, 5, 6, 7, 6, 7, 8, 9, 10, 11, 12, 13,
+		4, 5, 6, 7, 8, 9, 10, 11, 10, 11, 12, 13, 14, 15, -1, -1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const BYTE* s = src;
+		uint64_t* dst64 = (uint64_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels8; i += 8) {
+			// lane 0 - bytes 0..15, lane 1 - bytes 8..23 of each 4-pixel group
+			__m256i va = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)s)), _mm_loadu_si128((const __m128i*)(s + 8)), 1);
+			__m256i vb = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(s + 24))), _mm_loadu_si128((const __m128i*)(s + 32)), 1);
+			_mm256_storeu_si256((__m256i*)(dst64 + i), _mm256_shuffle_epi8(va, mask));
+			_mm256_storeu_si256((__m256i*)(dst64 + i + 4), _mm256_shuffle_epi8(vb, mask));
+			s += 48;
+		}
+		if (i < line_pixels4) {
+			__m256i va = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)s)), _mm_loadu_si128((const __m128i*)(s + 8)), 1);
+			_mm256_storeu_si256((__m256i*)(dst64 + i), _mm256_shuffle_epi8(va, mask));
+		}
+		CopyLineRGB48_Tail(dst64, src, line_pixels4, line_pixels);
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+	_mm256_zeroupper();
+}
+
+void CopyFrameBGR48(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels  = abs(src_pitch) / 6;
+	UINT line_pixels4 = line_pixels & ~(4u - 1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		uint64_t* src64 = (uint64_t*)src;
+		uint64_t* dst64 = (uint64_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels4; i += 4) {
+			uint64_t sa = *src64++;
+			uint64_t sb = *src64++;
+			uint64_t sc = *src64++;
+
+			*dst64++ = ((sa & 0xffff) << 32) | (sa & 0xffff0000) | ((sa & 0xffff00000000) >> 32);
+			*dst64++ = ((sa & 0xffff000000000000) >> 16) | ((sb & 0xffff) << 16) | ((sb & 0xffff0000) >> 16);
+			*dst64++ = (sb & 0xffff00000000) | ((sb & 0xffff000000000000) >> 32) | (sc & 0xffff);
+			*dst64++ = ((sc & 0xffff0000) << 16) | ((sc & 0xffff00000000) >> 16) | ((sc & 0xffff000000000000) >> 48);
+		}
+
+		if (UINT remainder = line_pixels - i) {
+			uint64_t sa = *src64++;
+			*dst64++ = ((sa & 0xffff) << 32) | (sa & 0xffff0000) | ((sa & 0xffff00000000) >> 32);
+
+			if (remainder==2) {
+				uint64_t sb = *(uint32_t*)src64;
+				*dst64 = ((sa & 0xffff000000000000) >> 16) | ((sb & 0xffff) << 16) | ((sb & 0xffff0000) >> 16);
+			}
+			else if (remainder == 3) {
+				uint64_t sb = *src64++;
+				uint64_t sc = *(uint32_t*)src64;
+				*dst64++ = ((sa & 0xffff000000000000) >> 16) | ((sb & 0xffff) << 16) | ((sb & 0xffff0000) >> 16);
+				*dst64 = (sb & 0xffff00000000) | ((sb & 0xffff000000000000) >> 32) | (sc & 0xffff);
+			}
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+static inline uint64_t BGR48toRGBA64(const uint16_t* p)
+{
+	return (uint64_t)p[2] | ((uint64_t)p[1] << 16) | ((uint64_t)p[0] << 32);
+}
+
+void CopyFrameBGR48_SSSE3(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels  = abs(src_pitch) / 6;
+	UINT line_pixels8 = line_pixels & ~(8u - 1);
+
+	const __m128i mask = _mm_setr_epi8(4, 5, 2, 3, 0, 1, -1, -1, 10, 11, 8, 9, 6, 7, -1, -1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const __m128i* src128 = (const __m128i*)src;
+		__m128i* dst128 = (__m128i*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels8; i += 8) {
+			__m128i sa = _mm_loadu_si128(src128);
+			__m128i sb = _mm_loadu_si128(src128 + 1);
+			__m128i sc = _mm_loadu_si128(src128 + 2);
+
+			_mm_storeu_si128(dst128,     _mm_shuffle_epi8(sa, mask));
+			_mm_storeu_si128(dst128 + 1, _mm_shuffle_epi8(_mm_alignr_epi8(sb, sa, 12), mask));
+			_mm_storeu_si128(dst128 + 2, _mm_shuffle_epi8(_mm_alignr_epi8(sc, sb, 8), mask));
+			_mm_storeu_si128(dst128 + 3, _mm_shuffle_epi8(_mm_alignr_epi8(sc, sc, 4), mask));
+
+			src128 += 3;
+			dst128 += 4;
+		}
+
+		const uint16_t* src16 = (const uint16_t*)src128;
+		uint64_t* dst64 = (uint64_t*)dst128;
+		for (; i < line_pixels; i++) {
+			*dst64++ = BGR48toRGBA64(src16);
+			src16 += 3;
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyFrameBGR48_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels  = abs(src_pitch) / 6;
+	UINT line_pixels4 = line_pixels & ~(4u - 1);
+
+	const __m256i mask = _mm256_setr_epi8(
+		4, 5, 2, 3, 0, 1, -1, -1, 10, 11, 8, 9, 6, 7, -1, -1,
+		8, 9, 6, 7, 4, 5, -1, -1, 14, 15, 12, 13, 10, 11, -1, -1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const BYTE* s = src;
+		uint64_t* dst64 = (uint64_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels4; i += 4) {
+			// lane 0 - bytes 0..15, lane 1 - bytes 8..23 of the 4-pixel group
+			__m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)s)), _mm_loadu_si128((const __m128i*)(s + 8)), 1);
+			_mm256_storeu_si256((__m256i*)(dst64 + i), _mm256_shuffle_epi8(v, mask));
+			s += 24;
+		}
+
+		const uint16_t* src16 = (const uint16_t*)s;
+		for (; i < line_pixels; i++) {
+			dst64[i] = BGR48toRGBA64(src16);
+			src16 += 3;
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+	_mm256_zeroupper();
+}
+
+void CopyFrameBGRA64(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels = abs(src_pitch) / 8;
+
+	for (UINT y = 0; y < lines; ++y) {
+		uint64_t* src64 = (uint64_t*)src;
+		uint64_t* dst64 = (uint64_t*)dst;
+		for (UINT i = 0; i < line_pixels; ++i) {
+			dst64[i] =
+				((src64[i] & 0x000000000000ffff) << 32) |
+				((src64[i] & 0x0000ffff00000000) >> 32) |
+				( src64[i] & 0xffff0000ffff0000);
+		}
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyFrameBGRA64_SSSE3(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels  = abs(src_pitch) / 8;
+	UINT line_pixels2 = line_pixels & ~(2u - 1);
+
+	const __m128i mask = _mm_setr_epi8(4, 5, 2, 3, 0, 1, 6, 7, 12, 13, 10, 11, 8, 9, 14, 15);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint64_t* src64 = (const uint64_t*)src;
+		uint64_t* dst64 = (uint64_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels2; i += 2) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(src64 + i));
+			_mm_storeu_si128((__m128i*)(dst64 + i), _mm_shuffle_epi8(v, mask));
+		}
+		if (i < line_pixels) {
+			dst64[i] =
+				((src64[i] & 0x000000000000ffff) << 32) |
+				((src64[i] & 0x0000ffff00000000) >> 32) |
+				( src64[i] & 0xffff0000ffff0000);
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyFrameBGRA64_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels  = abs(src_pitch) / 8;
+	UINT line_pixels4 = line_pixels & ~(4u - 1);
+
+	const __m256i mask = _mm256_setr_epi8(
+		4, 5, 2, 3, 0, 1, 6, 7, 12, 13, 10, 11, 8, 9, 14, 15,
+		4, 5, 2, 3, 0, 1, 6, 7, 12, 13, 10, 11, 8, 9, 14, 15);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint64_t* src64 = (const uint64_t*)src;
+		uint64_t* dst64 = (uint64_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels4; i += 4) {
+			__m256i v = _mm256_loadu_si256((const __m256i*)(src64 + i));
+			_mm256_storeu_si256((__m256i*)(dst64 + i), _mm256_shuffle_epi8(v, mask));
+		}
+		for (; i < line_pixels; i++) {
+			dst64[i] =
+				((src64[i] & 0x000000000000ffff) << 32) |
+				((src64[i] & 0x0000ffff00000000) >> 32) |
+				( src64[i] & 0xffff0000ffff0000);
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+	_mm256_zeroupper();
+}
+
+void CopyFrameB64A(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels = abs(src_pitch) / 8;
+
+	for (UINT y = 0; y < lines; ++y) {
+		uint64_t* src64 = (uint64_t*)src;
+		uint64_t* dst64 = (uint64_t*)dst;
+		for (UINT i = 0; i < line_pixels; ++i) {
+			dst64[i] =
+				((src64[i] & 0xFF00FF00FF000000) >> 24) +
+				((src64[i] & 0x00FF00FF00FF0000) >>  8) +
+				((src64[i] & 0x000000000000FF00) << 40) +
+				((src64[i] & 0x00000000000000FF) << 56);
+		}
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyFrameB64A_SSSE3(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels  = abs(src_pitch) / 8;
+	UINT line_pixels2 = line_pixels & ~(2u - 1);
+
+	const __m128i mask = _mm_setr_epi8(3, 2, 5, 4, 7, 6, 1, 0, 11, 10, 13, 12, 15, 14, 9, 8);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint64_t* src64 = (const uint64_t*)src;
+		uint64_t* dst64 = (uint64_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels2; i += 2) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(src64 + i));
+			_mm_storeu_si128((__m128i*)(dst64 + i), _mm_shuffle_epi8(v, mask));
+		}
+		if (i < line_pixels) {
+			dst64[i] =
+				((src64[i] & 0xFF00FF00FF000000) >> 24) +
+				((src64[i] & 0x00FF00FF00FF0000) >>  8) +
+				((src64[i] & 0x000000000000FF00) << 40) +
+				((src64[i] & 0x00000000000000FF) << 56);
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyFrameB64A_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels  = abs(src_pitch) / 8;
+	UINT line_pixels4 = line_pixels & ~(4u - 1);
+
+	const __m256i mask = _mm256_setr_epi8(
+		3, 2, 5, 4, 7, 6, 1, 0, 11, 10, 13, 12, 15, 14, 9, 8,
+		3, 2, 5, 4, 7, 6, 1, 0, 11, 10, 13, 12, 15, 14, 9, 8);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint64_t* src64 = (const uint64_t*)src;
+		uint64_t* dst64 = (uint64_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels4; i += 4) {
+			__m256i v = _mm256_loadu_si256((const __m256i*)(src64 + i));
+			_mm256_storeu_si256((__m256i*)(dst64 + i), _mm256_shuffle_epi8(v, mask));
+		}
+		for (; i < line_pixels; i++) {
+			dst64[i] =
+				((src64[i] & 0xFF00FF00FF000000) >> 24) +
+				((src64[i] & 0x00FF00FF00FF0000) >>  8) +
+				((src64[i] & 0x000000000000FF00) << 40) +
+				((src64[i] & 0x00000000000000FF) << 56);
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+	_mm256_zeroupper();
+}
+
+void CopyFrameYV12(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+
+	if (dst_pitch == src_pitch) {
+		memcpy(dst, src, dst_pitch * lines);
+		return;
+	}
+
+	const UINT chromaheight = lines / 3;
+	const UINT lumaheight = chromaheight * 2;
+
+	for (UINT y = 0; y < lumaheight; ++y) {
+		memcpy(dst, src, src_pitch);
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+
+	src_pitch /= 2;
+	dst_pitch /= 2;
+	for (UINT y = 0; y < chromaheight; ++y) {
+		memcpy(dst, src, src_pitch);
+		src += src_pitch;
+		dst += dst_pitch;
+		memcpy(dst, src, src_pitch);
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyFrameY410(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	UINT line_pixels = src_pitch / 4;
+
+	for (UINT y = 0; y < lines; ++y) {
+		uint32_t* src32 = (uint32_t*)src;
+		uint32_t* dst32 = (uint32_t*)dst;
+		for (UINT i = 0; i < line_pixels; i++) {
+			uint32_t t = src32[i];
+			// U = (t & 0x000003ff); Y = (t & 0x000ffc00) >> 10; V = (t & 0x3ff00000) >> 20; A = (t & 0xC0000000) >> 30;
+			//dst32[i] = (t & 0xC0000000) | ((t & 0x000fffff) << 10) | ((t & 0x3ff00000) >> 20); // to D3DFMT_A2R10G10B10
+			dst32[i] = (t & 0xfff00000) | ((t & 0x000003ff) << 10) | ((t & 0x000ffc00) >> 10); // to D3DFMT_A2B10G10R10
+		}
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+static inline uint32_t R210toRGB10A2(const uint32_t t)
+{
+	uint32_t r = ((t & 0x0000003f) << 4) | ((t & 0x0000f000) >> 12);
+	uint32_t g = ((t & 0x00fc0000) >> 8) | ((t & 0x00000f00) << 8);
+	uint32_t b = ((t & 0xff000000) >> 4) | ((t & 0x00030000) << 12);
+	return r | g | b;
+}
+
+void CopyFrameR210(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	UINT line_pixels = src_pitch / 4;
+
+	for (UINT y = 0; y < lines; ++y) {
+		uint32_t* src32 = (uint32_t*)src;
+		uint32_t* dst32 = (uint32_t*)dst;
+		for (UINT i = 0; i < line_pixels; i++) {
+			dst32[i] = R210toRGB10A2(src32[i]);
+		}
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyFrameR210_SSE2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	UINT line_pixels  = src_pitch / 4;
+	UINT line_pixels4 = line_pixels & ~(4u - 1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint32_t* src32 = (const uint32_t*)src;
+		uint32_t* dst32 = (uint32_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels4; i += 4) {
+			const __m128i t = _mm_loadu_si128((const __m128i*)(src32 + i));
+			__m128i r = _mm_or_si128(
+				_mm_slli_epi32(_mm_and_si128(t, _mm_set1_epi32(0x0000003f)), 4),
+				_mm_srli_epi32(_mm_and_si128(t, _mm_set1_epi32(0x0000f000)), 12));
+			__m128i g = _mm_or_si128(
+				_mm_srli_epi32(_mm_and_si128(t, _mm_set1_epi32(0x00fc0000)), 8),
+				_mm_slli_epi32(_mm_and_si128(t, _mm_set1_epi32(0x00000f00)), 8));
+			__m128i b = _mm_or_si128(
+				_mm_srli_epi32(_mm_and_si128(t, _mm_set1_epi32(0xff000000)), 4),
+				_mm_slli_epi32(_mm_and_si128(t, _mm_set1_epi32(0x00030000)), 12));
+			_mm_storeu_si128((__m128i*)(dst32 + i), _mm_or_si128(_mm_or_si128(r, g), b));
+		}
+		for (; i < line_pixels; i++) {
+			dst32[i] = R210toRGB10A2(src32[i]);
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyFrameR210_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	UINT line_pixels  = src_pitch / 4;
+	UINT line_pixels8 = line_pixels & ~(8u - 1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint32_t* src32 = (const uint32_t*)src;
+		uint32_t* dst32 = (uint32_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels8; i += 8) {
+			const __m256i t = _mm256_loadu_si256((const __m256i*)(src32 + i));
+			__m256i r = _mm256_or_si256(
+				_mm256_slli_epi32(_mm256_and_si256(t, _mm256_set1_epi32(0x0000003f)), 4),
+				_mm256_srli_epi32(_mm256_and_si256(t, _mm256_set1_epi32(0x0000f000)), 12));
+			__m256i g = _mm256_or_si256(
+				_mm256_srli_epi32(_mm256_and_si256(t, _mm256_set1_epi32(0x00fc0000)), 8),
+				_mm256_slli_epi32(_mm256_and_si256(t, _mm256_set1_epi32(0x00000f00)), 8));
+			__m256i b = _mm256_or_si256(
+				_mm256_srli_epi32(_mm256_and_si256(t, _mm256_set1_epi32(0xff000000)), 4),
+				_mm256_slli_epi32(_mm256_and_si256(t, _mm256_set1_epi32(0x00030000)), 12));
+			_mm256_storeu_si256((__m256i*)(dst32 + i), _mm256_or_si256(_mm256_or_si256(r, g), b));
+		}
+		for (; i < line_pixels; i++) {
+			dst32[i] = R210toRGB10A2(src32[i]);
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+	_mm256_zeroupper();
+}
+
+void CopyPlane10to16(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	UINT line_pixels = src_pitch / 2;
+
+	for (UINT y = 0; y < lines; ++y) {
+		uint16_t* src16 = (uint16_t*)src;
+		uint16_t* dst16 = (uint16_t*)dst;
+		for (UINT i = 0; i < line_pixels; i++) {
+			dst16[i] = src16[i] << 6;
+		}
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyPlane10to16_SSE2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	UINT line_pixels  = src_pitch / 2;
+	UINT line_pixels8 = line_pixels & ~(8u - 1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint16_t* src16 = (const uint16_t*)src;
+		uint16_t* dst16 = (uint16_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels8; i += 8) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(src16 + i));
+			_mm_storeu_si128((__m128i*)(dst16 + i), _mm_slli_epi16(v, 6));
+		}
+		for (; i < line_pixels; i++) {
+			dst16[i] = src16[i] << 6;
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void CopyPlane10to16_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	UINT line_pixels   = src_pitch / 2;
+	UINT line_pixels16 = line_pixels & ~(16u - 1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint16_t* src16 = (const uint16_t*)src;
+		uint16_t* dst16 = (uint16_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels16; i += 16) {
+			__m256i v = _mm256_loadu_si256((const __m256i*)(src16 + i));
+			_mm256_storeu_si256((__m256i*)(dst16 + i), _mm256_slli_epi16(v, 6));
+		}
+		for (; i < line_pixels; i++) {
+			dst16[i] = src16[i] << 6;
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+	_mm256_zeroupper();
+}
+
+// Planar YUV to NV12, P010, P016, YUY2, Y210, Y216
+
+static inline void StoreStream(__m128i* dst, const __m128i v, const bool aligned)
+{
+	if (aligned) {
+		_mm_stream_si128(dst, v);
+	} else {
+		_mm_storeu_si128(dst, v);
+	}
+}
+
+template <int shift>
+static void ConvertPlanar420to16(const UINT lines, BYTE* dstY, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ASSERT(src_pitch > 0 && !(lines & 1));
+	const UINT line_pixels = std::min((UINT)src_pitch, dst_pitch) / 2;
+	const int chroma_pitch = src_pitch / 2;
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint16_t* src16 = (const uint16_t*)srcY;
+		uint16_t* dst16 = (uint16_t*)dstY;
+		for (UINT i = 0; i < line_pixels; i++) {
+			dst16[i] = src16[i] << shift;
+		}
+		srcY += src_pitch;
+		dstY += dst_pitch;
+	}
+
+	for (UINT y = 0; y < lines / 2; ++y) {
+		const uint16_t* u16 = (const uint16_t*)srcU;
+		const uint16_t* v16 = (const uint16_t*)srcV;
+		uint16_t* dst16 = (uint16_t*)dstUV;
+		for (UINT i = 0; i < line_pixels / 2; i++) {
+			dst16[i * 2 + 0] = u16[i] << shift;
+			dst16[i * 2 + 1] = v16[i] << shift;
+		}
+		srcU += chroma_pitch;
+		srcV += chroma_pitch;
+		dstUV += dst_pitch;
+	}
+}
+
+template <int shift>
+static void ConvertPlanar420to16_SSE2(const UINT lines, BYTE* dstY, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ASSERT(src_pitch > 0 && !(lines & 1));
+	const UINT line_pixels   = std::min((UINT)src_pitch, dst_pitch) / 2;
+	const UINT line_pixels8  = line_pixels & ~(8u - 1);
+	const UINT chroma_pixels = line_pixels / 2;
+	const UINT chroma_pixels8 = chroma_pixels & ~(8u - 1);
+	const int chroma_pitch = src_pitch / 2;
+	const bool aligned = !(((size_t)dstY | (size_t)dstUV | dst_pitch) & 15);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint16_t* src16 = (const uint16_t*)srcY;
+		uint16_t* dst16 = (uint16_t*)dstY;
+
+		UINT i = 0;
+		for (; i < line_pixels8; i += 8) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(src16 + i));
+			StoreStream((__m128i*)(dst16 + i), _mm_slli_epi16(v, shift), aligned);
+		}
+		for (; i < line_pixels; i++) {
+			dst16[i] = src16[i] << shift;
+		}
+		srcY += src_pitch;
+		dstY += dst_pitch;
+	}
+
+	for (UINT y = 0; y < lines / 2; ++y) {
+		const uint16_t* u16 = (const uint16_t*)srcU;
+		const uint16_t* v16 = (const uint16_t*)srcV;
+		uint16_t* dst16 = (uint16_t*)dstUV;
+
+		UINT i = 0;
+		for (; i < chroma_pixels8; i += 8) {
+			__m128i u = _mm_slli_epi16(_mm_loadu_si128((const __m128i*)(u16 + i)), shift);
+			__m128i v = _mm_slli_epi16(_mm_loadu_si128((const __m128i*)(v16 + i)), shift);
+			StoreStream((__m128i*)(dst16 + i * 2), _mm_unpacklo_epi16(u, v), aligned);
+			StoreStream((__m128i*)(dst16 + i * 2 + 8), _mm_unpackhi_epi16(u, v), aligned);
+		}
+		for (; i < chroma_pixels; i++) {
+			dst16[i * 2 + 0] = u16[i] << shift;
+			dst16[i * 2 + 1] = v16[i] << shift;
+		}
+		srcU += chroma_pitch;
+		srcV += chroma_pitch;
+		dstUV += dst_pitch;
+	}
+
+	_mm_sfence();
+}
+
+template <int shift>
+static void ConvertPlanar422to16(const UINT lines, BYTE* dst, BYTE*, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	const UINT pairs = std::min((UINT)src_pitch, dst_pitch / 2) / 4;
+	const int chroma_pitch = src_pitch / 2;
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint16_t* y16 = (const uint16_t*)srcY;
+		const uint16_t* u16 = (const uint16_t*)srcU;
+		const uint16_t* v16 = (const uint16_t*)srcV;
+		uint16_t* dst16 = (uint16_t*)dst;
+		for (UINT i = 0; i < pairs; i++) {
+			dst16[i * 4 + 0] = y16[i * 2 + 0] << shift;
+			dst16[i * 4 + 1] = u16[i] << shift;
+			dst16[i * 4 + 2] = y16[i * 2 + 1] << shift;
+			dst16[i * 4 + 3] = v16[i] << shift;
+		}
+		srcY += src_pitch;
+		srcU += chroma_pitch;
+		srcV += chroma_pitch;
+		dst += dst_pitch;
+	}
+}
+
+template <int shift>
+static void ConvertPlanar422to16_SSE2(const UINT lines, BYTE* dst, BYTE*, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	const UINT pairs  = std::min((UINT)src_pitch, dst_pitch / 2) / 4;
+	const UINT pairs4 = pairs & ~(4u - 1);
+	const int chroma_pitch = src_pitch / 2;
+	const bool aligned = !(((size_t)dst | dst_pitch) & 15);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint16_t* y16 = (const uint16_t*)srcY;
+		const uint16_t* u16 = (const uint16_t*)srcU;
+		const uint16_t* v16 = (const uint16_t*)srcV;
+		uint16_t* dst16 = (uint16_t*)dst;
+
+		UINT i = 0;
+		for (; i < pairs4; i += 4) {
+			__m128i yy = _mm_slli_epi16(_mm_loadu_si128((const __m128i*)(y16 + i * 2)), shift);
+			__m128i u  = _mm_slli_epi16(_mm_loadl_epi64((const __m128i*)(u16 + i)), shift);
+			__m128i v  = _mm_slli_epi16(_mm_loadl_epi64((const __m128i*)(v16 + i)), shift);
+			__m128i uv = _mm_unpacklo_epi16(u, v);
+			StoreStream((__m128i*)(dst16 + i * 4), _mm_unpacklo_epi16(yy, uv), aligned);
+			StoreStream((__m128i*)(dst16 + i * 4 + 8), _mm_unpackhi_epi16(yy, uv), aligned);
+		}
+		for (; i < pairs; i++) {
+			dst16[i * 4 + 0] = y16[i * 2 + 0] << shift;
+			dst16[i * 4 + 1] = u16[i] << shift;
+			dst16[i * 4 + 2] = y16[i * 2 + 1] << shift;
+			dst16[i * 4 + 3] = v16[i] << shift;
+		}
+		srcY += src_pitch;
+		srcU += chroma_pitch;
+		srcV += chroma_pitch;
+		dst += dst_pitch;
+	}
+
+	_mm_sfence();
+}
+
+void ConvertYUV420P8toNV12(const UINT lines, BYTE* dstY, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ASSERT(src_pitch > 0 && !(lines & 1));
+	const UINT line_pixels = std::min((UINT)src_pitch, dst_pitch);
+	const int chroma_pitch = src_pitch / 2;
+
+	for (UINT y = 0; y < lines; ++y) {
+		memcpy(dstY, srcY, line_pixels);
+		srcY += src_pitch;
+		dstY += dst_pitch;
+	}
+
+	for (UINT y = 0; y < lines / 2; ++y) {
+		for (UINT i = 0; i < line_pixels / 2; i++) {
+			dstUV[i * 2 + 0] = srcU[i];
+			dstUV[i * 2 + 1] = srcV[i];
+		}
+		srcU += chroma_pitch;
+		srcV += chroma_pitch;
+		dstUV += dst_pitch;
+	}
+}
+
+void ConvertYUV420P8toNV12_SSE2(const UINT lines, BYTE* dstY, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ASSERT(src_pitch > 0 && !(lines & 1));
+	const UINT line_pixels    = std::min((UINT)src_pitch, dst_pitch);
+	const UINT chroma_pixels  = line_pixels / 2;
+	const UINT chroma_pixels16 = chroma_pixels & ~(16u - 1);
+	const int chroma_pitch = src_pitch / 2;
+	const bool aligned = !(((size_t)dstUV | dst_pitch) & 15);
+
+	for (UINT y = 0; y < lines; ++y) {
+		StreamLine(dstY, srcY, line_pixels);
+		srcY += src_pitch;
+		dstY += dst_pitch;
+	}
+
+	for (UINT y = 0; y < lines / 2; ++y) {
+		UINT i = 0;
+		for (; i < chroma_pixels16; i += 16) {
+			__m128i u = _mm_loadu_si128((const __m128i*)(srcU + i));
+			__m128i v = _mm_loadu_si128((const __m128i*)(srcV + i));
+			StoreStream((__m128i*)(dstUV + i * 2), _mm_unpacklo_epi8(u, v), aligned);
+			StoreStream((__m128i*)(dstUV + i * 2 + 16), _mm_unpackhi_epi8(u, v), aligned);
+		}
+		for (; i < chroma_pixels; i++) {
+			dstUV[i * 2 + 0] = srcU[i];
+			dstUV[i * 2 + 1] = srcV[i];
+		}
+		srcU += chroma_pitch;
+		srcV += chroma_pitch;
+		dstUV += dst_pitch;
+	}
+
+	_mm_sfence();
+}
+
+void ConvertYUV420P10toP010(const UINT lines, BYTE* dstY, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ConvertPlanar420to16<6>(lines, dstY, dstUV, dst_pitch, srcY, srcU, srcV, src_pitch);
+}
+
+void ConvertYUV420P10toP010_SSE2(const UINT lines, BYTE* dstY, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ConvertPlanar420to16_SSE2<6>(lines, dstY, dstUV, dst_pitch, srcY, srcU, srcV, src_pitch);
+}
+
+void ConvertYUV420P16toP016(const UINT lines, BYTE* dstY, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ConvertPlanar420to16<0>(lines, dstY, dstUV, dst_pitch, srcY, srcU, srcV, src_pitch);
+}
+
+void ConvertYUV420P16toP016_SSE2(const UINT lines, BYTE* dstY, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ConvertPlanar420to16_SSE2<0>(lines, dstY, dstUV, dst_pitch, srcY, srcU, srcV, src_pitch);
+}
+
+void ConvertYUV422P8toYUY2(const UINT lines, BYTE* dst, BYTE*, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	const UINT pairs = std::min((UINT)src_pitch, dst_pitch / 2) / 2;
+	const int chroma_pitch = src_pitch / 2;
+
+	for (UINT y = 0; y < lines; ++y) {
+		for (UINT i = 0; i < pairs; i++) {
+			dst[i * 4 + 0] = srcY[i * 2 + 0];
+			dst[i * 4 + 1] = srcU[i];
+			dst[i * 4 + 2] = srcY[i * 2 + 1];
+			dst[i * 4 + 3] = srcV[i];
+		}
+		srcY += src_pitch;
+		srcU += chroma_pitch;
+		srcV += chroma_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void ConvertYUV422P8toYUY2_SSE2(const UINT lines, BYTE* dst, BYTE*, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	const UINT pairs  = std::min((UINT)src_pitch, dst_pitch / 2) / 2;
+	const UINT pairs8 = pairs & ~(8u - 1);
+	const int chroma_pitch = src_pitch / 2;
+	const bool aligned = !(((size_t)dst | dst_pitch) & 15);
+
+	for (UINT y = 0; y < lines; ++y) {
+		UINT i = 0;
+		for (; i < pairs8; i += 8) {
+			__m128i yy = _mm_loadu_si128((const __m128i*)(srcY + i * 2));
+			__m128i uv = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(srcU + i)), _mm_loadl_epi64((const __m128i*)(srcV + i)));
+			StoreStream((__m128i*)(dst + i * 4), _mm_unpacklo_epi8(yy, uv), aligned);
+			StoreStream((__m128i*)(dst + i * 4 + 16), _mm_unpackhi_epi8(yy, uv), aligned);
+		}
+		for (; i < pairs; i++) {
+			dst[i * 4 + 0] = srcY[i * 2 + 0];
+			dst[i * 4 + 1] = srcU[i];
+			dst[i * 4 + 2] = srcY[i * 2 + 1];
+			dst[i * 4 + 3] = srcV[i];
+		}
+		srcY += src_pitch;
+		srcU += chroma_pitch;
+		srcV += chroma_pitch;
+		dst += dst_pitch;
+	}
+
+	_mm_sfence();
+}
+
+void ConvertYUV422P10toY210(const UINT lines, BYTE* dst, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ConvertPlanar422to16<6>(lines, dst, dstUV, dst_pitch, srcY, srcU, srcV, src_pitch);
+}
+
+void ConvertYUV422P10toY210_SSE2(const UINT lines, BYTE* dst, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ConvertPlanar422to16_SSE2<6>(lines, dst, dstUV, dst_pitch, srcY, srcU, srcV, src_pitch);
+}
+
+void ConvertYUV422P16toY216(const UINT lines, BYTE* dst, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ConvertPlanar422to16<0>(lines, dst, dstUV, dst_pitch, srcY, srcU, srcV, src_pitch);
+}
+
+void ConvertYUV422P16toY216_SSE2(const UINT lines, BYTE* dst, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch)
+{
+	ConvertPlanar422to16_SSE2<0>(lines, dst, dstUV, dst_pitch, srcY, srcU, srcV, src_pitch);
+}
+
+// v210, Y210, Y216 to P210, P216 (separate luma and chroma planes)
+
+static inline void StoreStream(__m256i* dst, const __m256i v, const bool aligned)
+{
+	if (aligned) {
+		_mm256_stream_si256(dst, v);
+	} else {
+		_mm256_storeu_si256(dst, v);
+	}
+}
+
+// v210 packs 6 pixels in 4 little-endian 32-bit words of three 10-bit samples:
+// Cb0 Y0 Cr0 | Y1 Cb2 Y2 | Cr2 Y3 Cb4 | Y4 Cr4 Y5
+static inline uint16_t V210Sample(const uint32_t w, const int shift)
+{
+	return (uint16_t)(((w >> shift) & 0x3ff) << 6);
+}
+
+// unpacks the pairs of pixels from first to pairs, first is a multiple of 3
+static void UnpackV210Pairs(const BYTE* src, uint16_t* dstY, uint16_t* dstUV, const UINT first, const UINT pairs)
+{
+	for (UINT i = first; i < pairs; i += 3) {
+		const uint32_t* w = (const uint32_t*)src + i / 3 * 4;
+		const uint16_t yy[6] = {
+			V210Sample(w[0], 10), V210Sample(w[1], 0), V210Sample(w[1], 20),
+			V210Sample(w[2], 10), V210Sample(w[3], 0), V210Sample(w[3], 20)
+		};
+		const uint16_t uv[6] = {
+			V210Sample(w[0], 0),  V210Sample(w[0], 20), V210Sample(w[1], 10),
+			V210Sample(w[2], 0),  V210Sample(w[2], 20), V210Sample(w[3], 10)
+		};
+		const UINT count = std::min(3u, pairs - i) * 2;
+		for (UINT k = 0; k < count; k++) {
+			dstY[i * 2 + k]  = yy[k];
+			dstUV[i * 2 + k] = uv[k];
+		}
+	}
+}
+
+static inline UINT V210LinePairs(const UINT dstY_pitch, const UINT dstUV_pitch, const int src_pitch)
+{
+	return std::min({ (UINT)src_pitch / 16 * 3, dstY_pitch / 4, dstUV_pitch / 4 });
+}
+
+void UnpackV210toP210(const UINT lines, BYTE* dstY, UINT dstY_pitch, BYTE* dstUV, UINT dstUV_pitch, const BYTE* src, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	const UINT pairs = V210LinePairs(dstY_pitch, dstUV_pitch, src_pitch);
+
+	for (UINT y = 0; y < lines; ++y) {
+		UnpackV210Pairs(src, (uint16_t*)dstY, (uint16_t*)dstUV, 0, pairs);
+		src += src_pitch;
+		dstY += dstY_pitch;
+		dstUV += dstUV_pitch;
+	}
+}
+
+// the pshufb controls of the 16-bit samples, -1 clears a sample
+#define W(n) (char)(2 * (n)), (char)(2 * (n) + 1)
+#define Z    -1, -1
+
+// Unpacks the 4 words of each 128-bit lane to 6 luma and 6 chroma samples, the last 4 bytes are zero.
+// t0 - the first and the second sample of each word: Cb0 Y0 Y1 Cb2 Cr2 Y3 Y4 Cr4,
+// t1 - the third sample of each word: Cr0 0 Y2 0 Cb4 0 Y5 0.
+static inline void UnpackV210Group_SSSE3(const __m128i w, __m128i& yy, __m128i& uv)
+{
+	const __m128i mask = _mm_set1_epi32(0x3ff);
+	const __m128i f1 = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(w, 10), mask), 16);
+	const __m128i t0 = _mm_slli_epi16(_mm_or_si128(_mm_and_si128(w, mask), f1), 6);
+	const __m128i t1 = _mm_slli_epi16(_mm_and_si128(_mm_srli_epi32(w, 20), mask), 6);
+
+	yy = _mm_or_si128(_mm_shuffle_epi8(t0, _mm_setr_epi8(W(1), W(2), Z, W(5), W(6), Z, Z, Z)),
+	                  _mm_shuffle_epi8(t1, _mm_setr_epi8(Z, Z, W(2), Z, Z, W(6), Z, Z)));
+	uv = _mm_or_si128(_mm_shuffle_epi8(t0, _mm_setr_epi8(W(0), Z, W(3), W(4), Z, W(7), Z, Z)),
+	                  _mm_shuffle_epi8(t1, _mm_setr_epi8(Z, W(0), Z, Z, W(4), Z, Z, Z)));
+}
+
+static inline void UnpackV210Group_AVX2(const __m256i w, __m256i& yy, __m256i& uv)
+{
+	const __m256i mask = _mm256_set1_epi32(0x3ff);
+	const __m256i f1 = _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(w, 10), mask), 16);
+	const __m256i t0 = _mm256_slli_epi16(_mm256_or_si256(_mm256_and_si256(w, mask), f1), 6);
+	const __m256i t1 = _mm256_slli_epi16(_mm256_and_si256(_mm256_srli_epi32(w, 20), mask), 6);
+
+	yy = _mm256_or_si256(_mm256_shuffle_epi8(t0, _mm256_broadcastsi128_si256(_mm_setr_epi8(W(1), W(2), Z, W(5), W(6), Z, Z, Z))),
+	                     _mm256_shuffle_epi8(t1, _mm256_broadcastsi128_si256(_mm_setr_epi8(Z, Z, W(2), Z, Z, W(6), Z, Z))));
+	uv = _mm256_or_si256(_mm256_shuffle_epi8(t0, _mm256_broadcastsi128_si256(_mm_setr_epi8(W(0), Z, W(3), W(4), Z, W(7), Z, Z))),
+	                     _mm256_shuffle_epi8(t1, _mm256_broadcastsi128_si256(_mm_setr_epi8(Z, W(0), Z, Z, W(4), Z, Z, Z))));
+}
+
+#undef W
+#undef Z
+
+// 4 groups of 12 bytes to 3 vectors
+static inline void JoinV210Groups_SSE2(const __m128i (&g)[4], __m128i* dst, const bool aligned)
+{
+	StoreStream(dst + 0, _mm_or_si128(g[0], _mm_slli_si128(g[1], 12)), aligned);
+	StoreStream(dst + 1, _mm_or_si128(_mm_srli_si128(g[1], 4), _mm_slli_si128(g[2], 8)), aligned);
+	StoreStream(dst + 2, _mm_or_si128(_mm_srli_si128(g[2], 8), _mm_slli_si128(g[3], 4)), aligned);
+}
+
+void UnpackV210toP210_SSSE3(const UINT lines, BYTE* dstY, UINT dstY_pitch, BYTE* dstUV, UINT dstUV_pitch, const BYTE* src, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	const UINT pairs   = V210LinePairs(dstY_pitch, dstUV_pitch, src_pitch);
+	const UINT pairs12 = pairs - pairs % 12; // 4 words give 3 pairs
+	const bool aligned = !(((size_t)dstY | (size_t)dstUV | dstY_pitch | dstUV_pitch) & 15);
+
+	for (UINT y = 0; y < lines; ++y) {
+		uint16_t* y16  = (uint16_t*)dstY;
+		uint16_t* uv16 = (uint16_t*)dstUV;
+
+		UINT i = 0;
+		for (; i < pairs12; i += 12) {
+			const __m128i* s = (const __m128i*)(src + i / 3 * 16);
+			__m128i yy[4], uv[4];
+			for (int n = 0; n < 4; n++) {
+				UnpackV210Group_SSSE3(_mm_loadu_si128(s + n), yy[n], uv[n]);
+			}
+			JoinV210Groups_SSE2(yy, (__m128i*)(y16 + i * 2), aligned);
+			JoinV210Groups_SSE2(uv, (__m128i*)(uv16 + i * 2), aligned);
+		}
+		UnpackV210Pairs(src, y16, uv16, i, pairs);
+
+		src += src_pitch;
+		dstY += dstY_pitch;
+		dstUV += dstUV_pitch;
+	}
+
+	_mm_sfence();
+}
+
+// the pshufb control that shifts the bytes of the low and the high 128-bit lane, a positive shift is to the higher bytes
+static inline __m256i LaneShiftControl(const int shift0, const int shift1)
+{
+	alignas(32) char ctrl[32];
+	for (int i = 0; i < 32; i++) {
+		const int pos = (i & 15) - (i < 16 ? shift0 : shift1);
+		ctrl[i] = (pos >= 0 && pos < 16) ? (char)pos : -1;
+	}
+	return _mm256_load_si256((const __m256i*)ctrl);
+}
+
+void UnpackV210toP210_AVX2(const UINT lines, BYTE* dstY, UINT dstY_pitch, BYTE* dstUV, UINT dstUV_pitch, const BYTE* src, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	const UINT pairs   = V210LinePairs(dstY_pitch, dstUV_pitch, src_pitch);
+	const UINT pairs24 = pairs - pairs % 24;
+	const bool aligned = !(((size_t)dstY | (size_t)dstUV | dstY_pitch | dstUV_pitch) & 31);
+
+	// 8 groups of 12 bytes in the lanes of a, b, c, d to 3 vectors
+	const __m256i ctrl0a = LaneShiftControl(0, -4),  ctrl0b = LaneShiftControl(12, 8);
+	const __m256i ctrl1a = LaneShiftControl(-8, 0),  ctrl1b = LaneShiftControl(4, 12);
+	const __m256i ctrl2a = LaneShiftControl(-4, -8), ctrl2b = LaneShiftControl(8, 4);
+	auto Join = [&](const __m256i (&g)[4], __m256i* dst) {
+		const __m256i g12 = _mm256_permute2x128_si256(g[0], g[1], 0x21);
+		const __m256i g24 = _mm256_permute2x128_si256(g[1], g[2], 0x20);
+		const __m256i g35 = _mm256_permute2x128_si256(g[1], g[2], 0x31);
+		const __m256i g56 = _mm256_permute2x128_si256(g[2], g[3], 0x21);
+		StoreStream(dst + 0, _mm256_or_si256(_mm256_shuffle_epi8(g[0], ctrl0a), _mm256_shuffle_epi8(g12, ctrl0b)), aligned);
+		StoreStream(dst + 1, _mm256_or_si256(_mm256_shuffle_epi8(g24, ctrl1a), _mm256_shuffle_epi8(g35, ctrl1b)), aligned);
+		StoreStream(dst + 2, _mm256_or_si256(_mm256_shuffle_epi8(g56, ctrl2a), _mm256_shuffle_epi8(g[3], ctrl2b)), aligned);
+	};
+
+	for (UINT y = 0; y < lines; ++y) {
+		uint16_t* y16  = (uint16_t*)dstY;
+		uint16_t* uv16 = (uint16_t*)dstUV;
+
+		UINT i = 0;
+		for (; i < pairs24; i += 24) {
+			const __m256i* s = (const __m256i*)(src + i / 3 * 16);
+			__m256i yy[4], uv[4];
+			for (int n = 0; n < 4; n++) {
+				UnpackV210Group_AVX2(_mm256_loadu_si256(s + n), yy[n], uv[n]);
+			}
+			Join(yy, (__m256i*)(y16 + i * 2));
+			Join(uv, (__m256i*)(uv16 + i * 2));
+		}
+		UnpackV210Pairs(src, y16, uv16, i, pairs);
+
+		src += src_pitch;
+		dstY += dstY_pitch;
+		dstUV += dstUV_pitch;
+	}
+
+	_mm_sfence();
+	_mm256_zeroupper();
+}
+
+// Y210 and Y216 are Y0 Cb Y1 Cr of 16-bit samples, the samples are only moved
+static inline UINT Y21xLinePairs(const UINT dstY_pitch, const UINT dstUV_pitch, const int src_pitch)
+{
+	return std::min({ (UINT)src_pitch / 8, dstY_pitch / 4, dstUV_pitch / 4 });
+}
+
+static void UnpackY21xPairs(const uint16_t* src16, uint16_t* dstY, uint16_t* dstUV, const UINT first, const UINT pairs)
+{
+	for (UINT i = first; i < pairs; i++) {
+		dstY[i * 2 + 0]  = src16[i * 4 + 0];
+		dstUV[i * 2 + 0] = src16[i * 4 + 1];
+		dstY[i * 2 + 1]  = src16[i * 4 + 2];
+		dstUV[i * 2 + 1] = src16[i * 4 + 3];
+	}
+}
+
+void UnpackY21xtoP21x(const UINT lines, BYTE* dstY, UINT dstY_pitch, BYTE* dstUV, UINT dstUV_pitch, const BYTE* src, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	const UINT pairs = Y21xLinePairs(dstY_pitch, dstUV_pitch, src_pitch);
+
+	for (UINT y = 0; y < lines; ++y) {
+		UnpackY21xPairs((const uint16_t*)src, (uint16_t*)dstY, (uint16_t*)dstUV, 0, pairs);
+		src += src_pitch;
+		dstY += dstY_pitch;
+		dstUV += dstUV_pitch;
+	}
+}
+
+void UnpackY21xtoP21x_SSE2(const UINT lines, BYTE* dstY, UINT dstY_pitch, BYTE* dstUV, UINT dstUV_pitch, const BYTE* src, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	const UINT pairs  = Y21xLinePairs(dstY_pitch, dstUV_pitch, src_pitch);
+	const UINT pairs4 = pairs & ~(4u - 1);
+	const bool aligned = !(((size_t)dstY | (size_t)dstUV | dstY_pitch | dstUV_pitch) & 15);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint16_t* src16 = (const uint16_t*)src;
+		uint16_t* y16  = (uint16_t*)dstY;
+		uint16_t* uv16 = (uint16_t*)dstUV;
+
+		UINT i = 0;
+		for (; i < pairs4; i += 4) {
+			// the sign extension of the 16-bit samples keeps them exact in the signed saturation of packs
+			const __m128i a = _mm_loadu_si128((const __m128i*)(src16 + i * 4));
+			const __m128i b = _mm_loadu_si128((const __m128i*)(src16 + i * 4 + 8));
+			const __m128i yy = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16), _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+			const __m128i uv = _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16));
+			StoreStream((__m128i*)(y16 + i * 2), yy, aligned);
+			StoreStream((__m128i*)(uv16 + i * 2), uv, aligned);
+		}
+		UnpackY21xPairs(src16, y16, uv16, i, pairs);
+
+		src += src_pitch;
+		dstY += dstY_pitch;
+		dstUV += dstUV_pitch;
+	}
+
+	_mm_sfence();
+}
+
+void UnpackY21xtoP21x_AVX2(const UINT lines, BYTE* dstY, UINT dstY_pitch, BYTE* dstUV, UINT dstUV_pitch, const BYTE* src, int src_pitch)
+{
+	ASSERT(src_pitch > 0);
+	const UINT pairs  = Y21xLinePairs(dstY_pitch, dstUV_pitch, src_pitch);
+	const UINT pairs8 = pairs & ~(8u - 1);
+	const bool aligned = !(((size_t)dstY | (size_t)dstUV | dstY_pitch | dstUV_pitch) & 31);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint16_t* src16 = (const uint16_t*)src;
+		uint16_t* y16  = (uint16_t*)dstY;
+		uint16_t* uv16 = (uint16_t*)dstUV;
+
+		UINT i = 0;
+		for (; i < pairs8; i += 8) {
+			const __m256i a = _mm256_loadu_si256((const __m256i*)(src16 + i * 4));
+			const __m256i b = _mm256_loadu_si256((const __m256i*)(src16 + i * 4 + 16));
+			// packs works on each lane, the 64-bit blocks are reordered afterwards
+			const __m256i yy = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16), _mm256_srai_epi32(_mm256_slli_epi32(b, 16), 16));
+			const __m256i uv = _mm256_packs_epi32(_mm256_srai_epi32(a, 16), _mm256_srai_epi32(b, 16));
+			StoreStream((__m256i*)(y16 + i * 2), _mm256_permute4x64_epi64(yy, _MM_SHUFFLE(3, 1, 2, 0)), aligned);
+			StoreStream((__m256i*)(uv16 + i * 2), _mm256_permute4x64_epi64(uv, _MM_SHUFFLE(3, 1, 2, 0)), aligned);
+		}
+		UnpackY21xPairs(src16, y16, uv16, i, pairs);
+
+		src += src_pitch;
+		dstY += dstY_pitch;
+		dstUV += dstUV_pitch;
+	}
+
+	_mm_sfence();
+	_mm256_zeroupper();
+}
+
+static inline uint32_t R10G10B10A2toBGR32(const uint32_t t)
+{
+	return ((t & 0x3fc00000) >> 22) // B
+		 | ((t & 0x000ff000) >> 4)  // G
+		 | ((t & 0x000003fc) << 14) // R
+		 | 0xff000000; // X
+}
+
+void ConvertR10G10B10A2toBGR32(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	// R10G10B10A2
+	// R - 0x000003ff
+	// G - 0x000ffc00
+	// B - 0x3ff00000
+	// A - 0xc0000000
+	//
+	// BGR32 
+	// B - 0x000000ff
+	// G - 0x0000ff00
+	// R - 0x00ff0000
+	// X - 0xff000000
+
+	UINT line_pixels = abs(src_pitch) / 4;
+
+	for (UINT y = 0; y < lines; ++y) {
+		uint32_t* src32 = (uint32_t*)src;
+		uint32_t* dst32 = (uint32_t*)dst;
+		for (UINT i = 0; i < line_pixels; i++) {
+			dst32[i] = R10G10B10A2toBGR32(src32[i]);
+		}
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void ConvertR10G10B10A2toBGR32_SSE2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels  = abs(src_pitch) / 4;
+	UINT line_pixels4 = line_pixels & ~(4u - 1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint32_t* src32 = (const uint32_t*)src;
+		uint32_t* dst32 = (uint32_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels4; i += 4) {
+			const __m128i t = _mm_loadu_si128((const __m128i*)(src32 + i));
+			__m128i v = _mm_or_si128(
+				_mm_srli_epi32(_mm_and_si128(t, _mm_set1_epi32(0x3fc00000)), 22),
+				_mm_srli_epi32(_mm_and_si128(t, _mm_set1_epi32(0x000ff000)), 4));
+			v = _mm_or_si128(v, _mm_slli_epi32(_mm_and_si128(t, _mm_set1_epi32(0x000003fc)), 14));
+			_mm_storeu_si128((__m128i*)(dst32 + i), _mm_or_si128(v, _mm_set1_epi32(0xff000000)));
+		}
+		for (; i < line_pixels; i++) {
+			dst32[i] = R10G10B10A2toBGR32(src32[i]);
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void ConvertR10G10B10A2toBGR32_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels  = abs(src_pitch) / 4;
+	UINT line_pixels8 = line_pixels & ~(8u - 1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint32_t* src32 = (const uint32_t*)src;
+		uint32_t* dst32 = (uint32_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels8; i += 8) {
+			const __m256i t = _mm256_loadu_si256((const __m256i*)(src32 + i));
+			__m256i v = _mm256_or_si256(
+				_mm256_srli_epi32(_mm256_and_si256(t, _mm256_set1_epi32(0x3fc00000)), 22),
+				_mm256_srli_epi32(_mm256_and_si256(t, _mm256_set1_epi32(0x000ff000)), 4));
+			v = _mm256_or_si256(v, _mm256_slli_epi32(_mm256_and_si256(t, _mm256_set1_epi32(0x000003fc)), 14));
+			_mm256_storeu_si256((__m256i*)(dst32 + i), _mm256_or_si256(v, _mm256_set1_epi32(0xff000000)));
+		}
+		for (; i < line_pixels; i++) {
+			dst32[i] = R10G10B10A2toBGR32(src32[i]);
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+	_mm256_zeroupper();
+}
+
+void ConvertR10G10B10A2toBGR48(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	// R10G10B10A2
+	// R - 0x000003ff
+	// G - 0x000ffc00
+	// B - 0x3ff00000
+	// A - 0xc0000000
+	UINT line_pixels = abs(src_pitch) / 4;
+
+	for (UINT y = 0; y < lines; ++y) {
+		uint32_t* src32 = (uint32_t*)src;
+		uint16_t* dst16 = (uint16_t*)dst;
+		for (UINT i = 0; i < line_pixels; i++) {
+			uint32_t t = src32[i];
+			*dst16++ = (uint16_t)((t & 0x3ff00000) >> 14); // B
+			*dst16++ = (uint16_t)((t & 0x000ffc00) >> 4);  // G
+			*dst16++ = (uint16_t)((t & 0x000003ff) << 6);  // R 
+		}
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+// R10G10B10A2 to two 32-bit parts of a 16-bit BGRX pixel: B | G << 16 and R | X << 16
+static inline void R10G10B10A2toBG_RX_SSE2(const __m128i t, const __m128i x, __m128i& bg, __m128i& rx)
+{
+	bg = _mm_or_si128(
+		_mm_and_si128(_mm_srli_epi32(t, 14), _mm_set1_epi32(0x0000ffc0)),
+		_mm_and_si128(_mm_slli_epi32(t, 12), _mm_set1_epi32(0xffc00000)));
+	rx = _mm_or_si128(_mm_and_si128(_mm_slli_epi32(t, 6), _mm_set1_epi32(0x0000ffc0)), x);
+}
+
+void ConvertR10G10B10A2toBGR48_SSSE3(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels  = abs(src_pitch) / 4;
+	UINT line_pixels8 = line_pixels & ~(8u - 1);
+
+	const __m128i mask = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -1, -1, -1, -1);
+	const __m128i zero = _mm_setzero_si128();
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint32_t* src32 = (const uint32_t*)src;
+		__m128i* dst128 = (__m128i*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels8; i += 8) {
+			__m128i bg, rx;
+			R10G10B10A2toBG_RX_SSE2(_mm_loadu_si128((const __m128i*)(src32 + i)), zero, bg, rx);
+			const __m128i p01 = _mm_shuffle_epi8(_mm_unpacklo_epi32(bg, rx), mask); // 12 bytes
+			const __m128i p23 = _mm_shuffle_epi8(_mm_unpackhi_epi32(bg, rx), mask);
+			R10G10B10A2toBG_RX_SSE2(_mm_loadu_si128((const __m128i*)(src32 + i + 4)), zero, bg, rx);
+			const __m128i p45 = _mm_shuffle_epi8(_mm_unpacklo_epi32(bg, rx), mask);
+			const __m128i p67 = _mm_shuffle_epi8(_mm_unpackhi_epi32(bg, rx), mask);
+
+			_mm_storeu_si128(dst128,     _mm_or_si128(p01, _mm_slli_si128(p23, 12)));
+			_mm_storeu_si128(dst128 + 1, _mm_or_si128(_mm_srli_si128(p23, 4), _mm_slli_si128(p45, 8)));
+			_mm_storeu_si128(dst128 + 2, _mm_or_si128(_mm_srli_si128(p45, 8), _mm_slli_si128(p67, 4)));
+			dst128 += 3;
+		}
+
+		uint16_t* dst16 = (uint16_t*)dst128;
+		for (; i < line_pixels; i++) {
+			const uint32_t t = src32[i];
+			*dst16++ = (uint16_t)((t & 0x3ff00000) >> 14); // B
+			*dst16++ = (uint16_t)((t & 0x000ffc00) >> 4);  // G
+			*dst16++ = (uint16_t)((t & 0x000003ff) << 6);  // R
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void ConvertR10G10B10A2toBGR48_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels  = abs(src_pitch) / 4;
+	UINT line_pixels8 = line_pixels & ~(8u - 1);
+
+	const __m256i mask = _mm256_setr_epi8(
+		0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -1, -1, -1, -1,
+		0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -1, -1, -1, -1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint32_t* src32 = (const uint32_t*)src;
+		__m128i* dst128 = (__m128i*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels8; i += 8) {
+			const __m256i t = _mm256_loadu_si256((const __m256i*)(src32 + i));
+			const __m256i bg = _mm256_or_si256(
+				_mm256_and_si256(_mm256_srli_epi32(t, 14), _mm256_set1_epi32(0x0000ffc0)),
+				_mm256_and_si256(_mm256_slli_epi32(t, 12), _mm256_set1_epi32(0xffc00000)));
+			const __m256i rx = _mm256_and_si256(_mm256_slli_epi32(t, 6), _mm256_set1_epi32(0x0000ffc0));
+			// per lane: lo - pixels 0,1 (4,5), hi - pixels 2,3 (6,7), packed to 12 bytes
+			const __m256i lo = _mm256_shuffle_epi8(_mm256_unpacklo_epi32(bg, rx), mask);
+			const __m256i hi = _mm256_shuffle_epi8(_mm256_unpackhi_epi32(bg, rx), mask);
+			const __m128i p01 = _mm256_castsi256_si128(lo);
+			const __m128i p23 = _mm256_castsi256_si128(hi);
+			const __m128i p45 = _mm256_extracti128_si256(lo, 1);
+			const __m128i p67 = _mm256_extracti128_si256(hi, 1);
+
+			_mm_storeu_si128(dst128,     _mm_or_si128(p01, _mm_slli_si128(p23, 12)));
+			_mm_storeu_si128(dst128 + 1, _mm_or_si128(_mm_srli_si128(p23, 4), _mm_slli_si128(p45, 8)));
+			_mm_storeu_si128(dst128 + 2, _mm_or_si128(_mm_srli_si128(p45, 8), _mm_slli_si128(p67, 4)));
+			dst128 += 3;
+		}
+
+		uint16_t* dst16 = (uint16_t*)dst128;
+		for (; i < line_pixels; i++) {
+			const uint32_t t = src32[i];
+			*dst16++ = (uint16_t)((t & 0x3ff00000) >> 14); // B
+			*dst16++ = (uint16_t)((t & 0x000ffc00) >> 4);  // G
+			*dst16++ = (uint16_t)((t & 0x000003ff) << 6);  // R
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+	_mm256_zeroupper();
+}
+
+void ConvertR10G10B10A2toBGR64(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	// R10G10B10A2
+	// R - 0x000003ff
+	// G - 0x000ffc00
+	// B - 0x3ff00000
+	// A - 0xc0000000
+	UINT line_pixels = abs(src_pitch) / 4;
+
+	for (UINT y = 0; y < lines; ++y) {
+		uint32_t* src32 = (uint32_t*)src;
+		uint16_t* dst16 = (uint16_t*)dst;
+		for (UINT i = 0; i < line_pixels; i++) {
+			uint32_t t = src32[i];
+			*dst16++ = (uint16_t)((t & 0x3ff00000) >> 14); // B
+			*dst16++ = (uint16_t)((t & 0x000ffc00) >> 4);  // G
+			*dst16++ = (uint16_t)((t & 0x000003ff) << 6);  // R 
+			*dst16++ = 0xffff; // X
+		}
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void ConvertR10G10B10A2toBGR64_SSE2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels  = abs(src_pitch) / 4;
+	UINT line_pixels4 = line_pixels & ~(4u - 1);
+
+	const __m128i x = _mm_set1_epi32(0xffff0000);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint32_t* src32 = (const uint32_t*)src;
+		uint64_t* dst64 = (uint64_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels4; i += 4) {
+			__m128i bg, rx;
+			R10G10B10A2toBG_RX_SSE2(_mm_loadu_si128((const __m128i*)(src32 + i)), x, bg, rx);
+			_mm_storeu_si128((__m128i*)(dst64 + i),     _mm_unpacklo_epi32(bg, rx));
+			_mm_storeu_si128((__m128i*)(dst64 + i + 2), _mm_unpackhi_epi32(bg, rx));
+		}
+
+		uint16_t* dst16 = (uint16_t*)(dst64 + i);
+		for (; i < line_pixels; i++) {
+			const uint32_t t = src32[i];
+			*dst16++ = (uint16_t)((t & 0x3ff00000) >> 14); // B
+			*dst16++ = (uint16_t)((t & 0x000ffc00) >> 4);  // G
+			*dst16++ = (uint16_t)((t & 0x000003ff) << 6);  // R
+			*dst16++ = 0xffff; // X
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+}
+
+void ConvertR10G10B10A2toBGR64_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	UINT line_pixels  = abs(src_pitch) / 4;
+	UINT line_pixels8 = line_pixels & ~(8u - 1);
+
+	for (UINT y = 0; y < lines; ++y) {
+		const uint32_t* src32 = (const uint32_t*)src;
+		uint64_t* dst64 = (uint64_t*)dst;
+
+		UINT i = 0;
+		for (; i < line_pixels8; i += 8) {
+			const __m256i t = _mm256_loadu_si256((const __m256i*)(src32 + i));
+			const __m256i bg = _mm256_or_si256(
+				_mm256_and_si256(_mm256_srli_epi32(t, 14), _mm256_set1_epi32(0x0000ffc0)),
+				_mm256_and_si256(_mm256_slli_epi32(t, 12), _mm256_set1_epi32(0xffc00000)));
+			const __m256i rx = _mm256_or_si256(
+				_mm256_and_si256(_mm256_slli_epi32(t, 6), _mm256_set1_epi32(0x0000ffc0)),
+				_mm256_set1_epi32(0xffff0000));
+			// per lane: lo - pixels 0,1 (4,5), hi - pixels 2,3 (6,7)
+			const __m256i lo = _mm256_unpacklo_epi32(bg, rx);
+			const __m256i hi = _mm256_unpackhi_epi32(bg, rx);
+			_mm256_storeu_si256((__m256i*)(dst64 + i),     _mm256_permute2x128_si256(lo, hi, 0x20));
+			_mm256_storeu_si256((__m256i*)(dst64 + i + 4), _mm256_permute2x128_si256(lo, hi, 0x31));
+		}
+
+		uint16_t* dst16 = (uint16_t*)(dst64 + i);
+		for (; i < line_pixels; i++) {
+			const uint32_t t = src32[i];
+			*dst16++ = (uint16_t)((t & 0x3ff00000) >> 14); // B
+			*dst16++ = (uint16_t)((t & 0x000ffc00) >> 4);  // G
+			*dst16++ = (uint16_t)((t & 0x000003ff) << 6);  // R
+			*dst16++ = 0xffff; // X
+		}
+
+		src += src_pitch;
+		dst += dst_pitch;
+	}
+	_mm256_zeroupper();
+}
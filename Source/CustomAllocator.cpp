@@ -39,6 +39,15 @@ CCustomAllocator::~CCustomAllocator()
 	if (m_pVideoRendererInputPin && m_pVideoRendererInputPin->m_pCustomAllocator == this) {
 		m_pVideoRendererInputPin->m_pCustomAllocator = nullptr;
 	}
+	ReleaseUploadBuffers(); // CMemAllocator frees the memory
+}
+
+void CCustomAllocator::ReleaseUploadBuffers()
+{
+	if (m_pUploadBuffers) {
+		m_pUploadBuffers->ReleaseBuffers();
+		m_pUploadBuffers.reset();
+	}
 }
 
 HRESULT CCustomAllocator::Alloc(void)
@@ -59,6 +68,7 @@ HRESULT CCustomAllocator::Alloc(void)
     ASSERT(hr == S_OK); // we use this fact in the loop below
 
     /* Free the old resources */
+    ReleaseUploadBuffers();
     if (m_pBuffer) {
         ReallyFree();
     }
@@ -68,29 +78,23 @@ HRESULT CCustomAllocator::Alloc(void)
         return E_OUTOFMEMORY;
     }
 
-    /* Compute the aligned size */
-    LONG lAlignedSize = m_lSize + m_lPrefix;
+    /* The video processor can use the buffers directly if each of them starts at its alignment */
+    std::shared_ptr<CUploadBuffers> pUploadBuffers = m_pVideoRendererInputPin ? m_pVideoRendererInputPin->GetUploadBuffers() : nullptr;
 
-    /*  Check overflow */
-    if (lAlignedSize < m_lSize) {
+    /* Compute the aligned size, check overflow */
+    SampleBuffersLayout_t layout;
+    if (!GetSampleBuffersLayout(m_lSize, m_lPrefix, m_lAlignment, pUploadBuffers ? pUploadBuffers->GetAlignment() : 0, layout)) {
         return E_OUTOFMEMORY;
     }
-
-    if (m_lAlignment > 1) {
-        LONG lRemainder = lAlignedSize % m_lAlignment;
-        if (lRemainder != 0) {
-            LONG lNewSize = lAlignedSize + m_lAlignment - lRemainder;
-            if (lNewSize < lAlignedSize) {
-                return E_OUTOFMEMORY;
-            }
-            lAlignedSize = lNewSize;
-        }
+    if (!layout.bUpload) {
+        pUploadBuffers.reset();
     }
+    const LONG lAlignedSize = layout.alignedSize;
 
     /* Create the contiguous memory block for the samples
        making sure it's properly aligned (64K should be enough!)
     */
-    ASSERT(lAlignedSize % m_lAlignment == 0);
+    ASSERT(lAlignedSize % layout.alignment == 0);
 
     LONGLONG lToAllocate = m_lCount * (LONGLONG)lAlignedSize;
 
@@ -110,6 +114,7 @@ HRESULT CCustomAllocator::Alloc(void)
 
     LPBYTE pNext = m_pBuffer;
     CCustomMediaSample *pSample;
+    std::vector<BYTE*> buffers;
 
     ASSERT(m_lAllocated == 0);
 
@@ -134,6 +139,12 @@ HRESULT CCustomAllocator::Alloc(void)
 
         // This CANNOT fail
         m_lFree.Add(pSample);
+        buffers.emplace_back(pNext + m_lPrefix);
+    }
+
+    if (pUploadBuffers) {
+        pUploadBuffers->SetBuffers(buffers, m_lSize);
+        m_pUploadBuffers = pUploadBuffers;
     }
 
     m_bChanged = FALSE;
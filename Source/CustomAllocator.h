@@ -22,6 +22,7 @@
 
 #include <memory>
 #include "MediaSampleSideData.h"
+#include "UploadBuffers.h"
 
 class CVideoRendererInputPin;
 
@@ -43,6 +44,9 @@ protected:
 	std::unique_ptr<CMediaType> m_pNewMT;
 	long m_cbBuffer = 0;
 
+	std::shared_ptr<CUploadBuffers> m_pUploadBuffers; // the user of the current buffers
+	void ReleaseUploadBuffers();
+
 public:
 	CCustomAllocator(LPCTSTR pName, LPUNKNOWN pUnk, CVideoRendererInputPin* pVideoRendererInputPin, HRESULT *phr);
 	~CCustomAllocator();
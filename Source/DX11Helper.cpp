@@ -78,6 +78,71 @@ D3D11_TEXTURE2D_DESC CreateTex2DDesc(const DXGI_FORMAT format, const UINT width,
 	return desc;
 }
 
+// CD3D11ViewCache
+
+#define VIEWCACHE_MAX_UNUSED_FRAMES 2
+
+template <class View, class Desc, class CreateFn>
+HRESULT CD3D11ViewCache::GetView(std::vector<Entry_t<View, Desc>>& entries, ID3D11Resource* pResource, const Desc* pDesc, View** ppView, CreateFn create)
+{
+	CheckPointer(pResource, E_POINTER);
+	CheckPointer(ppView, E_POINTER);
+
+	for (auto& entry : entries) {
+		if (entry.pResource == pResource && entry.bDesc == !!pDesc && (!pDesc || memcmp(&entry.desc, pDesc, sizeof(Desc)) == 0)) {
+			entry.lastFrame = m_frame;
+			*ppView = entry.pView;
+			(*ppView)->AddRef();
+			return S_OK;
+		}
+	}
+
+	Entry_t<View, Desc> entry;
+	HRESULT hr = create(pResource, pDesc, &entry.pView);
+	if (FAILED(hr)) {
+		return hr;
+	}
+	m_nCreated++;
+
+	entry.pResource = pResource;
+	entry.bDesc = !!pDesc;
+	if (pDesc) {
+		entry.desc = *pDesc;
+	}
+	entry.lastFrame = m_frame;
+
+	*ppView = entry.pView;
+	(*ppView)->AddRef();
+	entries.emplace_back(std::move(entry));
+
+	return hr;
+}
+
+HRESULT CD3D11ViewCache::GetRenderTargetView(ID3D11Device* pDevice, ID3D11Resource* pResource, const D3D11_RENDER_TARGET_VIEW_DESC* pDesc, ID3D11RenderTargetView** ppView)
+{
+	return GetView(m_RTViews, pResource, pDesc, ppView, [pDevice](ID3D11Resource* pResource, const D3D11_RENDER_TARGET_VIEW_DESC* pDesc, ID3D11RenderTargetView** ppView) {
+		return pDevice->CreateRenderTargetView(pResource, pDesc, ppView);
+	});
+}
+
+void CD3D11ViewCache::EndFrame()
+{
+	// the views of textures that were recreated or are no longer drawn to are released here
+	auto unused = [this](const auto& entry) {
+		return m_frame - entry.lastFrame >= VIEWCACHE_MAX_UNUSED_FRAMES;
+	};
+	std::erase_if(m_RTViews, unused);
+
+	m_frame++;
+	m_nCreatedLastFrame = m_nCreated;
+	m_nCreated = 0;
+}
+
+void CD3D11ViewCache::Clear()
+{
+	m_RTViews.clear();
+}
+
 UINT GetAdapter(HWND hWnd, IDXGIFactory1* pDXGIFactory, IDXGIAdapter** ppDXGIAdapter)
 {
 	*ppDXGIAdapter = nullptr;
@@ -238,6 +238,41 @@ public:
 	}
 };
 
+// Keeps the render target views of resources between frames, so that the passes
+// do not create a view for the same texture on every frame.
+// A cached view holds a reference to its resource. The entries not used during the last frames are
+// released by EndFrame(), Clear() must be called before the swap chain buffers are resized or released.
+class CD3D11ViewCache
+{
+	template <class View, class Desc>
+	struct Entry_t {
+		ID3D11Resource* pResource = nullptr;
+		bool bDesc = false;
+		Desc desc = {};
+		CComPtr<View> pView;
+		UINT lastFrame = 0;
+	};
+
+	std::vector<Entry_t<ID3D11RenderTargetView, D3D11_RENDER_TARGET_VIEW_DESC>> m_RTViews;
+
+	UINT m_frame = 0;
+	UINT m_nCreated = 0;
+	UINT m_nCreatedLastFrame = 0;
+
+	template <class View, class Desc, class CreateFn>
+	HRESULT GetView(std::vector<Entry_t<View, Desc>>& entries, ID3D11Resource* pResource, const Desc* pDesc, View** ppView, CreateFn create);
+
+public:
+	// Same as ID3D11Device::CreateRenderTargetView, the returned view is AddRef'ed.
+	HRESULT GetRenderTargetView(ID3D11Device* pDevice, ID3D11Resource* pResource, const D3D11_RENDER_TARGET_VIEW_DESC* pDesc, ID3D11RenderTargetView** ppView);
+
+	void EndFrame();
+	void Clear();
+
+	UINT GetCreatedLastFrame() const { return m_nCreatedLastFrame; }
+	UINT GetCount() const { return (UINT)m_RTViews.size(); }
+};
+
 struct ExternalPixelShader11_t
 {
 	std::wstring name;
@@ -33,6 +33,7 @@
 #include "DX11VideoProcessor.h"
 #include "../Include/ID3DVideoMemoryConfiguration.h"
 #include "Shaders.h"
+#include "ColorLut.h"
 #include "Utils/CPUInfo.h"
 
 #include "../external/minhook/include/MinHook.h"
@@ -280,7 +281,7 @@ HRESULT CDX11VideoProcessor::AlphaBlt(
     ID3D11SamplerState* pSampler)
 {
     ID3D11RenderTargetView* pRenderTargetView;
-    HRESULT hr = m_pDevice->CreateRenderTargetView(pRenderTarget, nullptr, &pRenderTargetView);
+    HRESULT hr = m_ViewCache.GetRenderTargetView(m_pDevice, pRenderTarget, nullptr, &pRenderTargetView);
 
     if (S_OK == hr)
     {
@@ -304,7 +305,7 @@ HRESULT CDX11VideoProcessor::AlphaBlt(
 
         pRenderTargetView->Release();
     }
-    DLogIf(FAILED(hr), L"AlphaBlt() : CreateRenderTargetView() failed with error {}", HR2Str(hr));
+    DLogIf(FAILED(hr), L"AlphaBlt() : GetRenderTargetView() failed with error {}", HR2Str(hr));
 
     return hr;
 }
@@ -317,10 +318,10 @@ HRESULT CDX11VideoProcessor::TextureCopyRect(
 {
     CComPtr < ID3D11RenderTargetView > pRenderTargetView;
 
-    HRESULT hr = m_pDevice->CreateRenderTargetView(pRenderTarget, nullptr, &pRenderTargetView);
+    HRESULT hr = m_ViewCache.GetRenderTargetView(m_pDevice, pRenderTarget, nullptr, &pRenderTargetView);
     if (FAILED(hr))
     {
-        DLog(L"TextureCopyRect() : CreateRenderTargetView() failed with error {}", HR2Str(hr));
+        DLog(L"TextureCopyRect() : GetRenderTargetView() failed with error {}", HR2Str(hr));
         return hr;
     }
 
@@ -353,10 +354,10 @@ HRESULT CDX11VideoProcessor::TextureResizeShader(
 {
     CComPtr < ID3D11RenderTargetView > pRenderTargetView;
 
-    HRESULT hr = m_pDevice->CreateRenderTargetView(pRenderTarget, nullptr, &pRenderTargetView);
+    HRESULT hr = m_ViewCache.GetRenderTargetView(m_pDevice, pRenderTarget, nullptr, &pRenderTargetView);
     if (FAILED(hr))
     {
-        DLog(L"CDX11VideoProcessor::TextureResizeShader() : CreateRenderTargetView() failed with error {}", HR2Str(hr));
+        DLog(L"CDX11VideoProcessor::TextureResizeShader() : GetRenderTargetView() failed with error {}", HR2Str(hr));
         return hr;
     }
 
@@ -426,9 +427,12 @@ CDX11VideoProcessor::CDX11VideoProcessor(CMpcVideoRenderer* pFilter, const Setti
     m_iHdrOsdBrightness = config.iHdrOsdBrightness;
     m_bConvertToSdr = config.bConvertToSdr;
     m_iSDRDisplayNits = config.iSDRDisplayNits;
+    m_bTransferLut = config.bTransferLut;
+    m_bHdrSceneAdaptive = config.bHdrSceneAdaptive;
     m_bVPRTXVideoHDR = config.bVPRTXVideoHDR;
     m_iVPSuperRes = config.iVPSuperRes;
     m_activeHdrMode = HdrMode::UNKNOWN;
+    m_ParallelCopy.SetThreads(config.iUploadThreads);
 
     m_nCurrentAdapter = -1;
 
@@ -694,7 +698,11 @@ HRESULT CDX11VideoProcessor::Init(const HWND hwnd, const bool displayHdrChanged,
         }
     }
 
-    if (m_VendorId == PCIV_INTEL && CPUInfo::HaveSSE41())
+    if (m_VendorId == PCIV_INTEL && CPUInfo::HaveAVX2())
+    {
+        m_pCopyGpuFn = CopyGpuFrame_AVX2;
+    }
+    else if (m_VendorId == PCIV_INTEL && CPUInfo::HaveSSE41())
     {
         m_pCopyGpuFn = CopyGpuFrame_SSE41;
     }
@@ -717,12 +725,16 @@ void CDX11VideoProcessor::ReleaseVP()
 
     m_pFilter->ResetStreamingTimes2();
     m_RenderStats.Reset();
+    m_RenderLatency.Reset();
+    m_DirtyRows.ResetCounters();
+    m_DirtyRows.Invalidate();
 
     if (m_pDeviceContext)
     {
         m_pDeviceContext->ClearState();
     }
 
+    m_ViewCache.Clear();
     m_TexSrcVideo.Release();
     m_TexConvertOutput.Release();
     m_TexResize.Release();
@@ -730,13 +742,16 @@ void CDX11VideoProcessor::ReleaseVP()
 
     m_PSConvColorData.Release();
     m_pDoviCurvesConstantBuffer.Release();
+    m_ConvertShaderQueue.Cancel();
 
     m_D3D11VP.ReleaseVideoProcessor();
     m_strCorrection = nullptr;
 
     m_srcParams = {};
     m_srcDXGIFormat = DXGI_FORMAT_UNKNOWN;
-    m_pCopyPlaneFn = CopyPlaneAsIs;
+    ResetCopyPlaneKernel();
+    m_pConvertPlanarFn = nullptr;
+    m_pUnpackFn = nullptr;
     m_srcWidth = 0;
     m_srcHeight = 0;
 }
@@ -757,6 +772,16 @@ void CDX11VideoProcessor::ReleaseDevice()
     m_SyncLine.InvalidateDeviceObjects();
 
     m_TexDither.Release();
+    m_TexTrcLut.Release();
+    m_TrcLut = MP_CSP_TRC_AUTO;
+    m_TexDoviLut.Release();
+    m_DoviLutHash = 0;
+    m_TexHdrStats.Release();
+    for (auto& tex : m_TexHdrStatsStaging)
+    {
+        tex.Release();
+    }
+    m_nHdrStatsFrames = 0;
     m_bAlphaBitmapEnable = false;
     m_pAlphaBitmapVertex.Release();
     m_TexAlphaBitmap.Release();
@@ -833,6 +858,7 @@ void CDX11VideoProcessor::ReleaseSwapChain()
     {
         m_pDXGISwapChain1->SetFullscreenState(FALSE, nullptr);
     }
+    m_ViewCache.Clear(); // the back buffer views
     m_pDXGIOutput.Release();
     m_pDXGISwapChain4.Release();
     m_pDXGISwapChain1.Release();
@@ -995,7 +1021,7 @@ struct HDR10ParamsCB
     float MaxFALL;
     float DisplayMaxNits;
     UINT  Selection;
-    float Reserved1;
+    float ScenePeakNits;
     float Reserved2;
 };
 
@@ -1011,9 +1037,18 @@ void CDX11VideoProcessor::SetHDR10ShaderParams(float masteringMinLuminanceNits,
     if (displayMaxNits < 1.0f || displayMaxNits > 10000.0f) displayMaxNits = 1000.0f;
     if (toneMappingType < 1 || toneMappingType > 5) toneMappingType = 1;
 
+    float scenePeakNits = 0.0f;
+    if (m_bHdrSceneAdaptive && m_HdrScene.IsValid())
+    {
+        // the static peak of ps_fix_hdr10.hlsl
+        float staticPeakNits = std::max(masteringMaxLuminanceNits, 1000.0f);
+        if (maxCLL > 100.0f && maxCLL <= masteringMaxLuminanceNits) staticPeakNits = maxCLL;
+        scenePeakNits = GetHdrSceneAdaptedPeak(m_HdrScene.GetPeakNits(), staticPeakNits, displayMaxNits);
+    }
+
     HDR10ParamsCB cb = {
         masteringMinLuminanceNits, masteringMaxLuminanceNits,
-        maxCLL, maxFALL, displayMaxNits, (UINT)toneMappingType, 0.0f, 0.0f
+        maxCLL, maxFALL, displayMaxNits, (UINT)toneMappingType, scenePeakNits, 0.0f
     };
 
     if (m_pHDR10ToneMappingConstants)
@@ -1035,6 +1070,63 @@ void CDX11VideoProcessor::SetHDR10ShaderParams(float masteringMinLuminanceNits,
     }
 }
 
+// Measures the frame that goes to the tone mapping pass and updates its scene peak.
+// The frame is decimated on the GPU and read back a few frames later.
+void CDX11VideoProcessor::UpdateHdrSceneStats(const Tex2D_t& Tex, const CRect& srcRect)
+{
+    HRESULT hr = m_TexHdrStats.CheckCreate(m_pDevice, DXGI_FORMAT_R10G10B10A2_UNORM, HDR_STATS_WIDTH, HDR_STATS_HEIGHT, Tex2D_DefaultRTarget);
+    for (auto& tex : m_TexHdrStatsStaging)
+    {
+        if (S_OK == hr)
+        {
+            hr = tex.CheckCreate(m_pDevice, DXGI_FORMAT_R10G10B10A2_UNORM, HDR_STATS_WIDTH, HDR_STATS_HEIGHT, Tex2D_StagingRead);
+        }
+    }
+    if (FAILED(hr))
+    {
+        DLog(L"CDX11VideoProcessor::UpdateHdrSceneStats() : texture creation failed with error {}", HR2Str(hr));
+        return;
+    }
+
+    // point sampling, each pixel of the small texture is a pixel of the frame
+    hr = TextureCopyRect(Tex, m_TexHdrStats.pTexture, srcRect, CRect(0, 0, HDR_STATS_WIDTH, HDR_STATS_HEIGHT), m_pPS_Simple, nullptr, 0, false);
+    if (FAILED(hr))
+    {
+        return;
+    }
+    m_pDeviceContext->CopyResource(m_TexHdrStatsStaging[m_nHdrStatsFrames % HDR_STATS_LATENCY].pTexture, m_TexHdrStats.pTexture);
+    m_nHdrStatsFrames++;
+
+    if (m_nHdrStatsFrames < HDR_STATS_LATENCY)
+    {
+        return;
+    }
+
+    // the oldest copy is usually finished, otherwise it is skipped instead of waiting
+    ID3D11Texture2D* pStaging = m_TexHdrStatsStaging[m_nHdrStatsFrames % HDR_STATS_LATENCY].pTexture;
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    hr = m_pDeviceContext->Map(pStaging, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mappedResource);
+    if (hr == DXGI_ERROR_WAS_STILL_DRAWING)
+    {
+        return;
+    }
+    if (FAILED(hr))
+    {
+        DLog(L"CDX11VideoProcessor::UpdateHdrSceneStats() : Map() failed with error {}", HR2Str(hr));
+        return;
+    }
+
+    HdrFrameStats_t stats;
+    MeasureHdrFrameR10G10B10A2((const BYTE*)mappedResource.pData, mappedResource.RowPitch, HDR_STATS_WIDTH, HDR_STATS_HEIGHT, stats);
+    m_pDeviceContext->Unmap(pStaging, 0);
+
+    const bool bSceneCut = m_HdrScene.Update(stats);
+    DLogIf(bSceneCut, L"CDX11VideoProcessor::UpdateHdrSceneStats() : scene cut, peak {:.0f} nits, average {:.1f} nits",
+           stats.peakNits, stats.avgNits);
+
+    SetHDR10ShaderParams(0, 0, 0, 0, m_fHdrDisplayMaxNits, m_iHdrLocalToneMappingType);
+}
+
 HRESULT CDX11VideoProcessor::SetShaderDoviCurvesPoly()
 {
     ASSERT(m_Dovi.bValid);
@@ -1275,7 +1367,7 @@ void CDX11VideoProcessor::CalcStatsParams()
         {
             SIZE charSize = m_Font3D.GetMaxCharMetric();
             m_StatsRect.right = m_StatsRect.left + 61 * charSize.cx + 5 + 3;
-            m_StatsRect.bottom = m_StatsRect.top + 18 * charSize.cy + 5 + 3;
+            m_StatsRect.bottom = m_StatsRect.top + 20 * charSize.cy + 5 + 3;
         }
         m_StatsBackground.Set(m_StatsRect, rtSize, D3DCOLOR_ARGB(80, 0, 0, 0));
 
@@ -1301,12 +1393,41 @@ HRESULT CDX11VideoProcessor::MemCopyToTexSrcVideo(const BYTE* srcData, const int
     HRESULT hr = S_FALSE;
     D3D11_MAPPED_SUBRESOURCE mappedResource = {};
 
-    if (m_TexSrcVideo.pTexture2)
+    // A dynamic texture can only be mapped with D3D11_MAP_WRITE_DISCARD and must then be written completely,
+    // so only unchanged frames are skipped. The texture keeps its content until the next Map().
+    const BYTE* firstLine = (srcPitch < 0) ? srcData + srcPitch * (1 - (int)m_srcLines) : srcData;
+    if (m_DirtyRows.Compare(firstLine, srcPitch, abs(srcPitch), m_srcLines, 0.0, &m_ParallelCopy) == CDirtyRows::DIRTY_NONE)
+    {
+        return S_OK;
+    }
+
+    if (m_pUnpackFn)
+    {
+        D3D11_MAPPED_SUBRESOURCE mappedUV = {};
+        hr = m_pDeviceContext->Map(m_TexSrcVideo.pTexture, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+        if (SUCCEEDED(hr))
+        {
+            hr = m_pDeviceContext->Map(m_TexSrcVideo.pTexture2, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedUV);
+            if (SUCCEEDED(hr))
+            {
+                BYTE* dstY = (BYTE*)mappedResource.pData;
+                BYTE* dstUV = (BYTE*)mappedUV.pData;
+                m_ParallelCopy.Run(m_srcHeight, [&](UINT first, UINT count)
+                {
+                    m_pUnpackFn(count, dstY + (size_t)mappedResource.RowPitch * first, mappedResource.RowPitch,
+                                dstUV + (size_t)mappedUV.RowPitch * first, mappedUV.RowPitch, srcData + (size_t)srcPitch * first, srcPitch);
+                });
+                m_pDeviceContext->Unmap(m_TexSrcVideo.pTexture2, 0);
+            }
+            m_pDeviceContext->Unmap(m_TexSrcVideo.pTexture, 0);
+        }
+    }
+    else if (m_TexSrcVideo.pTexture2)
     {
         hr = m_pDeviceContext->Map(m_TexSrcVideo.pTexture, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
         if (SUCCEEDED(hr))
         {
-            m_pCopyPlaneFn(m_srcHeight, (BYTE*)mappedResource.pData, mappedResource.RowPitch, srcData, srcPitch);
+            m_ParallelCopy.CopyPlane(GetCopyPlaneFn(srcData, srcPitch), m_srcHeight, (BYTE*)mappedResource.pData, mappedResource.RowPitch, srcData, srcPitch);
             m_pDeviceContext->Unmap(m_TexSrcVideo.pTexture, 0);
 
             hr = m_pDeviceContext->Map(m_TexSrcVideo.pTexture2, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
@@ -1317,7 +1438,7 @@ HRESULT CDX11VideoProcessor::MemCopyToTexSrcVideo(const BYTE* srcData, const int
                                            ? srcPitch / m_srcParams.pDX11Planes->div_chroma_w
                                            : srcPitch;
                 srcData += srcPitch * m_srcHeight;
-                m_pCopyPlaneFn(cromaH, (BYTE*)mappedResource.pData, mappedResource.RowPitch, srcData, cromaPitch);
+                m_ParallelCopy.CopyPlane(GetCopyPlaneFn(srcData, cromaPitch), cromaH, (BYTE*)mappedResource.pData, mappedResource.RowPitch, srcData, cromaPitch);
                 m_pDeviceContext->Unmap(m_TexSrcVideo.pTexture2, 0);
 
                 if (m_TexSrcVideo.pTexture3)
@@ -1326,25 +1447,73 @@ HRESULT CDX11VideoProcessor::MemCopyToTexSrcVideo(const BYTE* srcData, const int
                     if (SUCCEEDED(hr))
                     {
                         srcData += cromaPitch * cromaH;
-                        m_pCopyPlaneFn(cromaH, (BYTE*)mappedResource.pData, mappedResource.RowPitch, srcData,
-                                       cromaPitch);
+                        m_ParallelCopy.CopyPlane(GetCopyPlaneFn(srcData, cromaPitch), cromaH, (BYTE*)mappedResource.pData, mappedResource.RowPitch,
+                                                 srcData, cromaPitch);
                         m_pDeviceContext->Unmap(m_TexSrcVideo.pTexture3, 0);
                     }
                 }
             }
         }
     }
+    else if (m_pConvertPlanarFn)
+    {
+        hr = m_pDeviceContext->Map(m_TexSrcVideo.pTexture, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+        if (SUCCEEDED(hr))
+        {
+            // the planes are interleaved into the semiplanar or packed texture while they are copied
+            const UINT step = m_srcParams.pDX11Planes->div_chroma_h; // luma lines per chroma line
+            const UINT srcLumaLines = m_srcLines * 2 / m_srcParams.PitchCoeff;
+            const int cromaPitch = srcPitch / m_srcParams.pDX11Planes->div_chroma_w;
+
+            const BYTE* srcY = srcData;
+            const BYTE* srcU = srcY + srcPitch * srcLumaLines;
+            const BYTE* srcV = srcU + cromaPitch * (srcLumaLines / step);
+            if (m_srcParams.cformat == CF_YV12 || m_srcParams.cformat == CF_YV16)
+            {
+                std::swap(srcU, srcV);
+            }
+
+            BYTE* dstY = (BYTE*)mappedResource.pData;
+            BYTE* dstUV = (step == 2) ? dstY + mappedResource.RowPitch * m_TexSrcVideo.desc.Height : nullptr;
+            const UINT dstPitch = mappedResource.RowPitch;
+
+            const UINT height = std::min(m_srcHeight, srcLumaLines);
+            const UINT lines = height / step;
+            m_ParallelCopy.Run(lines, [&](UINT first, UINT count)
+            {
+                m_pConvertPlanarFn(count * step, dstY + (size_t)dstPitch * first * step, dstUV ? dstUV + (size_t)dstPitch * first : nullptr, dstPitch,
+                                   srcY + (size_t)srcPitch * first * step, srcU + (size_t)cromaPitch * first, srcV + (size_t)cromaPitch * first, srcPitch);
+            });
+            if (height % step && lines)
+            {
+                // the last luma line of an odd height 4:2:0 frame has no pair, the functions convert pairs of lines.
+                // The pair of the last two lines is converted to a temporary buffer, the chroma line above is repeated.
+                std::vector<BYTE> pair((size_t)dstPitch * 3);
+                const UINT last = height - 1;
+                m_pConvertPlanarFn(2, pair.data(), pair.data() + (size_t)dstPitch * 2, dstPitch,
+                                   srcY + (size_t)srcPitch * (last - 1), srcU + (size_t)cromaPitch * (lines - 1), srcV + (size_t)cromaPitch * (lines - 1), srcPitch);
+                memcpy(dstY + (size_t)dstPitch * last, pair.data() + dstPitch, dstPitch);
+                memcpy(dstUV + (size_t)dstPitch * lines, pair.data() + (size_t)dstPitch * 2, dstPitch);
+            }
+            m_pDeviceContext->Unmap(m_TexSrcVideo.pTexture, 0);
+        }
+    }
     else
     {
         hr = m_pDeviceContext->Map(m_TexSrcVideo.pTexture, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
         if (SUCCEEDED(hr))
         {
             const BYTE* src = (srcPitch < 0) ? srcData + srcPitch * (1 - (int)m_srcLines) : srcData;
-            m_pCopyPlaneFn(m_srcLines, (BYTE*)mappedResource.pData, mappedResource.RowPitch, src, srcPitch);
+            m_ParallelCopy.CopyPlane(GetCopyPlaneFn(src, srcPitch), m_srcLines, (BYTE*)mappedResource.pData, mappedResource.RowPitch, src, srcPitch);
             m_pDeviceContext->Unmap(m_TexSrcVideo.pTexture, 0);
         }
     }
 
+    if (FAILED(hr))
+    {
+        m_DirtyRows.Invalidate();
+    }
+
     return hr;
 }
 
@@ -1908,6 +2077,8 @@ BOOL CDX11VideoProcessor::InitMediaType(const CMediaType* pmt)
     case CF_RGB24:
     case CF_BGR48: m_srcPitch = ALIGN(m_srcPitch, 4);
         break;
+    case CF_V210: m_srcPitch = GetV210Pitch(biWidth);
+        break;
     }
     if (pBIH->biCompression == BI_RGB && pBIH->biHeight > 0) { m_srcPitch = -m_srcPitch; }
 
@@ -1930,15 +2101,27 @@ BOOL CDX11VideoProcessor::InitMediaType(const CMediaType* pmt)
 
     m_srcExFmt = SpecifyExtendedFormat(m_decExFmt, FmtParams, m_srcRectWidth, m_srcRectHeight);
 
+    if (FmtParams.VP11Format == DXGI_FORMAT_UNKNOWN)
+    {
+        // planar YUV is converted to NV12, P010, P016, YUY2, Y210 or Y216 while it is copied
+        FmtParams.VP11Format = GetPlanarVP11Format(FmtParams.cformat);
+    }
+
     bool disableD3D11VP = false;
     switch (FmtParams.cformat)
     {
-    case CF_NV12: disableD3D11VP = !m_VPFormats.bNV12;
+    case CF_NV12:
+    case CF_YV12:
+    case CF_YUV420P8: disableD3D11VP = !m_VPFormats.bNV12;
         break;
     case CF_P010:
-    case CF_P016: disableD3D11VP = !m_VPFormats.bP01x;
+    case CF_P016:
+    case CF_YUV420P10:
+    case CF_YUV420P16: disableD3D11VP = !m_VPFormats.bP01x;
         break;
-    case CF_YUY2: disableD3D11VP = !m_VPFormats.bYUY2;
+    case CF_YUY2:
+    case CF_YV16:
+    case CF_YUV422P8: disableD3D11VP = !m_VPFormats.bYUY2;
         break;
     default: disableD3D11VP = !m_VPFormats.bOther;
         break;
@@ -2059,6 +2242,7 @@ BOOL CDX11VideoProcessor::InitMediaType(const CMediaType* pmt)
                 {
                     DLog(L"CDX11VideoProcessor::InitMediaType() Enhanced ACES tone mapping selected");
                 }
+                m_HdrScene.Reset();
                 SetHDR10ShaderParams(0, 0, 0, 0, m_fHdrDisplayMaxNits, m_iHdrLocalToneMappingType);
             }
         }
@@ -2169,7 +2353,10 @@ HRESULT CDX11VideoProcessor::InitializeD3D11VP(const FmtConvParams_t& params, co
     m_srcHeight = height;
     m_srcParams = params;
     m_srcDXGIFormat = dxgiFormat;
-    m_pCopyPlaneFn = GetCopyPlaneFunction(params, VP_D3D11);
+    SetCopyPlaneKernel(params, VP_D3D11);
+    m_pConvertPlanarFn = GetConvertPlanarFunction(params.cformat, &m_strCopyKernel);
+    m_pUnpackFn = nullptr;
+    m_DirtyRows.Invalidate();
 
     DLog(L"CDX11VideoProcessor::InitializeD3D11VP() completed successfully");
 
@@ -2195,11 +2382,18 @@ HRESULT CDX11VideoProcessor::InitializeTexVP(const FmtConvParams_t& params, cons
     m_srcHeight = height;
     m_srcParams = params;
     m_srcDXGIFormat = srcDXGIFormat;
-    m_pCopyPlaneFn = GetCopyPlaneFunction(params, VP_D3D11_SHADER);
+    SetCopyPlaneKernel(params, VP_D3D11_SHADER);
+    m_pConvertPlanarFn = nullptr;
+    // Y210 and Y216 have their own texture format, v210 is unpacked to the P210 planes
+    m_pUnpackFn = (srcDXGIFormat == DXGI_FORMAT_PLANAR) ? GetUnpackPackedFunction(params.cformat, &m_strCopyKernel) : nullptr;
+    m_DirtyRows.Invalidate();
 
     // set default ProcAmp ranges
     SetDefaultDXVA2ProcAmpRanges(m_DXVA2ProcAmpRanges);
 
+    // the current shaders read a texture of another size
+    m_pPSConvertColor.Release();
+    m_pPSConvertColorDeint.Release();
     hr = UpdateConvertColorShader();
 
     SAFE_RELEASE(m_PSConvColorData.pVertexBuffer);
@@ -2236,6 +2430,10 @@ BOOL CDX11VideoProcessor::GetAlignmentSize(const CMediaType& mt, SIZE& Size)
         {
             // nothing
         }
+        else if (FmtParams.cformat == CF_V210)
+        {
+            // nothing, the P210 textures do not have the pitch of v210
+        }
         else
         {
             auto pBIH = GetBIHfromVIHs(&mt);
@@ -2353,6 +2551,7 @@ HRESULT CDX11VideoProcessor::ProcessSample(IMediaSample* pSample)
 
     // always Render(1) a frame after CopySample()
     hr = Render(1, rtStart);
+    m_ViewCache.EndFrame();
     m_pFilter->m_DrawStats.Add(GetPreciseTick());
     if (m_pFilter->m_filterState == State_Running)
     {
@@ -2378,6 +2577,7 @@ HRESULT CDX11VideoProcessor::ProcessSample(IMediaSample* pSample)
         rtStart += rtFrameDur / 2;
 
         hr = Render(2, rtStart);
+        m_ViewCache.EndFrame();
         m_pFilter->m_DrawStats.Add(GetPreciseTick());
         if (m_pFilter->m_filterState == State_Running)
         {
@@ -2430,7 +2630,8 @@ HRESULT CDX11VideoProcessor::CopySample(IMediaSample* pSample)
 
     bool updateStats = false; // FIXED: Declare updateStats variable
     m_hdr10 = {};
-    m_Dovi.bValid = false; // reset DoVi every sample
+    // the sample has Dolby Vision metadata, m_Dovi keeps the metadata of the last one
+    bool bDoviSample = false;
 
     if (CComQIPtr<IMediaSideData> pMediaSideData = pSample)
     {
@@ -2503,51 +2704,33 @@ HRESULT CDX11VideoProcessor::CopySample(IMediaSample* pSample)
             size = 0;
             hrLocal = pMediaSideData->GetSideData(IID_MediaSideDataDOVIMetadata,
                                                   reinterpret_cast<const BYTE**>(&pDOVIMetadata), &size);
-            if (SUCCEEDED(hrLocal) && size == sizeof(MediaSideDataDOVIMetadata) && CheckDoviMetadata(pDOVIMetadata, 1))
+            const bool bDoviData = SUCCEEDED(hrLocal) && size == sizeof(MediaSideDataDOVIMetadata);
+            DoviFingerprint_t fp;
+            if (bDoviData)
+            {
+                GetDoviFingerprint(*pDOVIMetadata, fp);
+            }
+
+            // most frames repeat the metadata of the previous one, which has been checked and applied
+            if (bDoviData && m_Dovi.IsApplied(fp) && m_PSConvColorData.bEnable
+                && (m_pDoviCurvesConstantBuffer || m_TexDoviLut.pTexture))
+            {
+                bDoviSample = true;
+            }
+            else if (bDoviData && CheckDoviMetadata(pDOVIMetadata, 1))
             {
-                const bool bYCCtoRGBChanged = !m_PSConvColorData.bEnable ||
-                (memcmp(
-                    &m_Dovi.msd.ColorMetadata.ycc_to_rgb_matrix,
-                    &pDOVIMetadata->ColorMetadata.ycc_to_rgb_matrix,
-                    sizeof(pDOVIMetadata->ColorMetadata.ycc_to_rgb_matrix)) != 0) || // FIXED: Added sizeof()
-                (memcmp(
-                    &m_Dovi.msd.ColorMetadata.ycc_to_rgb_offset,
-                    &pDOVIMetadata->ColorMetadata.ycc_to_rgb_offset,
-                    sizeof(pDOVIMetadata->ColorMetadata.ycc_to_rgb_offset)) != 0); // FIXED: Split into two memcmp calls
-
-                const bool bRGBtoLMSChanged =
-                (memcmp(
-                    &m_Dovi.msd.ColorMetadata.rgb_to_lms_matrix,
-                    &pDOVIMetadata->ColorMetadata.rgb_to_lms_matrix,
-                    sizeof(pDOVIMetadata->ColorMetadata.rgb_to_lms_matrix)
-                ) != 0);
-
-                const bool bMappingCurvesChanged = !m_pDoviCurvesConstantBuffer ||
-                (memcmp(
-                    &m_Dovi.msd.Mapping.curves,
-                    &pDOVIMetadata->Mapping.curves,
-                    sizeof(pDOVIMetadata->Mapping.curves)
-                ) != 0);
-
-                const bool bMasteringLuminanceChanged = m_Dovi.msd.ColorMetadata.source_max_pq != pDOVIMetadata->
-                    ColorMetadata.source_max_pq
-                    || m_Dovi.msd.ColorMetadata.source_min_pq != pDOVIMetadata->ColorMetadata.source_min_pq;
+                bDoviSample = true;
+
+                const bool bYCCtoRGBChanged = !m_PSConvColorData.bEnable || fp.yccToRgb != m_Dovi.fp.yccToRgb;
+                const bool bRGBtoLMSChanged = fp.rgbToLms != m_Dovi.fp.rgbToLms;
+                const bool bMappingCurvesChanged = !(m_pDoviCurvesConstantBuffer || m_TexDoviLut.pTexture) ||
+                    fp.CurvesChanged(m_Dovi.fp);
+                const bool bMasteringLuminanceChanged = fp.levels != m_Dovi.fp.levels;
 
                 bool bMMRChanged = false;
                 if (bMappingCurvesChanged)
                 {
-                    bool has_mmr = false;
-                    for (const auto& curve : pDOVIMetadata->Mapping.curves)
-                    {
-                        for (uint8_t i = 0; i < (curve.num_pivots - 1); i++)
-                        {
-                            if (curve.mapping_idc[i] == 1)
-                            {
-                                has_mmr = true;
-                                break;
-                            }
-                        }
-                    }
+                    const bool has_mmr = DoviHasMMR(*pDOVIMetadata);
                     if (m_Dovi.bHasMMR != has_mmr)
                     {
                         m_Dovi.bHasMMR = has_mmr;
@@ -2557,6 +2740,7 @@ HRESULT CDX11VideoProcessor::CopySample(IMediaSample* pSample)
                 }
 
                 memcpy(&m_Dovi.msd, pDOVIMetadata, sizeof(MediaSideDataDOVIMetadata));
+                m_Dovi.fp = fp;
                 const bool doviStateChanged = !m_Dovi.bValid;
                 m_Dovi.bValid = true;
 
@@ -2604,12 +2788,22 @@ HRESULT CDX11VideoProcessor::CopySample(IMediaSample* pSample)
                 {
                     DLogIf(bRGBtoLMSChanged, L"CDX11VideoProcessor::CopySample() : DoVi rgb_to_lms_matrix is changed");
                     DLogIf(bMMRChanged, L"CDX11VideoProcessor::CopySample() : DoVi has_mmr is changed");
+                    if (bMMRChanged)
+                    {
+                        // the current shaders read the curves in another layout
+                        m_pPSConvertColor.Release();
+                        m_pPSConvertColorDeint.Release();
+                    }
                     UpdateConvertColorShader();
                 }
                 if (bMappingCurvesChanged)
                 {
                     HRESULT hrCurves; // FIXED: Declare local hr variable
-                    if (m_Dovi.bHasMMR)
+                    if (m_TexDoviLut.pTexture)
+                    {
+                        hrCurves = UpdateDoviLut() ? S_OK : E_FAIL;
+                    }
+                    else if (m_Dovi.bHasMMR)
                     {
                         hrCurves = SetShaderDoviCurves();
                     }
@@ -2631,6 +2825,20 @@ HRESULT CDX11VideoProcessor::CopySample(IMediaSample* pSample)
         }
     } // End of IMediaSideData processing
 
+    if (!bDoviSample && m_Dovi.End())
+    {
+        // the next frames are converted without the reshaping and can use the video processor again
+        DLog(L"CDX11VideoProcessor::CopySample() : DoVi metadata has ended");
+        if (!SourceIsPQorHLG())
+        {
+            ReleaseSwapChain();
+            Init(m_hWnd, false);
+
+            m_srcVideoTransferFunction = 0;
+        }
+        InitMediaType(&m_pFilter->m_inputMT);
+    }
+
     // ---- START OF NEW LOGIC ----
     // Debounce + single-shot guard for auto-swap thrash
     static DWORD s_lastSwapTick = 0;
@@ -2640,7 +2848,7 @@ HRESULT CDX11VideoProcessor::CopySample(IMediaSample* pSample)
     // Determine HDR/SDR by transfer function or side data (does not depend on user flags)
     const bool srcTFisHDR = (m_srcExFmt.VideoTransferFunction == MFVideoTransFunc_2084) ||
         (m_srcExFmt.VideoTransferFunction == MFVideoTransFunc_HLG);
-    const bool sideDataHDR = (m_hdr10.bValid || m_Dovi.bValid);
+    const bool sideDataHDR = (m_hdr10.bValid || bDoviSample);
     const bool detectedHDR = srcTFisHDR || sideDataHDR;
 
     // Only log once per content type change or every 100 frames to reduce spam
@@ -2823,6 +3031,7 @@ HRESULT CDX11VideoProcessor::CopySample(IMediaSample* pSample)
         {
             m_iSrcFromGPU = 0;
             updateStats = true;
+            m_DirtyRows.Invalidate(); // the texture was written by the GPU
         }
 
         BYTE* data = nullptr;
@@ -2846,6 +3055,7 @@ HRESULT CDX11VideoProcessor::CopySample(IMediaSample* pSample)
     }
 
     m_RenderStats.copyticks = GetPreciseTick() - tick;
+    m_RenderLatency.copy.Add(m_RenderStats.copyticks);
 
     return hr;
 }
@@ -2863,10 +3073,10 @@ HRESULT CDX11VideoProcessor::FillBlack()
     }
 
     ID3D11RenderTargetView* pRenderTargetView;
-    hr = m_pDevice->CreateRenderTargetView(pBackBuffer, nullptr, &pRenderTargetView);
+    hr = m_ViewCache.GetRenderTargetView(m_pDevice, pBackBuffer, nullptr, &pRenderTargetView);
     if (FAILED(hr))
     {
-        DLog(L"CDX11VideoProcessor::FillBlack() : CreateRenderTargetView() failed with error {}", HR2Str(hr));
+        DLog(L"CDX11VideoProcessor::FillBlack() : GetRenderTargetView() failed with error {}", HR2Str(hr));
         return hr;
     }
 
@@ -2900,6 +3110,7 @@ HRESULT CDX11VideoProcessor::FillBlack()
     hr = m_pDXGISwapChain1->Present(1, 0);
     g_bPresent = false;
     DLogIf(FAILED(hr), L"CDX11VideoProcessor::FillBlack() : Present() failed with error {}", HR2Str(hr));
+    m_ViewCache.EndFrame();
 
     if (hr == DXGI_ERROR_INVALID_CALL && m_pFilter->m_bIsD3DFullscreen)
     {
@@ -2918,6 +3129,7 @@ void CDX11VideoProcessor::UpdateTexures()
 
     // TODO: try making w and h a multiple of 128.
     HRESULT hr = S_OK;
+    m_ViewCache.Clear(); // the textures may be recreated
 
     if (m_D3D11VP.IsReady())
     {
@@ -2957,6 +3169,7 @@ void CDX11VideoProcessor::UpdatePostScaleTexures()
     }
 
     const UINT numPostScaleSteps = GetPostScaleSteps();
+    m_ViewCache.Clear(); // the textures may be recreated
     HRESULT hr = m_TexsPostScale.CheckCreate(m_pDevice, m_InternalTexFmt, m_windowRect.Width(), m_windowRect.Height(),
                                              numPostScaleSteps);
     //UpdateStatsPostProc();
@@ -2998,12 +3211,8 @@ void CDX11VideoProcessor::UpdateDownscalingShaders()
     UpdateScalingStrings();
 }
 
-HRESULT CDX11VideoProcessor::UpdateConvertColorShader()
+HRESULT CDX11VideoProcessor::UpdateConvertColorShader(const bool bWait/* = false*/)
 {
-    m_pPSConvertColor.Release();
-    m_pPSConvertColorDeint.Release();
-    ID3DBlob* pShaderCode = nullptr;
-
     int convertType = (m_bConvertToSdr && !(m_bHdrSupport && (m_bHdrPassthrough || m_bHdrLocalToneMapping)))
                           ? SHADER_CONVERT_TO_SDR
                           : (m_bHdrSupport && (m_bHdrPassthrough || m_bHdrLocalToneMapping) && m_srcExFmt.
@@ -3013,71 +3222,251 @@ HRESULT CDX11VideoProcessor::UpdateConvertColorShader()
 
     MediaSideDataDOVIMetadata* pDOVIMetadata = m_Dovi.bValid ? &m_Dovi.msd : nullptr;
 
-    HRESULT hr = GetShaderConvertColor(true,
-                                       m_srcWidth,
-                                       m_TexSrcVideo.desc.Width, m_TexSrcVideo.desc.Height,
-                                       m_srcRect, m_srcParams, m_srcExFmt, pDOVIMetadata,
-                                       m_iChromaScaling, convertType, false,
-                                       &pShaderCode);
+    const bool bTrcLut = UpdateTrcLut(GetShaderConvertColorTrc(m_srcExFmt, pDOVIMetadata, convertType));
+    const bool bDoviLut = UpdateDoviLut();
+
+    // the second shader blends the fields of interlaced frames
+    const bool bDeint = m_bInterlaced && m_srcParams.Subsampling == 420 && m_srcParams.pDX11Planes;
+
+    std::vector<CShaderCompileQueue::Source_t> sources(bDeint ? 2 : 1);
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        sources[i].target = GetShaderConvertColorTarget(true);
+        GetShaderConvertColorCode(true,
+                                  m_srcWidth,
+                                  m_TexSrcVideo.desc.Width, m_TexSrcVideo.desc.Height,
+                                  m_srcRect, m_srcParams, m_srcExFmt, pDOVIMetadata,
+                                  m_iChromaScaling, convertType, i == 1, bTrcLut, bDoviLut,
+                                  sources[i].code);
+    }
+
+    CShaderCompileQueue::Result_t result;
+    result.hrs.resize(sources.size(), S_OK);
+    result.blobs.resize(sources.size());
+
+    if (bWait)
+    {
+        for (size_t i = 0; i < sources.size(); i++)
+        {
+            result.hrs[i] = CompileShaderSource(sources[i], result.blobs[i]);
+        }
+    }
+    else
+    {
+        // the shaders that are in the shader cache are created at once, the others are compiled
+        // in the background and the current shaders are used until CheckConvertColorShaders() gets them
+        for (size_t i = 0; i < sources.size(); i++)
+        {
+            if (!LoadCachedShader(sources[i].code, nullptr, sources[i].target, result.blobs[i]))
+            {
+                DLog(L"CDX11VideoProcessor::UpdateConvertColorShader() : the shaders are compiled in the background");
+                m_ConvertShaderQueue.Submit(std::move(sources));
+                if (!m_pPSConvertColor)
+                {
+                    SetConvertColorFallbackShader();
+                }
+                return S_FALSE;
+            }
+        }
+    }
+
+    m_ConvertShaderQueue.Cancel();
+
+    return SetConvertColorShaders(result);
+}
+
+HRESULT CDX11VideoProcessor::SetConvertColorShaders(const CShaderCompileQueue::Result_t& result)
+{
+    m_pPSConvertColor.Release();
+    m_pPSConvertColorDeint.Release();
+
+    HRESULT hr = result.hrs[0];
     if (S_OK == hr)
     {
-        hr = m_pDevice->CreatePixelShader(pShaderCode->GetBufferPointer(), pShaderCode->GetBufferSize(), nullptr,
+        hr = m_pDevice->CreatePixelShader(result.blobs[0].data(), result.blobs[0].size(), nullptr,
                                           &m_pPSConvertColor);
-        pShaderCode->Release();
     }
 
-    if (m_bInterlaced && m_srcParams.Subsampling == 420 && m_srcParams.pDX11Planes)
+    if (S_OK == hr && result.hrs.size() > 1)
     {
-        hr = GetShaderConvertColor(true,
-                                   m_srcWidth,
-                                   m_TexSrcVideo.desc.Width, m_TexSrcVideo.desc.Height,
-                                   m_srcRect, m_srcParams, m_srcExFmt, pDOVIMetadata,
-                                   m_iChromaScaling, convertType, true,
-                                   &pShaderCode);
+        hr = result.hrs[1];
         if (S_OK == hr)
         {
-            hr = m_pDevice->CreatePixelShader(pShaderCode->GetBufferPointer(), pShaderCode->GetBufferSize(), nullptr,
+            hr = m_pDevice->CreatePixelShader(result.blobs[1].data(), result.blobs[1].size(), nullptr,
                                               &m_pPSConvertColorDeint);
-            pShaderCode->Release();
         }
     }
 
     if (FAILED(hr))
     {
         ASSERT(0);
-        UINT resid = 0;
-        if (m_srcParams.cformat == CF_YUY2)
-        {
-            resid = IDF_PS_11_CONVERT_YUY2;
-        }
-        else if (m_srcParams.pDX11Planes)
+        SetConvertColorFallbackShader();
+
+        return S_FALSE;
+    }
+
+    return hr;
+}
+
+void CDX11VideoProcessor::SetConvertColorFallbackShader()
+{
+    m_pPSConvertColor.Release();
+    m_pPSConvertColorDeint.Release();
+
+    UINT resid = 0;
+    if (m_srcParams.cformat == CF_YUY2)
+    {
+        resid = IDF_PS_11_CONVERT_YUY2;
+    }
+    else if (m_srcParams.pDX11Planes)
+    {
+        if (m_srcParams.pDX11Planes->FmtPlane3)
         {
-            if (m_srcParams.pDX11Planes->FmtPlane3)
+            if (m_srcParams.cformat == CF_YV12 || m_srcParams.cformat == CF_YV16 || m_srcParams.cformat == CF_YV24)
             {
-                if (m_srcParams.cformat == CF_YV12 || m_srcParams.cformat == CF_YV16 || m_srcParams.cformat == CF_YV24)
-                {
-                    resid = IDF_PS_11_CONVERT_PLANAR_YV;
-                }
-                else
-                {
-                    resid = IDF_PS_11_CONVERT_PLANAR;
-                }
+                resid = IDF_PS_11_CONVERT_PLANAR_YV;
             }
             else
             {
-                resid = IDF_PS_11_CONVERT_BIPLANAR;
+                resid = IDF_PS_11_CONVERT_PLANAR;
             }
         }
         else
         {
-            resid = IDF_PS_11_CONVERT_COLOR;
+            resid = IDF_PS_11_CONVERT_BIPLANAR;
         }
-        EXECUTE_ASSERT(S_OK == CreatePShaderFromResource(&m_pPSConvertColor, resid));
+    }
+    else
+    {
+        resid = IDF_PS_11_CONVERT_COLOR;
+    }
+    EXECUTE_ASSERT(S_OK == CreatePShaderFromResource(&m_pPSConvertColor, resid));
+}
 
-        return S_FALSE;
+bool CDX11VideoProcessor::UpdateTrcLut(mp_csp_trc trc)
+{
+    if (!m_bTransferLut)
+    {
+        trc = MP_CSP_TRC_AUTO;
+    }
+    if (trc == m_TrcLut)
+    {
+        return trc != MP_CSP_TRC_AUTO;
     }
 
-    return hr;
+    // the current shaders sample the previous table
+    m_pPSConvertColor.Release();
+    m_pPSConvertColorDeint.Release();
+    m_TexTrcLut.Release();
+    m_TrcLut = MP_CSP_TRC_AUTO;
+
+    if (trc == MP_CSP_TRC_AUTO)
+    {
+        return false;
+    }
+
+    std::vector<float> lut;
+    HRESULT hr = BakeTrcLut1D(trc, TRC_LUT1D_SIZE, lut);
+    if (S_OK == hr)
+    {
+        hr = m_TexTrcLut.Create(m_pDevice, DXGI_FORMAT_R32_FLOAT, TRC_LUT1D_SIZE, 1, Tex2D_DynamicShaderWrite);
+    }
+    if (S_OK == hr)
+    {
+        D3D11_MAPPED_SUBRESOURCE mappedResource;
+        hr = m_pDeviceContext->Map(m_TexTrcLut.pTexture, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+        if (S_OK == hr)
+        {
+            memcpy(mappedResource.pData, lut.data(), lut.size() * sizeof(float));
+            m_pDeviceContext->Unmap(m_TexTrcLut.pTexture, 0);
+        }
+    }
+    if (FAILED(hr))
+    {
+        DLog(L"CDX11VideoProcessor::UpdateTrcLut() : the table for trc {} failed with error {}", (int)trc, HR2Str(hr));
+        m_TexTrcLut.Release();
+        return false;
+    }
+
+    m_TrcLut = trc;
+
+    return true;
+}
+
+bool CDX11VideoProcessor::UpdateDoviLut()
+{
+    // the MMR pieces depend on all three components and are computed by the shader
+    if (!m_bTransferLut || !m_Dovi.bValid || m_Dovi.bHasMMR)
+    {
+        if (m_TexDoviLut.pTexture)
+        {
+            // the current shaders sample the tables, the others read the curves from the constant buffer
+            m_pPSConvertColor.Release();
+            m_pPSConvertColorDeint.Release();
+            m_TexDoviLut.Release();
+            m_DoviLutHash = 0;
+            if (m_Dovi.bValid && m_Dovi.bHasMMR)
+            {
+                SetShaderDoviCurves();
+            }
+            else if (m_Dovi.bValid)
+            {
+                SetShaderDoviCurvesPoly();
+            }
+        }
+        return false;
+    }
+
+    const uint64_t hash = m_Dovi.fp.reshape;
+    if (m_TexDoviLut.pTexture && hash == m_DoviLutHash)
+    {
+        return true;
+    }
+
+    HRESULT hr = S_OK;
+    if (!m_TexDoviLut.pTexture)
+    {
+        m_pPSConvertColor.Release();
+        m_pPSConvertColorDeint.Release();
+        hr = m_TexDoviLut.Create(m_pDevice, DXGI_FORMAT_R32_FLOAT, DOVI_LUT_SIZE, 3, Tex2D_DynamicShaderWrite);
+    }
+    if (S_OK == hr)
+    {
+        // the scenes often return to a previous mapping, its tables are not baked again
+        const auto& lut = m_DoviLutCache.Get(m_Dovi.msd, hash);
+
+        D3D11_MAPPED_SUBRESOURCE mappedResource;
+        hr = m_pDeviceContext->Map(m_TexDoviLut.pTexture, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+        if (S_OK == hr)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                memcpy((BYTE*)mappedResource.pData + c * mappedResource.RowPitch, &lut[c * DOVI_LUT_SIZE], DOVI_LUT_SIZE * sizeof(float));
+            }
+            m_pDeviceContext->Unmap(m_TexDoviLut.pTexture, 0);
+        }
+    }
+    if (FAILED(hr))
+    {
+        DLog(L"CDX11VideoProcessor::UpdateDoviLut() : failed with error {}", HR2Str(hr));
+        m_TexDoviLut.Release();
+        m_DoviLutHash = 0;
+        return false;
+    }
+
+    m_DoviLutHash = hash;
+
+    return true;
+}
+
+void CDX11VideoProcessor::CheckConvertColorShaders()
+{
+    CShaderCompileQueue::Result_t result;
+    if (m_ConvertShaderQueue.GetResult(result))
+    {
+        DLog(L"CDX11VideoProcessor::CheckConvertColorShaders() : the compiled shaders are used");
+        SetConvertColorShaders(result);
+    }
 }
 
 void CDX11VideoProcessor::UpdateBitmapShader()
@@ -3131,13 +3520,15 @@ HRESULT CDX11VideoProcessor::ConvertColorPass(ID3D11Texture2D* pRenderTarget)
 {
     CComPtr < ID3D11RenderTargetView > pRenderTargetView;
 
-    HRESULT hr = m_pDevice->CreateRenderTargetView(pRenderTarget, nullptr, &pRenderTargetView);
+    HRESULT hr = m_ViewCache.GetRenderTargetView(m_pDevice, pRenderTarget, nullptr, &pRenderTargetView);
     if (FAILED(hr))
     {
-        DLog(L"ConvertColorPass() : CreateRenderTargetView() failed with error {}", HR2Str(hr));
+        DLog(L"ConvertColorPass() : GetRenderTargetView() failed with error {}", HR2Str(hr));
         return hr;
     }
 
+    CheckConvertColorShaders();
+
     D3D11_VIEWPORT VP;
     VP.TopLeftX = 0;
     VP.TopLeftY = 0;
@@ -3166,6 +3557,8 @@ HRESULT CDX11VideoProcessor::ConvertColorPass(ID3D11Texture2D* pRenderTarget)
     m_pDeviceContext->PSSetShaderResources(0, 1, &m_TexSrcVideo.pShaderResource.p);
     m_pDeviceContext->PSSetShaderResources(1, 1, &m_TexSrcVideo.pShaderResource2.p);
     m_pDeviceContext->PSSetShaderResources(2, 1, &m_TexSrcVideo.pShaderResource3.p);
+    m_pDeviceContext->PSSetShaderResources(3, 1, &m_TexTrcLut.pShaderResource.p);
+    m_pDeviceContext->PSSetShaderResources(4, 1, &m_TexDoviLut.pShaderResource.p);
     m_pDeviceContext->PSSetSamplers(0, 1, &m_pSamplerPoint.p);
     m_pDeviceContext->PSSetSamplers(1, 1, &m_pSamplerLinear.p);
     m_pDeviceContext->PSSetConstantBuffers(0, 1, &m_PSConvColorData.pConstants);
@@ -3177,8 +3570,8 @@ HRESULT CDX11VideoProcessor::ConvertColorPass(ID3D11Texture2D* pRenderTarget)
     // Draw textured quad onto render target
     m_pDeviceContext->Draw(4, 0);
 
-    ID3D11ShaderResourceView* views[3] = {};
-    m_pDeviceContext->PSSetShaderResources(0, 3, views);
+    ID3D11ShaderResourceView* views[5] = {};
+    m_pDeviceContext->PSSetShaderResources(0, 5, views);
 
     return hr;
 }
@@ -3242,6 +3635,7 @@ HRESULT CDX11VideoProcessor::ResizeShaderPass(const Tex2D_t& Tex, ID3D11Texture2
         {
             if (texWidth != m_TexResize.desc.Width || texHeight != m_TexResize.desc.Height)
             {
+                m_ViewCache.Clear();
                 m_TexResize.Release(); // need new texture
             }
         }
@@ -3295,10 +3689,10 @@ HRESULT CDX11VideoProcessor::FinalPass(const Tex2D_t& Tex, ID3D11Texture2D* pRen
 {
     CComPtr < ID3D11RenderTargetView > pRenderTargetView;
 
-    HRESULT hr = m_pDevice->CreateRenderTargetView(pRenderTarget, nullptr, &pRenderTargetView);
+    HRESULT hr = m_ViewCache.GetRenderTargetView(m_pDevice, pRenderTarget, nullptr, &pRenderTargetView);
     if (FAILED(hr))
     {
-        DLog(L"CDX11VideoProcessor::FinalPass() : CreateRenderTargetView() failed with error {}", HR2Str(hr));
+        DLog(L"CDX11VideoProcessor::FinalPass() : GetRenderTargetView() failed with error {}", HR2Str(hr));
         return hr;
     }
 
@@ -3353,7 +3747,7 @@ void CDX11VideoProcessor::DrawSubtitles(ID3D11Texture2D* pRenderTarget)
         if (SUCCEEDED(hr))
         {
             ID3D11RenderTargetView* pRenderTargetView;
-            hr = m_pDevice->CreateRenderTargetView(pRenderTarget, nullptr, &pRenderTargetView);
+            hr = m_ViewCache.GetRenderTargetView(m_pDevice, pRenderTarget, nullptr, &pRenderTargetView);
             if (SUCCEEDED(hr))
             {
                 // Set render target and shaders
@@ -3374,7 +3768,7 @@ void CDX11VideoProcessor::DrawSubtitles(ID3D11Texture2D* pRenderTarget)
     if (m_pFilter->m_pSub11CallBack)
     {
         ID3D11RenderTargetView* pRenderTargetView;
-        hr = m_pDevice->CreateRenderTargetView(pRenderTarget, nullptr, &pRenderTargetView);
+        hr = m_ViewCache.GetRenderTargetView(m_pDevice, pRenderTarget, nullptr, &pRenderTargetView);
         if (SUCCEEDED(hr))
         {
             const CRect rSrcPri(POINT(0, 0), m_windowRect.Size());
@@ -3493,6 +3887,10 @@ HRESULT CDX11VideoProcessor::Process(ID3D11Texture2D* pRenderTarget, const CRect
         // Otherwise, the m_pPSCorrection shader (if present) will handle the conversion from PQ to SDR.
         if (m_pPSHDR10ToneMapping && (m_hdr10.bValid || m_Dovi.bValid))
         {
+            if (m_bHdrSceneAdaptive && !second)
+            {
+                UpdateHdrSceneStats(*pInputTexture, rect);
+            }
             StepSetting();
             hr = TextureCopyRect(*pInputTexture, pRT, rect, rect, m_pPSHDR10ToneMapping, m_pHDR10ToneMappingConstants,
                                  0, false);
@@ -3586,6 +3984,7 @@ HRESULT CDX11VideoProcessor::SetWindowRect(const CRect& windowRect)
 
     if (m_pDXGISwapChain1 && !m_bIsFullscreen)
     {
+        m_ViewCache.Clear(); // ResizeBuffers() fails while there are references to the back buffer
         hr = m_pDXGISwapChain1->ResizeBuffers(0, w, h, DXGI_FORMAT_UNKNOWN, 0);
     }
 
@@ -3695,7 +4094,7 @@ HRESULT CDX11VideoProcessor::GetCurentImage(long* pDIBImage)
         {
             m_bHdrPassthrough = false;
             m_bHdrLocalToneMapping = false;
-            UpdateConvertColorShader();
+            UpdateConvertColorShader(true);
         }
     }
 
@@ -3735,7 +4134,7 @@ HRESULT CDX11VideoProcessor::GetCurentImage(long* pDIBImage)
         else
         {
             m_bHdrPassthrough = true;
-            UpdateConvertColorShader();
+            UpdateConvertColorShader(true);
         }
     }
 
@@ -3810,12 +4209,12 @@ HRESULT CDX11VideoProcessor::GetDisplayedImage(BYTE** ppDib, unsigned* pSize)
         if (m_bAllowDeepColorBitmaps)
         {
             dib_bitdepth = 48;
-            pConvertToDibFunc = ConvertR10G10B10A2toBGR48;
+            pConvertToDibFunc = GetConvertR10G10B10A2Function(dib_bitdepth);
         }
         else
         {
             dib_bitdepth = 32;
-            pConvertToDibFunc = ConvertR10G10B10A2toBGR32;
+            pConvertToDibFunc = GetConvertR10G10B10A2Function(dib_bitdepth);
         }
     }
     else
@@ -3908,6 +4307,9 @@ HRESULT CDX11VideoProcessor::GetVPInfo(std::wstring& str)
         }
     }
 
+    AppendLatencyInfo(str);
+    AppendUploadInfo(str);
+
 #ifdef _DEBUG
     str.append(L"\n\nDEBUG info:");
     str += std::format(L"\nSource tex size: {}x{}", m_srcWidth, m_srcHeight);
@@ -4023,6 +4425,7 @@ void CDX11VideoProcessor::Configure(const Settings_t& config)
     m_bVBlankBeforePresent = config.bVBlankBeforePresent;
     m_bAdjustPresentTime = config.bAdjustPresentTime;
     m_bDeintBlend = config.bDeintBlend;
+    m_ParallelCopy.SetThreads(config.iUploadThreads);
 
     // checking what needs to be changed
 
@@ -4038,15 +4441,16 @@ void CDX11VideoProcessor::Configure(const Settings_t& config)
         changeTextures = true;
     }
 
-    if (m_srcParams.cformat == CF_NV12)
+    if (m_srcParams.cformat == CF_NV12 || m_srcParams.cformat == CF_YV12 || m_srcParams.cformat == CF_YUV420P8)
     {
         changeVP = config.VPFmts.bNV12 != m_VPFormats.bNV12;
     }
-    else if (m_srcParams.cformat == CF_P010 || m_srcParams.cformat == CF_P016)
+    else if (m_srcParams.cformat == CF_P010 || m_srcParams.cformat == CF_P016
+        || m_srcParams.cformat == CF_YUV420P10 || m_srcParams.cformat == CF_YUV420P16)
     {
         changeVP = config.VPFmts.bP01x != m_VPFormats.bP01x;
     }
-    else if (m_srcParams.cformat == CF_YUY2)
+    else if (m_srcParams.cformat == CF_YUY2 || m_srcParams.cformat == CF_YV16 || m_srcParams.cformat == CF_YUV422P8)
     {
         changeVP = config.VPFmts.bYUY2 != m_VPFormats.bYUY2;
     }
@@ -4070,6 +4474,22 @@ void CDX11VideoProcessor::Configure(const Settings_t& config)
             422);
     }
 
+    if (config.bTransferLut != m_bTransferLut)
+    {
+        m_bTransferLut = config.bTransferLut;
+        changeConvertShader = m_PSConvColorData.bEnable;
+    }
+
+    if (config.bHdrSceneAdaptive != m_bHdrSceneAdaptive)
+    {
+        m_bHdrSceneAdaptive = config.bHdrSceneAdaptive;
+        m_HdrScene.Reset();
+        if (m_pPSHDR10ToneMapping)
+        {
+            SetHDR10ShaderParams(0, 0, 0, 0, m_fHdrDisplayMaxNits, m_iHdrLocalToneMappingType);
+        }
+    }
+
     if (config.iHdrOsdBrightness != m_iHdrOsdBrightness)
     {
         m_iHdrOsdBrightness = config.iHdrOsdBrightness;
@@ -4489,7 +4909,14 @@ void CDX11VideoProcessor::UpdateStatsStatic()
         m_strStatsVProc.assign(L"\nVideoProcessor: ");
         if (m_D3D11VP.IsReady())
         {
-            m_strStatsVProc += std::format(L"D3D11 VP, output to {}", DXGIFormatToString(m_D3D11OutputFmt));
+            if (m_pConvertPlanarFn)
+            {
+                m_strStatsVProc += std::format(L"D3D11 VP ({}), output to {}", DXGIFormatToString(m_srcDXGIFormat), DXGIFormatToString(m_D3D11OutputFmt));
+            }
+            else
+            {
+                m_strStatsVProc += std::format(L"D3D11 VP, output to {}", DXGIFormatToString(m_D3D11OutputFmt));
+            }
         }
         else
         {
@@ -4546,6 +4973,10 @@ void CDX11VideoProcessor::UpdateStatsStatic()
                         m_strStatsHDR.append(L" Unknown");
                         break;
                     }
+                    if (m_bHdrSceneAdaptive)
+                    {
+                        m_strStatsHDR.append(L", scene adaptive");
+                    }
                     m_strStatsHDR.append(std::format(L"\n Display Max Nits: {:.1f} nits", m_fHdrDisplayMaxNits));
                 }
 
@@ -4744,8 +5175,23 @@ HRESULT CDX11VideoProcessor::DrawStats(ID3D11Texture2D* pRenderTarget)
                        m_RenderStats.copyticks * 1000 / GetPreciseTicksPerSecondI(),
                        m_RenderStats.paintticks * 1000 / GetPreciseTicksPerSecondI(),
                        m_RenderStats.presentticks * 1000 / GetPreciseTicksPerSecondI());
+    AppendLatencyStats(str);
 
     str += std::format(L"\nSync offset   : {:+3} ms", (m_RenderStats.syncoffset + 5000) / 10000);
+    str += std::format(L"\nViews created : {} per frame, {} cached", m_ViewCache.GetCreatedLastFrame(),
+                       m_ViewCache.GetCount());
+
+    if (m_pSubPicAllocator)
+    {
+        uint64_t uploadedBytes, reusedBytes;
+        uint32_t uploads, reuses;
+        m_pSubPicAllocator->GetUploadStats(uploadedBytes, reusedBytes, uploads, reuses);
+        if (uploads || reuses)
+        {
+            str += std::format(L"\nSubtitles     : uploaded {} KiB/{}, reused {} KiB/{}", uploadedBytes / 1024, uploads,
+                               reusedBytes / 1024, reuses);
+        }
+    }
 
 #if SYNC_OFFSET_EX
     {
@@ -4769,7 +5215,7 @@ HRESULT CDX11VideoProcessor::DrawStats(ID3D11Texture2D* pRenderTarget)
 #endif
 
     ID3D11RenderTargetView* pRenderTargetView = nullptr;
-    HRESULT hr = m_pDevice->CreateRenderTargetView(pRenderTarget, nullptr, &pRenderTargetView);
+    HRESULT hr = m_ViewCache.GetRenderTargetView(m_pDevice, pRenderTarget, nullptr, &pRenderTargetView);
     if (S_OK == hr)
     {
         SIZE rtSize = m_windowRect.Size();
@@ -20,6 +20,8 @@
 #include "D3DUtil/D3D11Font.h"
 #include "D3DUtil/D3D11Geometry.h"
 #include "VideoProcessor.h"
+#include "ParallelCopy.h"
+#include "HdrSceneStats.h"
 #include "SubPic/DX11SubPic.h"
 
 #define TEST_SHADER 0
@@ -60,10 +62,16 @@ private:
 #endif
 
     Tex11Video_t m_TexSrcVideo; // for copy of frame
+    CParallelCopy m_ParallelCopy; // for MemCopyToTexSrcVideo()
     Tex2D_t m_TexConvertOutput;
     Tex2D_t m_TexResize; // for intermediate result of two-pass resize
     CTex2DRing m_TexsPostScale;
     Tex2D_t m_TexDither;
+    Tex2D_t m_TexTrcLut; // the transfer function table of the conversion shader
+    mp_csp_trc m_TrcLut = MP_CSP_TRC_AUTO;
+    Tex2D_t m_TexDoviLut; // the Dolby Vision reshaping tables of the conversion shader
+    uint64_t m_DoviLutHash = 0;
+    CD3D11ViewCache m_ViewCache; // render target views of the textures above and of the back buffer
 
     // for GetAlignmentSize()
     struct Alignment_t
@@ -89,6 +97,12 @@ private:
     CComPtr<ID3D11PixelShader> m_pPSHDR10ToneMapping;
     const wchar_t* m_strHDR10ToneMapping = nullptr;
 
+    // scene-adaptive tone mapping, see UpdateHdrSceneStats()
+    Tex2D_t m_TexHdrStats; // the decimated frame
+    Tex2D_t m_TexHdrStatsStaging[HDR_STATS_LATENCY];
+    UINT m_nHdrStatsFrames = 0;
+    CHdrSceneController m_HdrScene;
+
     // D3D11 Shader Video Processor
     CComPtr<ID3D11PixelShader> m_pPSConvertColor;
     CComPtr<ID3D11PixelShader> m_pPSConvertColorDeint;
@@ -128,6 +142,7 @@ private:
 
     // Input parameters
     DXGI_FORMAT m_srcDXGIFormat = DXGI_FORMAT_UNKNOWN;
+    ConvertPlanarFn m_pConvertPlanarFn = nullptr; // planar YUV to the input texture of D3D11 VP
 
     // D3D11 VP texture format
     DXGI_FORMAT m_D3D11OutputFmt = DXGI_FORMAT_UNKNOWN;
@@ -219,6 +234,7 @@ private:
     void SetShaderConvertColorParams();
     void SetShaderLuminanceParams();
     void SetHDR10ShaderParams(float, float, float, float, float, int);
+    void UpdateHdrSceneStats(const Tex2D_t& Tex, const CRect& srcRect);
 
     HRESULT SetShaderDoviCurvesPoly();
     HRESULT SetShaderDoviCurves();
@@ -289,7 +305,14 @@ private:
     void UpdatePostScaleTexures();
     void UpdateUpscalingShaders();
     void UpdateDownscalingShaders();
-    HRESULT UpdateConvertColorShader();
+    // bWait - compile the shaders that are not in the shader cache at once, not in the background
+    HRESULT UpdateConvertColorShader(const bool bWait = false);
+    HRESULT SetConvertColorShaders(const CShaderCompileQueue::Result_t& result);
+    void SetConvertColorFallbackShader();
+    void CheckConvertColorShaders();
+    // returns false if the conversion shader computes the transfer function
+    bool UpdateTrcLut(mp_csp_trc trc);
+    bool UpdateDoviLut();
     void UpdateBitmapShader();
 
     HRESULT D3D11VPPass(ID3D11Texture2D* pRenderTarget, const CRect& srcRect, const CRect& dstRect, const bool second);
@@ -152,3 +152,161 @@ HRESULT DumpDX9Surface(IDirect3DSurface9* pSurface, const wchar_t* filename)
 
 	return hr;
 }
+
+//
+// CDX9UploadBuffers
+//
+
+void CDX9UploadBuffers::TakeBusySample(CComPtr<IMediaSample>& pSample)
+{
+	if (!m_pBusySample) {
+		return;
+	}
+
+	// the transfer was queued a frame ago and is usually done, GetData() returns S_FALSE while it is not
+	if (m_pQuery) {
+		for (unsigned i = 0; i < 1000; i++) {
+			if (m_pQuery->GetData(nullptr, 0, D3DGETDATA_FLUSH) != S_FALSE) {
+				break;
+			}
+			Sleep(i ? 1 : 0);
+		}
+	}
+	pSample.Attach(m_pBusySample.Detach());
+}
+
+void CDX9UploadBuffers::SetBuffers(const std::vector<BYTE*>& buffers, const LONG size)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_textures.clear();
+	m_buffers = buffers;
+	m_size = size;
+	m_bFailed = false;
+}
+
+void CDX9UploadBuffers::ReleaseBuffers()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// a kept sample is outstanding, so the allocator does not free the buffers before Flush() or the next Upload()
+	ASSERT(!m_pBusySample);
+	m_textures.clear();
+	m_buffers.clear();
+	m_size = 0;
+}
+
+HRESULT CDX9UploadBuffers::Upload(IDirect3DDevice9Ex* pDevice, IMediaSample* pSample, const UINT pitch, const UINT lineSize,
+	const UINT firstLine, const UINT numLines, IDirect3DSurface9* pDstSurface)
+{
+	CComPtr<IMediaSample> pDoneSample;
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// the previous transfer has had the time of a frame
+	TakeBusySample(pDoneSample);
+
+	BYTE* pBuffer = nullptr;
+	if (FAILED(pSample->GetPointer(&pBuffer))) {
+		return E_FAIL;
+	}
+	const auto it = std::find(m_buffers.cbegin(), m_buffers.cend(), pBuffer);
+	if (it == m_buffers.cend()) {
+		return E_FAIL;
+	}
+
+	D3DSURFACE_DESC desc;
+	HRESULT hr = pDstSurface->GetDesc(&desc);
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	// the lines of a user memory texture follow each other without a gap, so the pitch must be a whole number of texels
+	const UINT texelSize = lineSize / desc.Width;
+	if (!texelSize || texelSize * desc.Width != lineSize || pitch % texelSize) {
+		return E_FAIL;
+	}
+	const UINT width  = pitch / texelSize;
+	const UINT height = (UINT)m_size / pitch;
+	if (height < firstLine + numLines || height < desc.Height) {
+		return E_FAIL;
+	}
+
+	if (pDevice != m_pDevice || desc.Format != m_format || width != m_width || height != m_height) {
+		m_textures.clear();
+		if (pDevice != m_pDevice) {
+			m_pQuery.Release();
+		}
+		m_pDevice = pDevice;
+		m_format  = desc.Format;
+		m_width   = width;
+		m_height  = height;
+		m_bFailed = false;
+	}
+	if (m_bFailed) {
+		return E_FAIL;
+	}
+
+	m_textures.resize(m_buffers.size());
+	auto& pTexture = m_textures[it - m_buffers.cbegin()];
+	if (!pTexture) {
+		// with D3DPOOL_SYSTEMMEM the shared handle of Direct3D 9Ex is the memory of the texture
+		HANDLE hMemory = (HANDLE)pBuffer;
+		hr = pDevice->CreateTexture(width, height, 1, 0, desc.Format, D3DPOOL_SYSTEMMEM, &pTexture, &hMemory);
+		if (FAILED(hr)) {
+			DLog(L"CDX9UploadBuffers::Upload() : CreateTexture() failed with error {}", HR2Str(hr));
+			m_bFailed = true;
+			return hr;
+		}
+	}
+
+	CComPtr<IDirect3DSurface9> pSrcSurface;
+	hr = pTexture->GetSurfaceLevel(0, &pSrcSurface);
+	if (S_OK == hr) {
+		const RECT rect = { 0, (LONG)firstLine, (LONG)desc.Width, (LONG)(firstLine + numLines) };
+		const POINT point = { 0, (LONG)firstLine };
+		hr = pDevice->UpdateSurface(pSrcSurface, &rect, pDstSurface, &point);
+	}
+	if (S_OK == hr) {
+		// the decoder can write to the buffer after the end of the transfer. A lock of the source surface
+		// would wait for it now, the event query lets the CPU prepare the frame while the GPU reads the buffer.
+		if (!m_pQuery) {
+			pDevice->CreateQuery(D3DQUERYTYPE_EVENT, &m_pQuery);
+		}
+		if (m_pQuery && m_buffers.size() > 1 && S_OK == m_pQuery->Issue(D3DISSUE_END)) {
+			m_pBusySample = pSample;
+		} else {
+			// with a single buffer the decoder waits for this sample, so the transfer is waited for now
+			D3DLOCKED_RECT lr;
+			hr = pSrcSurface->LockRect(&lr, nullptr, D3DLOCK_READONLY);
+			if (S_OK == hr) {
+				hr = pSrcSurface->UnlockRect();
+			}
+		}
+		m_uploads++;
+	}
+	if (FAILED(hr)) {
+		DLog(L"CDX9UploadBuffers::Upload() : the transfer failed with error {}", HR2Str(hr));
+		m_bFailed = true;
+	}
+
+	return hr;
+}
+
+void CDX9UploadBuffers::Flush()
+{
+	CComPtr<IMediaSample> pDoneSample;
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	TakeBusySample(pDoneSample);
+}
+
+void CDX9UploadBuffers::ReleaseTextures()
+{
+	CComPtr<IMediaSample> pDoneSample;
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	TakeBusySample(pDoneSample);
+	m_textures.clear();
+	m_pQuery.Release();
+	m_pDevice.Release();
+}
@@ -20,6 +20,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
+#include "UploadBuffers.h"
+
 struct Tex_t
 {
 	CComPtr<IDirect3DTexture9> pTexture;
@@ -174,6 +178,49 @@ public:
 	}
 };
 
+// The sample buffers of the custom allocator become the memory of system memory textures
+// of Direct3D 9Ex, UpdateSurface() transfers them to a texture without a copy by the CPU.
+// The sample of the last transfer is kept until the transfer is done, usually until the next frame,
+// so that the CPU does not wait for the GPU and the decoder does not write to the buffer while it is read.
+class CDX9UploadBuffers : public CUploadBuffers
+{
+	std::mutex m_mutex;
+	std::vector<BYTE*> m_buffers;
+	LONG m_size = 0;
+
+	CComPtr<IDirect3DDevice9Ex> m_pDevice;
+	std::vector<CComPtr<IDirect3DTexture9>> m_textures; // for m_buffers, created on first use
+	D3DFORMAT m_format = D3DFMT_UNKNOWN;
+	UINT m_width  = 0;
+	UINT m_height = 0;
+	bool m_bFailed = false; // the textures cannot be created for the current buffers and layout
+
+	CComPtr<IDirect3DQuery9> m_pQuery;     // signals the end of the last transfer
+	CComPtr<IMediaSample> m_pBusySample;   // the sample of the last transfer
+
+	std::atomic<uint64_t> m_uploads = 0;
+
+	// Waits for the end of the last transfer and moves its sample to pSample. The caller releases it
+	// after m_mutex, the release of the last outstanding sample can free the buffers and call ReleaseBuffers().
+	void TakeBusySample(CComPtr<IMediaSample>& pSample);
+
+public:
+	LONG GetAlignment() override { return 4096; }
+	void SetBuffers(const std::vector<BYTE*>& buffers, const LONG size) override;
+	void ReleaseBuffers() override;
+
+	// Transfers numLines from firstLine of the frame in the buffer of pSample to pDstSurface. pSample is kept
+	// until the transfer is done, the next call or Flush() returns it. lineSize is the number of bytes of a line of pDstSurface.
+	// Returns E_FAIL if the buffer is not a sample buffer or its layout does not fit, then the frame must be copied.
+	HRESULT Upload(IDirect3DDevice9Ex* pDevice, IMediaSample* pSample, const UINT pitch, const UINT lineSize,
+		const UINT firstLine, const UINT numLines, IDirect3DSurface9* pDstSurface);
+	// returns the sample of the last transfer, the allocator can be decommitted
+	void Flush();
+	void ReleaseTextures();
+
+	uint64_t GetUploads() const { return m_uploads; }
+};
+
 struct ExternalPixelShader9_t
 {
 	std::wstring name;
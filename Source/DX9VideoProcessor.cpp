@@ -28,6 +28,7 @@
 #include "VideoRenderer.h"
 #include "../Include/Version.h"
 #include "DX9VideoProcessor.h"
+#include "ColorLut.h"
 #include "Utils/CPUInfo.h"
 
 #include "../external/minhook/include/MinHook.h"
@@ -289,6 +290,9 @@ CDX9VideoProcessor::CDX9VideoProcessor(CMpcVideoRenderer* pFilter, const Setting
 	m_iHdrToggleDisplay    = HDRTD_Disabled;
 	m_bConvertToSdr        = config.bConvertToSdr;
 	m_iSDRDisplayNits      = config.iSDRDisplayNits;
+	m_bCropBlackBars       = config.bCropBlackBars;
+	m_bZeroCopyUpload      = config.bZeroCopyUpload;
+	m_bTransferLut         = config.bTransferLut;
 
 	m_nCurrentAdapter = D3DADAPTER_DEFAULT;
 
@@ -596,7 +600,9 @@ HRESULT CDX9VideoProcessor::InitInternal(bool* pChangeDevice/* = nullptr*/)
 		m_pFilter->m_pSubCallBack->SetDevice(m_pD3DDevEx);
 	}
 
-	if (m_VendorId == PCIV_INTEL && CPUInfo::HaveSSE41()) {
+	if (m_VendorId == PCIV_INTEL && CPUInfo::HaveAVX2()) {
+		m_pCopyGpuFn = CopyGpuFrame_AVX2;
+	} else if (m_VendorId == PCIV_INTEL && CPUInfo::HaveSSE41()) {
 		m_pCopyGpuFn = CopyGpuFrame_SSE41;
 	} else {
 		m_pCopyGpuFn = CopyPlaneAsIs;
@@ -678,6 +684,10 @@ void CDX9VideoProcessor::ReleaseVP()
 
 	m_pFilter->ResetStreamingTimes2();
 	m_RenderStats.Reset();
+	m_RenderLatency.Reset();
+	m_DirtyRows.ResetCounters();
+	m_DirtyRows.Invalidate();
+	m_Letterbox.Reset();
 
 	m_DXVA2VP.ReleaseVideoProcessor();
 	m_strCorrection = nullptr;
@@ -686,10 +696,12 @@ void CDX9VideoProcessor::ReleaseVP()
 	m_TexConvertOutput.Release();
 	m_TexResize.Release();
 	m_TexsPostScale.Release();
+	m_ConvertShaderQueue.Cancel();
 
 	m_srcParams      = {};
 	m_srcDXVA2Format = D3DFMT_UNKNOWN;
-	m_pCopyPlaneFn   = CopyPlaneAsIs;
+	m_pUnpackFn      = nullptr;
+	ResetCopyPlaneKernel();
 	m_srcWidth       = 0;
 	m_srcHeight      = 0;
 }
@@ -699,8 +711,13 @@ void CDX9VideoProcessor::ReleaseDevice()
 	DLog(L"CDX9VideoProcessor::ReleaseDevice()");
 
 	ReleaseVP();
+	m_pUploadBuffers->ReleaseTextures();
 
 	m_TexDither.Release();
+	m_TexTrcLut.Release();
+	m_TrcLut = MP_CSP_TRC_AUTO;
+	m_TexDoviLut.Release();
+	m_DoviLutHash = 0;
 	m_bAlphaBitmapEnable = false;
 	m_TexAlphaBitmap.Release();
 
@@ -769,7 +786,8 @@ HRESULT CDX9VideoProcessor::InitializeDXVA2VP(const FmtConvParams_t& params, con
 	m_srcHeight      = height;
 	m_srcParams      = params;
 	m_srcDXVA2Format = dxva2format;
-	m_pCopyPlaneFn   = GetCopyPlaneFunction(params, VP_DXVA2);
+	SetCopyPlaneKernel(params, VP_DXVA2);
+	m_pUnpackFn      = GetUnpackPackedFunction(params.cformat, &m_strCopyKernel);
 
 	m_DXVA2VP.GetProcAmpRanges(m_DXVA2ProcAmpRanges);
 	m_DXVA2VP.SetProcAmpValues(m_DXVA2ProcAmpValues);
@@ -798,11 +816,16 @@ HRESULT CDX9VideoProcessor::InitializeTexVP(const FmtConvParams_t& params, const
 	m_srcHeight      = height;
 	m_srcParams      = params;
 	m_srcDXVA2Format = d3dformat;
-	m_pCopyPlaneFn   = GetCopyPlaneFunction(params, VP_D3D9_SHADER);
+	SetCopyPlaneKernel(params, VP_D3D9_SHADER);
+	m_pUnpackFn      = GetUnpackPackedFunction(params.cformat, &m_strCopyKernel);
+	m_DirtyRows.Invalidate();
 
 	// set default ProcAmp ranges
 	SetDefaultDXVA2ProcAmpRanges(m_DXVA2ProcAmpRanges);
 
+	// the current shaders read a texture of another size
+	m_pPSConvertColor.Release();
+	m_pPSConvertColorDeint.Release();
 	hr = UpdateConvertColorShader();
 
 	DLog(L"CDX9VideoProcessor::InitializeTexVP() completed successfully");
@@ -994,7 +1017,7 @@ void CDX9VideoProcessor::CalcStatsParams()
 		if (S_OK == m_Font3D.CreateFontBitmap(L"Consolas", m_StatsFontH, 0)) {
 			SIZE charSize = m_Font3D.GetMaxCharMetric();
 			m_StatsRect.right  = m_StatsRect.left + 61 * charSize.cx + 5 + 3;
-			m_StatsRect.bottom = m_StatsRect.top + 18 * charSize.cy + 5 + 3;
+			m_StatsRect.bottom = m_StatsRect.top + 20 * charSize.cy + 5 + 3;
 			m_StatsBackground.Set(m_StatsRect, D3DCOLOR_ARGB(80, 0, 0, 0));
 		}
 
@@ -1046,6 +1069,9 @@ BOOL CDX9VideoProcessor::GetAlignmentSize(const CMediaType& mt, SIZE& Size)
 		else if (FmtParams.cformat == CF_BGRA64 || FmtParams.cformat == CF_B64A) {
 			// nothing
 		}
+		else if (FmtParams.cformat == CF_Y210 || FmtParams.cformat == CF_Y216 || FmtParams.cformat == CF_V210) {
+			// nothing, the P210 and P216 surfaces do not have the pitch of the packed format
+		}
 		else {
 			CComPtr<IDirect3DSurface9> pSurface;
 			if (m_DXVA2VP.IsReady()) {
@@ -1144,6 +1170,9 @@ BOOL CDX9VideoProcessor::InitMediaType(const CMediaType* pmt)
 	case CF_BGR48:
 		m_srcPitch = ALIGN(m_srcPitch, 4);
 		break;
+	case CF_V210:
+		m_srcPitch = GetV210Pitch(biWidth);
+		break;
 	}
 	if (pBIH->biCompression == BI_RGB && pBIH->biHeight > 0) {
 		m_srcPitch = -m_srcPitch;
@@ -1247,6 +1276,8 @@ BOOL CDX9VideoProcessor::InitMediaType(const CMediaType* pmt)
 	}
 
 	if (SUCCEEDED(hr)) {
+		m_Letterbox.SetFormat(FmtParams, m_srcExFmt.NominalRange == DXVA2_NominalRange_0_255);
+
 		UpdateTexures();
 		UpdatePostScaleTexures();
 		UpdateStatsStatic();
@@ -1336,6 +1367,8 @@ HRESULT CDX9VideoProcessor::CopySample(IMediaSample* pSample)
 	HRESULT hr = S_OK;
 	m_FieldDrawn = 0;
 	bool updateStats = false;
+	// the sample has Dolby Vision metadata, m_Dovi keeps the metadata of the last one
+	bool bDoviSample = false;
 
 	if (CComQIPtr<IMediaSideData> pMediaSideData = pSample) {
 		size_t size = 0;
@@ -1348,28 +1381,24 @@ HRESULT CDX9VideoProcessor::CopySample(IMediaSample* pSample)
 		if (m_srcParams.CSType == CS_YUV && (m_bHdrPreferDoVi || !SourceIsPQorHLG())) {
 			MediaSideDataDOVIMetadata* pDOVIMetadata = nullptr;
 			hr = pMediaSideData->GetSideData(IID_MediaSideDataDOVIMetadata, (const BYTE**)&pDOVIMetadata, &size);
-			if (SUCCEEDED(hr) && size == sizeof(MediaSideDataDOVIMetadata) && CheckDoviMetadata(pDOVIMetadata, 0)) {
-
-				const bool bYCCtoRGBChanged = !m_PSConvColorData.bEnable ||
-					(memcmp(
-						&m_Dovi.msd.ColorMetadata.ycc_to_rgb_matrix,
-						&pDOVIMetadata->ColorMetadata.ycc_to_rgb_matrix,
-						sizeof(MediaSideDataDOVIMetadata::ColorMetadata.ycc_to_rgb_matrix) + sizeof(MediaSideDataDOVIMetadata::ColorMetadata.ycc_to_rgb_offset)
-					) != 0);
-				const bool bRGBtoLMSChanged =
-					(memcmp(
-						&m_Dovi.msd.ColorMetadata.rgb_to_lms_matrix,
-						&pDOVIMetadata->ColorMetadata.rgb_to_lms_matrix,
-						sizeof(MediaSideDataDOVIMetadata::ColorMetadata.rgb_to_lms_matrix)
-					) != 0);
-				const bool bMappingCurvesChanged =
-					(memcmp(
-						&m_Dovi.msd.Mapping.curves,
-						&pDOVIMetadata->Mapping.curves,
-						sizeof(MediaSideDataDOVIMetadata::Mapping.curves)
-					) != 0);
+			const bool bDoviData = SUCCEEDED(hr) && size == sizeof(MediaSideDataDOVIMetadata);
+			DoviFingerprint_t fp;
+			if (bDoviData) {
+				GetDoviFingerprint(*pDOVIMetadata, fp);
+			}
+
+			// most frames repeat the metadata of the previous one, which has been checked and applied
+			if (bDoviData && m_Dovi.IsApplied(fp) && m_PSConvColorData.bEnable) {
+				bDoviSample = true;
+			} else if (bDoviData && CheckDoviMetadata(pDOVIMetadata, 0)) {
+				bDoviSample = true;
+
+				const bool bYCCtoRGBChanged = !m_PSConvColorData.bEnable || fp.yccToRgb != m_Dovi.fp.yccToRgb;
+				const bool bRGBtoLMSChanged = fp.rgbToLms != m_Dovi.fp.rgbToLms;
+				const bool bMappingCurvesChanged = fp.reshape != m_Dovi.fp.reshape;
 
 				memcpy(&m_Dovi.msd, pDOVIMetadata, sizeof(MediaSideDataDOVIMetadata));
+				m_Dovi.fp = fp;
 				const bool updateStats = !m_Dovi.bValid;
 				m_Dovi.bValid = true;
 
@@ -1389,12 +1418,22 @@ HRESULT CDX9VideoProcessor::CopySample(IMediaSample* pSample)
 					UpdateConvertColorShader();
 				}
 				if (bMappingCurvesChanged) {
-					hr = SetShaderDoviCurvesPoly();
+					if (m_TexDoviLut.pTexture) {
+						UpdateDoviLut();
+					} else {
+						hr = SetShaderDoviCurvesPoly();
+					}
 				}
 			}
 		}
 	}
 
+	if (!bDoviSample && m_Dovi.End()) {
+		// the next frames are converted without the reshaping and can use the DXVA2 video processor again
+		DLog(L"CDX9VideoProcessor::CopySample() : DoVi metadata has ended");
+		InitMediaType(&m_pFilter->m_inputMT);
+	}
+
 	if (CComQIPtr<IMFGetService> pService = pSample) {
 		if (m_iSrcFromGPU != 9) {
 			m_iSrcFromGPU = 9;
@@ -1457,6 +1496,8 @@ HRESULT CDX9VideoProcessor::CopySample(IMediaSample* pSample)
 		if (m_iSrcFromGPU != 0) {
 			m_iSrcFromGPU = 0;
 			updateStats = true;
+			m_DirtyRows.Invalidate(); // the texture was written by the GPU
+			m_Letterbox.Reset();
 		}
 
 		BYTE* data = nullptr;
@@ -1467,6 +1508,11 @@ HRESULT CDX9VideoProcessor::CopySample(IMediaSample* pSample)
 			}
 
 			D3DLOCKED_RECT lr;
+			const BYTE* src = (m_srcPitch < 0) ? data + m_srcPitch * (1 - (int)m_srcLines) : data;
+
+			if (CanCropBars()) {
+				m_Letterbox.Detect(src, m_srcPitch, m_srcWidth, m_srcHeight);
+			}
 
 			if (m_DXVA2VP.IsReady()) {
 				const REFERENCE_TIME start_100ns = m_pFilter->m_FrameStats.GetFrames() * 170000i64;
@@ -1476,15 +1522,64 @@ HRESULT CDX9VideoProcessor::CopySample(IMediaSample* pSample)
 
 				hr = pDXVA2VPSurface->LockRect(&lr, nullptr, D3DLOCK_DISCARD|D3DLOCK_NOSYSLOCK);
 				if (S_OK == hr) {
-					const BYTE* src = (m_srcPitch < 0) ? data + m_srcPitch * (1 - (int)m_srcLines) : data;
-					m_pCopyPlaneFn(m_srcLines, (BYTE*)lr.pBits, lr.Pitch, src, m_srcPitch);
+					if (m_pUnpackFn) {
+						// the chroma plane of the P210 or P216 surface follows the luma plane
+						BYTE* dstY = (BYTE*)lr.pBits;
+						m_pUnpackFn(m_srcHeight, dstY, lr.Pitch, dstY + (size_t)lr.Pitch * m_srcHeight, lr.Pitch, src, m_srcPitch);
+					} else {
+						GetCopyPlaneFn(src, m_srcPitch)(m_srcLines, (BYTE*)lr.pBits, lr.Pitch, src, m_srcPitch);
+					}
 					hr = pDXVA2VPSurface->UnlockRect();
 				}
 			} else {
-				if (m_TexSrcVideo.Plane2.pSurface) {
+				// the lines of the cropped bars of a single-plane texture are not copied, except for
+				// a few lines around the active area that the scalers read. The change of the copied
+				// lines changes their number, so m_DirtyRows compares the next frame completely.
+				UINT firstLine = 0;
+				UINT numLines = m_srcLines;
+				if (CanCropBars() && m_Letterbox.IsCropped() && !m_TexSrcVideo.Plane2.pSurface && m_srcLines == m_srcHeight) {
+					const auto& bars = m_Letterbox.GetBars();
+					firstLine = (bars.top > CLetterboxDetector::MARGIN) ? bars.top - CLetterboxDetector::MARGIN : 0;
+					numLines -= firstLine + ((bars.bottom > CLetterboxDetector::MARGIN) ? bars.bottom - CLetterboxDetector::MARGIN : 0);
+				}
+				const BYTE* srcLines = src + (ptrdiff_t)m_srcPitch * firstLine;
+
+				// a sample buffer of the custom allocator that needs no conversion is transferred by the GPU
+				bool bZeroCopy = false;
+				const bool bCopyAsIs = m_pCopyPlaneFn == CopyPlaneAsIs || m_pCopyPlaneFn == CopyPlaneAsIs_Stream;
+				if (m_bZeroCopyUpload && bCopyAsIs && !m_TexSrcVideo.Plane2.pSurface && m_srcPitch > 0) {
+					bZeroCopy = S_OK == m_pUploadBuffers->Upload(m_pD3DDevEx, pSample, m_srcPitch, m_srcWidth * m_srcParams.Packsize,
+						firstLine, numLines, m_TexSrcVideo.pSurface);
+				}
+
+				// the texture keeps its content between frames, the unchanged lines are not copied again.
+				// A lock without D3DLOCK_DISCARD of a part of a single-plane texture keeps the rest of it.
+				const double maxPartial = m_TexSrcVideo.Plane2.pSurface ? 0.0 : 0.5;
+				const auto dirty = bZeroCopy ? CDirtyRows::DIRTY_ALL : m_DirtyRows.Compare(srcLines, m_srcPitch, abs(m_srcPitch), numLines, maxPartial, nullptr);
+
+				if (bZeroCopy) {
+					m_DirtyRows.Invalidate(); // the texture was written by the GPU
+					hr = S_OK;
+				}
+				else if (dirty == CDirtyRows::DIRTY_NONE) {
+					hr = S_OK;
+				}
+				else if (m_pUnpackFn) {
+					D3DLOCKED_RECT lrUV;
 					hr = m_TexSrcVideo.pSurface->LockRect(&lr, nullptr, D3DLOCK_DISCARD|D3DLOCK_NOSYSLOCK);
 					if (S_OK == hr) {
-						m_pCopyPlaneFn(m_srcHeight, (BYTE*)lr.pBits, lr.Pitch, data, m_srcPitch);
+						hr = m_TexSrcVideo.Plane2.pSurface->LockRect(&lrUV, nullptr, D3DLOCK_DISCARD|D3DLOCK_NOSYSLOCK);
+						if (S_OK == hr) {
+							m_pUnpackFn(m_srcHeight, (BYTE*)lr.pBits, lr.Pitch, (BYTE*)lrUV.pBits, lrUV.Pitch, src, m_srcPitch);
+							hr = m_TexSrcVideo.Plane2.pSurface->UnlockRect();
+						}
+						m_TexSrcVideo.pSurface->UnlockRect();
+					}
+				}
+				else if (m_TexSrcVideo.Plane2.pSurface) {
+					hr = m_TexSrcVideo.pSurface->LockRect(&lr, nullptr, D3DLOCK_DISCARD|D3DLOCK_NOSYSLOCK);
+					if (S_OK == hr) {
+						GetCopyPlaneFn(data, m_srcPitch)(m_srcHeight, (BYTE*)lr.pBits, lr.Pitch, data, m_srcPitch);
 						hr = m_TexSrcVideo.pSurface->UnlockRect();
 
 						hr = m_TexSrcVideo.Plane2.pSurface->LockRect(&lr, nullptr, D3DLOCK_DISCARD|D3DLOCK_NOSYSLOCK);
@@ -1492,28 +1587,53 @@ HRESULT CDX9VideoProcessor::CopySample(IMediaSample* pSample)
 							const UINT cromaH = m_srcHeight / m_srcParams.pDX9Planes->div_chroma_h;
 							const UINT cromaPitch = (m_TexSrcVideo.Plane3.pSurface) ? m_srcPitch / m_srcParams.pDX9Planes->div_chroma_w : m_srcPitch;
 							data += m_srcPitch * m_srcHeight;
-							m_pCopyPlaneFn(cromaH, (BYTE*)lr.pBits, lr.Pitch, data, cromaPitch);
+							GetCopyPlaneFn(data, cromaPitch)(cromaH, (BYTE*)lr.pBits, lr.Pitch, data, cromaPitch);
 							hr = m_TexSrcVideo.Plane2.pSurface->UnlockRect();
 
 							if (m_TexSrcVideo.Plane3.pSurface) {
 								hr = m_TexSrcVideo.Plane3.pSurface->LockRect(&lr, nullptr, D3DLOCK_DISCARD | D3DLOCK_NOSYSLOCK);
 								if (S_OK == hr) {
 									data += cromaPitch * cromaH;
-									m_pCopyPlaneFn(cromaH, (BYTE*)lr.pBits, lr.Pitch, data, cromaPitch);
+									GetCopyPlaneFn(data, cromaPitch)(cromaH, (BYTE*)lr.pBits, lr.Pitch, data, cromaPitch);
 									hr = m_TexSrcVideo.Plane3.pSurface->UnlockRect();
 								}
 							}
 						}
 					}
 				}
+				else if (dirty == CDirtyRows::DIRTY_RANGES) {
+					for (const auto& range : m_DirtyRows.GetRanges()) {
+						const UINT first = firstLine + range.first;
+						RECT rect = { 0, (LONG)first, (LONG)m_TexSrcVideo.Width, (LONG)(first + range.count) };
+						hr = m_TexSrcVideo.pSurface->LockRect(&lr, &rect, D3DLOCK_NOSYSLOCK);
+						if (S_OK == hr) {
+							GetCopyPlaneFn(src, m_srcPitch)(range.count, (BYTE*)lr.pBits, lr.Pitch, src + (ptrdiff_t)m_srcPitch * first, m_srcPitch);
+							hr = m_TexSrcVideo.pSurface->UnlockRect();
+						}
+						if (FAILED(hr)) {
+							break;
+						}
+					}
+				}
+				else if (numLines < m_srcLines) {
+					RECT rect = { 0, (LONG)firstLine, (LONG)m_TexSrcVideo.Width, (LONG)(firstLine + numLines) };
+					hr = m_TexSrcVideo.pSurface->LockRect(&lr, &rect, D3DLOCK_NOSYSLOCK);
+					if (S_OK == hr) {
+						GetCopyPlaneFn(srcLines, m_srcPitch)(numLines, (BYTE*)lr.pBits, lr.Pitch, srcLines, m_srcPitch);
+						hr = m_TexSrcVideo.pSurface->UnlockRect();
+					}
+				}
 				else {
 					hr = m_TexSrcVideo.pSurface->LockRect(&lr, nullptr, D3DLOCK_DISCARD|D3DLOCK_NOSYSLOCK);
 					if (S_OK == hr) {
-						const BYTE* src = (m_srcPitch < 0) ? data + m_srcPitch * (1 - (int)m_srcLines) : data;
-						m_pCopyPlaneFn(m_srcLines, (BYTE*)lr.pBits, lr.Pitch, src, m_srcPitch);
+						GetCopyPlaneFn(src, m_srcPitch)(m_srcLines, (BYTE*)lr.pBits, lr.Pitch, src, m_srcPitch);
 						hr = m_TexSrcVideo.pSurface->UnlockRect();
 					}
 				}
+
+				if (FAILED(hr)) {
+					m_DirtyRows.Invalidate();
+				}
 			}
 		}
 	}
@@ -1523,6 +1643,7 @@ HRESULT CDX9VideoProcessor::CopySample(IMediaSample* pSample)
 	}
 
 	m_RenderStats.copyticks = GetPreciseTick() - tick;
+	m_RenderLatency.copy.Add(m_RenderStats.copyticks);
 
 	return hr;
 }
@@ -1549,11 +1670,16 @@ HRESULT CDX9VideoProcessor::Render(int field, const REFERENCE_TIME frameStartTim
 	m_pD3DDevEx->ColorFill(pBackBuffer, nullptr, 0);
 
 	if (!m_renderRect.IsRectEmpty()) {
-		hr = Process(pBackBuffer, m_srcRect, m_videoRect, m_FieldDrawn == 2);
+		CRect srcRect, dstRect;
+		GetCroppedRects(srcRect, dstRect);
+		hr = Process(pBackBuffer, srcRect, dstRect, m_FieldDrawn == 2);
 	}
 
 	if (!m_pPSHalfOUtoInterlace) {
+		const uint64_t tickSubs = GetPreciseTick();
 		DrawSubtitles(pBackBuffer);
+		m_RenderStats.substicks = GetPreciseTick() - tickSubs;
+		m_RenderLatency.subs.Add(m_RenderStats.substicks);
 	}
 
 	const SIZE windowSize = m_windowRect.Size();
@@ -1597,6 +1723,7 @@ HRESULT CDX9VideoProcessor::Render(int field, const REFERENCE_TIME frameStartTim
 
 	uint64_t tick2 = GetPreciseTick();
 	m_RenderStats.paintticks = tick2 - tick1;
+	m_RenderLatency.paint.Add(m_RenderStats.paintticks);
 
 	if (m_bVBlankBeforePresent) {
 		hr = m_pD3DDevEx->WaitForVBlank(0);
@@ -1615,6 +1742,7 @@ HRESULT CDX9VideoProcessor::Render(int field, const REFERENCE_TIME frameStartTim
 		hr = m_pD3DDevEx->PresentEx(nullptr, nullptr, nullptr, nullptr, 0);
 	}
 	m_RenderStats.presentticks = GetPreciseTick() - tick2;
+	m_RenderLatency.present.Add(m_RenderStats.presentticks);
 
 #ifdef _DEBUG
 	if (FAILED(hr) || hr == S_PRESENT_OCCLUDED || hr == S_PRESENT_MODE_CHANGED) {
@@ -1669,6 +1797,30 @@ HRESULT CDX9VideoProcessor::FillBlack()
 	return hr;
 }
 
+bool CDX9VideoProcessor::GetCroppedRects(CRect& srcRect, CRect& dstRect) const
+{
+	srcRect = m_srcRect;
+	dstRect = m_videoRect;
+
+	if (!CanCropBars() || m_iSrcFromGPU != 0 || !m_Letterbox.IsCropped()) {
+		return false;
+	}
+
+	CRect rect;
+	if (!rect.IntersectRect(m_srcRect, CRect(m_Letterbox.GetActiveRect())) || rect == m_srcRect) {
+		return false;
+	}
+
+	// the rest of the video rectangle stays black
+	dstRect.left   = m_videoRect.left + MulDiv(rect.left   - m_srcRect.left, m_videoRect.Width(),  m_srcRect.Width());
+	dstRect.top    = m_videoRect.top  + MulDiv(rect.top    - m_srcRect.top,  m_videoRect.Height(), m_srcRect.Height());
+	dstRect.right  = m_videoRect.left + MulDiv(rect.right  - m_srcRect.left, m_videoRect.Width(),  m_srcRect.Width());
+	dstRect.bottom = m_videoRect.top  + MulDiv(rect.bottom - m_srcRect.top,  m_videoRect.Height(), m_srcRect.Height());
+	srcRect = rect;
+
+	return true;
+}
+
 void CDX9VideoProcessor::SetVideoRect(const CRect& videoRect)
 {
 	m_videoRect = videoRect;
@@ -1884,6 +2036,17 @@ HRESULT CDX9VideoProcessor::GetVPInfo(std::wstring& str)
 		}
 	}
 
+	AppendLatencyInfo(str);
+	AppendUploadInfo(str);
+
+	CRect srcRect, dstRect;
+	if (GetCroppedRects(srcRect, dstRect)) {
+		str += std::format(L"\nBlack bars: cropped to {}x{}", srcRect.Width(), srcRect.Height());
+	}
+	if (const auto uploads = m_pUploadBuffers->GetUploads()) {
+		str += std::format(L"\nZero-copy : {} frames transferred from the sample buffers", uploads);
+	}
+
 #ifdef _DEBUG
 	str.append(L"\n\nDEBUG info:");
 	str += std::format(L"\nSource tex size: {}x{}", m_srcWidth, m_srcHeight);
@@ -1915,6 +2078,12 @@ void CDX9VideoProcessor::Configure(const Settings_t& config)
 	m_bAdjustPresentTime   = config.bAdjustPresentTime;
 	m_bDeintBlend          = config.bDeintBlend;
 	m_iSDRDisplayNits      = config.iSDRDisplayNits;
+	m_bZeroCopyUpload      = config.bZeroCopyUpload; // the allocator uses it from the next allocation
+
+	if (config.bCropBlackBars != m_bCropBlackBars) {
+		m_bCropBlackBars = config.bCropBlackBars;
+		m_Letterbox.Reset();
+	}
 
 	// checking what needs to be changed
 
@@ -1953,6 +2122,11 @@ void CDX9VideoProcessor::Configure(const Settings_t& config)
 		changeConvertShader = m_PSConvColorData.bEnable && (m_srcParams.Subsampling == 420 || m_srcParams.Subsampling == 422);
 	}
 
+	if (config.bTransferLut != m_bTransferLut) {
+		m_bTransferLut = config.bTransferLut;
+		changeConvertShader = m_PSConvColorData.bEnable;
+	}
+
 	if (config.iUpscaling != m_iUpscaling) {
 		m_iUpscaling = config.iUpscaling;
 		changeUpscalingShader = true;
@@ -2072,6 +2246,7 @@ void CDX9VideoProcessor::Flush()
 			m_DXVA2VP.CleanSamplesData();
 		}
 	}
+	m_pUploadBuffers->Flush();
 
 	m_rtStart = 0;
 }
@@ -2228,131 +2403,276 @@ void CDX9VideoProcessor::UpdateDownscalingShaders()
 
 HRESULT CDX9VideoProcessor::UpdateConvertColorShader()
 {
-	m_pPSConvertColor.Release();
-	m_pPSConvertColorDeint.Release();
-	HRESULT hr = S_OK;
+	if (!m_TexSrcVideo.pTexture) {
+		m_ConvertShaderQueue.Cancel();
+		m_pPSConvertColor.Release();
+		m_pPSConvertColorDeint.Release();
 
-	if (m_TexSrcVideo.pTexture) {
-		int convertType = m_bConvertToSdr ? SHADER_CONVERT_TO_SDR : SHADER_CONVERT_NONE;
+		return S_OK;
+	}
 
-		MediaSideDataDOVIMetadata* pDOVIMetadata = m_Dovi.bValid ? &m_Dovi.msd : nullptr;
+	const float dx = 1.0f / m_TexSrcVideo.Width;
+	const float dy = 1.0f / m_TexSrcVideo.Height;
+	float sx = 0.0f;
+	float sy = 0.0f;
 
-		ID3DBlob* pShaderCode = nullptr;
-		hr = GetShaderConvertColor(false,
+	if (m_srcParams.cformat != CF_YUY2 && m_iChromaScaling == CHROMA_Bilinear) {
+		if (m_srcParams.Subsampling == 420) {
+			switch (m_srcExFmt.VideoChromaSubsampling) {
+			case DXVA2_VideoChromaSubsampling_Cosited:
+				sx = 0.5f * dx;
+				sy = 0.5f * dy;
+				break;
+			case DXVA2_VideoChromaSubsampling_MPEG1:
+				//nothing;
+				break;
+			case DXVA2_VideoChromaSubsampling_MPEG2:
+			default:
+				sx = 0.5f * dx;
+			}
+		}
+		else if (m_srcParams.Subsampling == 422) {
+			sx = 0.5f * dx;
+		}
+	}
+
+	FloatRect fr = {
+		-0.5f,
+		-0.5f,
+		(float)m_srcRectWidth  - 0.5f,
+		(float)m_srcRectHeight - 0.5f
+	};
+
+	m_PSConvColorData.VertexData[0].Pos = { fr.left , fr.top   , 0.5f, 2.0f };
+	m_PSConvColorData.VertexData[1].Pos = { fr.right, fr.top   , 0.5f, 2.0f };
+	m_PSConvColorData.VertexData[2].Pos = { fr.left , fr.bottom, 0.5f, 2.0f };
+	m_PSConvColorData.VertexData[3].Pos = { fr.right, fr.bottom, 0.5f, 2.0f };
+
+	fr = {
+		(float)m_srcRect.left   * dx,
+		(float)m_srcRect.top    * dy,
+		(float)m_srcRect.right  * dx,
+		(float)m_srcRect.bottom * dy
+	};
+
+	if (m_srcParams.cformat == CF_YUY2) {
+		fr.left  /= 2;
+		fr.right /= 2;
+	}
+
+	m_PSConvColorData.VertexData[0].Tex[0] = { fr.left , fr.top };
+	m_PSConvColorData.VertexData[1].Tex[0] = { fr.right, fr.top };
+	m_PSConvColorData.VertexData[2].Tex[0] = { fr.left , fr.bottom };
+	m_PSConvColorData.VertexData[3].Tex[0] = { fr.right, fr.bottom };
+
+	fr.left   += sx;
+	fr.top    += sy;
+	fr.right  += sx;
+	fr.bottom += sy;
+
+	m_PSConvColorData.VertexData[0].Tex[1] = { fr.left , fr.top };
+	m_PSConvColorData.VertexData[1].Tex[1] = { fr.right, fr.top };
+	m_PSConvColorData.VertexData[2].Tex[1] = { fr.left , fr.bottom };
+	m_PSConvColorData.VertexData[3].Tex[1] = { fr.right, fr.bottom };
+
+	int convertType = m_bConvertToSdr ? SHADER_CONVERT_TO_SDR : SHADER_CONVERT_NONE;
+
+	MediaSideDataDOVIMetadata* pDOVIMetadata = m_Dovi.bValid ? &m_Dovi.msd : nullptr;
+
+	const bool bTrcLut = UpdateTrcLut(GetShaderConvertColorTrc(m_srcExFmt, pDOVIMetadata, convertType));
+	const bool bDoviLut = UpdateDoviLut();
+
+	// the second shader blends the fields of interlaced frames
+	const bool bDeint = m_bInterlaced && m_srcParams.Subsampling == 420 && m_srcParams.pDX9Planes;
+
+	std::vector<CShaderCompileQueue::Source_t> sources(bDeint ? 2 : 1);
+	for (size_t i = 0; i < sources.size(); i++) {
+		sources[i].target = GetShaderConvertColorTarget(false);
+		GetShaderConvertColorCode(false,
 			m_srcWidth,
 			m_TexSrcVideo.Width, m_TexSrcVideo.Height,
 			m_srcRect, m_srcParams, m_srcExFmt, pDOVIMetadata,
-			m_iChromaScaling, convertType, false,
-			&pShaderCode);
-		if (S_OK == hr) {
-			hr = m_pD3DDevEx->CreatePixelShader((const DWORD*)pShaderCode->GetBufferPointer(), &m_pPSConvertColor);
-			pShaderCode->Release();
-		}
-
-		if (m_bInterlaced && m_srcParams.Subsampling == 420 && m_srcParams.pDX9Planes) {
-			hr = GetShaderConvertColor(false,
-				m_srcWidth,
-				m_TexSrcVideo.Width, m_TexSrcVideo.Height,
-				m_srcRect, m_srcParams, m_srcExFmt, pDOVIMetadata,
-				m_iChromaScaling, convertType, true,
-				&pShaderCode);
-			if (S_OK == hr) {
-				hr = m_pD3DDevEx->CreatePixelShader((const DWORD*)pShaderCode->GetBufferPointer(), &m_pPSConvertColorDeint);
-				pShaderCode->Release();
+			m_iChromaScaling, convertType, i == 1, bTrcLut, bDoviLut,
+			sources[i].code);
+	}
+
+	// the shaders that are in the shader cache are created at once, the others are compiled
+	// in the background and the current shaders are used until CheckConvertColorShaders() gets them
+	CShaderCompileQueue::Result_t result;
+	result.hrs.resize(sources.size(), S_OK);
+	result.blobs.resize(sources.size());
+
+	for (size_t i = 0; i < sources.size(); i++) {
+		if (!LoadCachedShader(sources[i].code, nullptr, sources[i].target, result.blobs[i])) {
+			DLog(L"CDX9VideoProcessor::UpdateConvertColorShader() : the shaders are compiled in the background");
+			m_ConvertShaderQueue.Submit(std::move(sources));
+			if (!m_pPSConvertColor) {
+				SetConvertColorFallbackShader();
 			}
+			return S_FALSE;
 		}
+	}
 
-		const float dx = 1.0f / m_TexSrcVideo.Width;
-		const float dy = 1.0f / m_TexSrcVideo.Height;
-		float sx = 0.0f;
-		float sy = 0.0f;
+	m_ConvertShaderQueue.Cancel();
 
-		if (m_srcParams.cformat != CF_YUY2 && m_iChromaScaling == CHROMA_Bilinear) {
-			if (m_srcParams.Subsampling == 420) {
-				switch (m_srcExFmt.VideoChromaSubsampling) {
-				case DXVA2_VideoChromaSubsampling_Cosited:
-					sx = 0.5f * dx;
-					sy = 0.5f * dy;
-					break;
-				case DXVA2_VideoChromaSubsampling_MPEG1:
-					//nothing;
-					break;
-				case DXVA2_VideoChromaSubsampling_MPEG2:
-				default:
-					sx = 0.5f * dx;
-				}
-			}
-			else if (m_srcParams.Subsampling == 422) {
-				sx = 0.5f * dx;
-			}
+	return SetConvertColorShaders(result);
+}
+
+HRESULT CDX9VideoProcessor::SetConvertColorShaders(const CShaderCompileQueue::Result_t& result)
+{
+	m_pPSConvertColor.Release();
+	m_pPSConvertColorDeint.Release();
+
+	HRESULT hr = result.hrs[0];
+	if (S_OK == hr) {
+		hr = m_pD3DDevEx->CreatePixelShader((const DWORD*)result.blobs[0].data(), &m_pPSConvertColor);
+	}
+
+	if (S_OK == hr && result.hrs.size() > 1) {
+		hr = result.hrs[1];
+		if (S_OK == hr) {
+			hr = m_pD3DDevEx->CreatePixelShader((const DWORD*)result.blobs[1].data(), &m_pPSConvertColorDeint);
 		}
+	}
 
-		FloatRect fr = {
-			-0.5f,
-			-0.5f,
-			(float)m_srcRectWidth  - 0.5f,
-			(float)m_srcRectHeight - 0.5f
-		};
+	if (FAILED(hr)) {
+		ASSERT(0);
+		SetConvertColorFallbackShader();
 
-		m_PSConvColorData.VertexData[0].Pos = { fr.left , fr.top   , 0.5f, 2.0f };
-		m_PSConvColorData.VertexData[1].Pos = { fr.right, fr.top   , 0.5f, 2.0f };
-		m_PSConvColorData.VertexData[2].Pos = { fr.left , fr.bottom, 0.5f, 2.0f };
-		m_PSConvColorData.VertexData[3].Pos = { fr.right, fr.bottom, 0.5f, 2.0f };
+		return S_FALSE;
+	}
 
-		fr = {
-			(float)m_srcRect.left   * dx,
-			(float)m_srcRect.top    * dy,
-			(float)m_srcRect.right  * dx,
-			(float)m_srcRect.bottom * dy
-		};
+	return hr;
+}
 
-		if (m_srcParams.cformat == CF_YUY2) {
-			fr.left  /= 2;
-			fr.right /= 2;
+void CDX9VideoProcessor::SetConvertColorFallbackShader()
+{
+	m_pPSConvertColor.Release();
+	m_pPSConvertColorDeint.Release();
+
+	UINT resid = 0;
+	if (m_srcParams.cformat == CF_YUY2) {
+		resid = IDF_PS_9_CONVERT_YUY2;
+	}
+	else if (m_srcParams.pDX9Planes) {
+		if (m_srcParams.pDX9Planes->FmtPlane3) {
+			if (m_srcParams.cformat == CF_YV12 || m_srcParams.cformat == CF_YV16 || m_srcParams.cformat == CF_YV24) {
+				resid = IDF_PS_9_CONVERT_PLANAR_YV;
+			} else {
+				resid = IDF_PS_9_CONVERT_PLANAR;
+			}
+		} else {
+			resid = IDF_PS_9_CONVERT_BIPLANAR;
 		}
+	}
+	else {
+		resid = IDF_PS_9_CONVERT_COLOR;
+	}
+	EXECUTE_ASSERT(S_OK == CreatePShaderFromResource(&m_pPSConvertColor, resid));
+}
 
-		m_PSConvColorData.VertexData[0].Tex[0] = { fr.left , fr.top };
-		m_PSConvColorData.VertexData[1].Tex[0] = { fr.right, fr.top };
-		m_PSConvColorData.VertexData[2].Tex[0] = { fr.left , fr.bottom };
-		m_PSConvColorData.VertexData[3].Tex[0] = { fr.right, fr.bottom };
+bool CDX9VideoProcessor::UpdateTrcLut(mp_csp_trc trc)
+{
+	if (!m_bTransferLut) {
+		trc = MP_CSP_TRC_AUTO;
+	}
+	if (trc == m_TrcLut) {
+		return trc != MP_CSP_TRC_AUTO;
+	}
 
-		fr.left   += sx;
-		fr.top    += sy;
-		fr.right  += sx;
-		fr.bottom += sy;
+	// the current shaders sample the previous table
+	m_pPSConvertColor.Release();
+	m_pPSConvertColorDeint.Release();
+	m_TexTrcLut.Release();
+	m_TrcLut = MP_CSP_TRC_AUTO;
 
-		m_PSConvColorData.VertexData[0].Tex[1] = { fr.left , fr.top };
-		m_PSConvColorData.VertexData[1].Tex[1] = { fr.right, fr.top };
-		m_PSConvColorData.VertexData[2].Tex[1] = { fr.left , fr.bottom };
-		m_PSConvColorData.VertexData[3].Tex[1] = { fr.right, fr.bottom };
+	if (trc == MP_CSP_TRC_AUTO) {
+		return false;
 	}
 
+	std::vector<float> lut;
+	HRESULT hr = BakeTrcLut1D(trc, TRC_LUT1D_SIZE, lut);
+	if (S_OK == hr) {
+		hr = m_TexTrcLut.Create(m_pD3DDevEx, D3DFMT_R32F, TRC_LUT1D_SIZE, 1, D3DUSAGE_DYNAMIC);
+	}
+	if (S_OK == hr) {
+		D3DLOCKED_RECT lockedRect;
+		hr = m_TexTrcLut.pTexture->LockRect(0, &lockedRect, nullptr, D3DLOCK_DISCARD);
+		if (S_OK == hr) {
+			memcpy(lockedRect.pBits, lut.data(), lut.size() * sizeof(float));
+			hr = m_TexTrcLut.pTexture->UnlockRect(0);
+		}
+	}
 	if (FAILED(hr)) {
-		ASSERT(0);
-		UINT resid = 0;
-		if (m_srcParams.cformat == CF_YUY2) {
-			resid = IDF_PS_9_CONVERT_YUY2;
-		}
-		else if (m_srcParams.pDX9Planes) {
-			if (m_srcParams.pDX9Planes->FmtPlane3) {
-				if (m_srcParams.cformat == CF_YV12 || m_srcParams.cformat == CF_YV16 || m_srcParams.cformat == CF_YV24) {
-					resid = IDF_PS_9_CONVERT_PLANAR_YV;
-				} else {
-					resid = IDF_PS_9_CONVERT_PLANAR;
-				}
-			} else {
-				resid = IDF_PS_9_CONVERT_BIPLANAR;
+		DLog(L"CDX9VideoProcessor::UpdateTrcLut() : the table for trc {} failed with error {}", (int)trc, HR2Str(hr));
+		m_TexTrcLut.Release();
+		return false;
+	}
+
+	m_TrcLut = trc;
+
+	return true;
+}
+
+bool CDX9VideoProcessor::UpdateDoviLut()
+{
+	if (!m_bTransferLut || !m_Dovi.bValid) {
+		if (m_TexDoviLut.pTexture) {
+			// the current shaders sample the tables, the others read the curves from the constants
+			m_pPSConvertColor.Release();
+			m_pPSConvertColorDeint.Release();
+			m_TexDoviLut.Release();
+			m_DoviLutHash = 0;
+			if (m_Dovi.bValid) {
+				SetShaderDoviCurvesPoly();
 			}
 		}
-		else {
-			resid = IDF_PS_9_CONVERT_COLOR;
-		}
-		EXECUTE_ASSERT(S_OK == CreatePShaderFromResource(&m_pPSConvertColor, resid));
+		return false;
+	}
 
-		return S_FALSE;
+	const uint64_t hash = m_Dovi.fp.reshape;
+	if (m_TexDoviLut.pTexture && hash == m_DoviLutHash) {
+		return true;
 	}
 
-	return hr;
+	HRESULT hr = S_OK;
+	if (!m_TexDoviLut.pTexture) {
+		m_pPSConvertColor.Release();
+		m_pPSConvertColorDeint.Release();
+		hr = m_TexDoviLut.Create(m_pD3DDevEx, D3DFMT_R32F, DOVI_LUT_SIZE, 3, D3DUSAGE_DYNAMIC);
+	}
+	if (S_OK == hr) {
+		// the scenes often return to a previous mapping, its tables are not baked again
+		const auto& lut = m_DoviLutCache.Get(m_Dovi.msd, hash);
+
+		D3DLOCKED_RECT lockedRect;
+		hr = m_TexDoviLut.pTexture->LockRect(0, &lockedRect, nullptr, D3DLOCK_DISCARD);
+		if (S_OK == hr) {
+			for (int c = 0; c < 3; c++) {
+				memcpy((BYTE*)lockedRect.pBits + c * lockedRect.Pitch, &lut[c * DOVI_LUT_SIZE], DOVI_LUT_SIZE * sizeof(float));
+			}
+			hr = m_TexDoviLut.pTexture->UnlockRect(0);
+		}
+	}
+	if (FAILED(hr)) {
+		DLog(L"CDX9VideoProcessor::UpdateDoviLut() : failed with error {}", HR2Str(hr));
+		m_TexDoviLut.Release();
+		m_DoviLutHash = 0;
+		return false;
+	}
+
+	m_DoviLutHash = hash;
+
+	return true;
+}
+
+void CDX9VideoProcessor::CheckConvertColorShaders()
+{
+	CShaderCompileQueue::Result_t result;
+	if (m_ConvertShaderQueue.GetResult(result)) {
+		DLog(L"CDX9VideoProcessor::CheckConvertColorShaders() : the compiled shaders are used");
+		SetConvertColorShaders(result);
+	}
 }
 
 HRESULT CDX9VideoProcessor::DxvaVPPass(IDirect3DSurface9* pRenderTarget, const CRect& srcRect, const CRect& dstRect, const bool second)
@@ -2362,10 +2682,30 @@ HRESULT CDX9VideoProcessor::DxvaVPPass(IDirect3DSurface9* pRenderTarget, const C
 	return m_DXVA2VP.Process(pRenderTarget, m_CurrentSampleFmt, second);
 }
 
-HRESULT CDX9VideoProcessor::ConvertColorPass(IDirect3DSurface9* pRenderTarget)
+HRESULT CDX9VideoProcessor::ConvertColorPass(IDirect3DSurface9* pRenderTarget, const CRect& rect)
 {
+	CheckConvertColorShaders();
+
 	HRESULT hr = m_pD3DDevEx->SetRenderTarget(0, pRenderTarget);
 
+	// VertexData covers the whole render target, a part of it is interpolated
+	const auto& v = m_PSConvColorData.VertexData;
+	decltype(m_PSConvColorData.VertexData) vertices;
+	if (rect != CRect(0, 0, m_srcRectWidth, m_srcRectHeight)) {
+		const float kx[2] = { (float)rect.left / m_srcRectWidth, (float)rect.right / m_srcRectWidth };
+		const float ky[2] = { (float)rect.top / m_srcRectHeight, (float)rect.bottom / m_srcRectHeight };
+		for (int i = 0; i < 4; i++) {
+			const float fx = kx[i & 1];
+			const float fy = ky[i >> 1];
+			vertices[i].Pos = { v[0].Pos.x + (v[3].Pos.x - v[0].Pos.x) * fx, v[0].Pos.y + (v[3].Pos.y - v[0].Pos.y) * fy, 0.5f, 2.0f };
+			for (int t = 0; t < 2; t++) {
+				vertices[i].Tex[t] = { v[0].Tex[t].x + (v[3].Tex[t].x - v[0].Tex[t].x) * fx, v[0].Tex[t].y + (v[3].Tex[t].y - v[0].Tex[t].y) * fy };
+			}
+		}
+	} else {
+		std::copy(std::begin(v), std::end(v), vertices);
+	}
+
 	float fConstDataHDR[][4] = {
 		{10000.0f / m_iSDRDisplayNits, 0.0f, 0.0f, 0.0f}
 	};
@@ -2419,14 +2759,34 @@ HRESULT CDX9VideoProcessor::ConvertColorPass(IDirect3DSurface9* pRenderTarget)
 		}
 	}
 
+	if (m_TexTrcLut.pTexture) {
+		// the shader interpolates the two samples that it reads
+		hr = m_pD3DDevEx->SetTexture(3, m_TexTrcLut.pTexture);
+		hr = m_pD3DDevEx->SetSamplerState(3, D3DSAMP_MAGFILTER, D3DTEXF_POINT);
+		hr = m_pD3DDevEx->SetSamplerState(3, D3DSAMP_MINFILTER, D3DTEXF_POINT);
+		hr = m_pD3DDevEx->SetSamplerState(3, D3DSAMP_MIPFILTER, D3DTEXF_NONE);
+		hr = m_pD3DDevEx->SetSamplerState(3, D3DSAMP_ADDRESSU, D3DTADDRESS_CLAMP);
+		hr = m_pD3DDevEx->SetSamplerState(3, D3DSAMP_ADDRESSV, D3DTADDRESS_CLAMP);
+	}
+	if (m_TexDoviLut.pTexture) {
+		hr = m_pD3DDevEx->SetTexture(4, m_TexDoviLut.pTexture);
+		hr = m_pD3DDevEx->SetSamplerState(4, D3DSAMP_MAGFILTER, D3DTEXF_POINT);
+		hr = m_pD3DDevEx->SetSamplerState(4, D3DSAMP_MINFILTER, D3DTEXF_POINT);
+		hr = m_pD3DDevEx->SetSamplerState(4, D3DSAMP_MIPFILTER, D3DTEXF_NONE);
+		hr = m_pD3DDevEx->SetSamplerState(4, D3DSAMP_ADDRESSU, D3DTADDRESS_CLAMP);
+		hr = m_pD3DDevEx->SetSamplerState(4, D3DSAMP_ADDRESSV, D3DTADDRESS_CLAMP);
+	}
+
 	hr = m_pD3DDevEx->SetFVF(D3DFVF_XYZRHW | FVF);
-	hr = m_pD3DDevEx->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, 2, m_PSConvColorData.VertexData, sizeof(m_PSConvColorData.VertexData[0]));
+	hr = m_pD3DDevEx->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, 2, vertices, sizeof(vertices[0]));
 
 	m_pD3DDevEx->SetPixelShader(nullptr);
 
 	m_pD3DDevEx->SetTexture(0, nullptr);
 	m_pD3DDevEx->SetTexture(1, nullptr);
 	m_pD3DDevEx->SetTexture(2, nullptr);
+	m_pD3DDevEx->SetTexture(3, nullptr);
+	m_pD3DDevEx->SetTexture(4, nullptr);
 
 	return hr;
 
@@ -2656,9 +3016,13 @@ HRESULT CDX9VideoProcessor::Process(IDirect3DSurface9* pRenderTarget, const CRec
 		rSrc = rect;
 	}
 	else if (m_PSConvColorData.bEnable) {
-		ConvertColorPass(m_TexConvertOutput.pSurface);
+		// m_TexConvertOutput has the size of m_srcRect, srcRect is smaller if the bars are cropped
+		rSrc.OffsetRect(-m_srcRect.TopLeft());
+		CRect rect(rSrc);
+		rect.InflateRect(CLetterboxDetector::MARGIN, CLetterboxDetector::MARGIN);
+		rect.IntersectRect(rect, CRect(0, 0, m_TexConvertOutput.Width, m_TexConvertOutput.Height));
+		ConvertColorPass(m_TexConvertOutput.pSurface, rect);
 		pInputTexture = m_TexConvertOutput.pTexture;
-		rSrc.SetRect(0, 0, m_TexConvertOutput.Width, m_TexConvertOutput.Height);
 	}
 	else {
 		pInputTexture = m_TexSrcVideo.pTexture;
@@ -3098,6 +3462,7 @@ HRESULT CDX9VideoProcessor::DrawStats(IDirect3DSurface9* pRenderTarget)
 		m_RenderStats.copyticks    * 1000 / GetPreciseTicksPerSecondI(),
 		m_RenderStats.paintticks   * 1000 / GetPreciseTicksPerSecondI(),
 		m_RenderStats.presentticks * 1000 / GetPreciseTicksPerSecondI());
+	AppendLatencyStats(str);
 	str += std::format(L"\nSync offset   : {:+3} ms", (m_RenderStats.syncoffset + 5000) / 10000);
 
 #if SYNC_OFFSET_EX
@@ -27,6 +27,7 @@
 #include "D3DUtil/D3D9Font.h"
 #include "D3DUtil/D3D9Geometry.h"
 #include "VideoProcessor.h"
+#include "LetterboxDetector.h"
 #include "Shaders.h"
 #include "SubPic/DX9SubPic.h"
 
@@ -64,6 +65,10 @@ private:
 	Tex_t m_TexResize;         // for intermediate result of two-pass resize
 	CTexRing m_TexsPostScale;
 	Tex_t m_TexDither;
+	Tex_t m_TexTrcLut; // the transfer function table of the conversion shader
+	mp_csp_trc m_TrcLut = MP_CSP_TRC_AUTO;
+	Tex_t m_TexDoviLut; // the Dolby Vision reshaping tables of the conversion shader
+	uint64_t m_DoviLutHash = 0;
 
 	CComPtr<IDirect3DPixelShader9> m_pPSCorrection;
 	const wchar_t* m_strCorrection = nullptr;
@@ -80,6 +85,16 @@ private:
 
 	PS_DOVI_POLY_CURVE m_DoviReshapePolyCurves[3];
 
+	// black bars of software-decoded frames that are not uploaded and processed
+	bool m_bCropBlackBars = false;
+	CLetterboxDetector m_Letterbox;
+	bool CanCropBars() const { return m_bCropBlackBars && !m_iRotation && !m_bFlip; }
+	bool GetCroppedRects(CRect& srcRect, CRect& dstRect) const;
+
+	// the sample buffers of the custom allocator that are transferred without a copy
+	bool m_bZeroCopyUpload = false;
+	std::shared_ptr<CDX9UploadBuffers> m_pUploadBuffers = std::make_shared<CDX9UploadBuffers>();
+
 	CComPtr<IDirect3DPixelShader9> m_pShaderUpscaleX;
 	CComPtr<IDirect3DPixelShader9> m_pShaderUpscaleY;
 	CComPtr<IDirect3DPixelShader9> m_pShaderDownscaleX;
@@ -166,6 +181,7 @@ public:
 	HRESULT Reset() override;
 
 	IDirect3DDeviceManager9* GetDeviceManager9() override { return m_pD3DDeviceManager; }
+	std::shared_ptr<CUploadBuffers> GetUploadBuffers() override { return m_bZeroCopyUpload ? m_pUploadBuffers : nullptr; }
 	HRESULT GetCurentImage(long *pDIBImage) override;
 	HRESULT GetDisplayedImage(BYTE **ppDib, unsigned *pSize) override;
 	HRESULT GetVPInfo(std::wstring& str) override;
@@ -192,9 +208,15 @@ private:
 	void UpdateUpscalingShaders();
 	void UpdateDownscalingShaders();
 	HRESULT UpdateConvertColorShader();
+	HRESULT SetConvertColorShaders(const CShaderCompileQueue::Result_t& result);
+	void SetConvertColorFallbackShader();
+	void CheckConvertColorShaders();
+	// returns false if the conversion shader computes the transfer function
+	bool UpdateTrcLut(mp_csp_trc trc);
+	bool UpdateDoviLut();
 
 	HRESULT DxvaVPPass(IDirect3DSurface9* pRenderTarget, const CRect& srcRect, const CRect& dstRect, const bool second);
-	HRESULT ConvertColorPass(IDirect3DSurface9* pRenderTarget);
+	HRESULT ConvertColorPass(IDirect3DSurface9* pRenderTarget, const CRect& rect);
 	HRESULT ResizeShaderPass(IDirect3DTexture9* pTexture, IDirect3DSurface9* pRenderTarget, const CRect& srcRect, const CRect& dstRect);
 	HRESULT FinalPass(IDirect3DTexture9* pTexture, IDirect3DSurface9* pRenderTarget, const CRect& srcRect, const CRect& dstRect);
 
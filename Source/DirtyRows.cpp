@@ -0,0 +1,235 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "stdafx.h"
+#include <array>
+#include <emmintrin.h>
+#include "DirtyRows.h"
+
+// The line hash accumulates 64-byte stripes in the way of XXH3: each 16-byte lane is mixed
+// with a key that depends on its position, multiplied 32x32->64 and added to the accumulator
+// together with the data itself. After every block of stripes the accumulators are scrambled.
+
+constexpr UINT STRIPES_PER_BLOCK = 16;
+constexpr UINT KEYS_STRIPES  = 0;                                   // 4 keys per stripe
+constexpr UINT KEYS_SCRAMBLE = KEYS_STRIPES + STRIPES_PER_BLOCK * 4; // 4 keys
+constexpr UINT KEYS_LAST     = KEYS_SCRAMBLE + 4;                   // 4 keys
+constexpr UINT KEYS_COUNT    = KEYS_LAST + 4;
+
+constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+
+static constexpr std::array<uint64_t, KEYS_COUNT * 2> MakeKeys()
+{
+	std::array<uint64_t, KEYS_COUNT * 2> keys = {};
+	uint64_t x = 0;
+	for (auto& key : keys) {
+		// splitmix64
+		x += 0x9E3779B97F4A7C15ull;
+		uint64_t z = x;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		key = z ^ (z >> 31);
+	}
+	return keys;
+}
+
+alignas(16) static constexpr std::array<uint64_t, KEYS_COUNT * 2> s_keys = MakeKeys();
+
+static inline __m128i Accumulate(const __m128i acc, const __m128i data, const __m128i key)
+{
+	const __m128i data_key = _mm_xor_si128(data, key);
+	const __m128i product = _mm_mul_epu32(data_key, _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1)));
+	const __m128i data_swap = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+	return _mm_add_epi64(_mm_add_epi64(acc, data_swap), product);
+}
+
+static inline __m128i Scramble(__m128i acc, const __m128i key)
+{
+	// acc = (acc ^ (acc >> 47) ^ key) * 0x9E3779B1
+	acc = _mm_xor_si128(_mm_xor_si128(acc, _mm_srli_epi64(acc, 47)), key);
+	const __m128i prime = _mm_set1_epi32((int)0x9E3779B1);
+	const __m128i lo = _mm_mul_epu32(acc, prime);
+	const __m128i hi = _mm_mul_epu32(_mm_shuffle_epi32(acc, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+	return _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+}
+
+static inline void AccumulateStripe(__m128i (&acc)[4], const BYTE* p, const __m128i* keys)
+{
+	acc[0] = Accumulate(acc[0], _mm_loadu_si128((const __m128i*)p), keys[0]);
+	acc[1] = Accumulate(acc[1], _mm_loadu_si128((const __m128i*)(p + 16)), keys[1]);
+	acc[2] = Accumulate(acc[2], _mm_loadu_si128((const __m128i*)(p + 32)), keys[2]);
+	acc[3] = Accumulate(acc[3], _mm_loadu_si128((const __m128i*)(p + 48)), keys[3]);
+}
+
+static uint64_t HashLine_SSE2(const BYTE* p, const size_t size)
+{
+	const __m128i* keys = (const __m128i*)s_keys.data();
+
+	__m128i acc[4] = {
+		_mm_set_epi64x((int64_t)PRIME64_1, (int64_t)PRIME64_2),
+		_mm_set_epi64x((int64_t)PRIME64_2, (int64_t)PRIME64_1),
+		_mm_set_epi64x((int64_t)(PRIME64_1 * 3), (int64_t)(PRIME64_2 * 5)),
+		_mm_set_epi64x((int64_t)(PRIME64_2 * 7), (int64_t)(PRIME64_1 * 11)),
+	};
+
+	size_t i = 0;
+	UINT stripe = 0;
+	for (; i + 64 <= size; i += 64) {
+		AccumulateStripe(acc, p + i, keys + KEYS_STRIPES + stripe * 4);
+		if (++stripe == STRIPES_PER_BLOCK) {
+			stripe = 0;
+			for (int n = 0; n < 4; n++) {
+				acc[n] = Scramble(acc[n], keys[KEYS_SCRAMBLE + n]);
+			}
+		}
+	}
+	if (i < size) {
+		// the last 64 bytes overlap the previous stripe, a short line is padded with zeros
+		alignas(16) BYTE last[64] = {};
+		const BYTE* t = last;
+		if (size >= 64) {
+			t = p + size - 64;
+		} else {
+			memcpy(last, p, size);
+		}
+		AccumulateStripe(acc, t, keys + KEYS_LAST);
+	}
+
+	alignas(16) uint64_t lanes[8];
+	for (int n = 0; n < 4; n++) {
+		_mm_store_si128((__m128i*)lanes + n, acc[n]);
+	}
+
+	uint64_t h = size * PRIME64_1;
+	for (const uint64_t lane : lanes) {
+		h = (h ^ lane) * PRIME64_2;
+		h ^= h >> 29;
+	}
+	return h;
+}
+
+//
+// CDirtyRows
+//
+
+void CDirtyRows::HashBands(const BYTE* src, const int pitch, const UINT firstBand, const UINT bands)
+{
+	for (UINT band = firstBand; band < firstBand + bands; band++) {
+		const UINT first = band * BAND_LINES;
+		const UINT last = std::min(first + BAND_LINES, m_lines);
+
+		uint64_t h = band;
+		for (UINT y = first; y < last; y++) {
+			h = (h ^ HashLine_SSE2(src + (ptrdiff_t)pitch * y, m_lineSize)) * PRIME64_1;
+		}
+		m_newHashes[band] = h;
+	}
+}
+
+CDirtyRows::Result_t CDirtyRows::Count(const Result_t result, const uint64_t uploaded)
+{
+	const uint64_t frameSize = (uint64_t)m_lineSize * m_lines;
+
+	m_bytesUploaded.fetch_add(uploaded, std::memory_order_relaxed);
+	m_bytesSkipped.fetch_add(frameSize - uploaded, std::memory_order_relaxed);
+
+	return result;
+}
+
+CDirtyRows::Result_t CDirtyRows::Compare(const BYTE* src, const int pitch, const size_t lineSize, const UINT lines, const double maxPartial, CParallelCopy* pParallel)
+{
+	m_ranges.clear();
+
+	if (lines != m_lines || lineSize != m_lineSize) {
+		m_lines = lines;
+		m_lineSize = lineSize;
+		m_bValid = false;
+		m_probeInterval = 0;
+		m_skipFrames = 0;
+	}
+	const uint64_t frameSize = (uint64_t)lineSize * lines;
+
+	if (m_skipFrames) {
+		// the recent frames changed completely, this one is not compared
+		m_skipFrames--;
+		m_bValid = false;
+		return Count(DIRTY_ALL, frameSize);
+	}
+
+	const UINT bands = (lines + BAND_LINES - 1) / BAND_LINES;
+	m_newHashes.resize(bands);
+	if (pParallel && frameSize >= 2 * 1024 * 1024) {
+		pParallel->Run(bands, [&](UINT first, UINT count) {
+			HashBands(src, pitch, first, count);
+		});
+	} else {
+		HashBands(src, pitch, 0, bands);
+	}
+
+	if (!m_bValid || m_hashes.size() != bands) {
+		m_hashes.swap(m_newHashes);
+		m_bValid = true;
+		return Count(DIRTY_ALL, frameSize);
+	}
+
+	UINT changedLines = 0;
+	for (UINT band = 0; band < bands; band++) {
+		if (m_newHashes[band] != m_hashes[band]) {
+			const UINT first = band * BAND_LINES;
+			const UINT count = std::min(BAND_LINES, lines - first);
+			if (m_ranges.size() && m_ranges.back().first + m_ranges.back().count == first) {
+				m_ranges.back().count += count;
+			} else {
+				m_ranges.push_back({ first, count });
+			}
+			changedLines += count;
+		}
+	}
+	m_hashes.swap(m_newHashes);
+
+	if (changedLines == 0) {
+		m_probeInterval = 0;
+		return Count(DIRTY_NONE, 0);
+	}
+
+	if (changedLines == lines) {
+		// probably a usual video, compare again after 1, 2, 4 ... MAX_PROBE_INTERVAL frames
+		m_probeInterval = std::clamp(m_probeInterval * 2, 1u, MAX_PROBE_INTERVAL);
+		m_skipFrames = m_probeInterval;
+		m_ranges.clear();
+		return Count(DIRTY_ALL, frameSize);
+	}
+	m_probeInterval = 0;
+
+	if (changedLines > maxPartial * lines || m_ranges.size() > MAX_RANGES) {
+		// one upload of the whole frame is cheaper than many small ones
+		m_ranges.clear();
+		return Count(DIRTY_ALL, frameSize);
+	}
+
+	return Count(DIRTY_RANGES, (uint64_t)changedLines * lineSize);
+}
+
+void CDirtyRows::ResetCounters()
+{
+	m_bytesUploaded.store(0, std::memory_order_relaxed);
+	m_bytesSkipped.store(0, std::memory_order_relaxed);
+}
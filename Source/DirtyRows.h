@@ -0,0 +1,80 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+
+#include <atomic>
+#include "ParallelCopy.h"
+
+// Compares a software-decoded frame with the previous one by the hashes of bands of lines.
+// If the destination keeps its content between frames, the unchanged frames and bands
+// do not have to be uploaded again (screen recordings, slideshows, animation).
+// When the frames change completely, as usual video does, the comparison is done
+// less and less often, at most once per MAX_PROBE_INTERVAL frames.
+class CDirtyRows
+{
+public:
+	static constexpr UINT BAND_LINES = 16;
+	static constexpr UINT MAX_RANGES = 16;
+	static constexpr UINT MAX_PROBE_INTERVAL = 64;
+
+	enum Result_t {
+		DIRTY_ALL,    // upload the whole frame
+		DIRTY_RANGES, // upload only the lines of GetRanges()
+		DIRTY_NONE,   // the frame has not changed, nothing to upload
+	};
+
+	struct Range_t {
+		UINT first; // line
+		UINT count; // lines
+	};
+
+private:
+	std::vector<uint64_t> m_hashes; // the hashes of the bands of the destination content
+	std::vector<uint64_t> m_newHashes;
+	std::vector<Range_t>  m_ranges;
+	UINT   m_lines    = 0;
+	size_t m_lineSize = 0;
+	bool   m_bValid   = false; // m_hashes match the destination
+
+	UINT m_probeInterval = 0;
+	UINT m_skipFrames    = 0;
+
+	std::atomic<uint64_t> m_bytesUploaded = 0;
+	std::atomic<uint64_t> m_bytesSkipped  = 0;
+
+	void HashBands(const BYTE* src, const int pitch, const UINT firstBand, const UINT bands);
+	Result_t Count(const Result_t result, const uint64_t uploaded);
+
+public:
+	// src is the first line of the frame, pitch can be negative. lineSize bytes of each line are compared.
+	// maxPartial is the largest part of the lines that is uploaded by ranges, 0 - only whole frames.
+	// pParallel hashes large frames with several threads, can be nullptr.
+	// The result must be followed by the upload, otherwise call Invalidate().
+	Result_t Compare(const BYTE* src, const int pitch, const size_t lineSize, const UINT lines, const double maxPartial, CParallelCopy* pParallel);
+	const std::vector<Range_t>& GetRanges() const { return m_ranges; }
+
+	// the destination was recreated or written by other code
+	void Invalidate() { m_bValid = false; }
+
+	uint64_t GetBytesUploaded() const { return m_bytesUploaded.load(std::memory_order_relaxed); }
+	uint64_t GetBytesSkipped() const { return m_bytesSkipped.load(std::memory_order_relaxed); }
+	void ResetCounters();
+};
@@ -0,0 +1,231 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "stdafx.h"
+#include <cfloat>
+#include "Utils/Hash.h"
+#include "Helper.h"
+#include "DoviLut.h"
+
+void GetDoviFingerprint(const MediaSideDataDOVIMetadata& msd, DoviFingerprint_t& fp)
+{
+	const auto& header = msd.Header;
+	const uint8_t headerFields[] = {
+		header.el_spatial_resampling_filter_flag, header.disable_residual_flag, header.vdr_bit_depth
+	};
+	fp.header = hash_mix64(headerFields, sizeof(headerFields));
+
+	const auto& color = msd.ColorMetadata;
+	static_assert(offsetof(MediaSideDataDOVIMetadata, ColorMetadata.ycc_to_rgb_offset) == offsetof(MediaSideDataDOVIMetadata, ColorMetadata.ycc_to_rgb_matrix) + sizeof(color.ycc_to_rgb_matrix));
+	fp.yccToRgb = hash_mix64(color.ycc_to_rgb_matrix, sizeof(color.ycc_to_rgb_matrix) + sizeof(color.ycc_to_rgb_offset));
+	fp.rgbToLms = hash_mix64(color.rgb_to_lms_matrix, sizeof(color.rgb_to_lms_matrix));
+	const uint16_t levels[] = { color.source_min_pq, color.source_max_pq };
+	fp.levels = hash_mix64(levels, sizeof(levels));
+
+	fp.reshape = GetDoviReshapeHash(msd);
+
+	// the MMR pieces one after another, the pieces and their orders are in fp.reshape
+	int64_t mmr[3 * LAV_DOVI_MAX_PIECES * (2 + 3 * 7)];
+	size_t mmrSize = 0;
+	for (const auto& curve : msd.Mapping.curves) {
+		const int num_coef = std::clamp<int>(curve.num_pivots - 1, 0, LAV_DOVI_MAX_PIECES);
+		for (int i = 0; i < num_coef; i++) {
+			if (curve.mapping_idc[i] == 1) {
+				const int order = std::clamp<int>(curve.mmr_order[i], 1, 3);
+				mmr[mmrSize++] = curve.mmr_order[i];
+				mmr[mmrSize++] = curve.mmr_constant[i];
+				memcpy(&mmr[mmrSize], curve.mmr_coef[i], order * sizeof(curve.mmr_coef[i][0]));
+				mmrSize += order * 7;
+			}
+		}
+	}
+	fp.mmr = hash_mix64(mmr, mmrSize * sizeof(mmr[0]));
+
+	const uint64_t parts[] = { fp.header, fp.yccToRgb, fp.rgbToLms, fp.reshape, fp.mmr, fp.levels };
+	fp.all = hash_mix64(parts, sizeof(parts));
+}
+
+bool DoviHasMMR(const MediaSideDataDOVIMetadata& msd)
+{
+	for (const auto& curve : msd.Mapping.curves) {
+		for (int i = 0; i < curve.num_pivots - 1; i++) {
+			if (curve.mapping_idc[i] == 1) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+double EvalDoviReshapePoly(const MediaSideDataDOVIMetadata& msd, const int c, const double s)
+{
+	const auto& curve = msd.Mapping.curves[c];
+
+	// the same values as SetShaderDoviCurvesPoly() uploads, the pivots are compared in single
+	// precision as the shader does, so that a signal on a pivot selects the same piece
+	const float scale = 1.0f / ((1 << msd.Header.bl_bit_depth) - 1);
+	const double scale_coef = 1.0 / (1ull << msd.Header.coef_log2_denom);
+
+	const double sig = std::clamp(s, 0.0, 1.0);
+
+	// the piece is the number of inner pivots below or at the signal
+	int i = 0;
+	while (i < curve.num_pivots - 2 && (float)sig >= scale * curve.pivots[i + 1]) {
+		i++;
+	}
+
+	double y = sig;
+	if (curve.mapping_idc[i] == 0) {
+		const double c0 = scale_coef * curve.poly_coef[i][0];
+		const double c1 = (curve.poly_order[i] >= 1) ? scale_coef * curve.poly_coef[i][1] : 0.0;
+		const double c2 = (curve.poly_order[i] >= 2) ? scale_coef * curve.poly_coef[i][2] : 0.0;
+		y = (c2 * sig + c1) * sig + c0;
+	}
+
+	return std::clamp(y, 0.0, 1.0);
+}
+
+void BakeDoviReshapeLut(const MediaSideDataDOVIMetadata& msd, std::vector<float>& lut)
+{
+	lut.resize(3 * DOVI_LUT_SIZE);
+	for (int c = 0; c < 3; c++) {
+		float* row = &lut[c * DOVI_LUT_SIZE];
+		for (int i = 0; i < DOVI_LUT_SIZE; i++) {
+			row[i] = (float)EvalDoviReshapePoly(msd, c, (double)i / (DOVI_LUT_SIZE - 1));
+		}
+	}
+}
+
+float SampleDoviReshapeLut(const float* lut, const int c, const float x)
+{
+	const float* row = lut + c * DOVI_LUT_SIZE;
+	const float pos = std::clamp(x, 0.0f, 1.0f) * (DOVI_LUT_SIZE - 1);
+	const int i = std::min((int)pos, DOVI_LUT_SIZE - 2);
+	const float f = pos - i;
+
+	return row[i] + f * (row[i + 1] - row[i]);
+}
+
+uint64_t GetDoviReshapeHash(const MediaSideDataDOVIMetadata& msd)
+{
+	// the used entries are gathered in one block that is hashed at once,
+	// the rest of the arrays may hold anything and is left zero
+	struct {
+		int64_t poly_coef[LAV_DOVI_MAX_PIECES][3];
+		uint16_t pivots[LAV_DOVI_MAX_PIECES + 1];
+		uint8_t mapping_idc[LAV_DOVI_MAX_PIECES];
+		uint8_t poly_order[LAV_DOVI_MAX_PIECES];
+		uint8_t num_pivots;
+	} used[3];
+	memset(used, 0, sizeof(used));
+
+	for (int c = 0; c < 3; c++) {
+		const auto& curve = msd.Mapping.curves[c];
+		const int num_pivots = std::clamp<int>(curve.num_pivots, 0, LAV_DOVI_MAX_PIECES + 1);
+		const int num_coef = std::max(num_pivots - 1, 0);
+		used[c].num_pivots = curve.num_pivots;
+		memcpy(used[c].pivots, curve.pivots, num_pivots * sizeof(curve.pivots[0]));
+		memcpy(used[c].mapping_idc, curve.mapping_idc, num_coef);
+		for (int i = 0; i < num_coef; i++) {
+			if (curve.mapping_idc[i] == 0) {
+				used[c].poly_order[i] = curve.poly_order[i];
+				memcpy(used[c].poly_coef[i], curve.poly_coef[i], sizeof(curve.poly_coef[i]));
+			}
+		}
+	}
+
+	const uint8_t scales[] = { msd.Header.bl_bit_depth, msd.Header.coef_log2_denom };
+
+	return hash_mix64(used, sizeof(used), hash_mix64(scales, sizeof(scales)));
+}
+
+DoviLutAccuracy_t MeasureDoviReshapeLut(const MediaSideDataDOVIMetadata& msd, const float* lut, const UINT samples)
+{
+	DoviLutAccuracy_t report;
+
+	auto measure = [&](const int c, const float x) {
+		const double err = fabs(SampleDoviReshapeLut(lut, c, x) - EvalDoviReshapePoly(msd, c, x));
+
+		report.samples++;
+		if (err > report.maxErr) {
+			report.maxErr = err;
+			report.maxErrInput = x;
+			report.maxErrComponent = c;
+		}
+		return err;
+	};
+
+	const int codes = (1 << msd.Header.bl_bit_depth) - 1;
+
+	for (int c = 0; c < 3; c++) {
+		// cell centres, where the interpolation error of the quadratic pieces is the largest
+		for (int i = 0; i < DOVI_LUT_SIZE - 1; i++) {
+			measure(c, (i + 0.5f) / (DOVI_LUT_SIZE - 1));
+		}
+
+		// the values that the decoder gives for the base layer
+		for (int i = 0; i <= codes; i++) {
+			report.maxErrCodes = std::max(report.maxErrCodes, measure(c, (float)i / codes));
+		}
+
+		// reproducible pseudo-random inputs
+		uint32_t seed = 0x9e3779b9u + c;
+		for (UINT i = 0; i < samples; i++) {
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+			measure(c, (seed >> 8) * (1.0f / (1 << 24)));
+		}
+	}
+
+	DLog(L"MeasureDoviReshapeLut() : {} samples, {} inputs, max error {:.3e} at {:.6f} of component {}, max error on {} code values {:.3e}",
+		DOVI_LUT_SIZE, report.samples, report.maxErr, report.maxErrInput, report.maxErrComponent, codes + 1, report.maxErrCodes);
+
+	return report;
+}
+
+//
+// CDoviLutCache
+//
+
+const std::vector<float>& CDoviLutCache::Get(const MediaSideDataDOVIMetadata& msd, const uint64_t hash)
+{
+	for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+		if (it->hash == hash) {
+			m_entries.splice(m_entries.begin(), m_entries, it);
+			m_hits++;
+			return m_entries.front().lut;
+		}
+	}
+
+	m_misses++;
+	if (m_entries.size() >= m_maxEntries) {
+		// reuse the memory of the least recently used tables
+		m_entries.splice(m_entries.begin(), m_entries, std::prev(m_entries.end()));
+	} else {
+		m_entries.emplace_front();
+	}
+	auto& entry = m_entries.front();
+	entry.hash = hash;
+	BakeDoviReshapeLut(msd, entry.lut);
+
+	return entry.lut;
+}
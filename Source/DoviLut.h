@@ -0,0 +1,126 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+
+#include <list>
+#include <vector>
+#include "../Include/IMediaSideData.h"
+
+#define DOVI_LUT_SIZE 1024 // samples of each component
+
+struct DoviLutAccuracy_t {
+	double maxErr          = 0.0; // absolute, in signal values
+	float  maxErrInput     = 0.0f;
+	int    maxErrComponent = 0;
+	double maxErrCodes     = 0.0; // on the code values of the base layer
+	UINT   samples         = 0;
+};
+
+// Hashes of the parts of the metadata that the renderer uses, computed once for each sample.
+// Only the used pieces of the curves are hashed, the rest of the arrays may hold anything.
+struct DoviFingerprint_t {
+	uint64_t header   = 0; // the fields that CheckDoviMetadata() tests
+	uint64_t yccToRgb = 0; // ycc_to_rgb_matrix and ycc_to_rgb_offset
+	uint64_t rgbToLms = 0;
+	uint64_t reshape  = 0; // GetDoviReshapeHash()
+	uint64_t mmr      = 0; // the MMR pieces
+	uint64_t levels   = 0; // source_min_pq and source_max_pq
+	uint64_t all      = 0; // all of the above
+
+	bool CurvesChanged(const DoviFingerprint_t& fp) const { return reshape != fp.reshape || mmr != fp.mmr; }
+};
+
+void GetDoviFingerprint(const MediaSideDataDOVIMetadata& msd, DoviFingerprint_t& fp);
+
+// The Dolby Vision metadata that the video processor has applied to the conversion shader.
+struct DoviState_t {
+	MediaSideDataDOVIMetadata msd = {};
+	DoviFingerprint_t fp; // of msd
+	bool bValid  = false;
+	bool bHasMMR = false;
+
+	// the metadata of a sample with the fingerprint sampleFp is the applied one
+	bool IsApplied(const DoviFingerprint_t& sampleFp) const { return bValid && sampleFp.all == fp.all; }
+
+	// A sample without metadata. Returns true if the metadata of the previous samples was applied,
+	// then the conversion shader must be built again without the reshaping.
+	// bHasMMR keeps the layout of the curves buffer that the shader reads.
+	bool End()
+	{
+		if (!bValid) {
+			return false;
+		}
+		bValid = false;
+		fp = {};
+		return true;
+	}
+};
+
+// true if a piece of one of the curves is reshaped with MMR
+bool DoviHasMMR(const MediaSideDataDOVIMetadata& msd);
+
+// The polynomial reshaping of component c as ShaderDoviReshapePoly() computes it, in double precision.
+// The MMR pieces depend on all three components, they are passed through as the Direct3D 9 shader does.
+double EvalDoviReshapePoly(const MediaSideDataDOVIMetadata& msd, const int c, const double s);
+
+// Bakes EvalDoviReshapePoly() into three rows of DOVI_LUT_SIZE floats, one row per component,
+// sample i of a row is the signal value i / (DOVI_LUT_SIZE - 1).
+void BakeDoviReshapeLut(const MediaSideDataDOVIMetadata& msd, std::vector<float>& lut);
+
+// Linear interpolation between the two nearest samples of row c in single precision,
+// the same as the conversion shader does with two point loads (see ShaderDoviReshapeLut()).
+float SampleDoviReshapeLut(const float* lut, const int c, const float x);
+
+// The hash of the metadata that the tables depend on, the mapping curves and the scales of the header.
+uint64_t GetDoviReshapeHash(const MediaSideDataDOVIMetadata& msd);
+
+// Compares SampleDoviReshapeLut() against EvalDoviReshapePoly() on cell centres, on the code values
+// of the base layer and on pseudo-random inputs. Does not need a device and can run headless.
+// The cells that contain a pivot interpolate between two pieces, the error there is
+// the step of the curve at the pivot if the pieces do not join.
+DoviLutAccuracy_t MeasureDoviReshapeLut(const MediaSideDataDOVIMetadata& msd, const float* lut, const UINT samples = 100000);
+
+// The tables of the recently used mappings. The reshaping changes per scene and the scenes
+// of a title often return to the same metadata, which is not baked again.
+class CDoviLutCache
+{
+	struct Entry_t {
+		uint64_t hash;
+		std::vector<float> lut;
+	};
+
+	std::list<Entry_t> m_entries; // the most recently used first
+	const size_t m_maxEntries;
+
+	uint64_t m_hits   = 0;
+	uint64_t m_misses = 0;
+
+public:
+	CDoviLutCache(const size_t maxEntries = 32) : m_maxEntries(maxEntries) {}
+
+	// Returns the tables of BakeDoviReshapeLut() for the metadata, valid until the next call.
+	// The hash is GetDoviReshapeHash() of the metadata.
+	const std::vector<float>& Get(const MediaSideDataDOVIMetadata& msd, const uint64_t hash);
+	void Clear() { m_entries.clear(); }
+
+	uint64_t GetHits() const { return m_hits; }
+	uint64_t GetMisses() const { return m_misses; }
+};
@@ -0,0 +1,94 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "stdafx.h"
+#include "FrameScheduler.h"
+
+//
+// CFrameScheduler
+//
+
+CFrameScheduler::CFrameScheduler()
+	: CFrameScheduler(std::make_unique<CSystemFrameSchedulerClock>())
+{
+}
+
+CFrameScheduler::CFrameScheduler(std::unique_ptr<CFrameSchedulerClock> pClock)
+	: m_pClock(std::move(pClock))
+{
+	m_ticksPerSecond = m_pClock->TicksPerSecond();
+
+	m_minMargin = m_ticksPerSecond / 20000; // 50 us
+	m_maxMargin = m_ticksPerSecond / 500;   // 2 ms
+
+	// start with the delay of a 1 ms system timer, the real one is learned on the first frames
+	m_overshootMean = (double)(m_ticksPerSecond / 1000);
+	m_overshootDev  = m_overshootMean / 4;
+}
+
+void CFrameScheduler::Learn(const int64_t overshoot)
+{
+	const double value = (double)std::clamp<int64_t>(overshoot, 0, m_maxMargin);
+
+	m_overshootMean += (value - m_overshootMean) / 8;
+	m_overshootDev  += (std::abs(value - m_overshootMean) - m_overshootDev) / 8;
+}
+
+uint64_t CFrameScheduler::GetMargin() const
+{
+	const uint64_t margin = m_minMargin + (uint64_t)(m_overshootMean + 2 * m_overshootDev);
+
+	return std::min(margin, m_maxMargin);
+}
+
+void CFrameScheduler::WaitUntil(const uint64_t target)
+{
+	uint64_t now = m_pClock->Now();
+
+	if (now < target) {
+		const uint64_t margin = GetMargin();
+		if (target - now > margin) {
+			const uint64_t request = target - now - margin;
+			m_pClock->Wait(request);
+
+			const uint64_t woken = m_pClock->Now();
+			Learn((int64_t)(woken - now) - (int64_t)request);
+			now = woken;
+		}
+
+		while (now < target) {
+			m_pClock->Pause();
+			now = m_pClock->Now();
+		}
+	}
+
+	m_lastError = (int64_t)(now - target);
+}
+
+void CFrameScheduler::WaitFor(const REFERENCE_TIME duration)
+{
+	if (duration <= 0) {
+		m_lastError = 0;
+		return;
+	}
+
+	const uint64_t start = m_pClock->Now();
+	WaitUntil(start + (uint64_t)duration * m_ticksPerSecond / 10000000);
+}
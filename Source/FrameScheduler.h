@@ -0,0 +1,90 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+
+#include <memory>
+
+// Time source of CFrameScheduler. Another implementation can simulate the time
+// and the wake-up delays to measure the accuracy of the scheduler.
+class CFrameSchedulerClock
+{
+public:
+	virtual ~CFrameSchedulerClock() = default;
+
+	virtual uint64_t Now() = 0; // current time in ticks
+	virtual uint64_t TicksPerSecond() = 0;
+	virtual void Wait(const uint64_t ticks) = 0; // blocks the thread, can wake up later
+	virtual void Pause() = 0; // one iteration of the spin loop
+};
+
+// QueryPerformanceCounter and a high resolution waitable timer if the system has it
+class CSystemFrameSchedulerClock : public CFrameSchedulerClock
+{
+	HANDLE m_hTimer = nullptr;
+	bool m_bHighResolution = false;
+
+public:
+	CSystemFrameSchedulerClock();
+	~CSystemFrameSchedulerClock() override;
+
+	uint64_t Now() override;
+	uint64_t TicksPerSecond() override;
+	void Wait(const uint64_t ticks) override;
+	void Pause() override;
+
+	bool IsHighResolution() const { return m_bHighResolution; }
+};
+
+// Waits until the specified time with a blocking wait followed by a short spin.
+// The blocking wait ends earlier by the learned wake-up delay of the clock,
+// so that only the last part of the interval is spent spinning.
+class CFrameScheduler
+{
+	std::unique_ptr<CFrameSchedulerClock> m_pClock;
+	uint64_t m_ticksPerSecond;
+
+	// learned wake-up delay, in ticks
+	double m_overshootMean = 0;
+	double m_overshootDev  = 0;
+
+	uint64_t m_minMargin; // spin time that is always left after the blocking wait
+	uint64_t m_maxMargin; // limit of the spin time
+
+	int64_t m_lastError = 0;
+
+	void Learn(const int64_t overshoot);
+
+public:
+	CFrameScheduler(); // uses CSystemFrameSchedulerClock
+	CFrameScheduler(std::unique_ptr<CFrameSchedulerClock> pClock);
+
+	CFrameSchedulerClock* GetClock() { return m_pClock.get(); }
+
+	// target is a time of the clock
+	void WaitUntil(const uint64_t target);
+	// duration is in 100 ns units
+	void WaitFor(const REFERENCE_TIME duration);
+
+	// time the blocking wait ends before the target, in ticks
+	uint64_t GetMargin() const;
+	// lateness of the last wake-up, in ticks
+	int64_t GetLastError() const { return m_lastError; }
+};
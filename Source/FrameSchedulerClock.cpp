@@ -0,0 +1,82 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "stdafx.h"
+#include "Times.h"
+#include "FrameScheduler.h"
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+//
+// CSystemFrameSchedulerClock
+//
+
+CSystemFrameSchedulerClock::CSystemFrameSchedulerClock()
+{
+	// Windows 10 1803 and newer
+	m_hTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	if (m_hTimer) {
+		m_bHighResolution = true;
+	} else {
+		// the resolution is set by timeBeginPeriod in CBaseRenderer2
+		m_hTimer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+	}
+	DLogIf(!m_hTimer, L"CSystemFrameSchedulerClock::CSystemFrameSchedulerClock() : CreateWaitableTimerExW() failed with error {}", HR2Str(HRESULT_FROM_WIN32(GetLastError())));
+}
+
+CSystemFrameSchedulerClock::~CSystemFrameSchedulerClock()
+{
+	if (m_hTimer) {
+		CloseHandle(m_hTimer);
+	}
+}
+
+uint64_t CSystemFrameSchedulerClock::Now()
+{
+	return GetPreciseTick();
+}
+
+uint64_t CSystemFrameSchedulerClock::TicksPerSecond()
+{
+	return GetPreciseTicksPerSecondI();
+}
+
+void CSystemFrameSchedulerClock::Wait(const uint64_t ticks)
+{
+	const int64_t duration = (int64_t)(ticks * 10000000 / GetPreciseTicksPerSecondI()); // 100 ns units
+
+	if (m_hTimer && duration > 0) {
+		LARGE_INTEGER dueTime;
+		dueTime.QuadPart = -duration; // relative time
+		if (SetWaitableTimerEx(m_hTimer, &dueTime, 0, nullptr, nullptr, nullptr, 0)) {
+			WaitForSingleObject(m_hTimer, INFINITE);
+			return;
+		}
+	}
+
+	Sleep((DWORD)(duration / 10000));
+}
+
+void CSystemFrameSchedulerClock::Pause()
+{
+	YieldProcessor();
+}
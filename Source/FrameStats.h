@@ -20,6 +20,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <bit>
+#include <cmath>
 #include "Times.h"
 
 #define SYNC_OFFSET_EX 0
@@ -172,6 +175,97 @@ struct CRenderStats {
 	}
 };
 
+// Log-bucketed histogram of durations in ticks with a fixed memory size.
+// Add() must be called from one thread, the getters can be called from any thread.
+class CLatencyHistogram
+{
+private:
+	static constexpr unsigned SUB_BITS  = 3; // 8 buckets per power of two, the error is less than 12.5%
+	static constexpr unsigned SUB_COUNT = 1u << SUB_BITS;
+	static constexpr unsigned BUCKETS   = SUB_COUNT + (64 - SUB_BITS) * SUB_COUNT;
+
+	std::atomic<uint32_t> m_buckets[BUCKETS] = {};
+	std::atomic<uint64_t> m_max = 0;
+
+	static unsigned GetBucket(const uint64_t value) {
+		if (value < SUB_COUNT) {
+			return (unsigned)value;
+		}
+		const unsigned exp = (unsigned)std::bit_width(value) - 1 - SUB_BITS;
+		return SUB_COUNT + exp * SUB_COUNT + (unsigned)(value >> exp) - SUB_COUNT;
+	}
+
+	// the middle of the bucket
+	static uint64_t GetBucketValue(const unsigned bucket) {
+		if (bucket < SUB_COUNT) {
+			return bucket;
+		}
+		const unsigned exp = bucket / SUB_COUNT - 1;
+		const uint64_t lower = (uint64_t)(SUB_COUNT + bucket % SUB_COUNT) << exp;
+		return lower + ((1ull << exp) >> 1);
+	}
+
+public:
+	void Reset() {
+		for (auto& bucket : m_buckets) {
+			bucket.store(0, std::memory_order_relaxed);
+		}
+		m_max.store(0, std::memory_order_relaxed);
+	}
+
+	// there is only one writer, so a read-modify-write without a locked instruction is enough
+	void Add(const uint64_t value) {
+		auto& bucket = m_buckets[GetBucket(value)];
+		bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		if (value > m_max.load(std::memory_order_relaxed)) {
+			m_max.store(value, std::memory_order_relaxed);
+		}
+	}
+
+	uint64_t GetMax() const {
+		return m_max.load(std::memory_order_relaxed);
+	}
+
+	// count - the number of values, pvalues - values of the percentiles in the range 0..100
+	void GetPercentiles(const double* percentiles, uint64_t* pvalues, const unsigned num, uint64_t& count) const {
+		uint32_t buckets[BUCKETS];
+		count = 0;
+		for (unsigned i = 0; i < BUCKETS; i++) {
+			buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+			count += buckets[i];
+		}
+
+		const uint64_t max = GetMax();
+		for (unsigned n = 0; n < num; n++) {
+			const uint64_t rank = (uint64_t)std::ceil(percentiles[n] / 100 * count);
+			uint64_t sum = 0;
+			pvalues[n] = 0;
+			for (unsigned i = 0; i < BUCKETS; i++) {
+				sum += buckets[i];
+				if (sum && sum >= rank) {
+					pvalues[n] = std::min(GetBucketValue(i), max);
+					break;
+				}
+			}
+		}
+	}
+};
+
+// histograms of the times of the rendering stages
+struct CRenderLatency {
+	CLatencyHistogram copy;
+	CLatencyHistogram subs;
+	CLatencyHistogram paint;
+	CLatencyHistogram present;
+
+	void Reset() {
+		copy.Reset();
+		subs.Reset();
+		paint.Reset();
+		present.Reset();
+	}
+};
+
 template<typename T> class CMovingAverage
 {
 private:
@@ -0,0 +1,133 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "stdafx.h"
+#include "csputils.h"
+#include "HdrSceneStats.h"
+
+static inline float PQToNits(const float pq)
+{
+	return (float)(10000.0 * mp_trc_linearize(MP_CSP_TRC_PQ, pq));
+}
+
+void MeasureHdrFrameR10G10B10A2(const BYTE* data, const UINT pitch, const UINT width, const UINT height, HdrFrameStats_t& stats)
+{
+	stats = {};
+	if (!data || !width || !height) {
+		return;
+	}
+
+	// the histogram of the 10-bit MaxRGB codes, the peak is found from the top
+	UINT histogram[1024] = {};
+	uint64_t sum = 0;
+
+	for (UINT y = 0; y < height; y++) {
+		const uint32_t* src = (const uint32_t*)(data + (size_t)pitch * y);
+		for (UINT x = 0; x < width; x++) {
+			const uint32_t v = src[x];
+			const uint32_t r = v & 0x3ff;
+			const uint32_t g = (v >> 10) & 0x3ff;
+			const uint32_t b = (v >> 20) & 0x3ff;
+			const uint32_t maxRGB = std::max(r, std::max(g, b));
+			histogram[maxRGB]++;
+			sum += maxRGB;
+		}
+	}
+
+	const UINT pixels = width * height;
+	const UINT ignore = (UINT)((uint64_t)pixels * HDR_STATS_PEAK_IGNORE / 10000);
+
+	int peak = 1023;
+	for (UINT count = 0; peak > 0; peak--) {
+		count += histogram[peak];
+		if (count > ignore) {
+			break;
+		}
+	}
+
+	stats.peakPQ   = peak / 1023.0f;
+	stats.avgPQ    = (float)((double)sum / pixels / 1023.0);
+	stats.peakNits = PQToNits(stats.peakPQ);
+	stats.avgNits  = PQToNits(stats.avgPQ);
+	stats.pixels   = pixels;
+}
+
+// CHdrSceneController
+
+CHdrSceneController::CHdrSceneController(const HdrSceneParams_t& params)
+	: m_params(params)
+{
+	m_params.smoothingFrames = std::max(m_params.smoothingFrames, 1.0f);
+	m_params.sceneCutHighPQ  = std::max(m_params.sceneCutHighPQ, m_params.sceneCutLowPQ + 1e-4f);
+}
+
+void CHdrSceneController::Reset()
+{
+	m_bValid     = false;
+	m_peakPQ     = 0.0f;
+	m_avgPQ      = 0.0f;
+	m_peakNits   = 0.0f;
+	m_avgNits    = 0.0f;
+	m_nFrames    = 0;
+	m_nSceneCuts = 0;
+}
+
+bool CHdrSceneController::Update(const HdrFrameStats_t& frame)
+{
+	if (!frame.pixels) {
+		return false;
+	}
+
+	// the weight of the new frame
+	float a = 1.0f;
+	bool bSceneCut = false;
+
+	if (m_bValid) {
+		const float delta = std::abs(frame.avgPQ - m_avgPQ);
+		if (delta >= m_params.sceneCutHighPQ) {
+			bSceneCut = true;
+			m_nSceneCuts++;
+		} else {
+			a = 1.0f / m_params.smoothingFrames;
+			if (delta > m_params.sceneCutLowPQ) {
+				const float t = (delta - m_params.sceneCutLowPQ) / (m_params.sceneCutHighPQ - m_params.sceneCutLowPQ);
+				a += (1.0f - a) * t;
+			}
+		}
+	}
+
+	m_peakPQ += (frame.peakPQ - m_peakPQ) * a;
+	m_avgPQ  += (frame.avgPQ - m_avgPQ) * a;
+	m_peakNits = PQToNits(m_peakPQ);
+	m_avgNits  = PQToNits(m_avgPQ);
+	m_bValid = true;
+	m_nFrames++;
+
+	return bSceneCut;
+}
+
+float GetHdrSceneAdaptedPeak(const float scenePeakNits, const float staticPeakNits, const float displayMaxNits)
+{
+	if (scenePeakNits <= 0.0f) {
+		return staticPeakNits;
+	}
+
+	return std::clamp(scenePeakNits, std::min(displayMaxNits, staticPeakNits), staticPeakNits);
+}
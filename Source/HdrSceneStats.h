@@ -0,0 +1,89 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+
+// The size of the decimated frame that is read back for the statistics.
+#define HDR_STATS_WIDTH  256
+#define HDR_STATS_HEIGHT 144
+// The frames between the copy of the decimated frame and its readback, so that the CPU does not wait for the GPU.
+#define HDR_STATS_LATENCY 3
+
+// The brightest pixels that are ignored by the peak, in 1/10000 of the pixels.
+#define HDR_STATS_PEAK_IGNORE 10
+
+// Statistics of one frame. Brightness is MaxRGB, the largest of the three components,
+// as the PQ signal value in the range 0..1 and in cd/m^2.
+struct HdrFrameStats_t {
+	float peakPQ   = 0.0f;
+	float avgPQ    = 0.0f; // averaged in PQ, which is close to perceptual
+	float peakNits = 0.0f;
+	float avgNits  = 0.0f;
+	UINT  pixels   = 0;
+};
+
+// Measures a decimated frame of PQ encoded RGB in DXGI_FORMAT_R10G10B10A2_UNORM.
+// Does not need a device and can run headless.
+void MeasureHdrFrameR10G10B10A2(const BYTE* data, const UINT pitch, const UINT width, const UINT height, HdrFrameStats_t& stats);
+
+struct HdrSceneParams_t {
+	float smoothingFrames = 20.0f;  // the time constant of the smoothing within a scene
+	float sceneCutLowPQ   = 0.02f;  // average changes above this speed up the smoothing
+	float sceneCutHighPQ  = 0.08f;  // average changes above this are a scene cut
+};
+
+// Smooths the frame statistics over time, so that the tone mapping does not flicker,
+// and follows a new scene at once. A scene cut is a change of the average brightness
+// against the smoothed one: between the low and high thresholds the smoothing becomes
+// gradually faster, above the high threshold the smoothed values are replaced.
+class CHdrSceneController
+{
+private:
+	HdrSceneParams_t m_params;
+
+	bool  m_bValid   = false;
+	float m_peakPQ   = 0.0f;
+	float m_avgPQ    = 0.0f;
+	float m_peakNits = 0.0f;
+	float m_avgNits  = 0.0f;
+	UINT  m_nFrames  = 0;
+	UINT  m_nSceneCuts = 0;
+
+public:
+	CHdrSceneController(const HdrSceneParams_t& params = {});
+
+	void Reset();
+	// returns true if the frame was a scene cut
+	bool Update(const HdrFrameStats_t& frame);
+
+	bool  IsValid() const { return m_bValid; }
+	// the smoothed values, 0 before the first frame
+	float GetPeakNits() const { return m_peakNits; }
+	float GetAvgNits() const { return m_avgNits; }
+	float GetPeakPQ() const { return m_peakPQ; }
+	float GetAvgPQ() const { return m_avgPQ; }
+	UINT  GetFrames() const { return m_nFrames; }
+	UINT  GetSceneCuts() const { return m_nSceneCuts; }
+};
+
+// The peak that the tone mapping pass (ps_fix_hdr10.hlsl) normalizes to instead of the static
+// peak from the metadata. It is not brighter than the static peak and not darker than the display,
+// scenes that the display can show are not compressed.
+float GetHdrSceneAdaptedPeak(const float scenePeakNits, const float staticPeakNits, const float displayMaxNits);
@@ -21,8 +21,7 @@
 #include "stdafx.h"
 #include <memory>
 #include <wincodec.h>
-#include "Utils/CPUInfo.h"
-#include "Utils/gpu_memcpy_sse4.h"
+#include <immintrin.h>
 #include "../Include/Version.h"
 #include "Helper.h"
 
@@ -221,6 +220,7 @@ static ColorFormat_t fourcc_to_cformat(const DWORD fourcc)
 	case FCC('P216'): cformat = CF_P216; break;
 	case FCC('Y210'): cformat = CF_Y210; break;
 	case FCC('Y216'): cformat = CF_Y216; break;
+	case FCC('v210'): cformat = CF_V210; break;
 	case FCC('AYUV'): cformat = CF_AYUV; break;
 	case FCC('Y410'): cformat = CF_Y410; break;
 	case FCC('Y416'): cformat = CF_Y416; break;
@@ -310,8 +310,9 @@ static const FmtConvParams_t s_FmtConvMapping[] = {
 	{CF_YUY2,      L"YUY2",      D3DFMT_YUY2,     D3DFMT_YUY2,    &DX9Plane_ARGB8, DXGI_FORMAT_YUY2,           DXGI_FORMAT_YUY2,         &DX11Plane_RGBA8,       2, 2,        CS_YUV,  422,        8 },
 	{CF_P210,      L"P210",      D3DFMT_P210,     D3DFMT_P210,     &DX9PlanesP21x, DXGI_FORMAT_UNKNOWN,        DXGI_FORMAT_PLANAR,        &DX11PlanesP21x,       2, 4,        CS_YUV,  422,       16 },
 	{CF_P216,      L"P216",      D3DFMT_P216,     D3DFMT_P216,     &DX9PlanesP21x, DXGI_FORMAT_UNKNOWN,        DXGI_FORMAT_PLANAR,        &DX11PlanesP21x,       2, 4,        CS_YUV,  422,       16 },
-	{CF_Y210,      L"Y210",      D3DFMT_UNKNOWN,  D3DFMT_UNKNOWN,         nullptr, DXGI_FORMAT_Y210,           DXGI_FORMAT_Y210,        &DX11Plane_RGBA16,       4, 2,        CS_YUV,  422,       10 },
-	{CF_Y216,      L"Y216",      D3DFMT_UNKNOWN,  D3DFMT_UNKNOWN,         nullptr, DXGI_FORMAT_Y216,           DXGI_FORMAT_Y216,        &DX11Plane_RGBA16,       4, 2,        CS_YUV,  422,       16 },
+	{CF_Y210,      L"Y210",      D3DFMT_P210,     D3DFMT_P210,     &DX9PlanesP21x, DXGI_FORMAT_Y210,           DXGI_FORMAT_Y210,        &DX11Plane_RGBA16,       4, 2,        CS_YUV,  422,       10 },
+	{CF_Y216,      L"Y216",      D3DFMT_P216,     D3DFMT_P216,     &DX9PlanesP21x, DXGI_FORMAT_Y216,           DXGI_FORMAT_Y216,        &DX11Plane_RGBA16,       4, 2,        CS_YUV,  422,       16 },
+	{CF_V210,      L"v210",      D3DFMT_P210,     D3DFMT_P210,     &DX9PlanesP21x, DXGI_FORMAT_UNKNOWN,        DXGI_FORMAT_PLANAR,        &DX11PlanesP21x,       2, 2,        CS_YUV,  422,       10 },
 	{CF_AYUV,      L"AYUV",      D3DFMT_UNKNOWN,  D3DFMT_X8R8G8B8,        nullptr, DXGI_FORMAT_AYUV,           DXGI_FORMAT_AYUV,         &DX11Plane_RGBA8,       4, 2,        CS_YUV,  444,        8 },
 	{CF_Y410,      L"Y410",      D3DFMT_Y410,     D3DFMT_A2B10G10R10,     nullptr, DXGI_FORMAT_Y410,           DXGI_FORMAT_Y410,       &DX11Plane_RGB10A2,       4, 2,        CS_YUV,  444,       10 },
 	{CF_Y416,      L"Y416",      D3DFMT_Y416,     D3DFMT_A16B16G16R16,    nullptr, DXGI_FORMAT_Y416,           DXGI_FORMAT_Y416,        &DX11Plane_RGBA16,       8, 2,        CS_YUV,  444,       16 },
@@ -353,6 +354,8 @@ static const FmtConvParams_t s_FmtConvMapping[] = {
 // Remarks:
 // 1. The table lists all possible formats. The real situation depends on the capabilities of the graphics card and drivers.
 // 2. We do not use DXVA2 processor for AYUV format, it works very poorly.
+// 3. Direct3D 9 has no packed 10-bit and 16-bit 4:2:2 formats, Y210 and Y216 are unpacked to P210 and P216 during the upload.
+//    v210 is always unpacked to P210. The pitch of v210 is not Packsize * width, see GetV210Pitch().
 
 const FmtConvParams_t& GetFmtConvParams(const ColorFormat_t fmt)
 {
@@ -366,467 +369,9 @@ const FmtConvParams_t& GetFmtConvParams(const CMediaType* pmt)
 	return GetFmtConvParams(fmt);
 }
 
-CopyFrameDataFn GetCopyPlaneFunction(const FmtConvParams_t& params, const int vp)
+std::span<const FmtConvParams_t> GetFmtConvMapping()
 {
-	switch (params.cformat) {
-	case CF_YV12:
-		if (vp == VP_DXVA2) {
-			return CopyFrameYV12;
-		}
-		break;
-	case CF_YUV420P10:
-	case CF_YUV422P10:
-	case CF_YUV444P10:
-	case CF_GBRP10:
-	case CF_Y10:
-		return CopyPlane10to16;
-	case CF_RGB24:
-		if (CPUInfo::HaveSSSE3()) {
-			return CopyFrameRGB24_SSSE3;
-		} else {
-			return CopyFrameRGB24;
-		}
-	case CF_r210:
-		return CopyFrameR210;
-	case CF_RGB48:
-		return CopyFrameRGB48;
-	case CF_BGR48:
-		return CopyFrameBGR48;
-	case CF_BGRA64:
-		return CopyFrameBGRA64;
-	case CF_B64A:
-		return CopyFrameB64A;
-	}
-
-	return CopyPlaneAsIs;
-}
-
-void CopyPlaneAsIs(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	if (dst_pitch == src_pitch) {
-		memcpy(dst, src, dst_pitch * lines);
-		return;
-	}
-
-	const UINT linesize = std::min((UINT)abs(src_pitch), dst_pitch);
-
-	for (UINT y = 0; y < lines; ++y) {
-		memcpy(dst, src, linesize);
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-}
-
-void CopyGpuFrame_SSE41(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	if (dst_pitch == src_pitch) {
-		gpu_memcpy(dst, src, dst_pitch * lines);
-		return;
-	}
-
-	const UINT linesize = std::min((UINT)abs(src_pitch), dst_pitch);
-
-	for (UINT y = 0; y < lines; ++y) {
-		gpu_memcpy(dst, src, linesize);
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-}
-
-void CopyFrameRGB24(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	UINT line_pixels  = abs(src_pitch) / 3;
-	UINT line_pixels4 = line_pixels & ~(4u - 1);
-
-	for (UINT y = 0; y < lines; ++y) {
-		uint32_t* src32 = (uint32_t*)src;
-		uint32_t* dst32 = (uint32_t*)dst;
-
-		UINT i = 0;
-		for (; i < line_pixels4; i += 4) {
-			uint32_t sa = *src32++;
-			uint32_t sb = *src32++;
-			uint32_t sc = *src32++;
-
-			*dst32++ = sa;
-			*dst32++ = (sa >> 24) | (sb << 8);
-			*dst32++ = (sb >> 16) | (sc << 16);
-			*dst32++ = sc >> 8;
-		}
-
-		if (i < line_pixels) {
-			if (line_pixels & 1) {
-				*dst32 = *src32;
-			} else {
-				uint32_t sa = *src32++;
-				uint32_t sb = *src32;
-
-				*dst32++ = sa;
-				*dst32 = (sa >> 24) | (sb << 8);
-			}
-		}
-
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-}
-
-void CopyFrameRGB24_SSSE3(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	UINT line_pixels   = abs(src_pitch) / 3;
-	UINT line_pixels4  = line_pixels & ~(4u - 1);
-	UINT line_pixels16 = line_pixels & ~(16u - 1);
-	__m128i mask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
-
-	for (UINT y = 0; y < lines; ++y) {
-		__m128i *src128 = (__m128i*)src;
-		__m128i *dst128 = (__m128i*)dst;
-
-		UINT i = 0;
-		for (; i < line_pixels16; i += 16) {
-			__m128i sa = _mm_load_si128(src128++);
-			__m128i sb = _mm_load_si128(src128++);
-			__m128i sc = _mm_load_si128(src128++);
-
-			__m128i val = _mm_shuffle_epi8(sa, mask);
-			_mm_store_si128(dst128++, val);
-			val = _mm_shuffle_epi8(_mm_alignr_epi8(sb, sa, 12), mask);
-			_mm_store_si128(dst128++, val);
-			val = _mm_shuffle_epi8(_mm_alignr_epi8(sc, sb, 8), mask);
-			_mm_store_si128(dst128++, val);
-			val = _mm_shuffle_epi8(_mm_alignr_epi8(sc, sc, 4), mask);
-			_mm_store_si128(dst128++, val);
-		}
-
-		uint32_t* src32 = (uint32_t*)src128;
-		uint32_t* dst32 = (uint32_t*)dst128;
-		for (; i < line_pixels4; i += 4) {
-			uint32_t sa = *src32++;
-			uint32_t sb = *src32++;
-			uint32_t sc = *src32++;
-
-			*dst32++ = sa;
-			*dst32++ = (sa >> 24) | (sb << 8);
-			*dst32++ = (sb >> 16) | (sc << 16);
-			*dst32++ = sc >> 8;
-		}
-
-		if (i < line_pixels) {
-			if (line_pixels & 1) {
-				*dst32 = *src32;
-			} else {
-				uint32_t sa = *src32++;
-				uint32_t sb = *src32;
-
-				*dst32++ = sa;
-				*dst32 = (sa >> 24) | (sb << 8);
-			}
-		}
-
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-}
-
-void CopyFrameRGB48(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	UINT line_pixels  = abs(src_pitch) / 6;
-	UINT line_pixels4 = line_pixels & ~(4u - 1);
-
-	for (UINT y = 0; y < lines; ++y) {
-		uint64_t* src64 = (uint64_t*)src;
-		uint64_t* dst64 = (uint64_t*)dst;
-		for (UINT i = 0; i < line_pixels4; i += 4) {
-			uint64_t sa = src64[0];
-			uint64_t sb = src64[1];
-			uint64_t sc = src64[2];
-
-			dst64[i + 0] = sa;
-			dst64[i + 1] = (sa >> 48) | (sb << 16);
-			dst64[i + 2] = (sb >> 32) | (sc << 32);
-			dst64[i + 3] = sc >> 16;
-
-			src64 += 3;
-		}
-
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-}
-
-void CopyFrameRGB48_SSSE3(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	UINT line_pixels  = abs(src_pitch) / 6;
-	UINT line_pixels8 = line_pixels & ~(8u - 1);
-
-	__m128i mask = _mm_setr_epi8(0, 1, 2, 3, 4, 5, -1, -1, 6, 7, 8, 9, 10, 11, -1, -1);
-
-	for (UINT y = 0; y < lines; ++y) {
-		__m128i *src128 = (__m128i*)src;
-		__m128i *dst128 = (__m128i*)dst;
-		for (UINT i = 0; i < line_pixels8; i += 8) {
-			__m128i sa = _mm_load_si128(src128);
-			__m128i sb = _mm_load_si128(src128 + 1);
-			__m128i sc = _mm_load_si128(src128 + 2);
-
-			__m128i val = _mm_shuffle_epi8(sa, mask);
-			_mm_store_si128(dst128, val);
-			val = _mm_shuffle_epi8(_mm_alignr_epi8(sb, sa, 12), mask);
-			_mm_store_si128(dst128 + 1, val);
-			val = _mm_shuffle_epi8(_mm_alignr_epi8(sc, sb, 8), mask);
-			_mm_store_si128(dst128 + 2, val);
-			val = _mm_shuffle_epi8(_mm_alignr_epi8(sc, sc, 4), mask);
-			_mm_store_si128(dst128 + 3, val);
-
-			src128 += 3;
-			dst128 += 4;
-		}
-
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-}
-
-void CopyFrameBGR48(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	UINT line_pixels  = abs(src_pitch) / 6;
-	UINT line_pixels4 = line_pixels & ~(4u - 1);
-
-	for (UINT y = 0; y < lines; ++y) {
-		uint64_t* src64 = (uint64_t*)src;
-		uint64_t* dst64 = (uint64_t*)dst;
-
-		UINT i = 0;
-		for (; i < line_pixels4; i += 4) {
-			uint64_t sa = *src64++;
-			uint64_t sb = *src64++;
-			uint64_t sc = *src64++;
-
-			*dst64++ = ((sa & 0xffff) << 32) | (sa & 0xffff0000) | ((sa & 0xffff00000000) >> 32);
-			*dst64++ = ((sa & 0xffff000000000000) >> 16) | ((sb & 0xffff) << 16) | ((sb & 0xffff0000) >> 16);
-			*dst64++ = (sb & 0xffff00000000) | ((sb & 0xffff000000000000) >> 32) | (sc & 0xffff);
-			*dst64++ = ((sc & 0xffff0000) << 16) | ((sc & 0xffff00000000) >> 16) | ((sc & 0xffff000000000000) >> 48);
-		}
-
-		if (UINT remainder = line_pixels - i) {
-			uint64_t sa = *src64++;
-			*dst64++ = ((sa & 0xffff) << 32) | (sa & 0xffff0000) | ((sa & 0xffff00000000) >> 32);
-
-			if (remainder==2) {
-				uint64_t sb = *(uint32_t*)src64;
-				*dst64 = ((sa & 0xffff000000000000) >> 16) | ((sb & 0xffff) << 16) | ((sb & 0xffff0000) >> 16);
-			}
-			else if (remainder == 3) {
-				uint64_t sb = *src64++;
-				uint64_t sc = *(uint32_t*)src64;
-				*dst64++ = ((sa & 0xffff000000000000) >> 16) | ((sb & 0xffff) << 16) | ((sb & 0xffff0000) >> 16);
-				*dst64 = (sb & 0xffff00000000) | ((sb & 0xffff000000000000) >> 32) | (sc & 0xffff);
-			}
-		}
-
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-}
-
-void CopyFrameBGRA64(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	UINT line_pixels = abs(src_pitch) / 8;
-
-	for (UINT y = 0; y < lines; ++y) {
-		uint64_t* src64 = (uint64_t*)src;
-		uint64_t* dst64 = (uint64_t*)dst;
-		for (UINT i = 0; i < line_pixels; ++i) {
-			dst64[i] =
-				((src64[i] & 0x000000000000ffff) << 32) |
-				((src64[i] & 0x0000ffff00000000) >> 32) |
-				( src64[i] & 0xffff0000ffff0000);
-		}
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-}
-
-void CopyFrameB64A(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	UINT line_pixels = abs(src_pitch) / 8;
-
-	for (UINT y = 0; y < lines; ++y) {
-		uint64_t* src64 = (uint64_t*)src;
-		uint64_t* dst64 = (uint64_t*)dst;
-		for (UINT i = 0; i < line_pixels; ++i) {
-			dst64[i] =
-				((src64[i] & 0xFF00FF00FF000000) >> 24) +
-				((src64[i] & 0x00FF00FF00FF0000) >>  8) +
-				((src64[i] & 0x000000000000FF00) << 40) +
-				((src64[i] & 0x00000000000000FF) << 56);
-		}
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-}
-
-void CopyFrameYV12(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	ASSERT(src_pitch > 0);
-
-	if (dst_pitch == src_pitch) {
-		memcpy(dst, src, dst_pitch * lines);
-		return;
-	}
-
-	const UINT chromaheight = lines / 3;
-	const UINT lumaheight = chromaheight * 2;
-
-	for (UINT y = 0; y < lumaheight; ++y) {
-		memcpy(dst, src, src_pitch);
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-
-	src_pitch /= 2;
-	dst_pitch /= 2;
-	for (UINT y = 0; y < chromaheight; ++y) {
-		memcpy(dst, src, src_pitch);
-		src += src_pitch;
-		dst += dst_pitch;
-		memcpy(dst, src, src_pitch);
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-}
-
-void CopyFrameY410(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	ASSERT(src_pitch > 0);
-	UINT line_pixels = src_pitch / 4;
-
-	for (UINT y = 0; y < lines; ++y) {
-		uint32_t* src32 = (uint32_t*)src;
-		uint32_t* dst32 = (uint32_t*)dst;
-		for (UINT i = 0; i < line_pixels; i++) {
-			uint32_t t = src32[i];
-			// U = (t & 0x000003ff); Y = (t & 0x000ffc00) >> 10; V = (t & 0x3ff00000) >> 20; A = (t & 0xC0000000) >> 30;
-			//dst32[i] = (t & 0xC0000000) | ((t & 0x000fffff) << 10) | ((t & 0x3ff00000) >> 20); // to D3DFMT_A2R10G10B10
-			dst32[i] = (t & 0xfff00000) | ((t & 0x000003ff) << 10) | ((t & 0x000ffc00) >> 10); // to D3DFMT_A2B10G10R10
-		}
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-}
-
-void CopyFrameR210(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	ASSERT(src_pitch > 0);
-	UINT line_pixels = src_pitch / 4;
-
-	for (UINT y = 0; y < lines; ++y) {
-		uint32_t* src32 = (uint32_t*)src;
-		uint32_t* dst32 = (uint32_t*)dst;
-		for (UINT i = 0; i < line_pixels; i++) {
-			const uint32_t t = src32[i];
-			uint32_t r = ((t & 0x0000003f) << 4) | ((t & 0x0000f000) >> 12);
-			uint32_t g = ((t & 0x00fc0000) >> 8) | ((t & 0x00000f00) << 8);
-			uint32_t b = ((t & 0xff000000) >> 4) | ((t & 0x00030000) << 12);
-			dst32[i] = r | g | b;
-		}
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-}
-
-void CopyPlane10to16(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	ASSERT(src_pitch > 0);
-	UINT line_pixels = src_pitch / 2;
-
-	for (UINT y = 0; y < lines; ++y) {
-		uint16_t* src16 = (uint16_t*)src;
-		uint16_t* dst16 = (uint16_t*)dst;
-		for (UINT i = 0; i < line_pixels; i++) {
-			dst16[i] = src16[i] << 6;
-		}
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-}
-
-void ConvertR10G10B10A2toBGR32(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	// R10G10B10A2
-	// R - 0x000003ff
-	// G - 0x000ffc00
-	// B - 0x3ff00000
-	// A - 0xc0000000
-	//
-	// BGR32 
-	// B - 0x000000ff
-	// G - 0x0000ff00
-	// R - 0x00ff0000
-	// X - 0xff000000
-
-	UINT line_pixels = abs(src_pitch) / 4;
-
-	for (UINT y = 0; y < lines; ++y) {
-		uint32_t* src32 = (uint32_t*)src;
-		uint32_t* dst32 = (uint32_t*)dst;
-		for (UINT i = 0; i < line_pixels; i++) {
-			uint32_t t = src32[i];
-			dst32[i] = ((t & 0x3fc00000) >> 22) // B
-					 | ((t & 0x000ff000) >> 4)  // G
-					 | ((t & 0x000003fc) << 14) // R
-					 | 0xff000000; // X
-		}
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-}
-
-void ConvertR10G10B10A2toBGR48(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	// R10G10B10A2
-	// R - 0x000003ff
-	// G - 0x000ffc00
-	// B - 0x3ff00000
-	// A - 0xc0000000
-	UINT line_pixels = abs(src_pitch) / 4;
-
-	for (UINT y = 0; y < lines; ++y) {
-		uint32_t* src32 = (uint32_t*)src;
-		uint16_t* dst16 = (uint16_t*)dst;
-		for (UINT i = 0; i < line_pixels; i++) {
-			uint32_t t = src32[i];
-			*dst16++ = (uint16_t)((t & 0x3ff00000) >> 14); // B
-			*dst16++ = (uint16_t)((t & 0x000ffc00) >> 4);  // G
-			*dst16++ = (uint16_t)((t & 0x000003ff) << 6);  // R 
-		}
-		src += src_pitch;
-		dst += dst_pitch;
-	}
-}
-
-void ConvertR10G10B10A2toBGR64(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
-{
-	// R10G10B10A2
-	// R - 0x000003ff
-	// G - 0x000ffc00
-	// B - 0x3ff00000
-	// A - 0xc0000000
-	UINT line_pixels = abs(src_pitch) / 4;
-
-	for (UINT y = 0; y < lines; ++y) {
-		uint32_t* src32 = (uint32_t*)src;
-		uint16_t* dst16 = (uint16_t*)dst;
-		for (UINT i = 0; i < line_pixels; i++) {
-			uint32_t t = src32[i];
-			*dst16++ = (uint16_t)((t & 0x3ff00000) >> 14); // B
-			*dst16++ = (uint16_t)((t & 0x000ffc00) >> 4);  // G
-			*dst16++ = (uint16_t)((t & 0x000003ff) << 6);  // R 
-			*dst16++ = 0xffff; // X
-		}
-		src += src_pitch;
-		dst += dst_pitch;
-	}
+	return s_FmtConvMapping;
 }
 
 void fill_u32(void* dst, uint32_t c, size_t count)
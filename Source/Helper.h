@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <span>
 #include <dxva2api.h>
 #include <mfobjects.h>
 #include "Utils/Util.h"
@@ -79,6 +80,8 @@ void SetDefaultDXVA2ProcAmpValues(DXVA2_ProcAmpValues& DXVA2ProcAmpValues);
 bool IsDefaultDXVA2ProcAmpValues(const DXVA2_ProcAmpValues& DXVA2ProcAmpValues);
 
 typedef void(*CopyFrameDataFn)(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+typedef void(*ConvertPlanarFn)(const UINT lines, BYTE* dstY, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch);
+typedef void(*UnpackPackedFn)(const UINT lines, BYTE* dstY, UINT dstY_pitch, BYTE* dstUV, UINT dstUV_pitch, const BYTE* src, int src_pitch);
 
 enum ColorFormat_t {
 	CF_NONE = 0,
@@ -90,6 +93,7 @@ enum ColorFormat_t {
 	CF_P216,
 	CF_Y210, // experimental
 	CF_Y216, // experimental
+	CF_V210,
 	CF_AYUV,
 	CF_Y410,
 	CF_Y416,
@@ -162,35 +166,124 @@ struct FmtConvParams_t {
 ColorFormat_t GetColorFormat(const CMediaType* pmt);
 const FmtConvParams_t& GetFmtConvParams(const ColorFormat_t fmt);
 const FmtConvParams_t& GetFmtConvParams(const CMediaType* pmt);
-CopyFrameDataFn GetCopyPlaneFunction(const FmtConvParams_t& params, const int vp);
+// all rows of the format table, the first one is CF_NONE
+std::span<const FmtConvParams_t> GetFmtConvMapping();
+// v210 packs 6 pixels in 16 bytes, the lines are aligned to 128 bytes
+inline UINT GetV210Pitch(const UINT width) { return (width + 47) / 48 * 128; }
+
+struct CopyKernel_t {
+	ColorFormat_t   cformat;  // CF_NONE - any format
+	int             vp;       // VP_DXVA2 ... VP_D3D11_SHADER, 0 - any video processor
+	int             features; // required CPUInfo::CPU_* instruction sets, 0 - scalar code
+	UINT            align;    // required alignment of the source pointer and pitch, 1 - any
+	const wchar_t*  name;
+	CopyFrameDataFn fn;       // for a locked or mapped upload surface, uses non-temporal stores
+	CopyFrameDataFn kernel;   // the same conversion with normal stores
+	// the planar formats that the D3D11 video processor does not accept are converted to VP11Format instead of copied,
+	// these kernels have no copy functions and are returned only by GetConvertPlanarFunction
+	DXGI_FORMAT     VP11Format = DXGI_FORMAT_UNKNOWN;
+	ConvertPlanarFn convert    = nullptr;
+};
+
+struct UnpackKernel_t {
+	ColorFormat_t  cformat;
+	int            features; // required CPUInfo::CPU_* instruction sets, 0 - scalar code
+	UnpackPackedFn fn;
+	const wchar_t* name;
+};
+
+// All registered variants, from the fastest to the scalar one for each format. For the tests.
+std::span<const CopyKernel_t> GetCopyKernels();
+std::span<const UnpackKernel_t> GetUnpackKernels();
+
+// Selects the fastest copy kernel of the format that the processor supports and that accepts
+// a source pointer and pitch aligned to srcAlign bytes.
+// The destination is a locked or mapped upload surface, the function of the kernel uses non-temporal stores.
+const CopyKernel_t& GetCopyPlaneKernel(const FmtConvParams_t& params, const int vp, const UINT srcAlign);
+CopyFrameDataFn GetCopyPlaneFunction(const FmtConvParams_t& params, const int vp, const UINT srcAlign);
+// R10G10B10A2 to BGR32, BGR48 or BGR64 DIB
+CopyFrameDataFn GetConvertR10G10B10A2Function(const UINT dib_bitdepth);
+// The D3D11 video processor does not accept planar YUV. These functions return the input format
+// of the video processor and the function that converts the planar format to it, or DXGI_FORMAT_UNKNOWN and nullptr.
+DXGI_FORMAT GetPlanarVP11Format(const ColorFormat_t cformat);
+ConvertPlanarFn GetConvertPlanarFunction(const ColorFormat_t cformat, const wchar_t** ppName = nullptr);
+// The packed 4:2:2 formats are uploaded to P210 or P216 surfaces and textures where the video processor has no packed format for them.
+// Returns the fastest function that unpacks the format to the luma and chroma planes, or nullptr.
+UnpackPackedFn GetUnpackPackedFunction(const ColorFormat_t cformat, const wchar_t** ppName = nullptr);
+
+// The SIMD variants give the same result as the scalar functions, see Tests/CopyKernelsTest.cpp.
+// The kernel tables in CopyKernels.cpp select the variant.
 
 // YUY2, AYUV, RGB32 to D3DFMT_X8R8G8B8, ARGB32 to D3DFMT_A8R8G8B8
 void CopyPlaneAsIs(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+// CopyPlaneAsIs with non-temporal stores for write-combined memory
+void CopyPlaneAsIs_Stream(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
 void CopyGpuFrame_SSE41(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void CopyGpuFrame_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
 // RGB24 to D3DFMT_X8R8G8B8
 void CopyFrameRGB24(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
 void CopyFrameRGB24_SSSE3(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch); // 30% faster than CopyFrameRGB24().
 // RGB48, b48r to D3DFMT_A16B16G16R16
 void CopyFrameRGB48(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
-void CopyFrameRGB48_SSSE3(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch); // Not faster than CopyFrameRGB48().
+void CopyFrameRGB48_SSSE3(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void CopyFrameRGB48_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
 // BGR48 to D3DFMT_A16B16G16R16
 void CopyFrameBGR48(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void CopyFrameBGR48_SSSE3(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void CopyFrameBGR48_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
 // BGRA64 to D3DFMT_A16B16G16R16
 void CopyFrameBGRA64(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void CopyFrameBGRA64_SSSE3(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void CopyFrameBGRA64_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
 // b64a to D3DFMT_A16B16G16R16
 void CopyFrameB64A(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void CopyFrameB64A_SSSE3(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void CopyFrameB64A_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
 // YV12
 void CopyFrameYV12(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
 // Y410 (not used)
 void CopyFrameY410(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
 // r210
 void CopyFrameR210(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void CopyFrameR210_SSE2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void CopyFrameR210_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
 // YUV444P10
 void CopyPlane10to16(const UINT lines, BYTE * dst, UINT dst_pitch, const BYTE * src, int src_pitch);
+void CopyPlane10to16_SSE2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void CopyPlane10to16_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+
+// Planar YUV to NV12, P010, P016 (dstUV is the chroma plane, lines must be even)
+void ConvertYUV420P8toNV12(const UINT lines, BYTE* dstY, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch);
+void ConvertYUV420P8toNV12_SSE2(const UINT lines, BYTE* dstY, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch);
+void ConvertYUV420P10toP010(const UINT lines, BYTE* dstY, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch);
+void ConvertYUV420P10toP010_SSE2(const UINT lines, BYTE* dstY, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch);
+void ConvertYUV420P16toP016(const UINT lines, BYTE* dstY, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch);
+void ConvertYUV420P16toP016_SSE2(const UINT lines, BYTE* dstY, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch);
+// Planar YUV to YUY2, Y210, Y216 (dstUV is not used)
+void ConvertYUV422P8toYUY2(const UINT lines, BYTE* dst, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch);
+void ConvertYUV422P8toYUY2_SSE2(const UINT lines, BYTE* dst, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch);
+void ConvertYUV422P10toY210(const UINT lines, BYTE* dst, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch);
+void ConvertYUV422P10toY210_SSE2(const UINT lines, BYTE* dst, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch);
+void ConvertYUV422P16toY216(const UINT lines, BYTE* dst, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch);
+void ConvertYUV422P16toY216_SSE2(const UINT lines, BYTE* dst, BYTE* dstUV, UINT dst_pitch, const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, int src_pitch);
+
+// v210 to P210, Y210 and Y216 to P210 and P216 (the luma and the chroma plane can have different pitches)
+void UnpackV210toP210(const UINT lines, BYTE* dstY, UINT dstY_pitch, BYTE* dstUV, UINT dstUV_pitch, const BYTE* src, int src_pitch);
+void UnpackV210toP210_SSSE3(const UINT lines, BYTE* dstY, UINT dstY_pitch, BYTE* dstUV, UINT dstUV_pitch, const BYTE* src, int src_pitch);
+void UnpackV210toP210_AVX2(const UINT lines, BYTE* dstY, UINT dstY_pitch, BYTE* dstUV, UINT dstUV_pitch, const BYTE* src, int src_pitch);
+void UnpackY21xtoP21x(const UINT lines, BYTE* dstY, UINT dstY_pitch, BYTE* dstUV, UINT dstUV_pitch, const BYTE* src, int src_pitch);
+void UnpackY21xtoP21x_SSE2(const UINT lines, BYTE* dstY, UINT dstY_pitch, BYTE* dstUV, UINT dstUV_pitch, const BYTE* src, int src_pitch);
+void UnpackY21xtoP21x_AVX2(const UINT lines, BYTE* dstY, UINT dstY_pitch, BYTE* dstUV, UINT dstUV_pitch, const BYTE* src, int src_pitch);
 
 void ConvertR10G10B10A2toBGR32(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void ConvertR10G10B10A2toBGR32_SSE2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void ConvertR10G10B10A2toBGR32_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
 void ConvertR10G10B10A2toBGR48(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void ConvertR10G10B10A2toBGR48_SSSE3(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void ConvertR10G10B10A2toBGR48_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
 void ConvertR10G10B10A2toBGR64(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void ConvertR10G10B10A2toBGR64_SSE2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+void ConvertR10G10B10A2toBGR64_AVX2(const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
 
 void fill_u32(void* dst, uint32_t c, size_t count);
 
@@ -84,6 +84,9 @@ enum :int {
 #define SDR_NITS_MAX 400
 #define SDR_NITS_STEP  5
 
+#define UPLOAD_THREADS_AUTO 0
+#define UPLOAD_THREADS_MAX  16
+
 #define HDR_NITS_DEF 1000.0f
 #define HDR_NITS_MIN 1.0f
 #define HDR_NITS_MAX 10000.0f
@@ -97,6 +100,7 @@ struct VPEnableFormats_t {
 
 struct Settings_t {
 	bool bUseD3D11;
+	bool bUseSoftware;
 	bool bShowStats;
 	int  iResizeStats;
 	int  iTexFormat;
@@ -125,6 +129,11 @@ struct Settings_t {
 	bool bHdrLocalToneMapping;
 	int  iHdrLocalToneMappingType;
 	float fHdrDisplayMaxNits;
+	int  iUploadThreads;
+	bool bCropBlackBars;
+	bool bZeroCopyUpload;
+	bool bTransferLut;
+	bool bHdrSceneAdaptive;
 
 	Settings_t() {
 		SetDefault();
@@ -132,6 +141,7 @@ struct Settings_t {
 
 	void SetDefault() {
 		bUseD3D11                   = true;
+		bUseSoftware                = false;
 		bShowStats                      = false;
 		iResizeStats                    = 0;
 		iTexFormat                      = TEXFMT_AUTOINT;
@@ -163,6 +173,11 @@ struct Settings_t {
 		bConvertToSdr                   = true;
 		iHdrOsdBrightness               = 0;
 		iSDRDisplayNits                 = SDR_NITS_DEF;
+		iUploadThreads                  = UPLOAD_THREADS_AUTO;
+		bCropBlackBars                  = false;
+		bZeroCopyUpload                 = false;
+		bTransferLut                    = false;
+		bHdrSceneAdaptive               = false;
 	}
 };
 
@@ -0,0 +1,306 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "stdafx.h"
+#include <emmintrin.h>
+#include "Helper.h"
+#include "LetterboxDetector.h"
+
+constexpr UINT NEAR_BARS = 4; // the bars of a candidate can move by a few lines, e.g. by compression artifacts
+
+static inline uint32_t RotateMask(const uint32_t mask, const size_t pos)
+{
+	// the mask of the 4 bytes that start at pos
+	const UINT shift = (UINT)(pos & 3) * 8;
+	return shift ? (mask >> shift) | (mask << (32 - shift)) : mask;
+}
+
+// Returns the bright samples of 16 bytes as 0 or 1 in each sample.
+static inline __m128i BrightSamples(const __m128i data, const __m128i mask, const __m128i threshold, const UINT sampleSize)
+{
+	const __m128i zero = _mm_setzero_si128();
+	if (sampleSize == 2) {
+		const __m128i over = _mm_subs_epu16(data, threshold);
+		return _mm_andnot_si128(_mm_cmpeq_epi16(over, zero), _mm_set1_epi16(1));
+	}
+	const __m128i over = _mm_subs_epu8(_mm_and_si128(data, mask), threshold);
+	return _mm_andnot_si128(_mm_cmpeq_epi8(over, zero), _mm_set1_epi8(1));
+}
+
+//
+// CLetterboxDetector
+//
+
+inline bool CLetterboxDetector::IsBright(const BYTE* p, const size_t pos) const
+{
+	if (m_sampleSize == 2) {
+		return *(const uint16_t*)(p + pos) > m_threshold;
+	}
+	return (p[pos] & (BYTE)(RotateMask(m_mask, pos))) > m_threshold;
+}
+
+size_t CLetterboxDetector::CountBright(const BYTE* p, const size_t size) const
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i mask = _mm_set1_epi32((int)m_mask);
+	const __m128i threshold = (m_sampleSize == 2) ? _mm_set1_epi16((short)m_threshold) : _mm_set1_epi8((char)m_threshold);
+
+	__m128i sum = zero;
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		const __m128i bright = BrightSamples(_mm_loadu_si128((const __m128i*)(p + i)), mask, threshold, m_sampleSize);
+		sum = _mm_add_epi64(sum, _mm_sad_epu8(bright, zero));
+	}
+	size_t count = (size_t)_mm_cvtsi128_si32(sum) + (size_t)_mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+
+	for (; i < size; i += m_sampleSize) {
+		count += IsBright(p, i);
+	}
+
+	return count;
+}
+
+bool CLetterboxDetector::IsContentRow(const BYTE* row, const size_t lineSize) const
+{
+	// a few bright samples (noise, a bright dot) do not make a row of the bar content
+	const size_t minCount = std::max(2u, m_width / 128) * m_countScale;
+
+	return CountBright(row, lineSize) > minCount;
+}
+
+UINT CLetterboxDetector::FindLeft(const BYTE* row, const UINT maxPixels) const
+{
+	const size_t size = (size_t)maxPixels * m_pixelSize;
+	const __m128i mask = _mm_set1_epi32((int)m_mask);
+	const __m128i threshold = (m_sampleSize == 2) ? _mm_set1_epi16((short)m_threshold) : _mm_set1_epi8((char)m_threshold);
+	const __m128i zero = _mm_setzero_si128();
+
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		const __m128i bright = BrightSamples(_mm_loadu_si128((const __m128i*)(row + i)), mask, threshold, m_sampleSize);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(bright, zero)) != 0xFFFF) {
+			break;
+		}
+	}
+	for (; i < size; i += m_sampleSize) {
+		if (IsBright(row, i)) {
+			return (UINT)(i / m_pixelSize);
+		}
+	}
+
+	return maxPixels;
+}
+
+UINT CLetterboxDetector::FindRight(const BYTE* row, const UINT width, const UINT maxPixels) const
+{
+	const size_t end = (size_t)width * m_pixelSize;
+	const size_t start = end - (size_t)maxPixels * m_pixelSize;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i threshold = (m_sampleSize == 2) ? _mm_set1_epi16((short)m_threshold) : _mm_set1_epi8((char)m_threshold);
+
+	size_t i = end;
+	for (; i >= start + 16; i -= 16) {
+		const __m128i mask = _mm_set1_epi32((int)RotateMask(m_mask, i - 16));
+		const __m128i bright = BrightSamples(_mm_loadu_si128((const __m128i*)(row + i - 16)), mask, threshold, m_sampleSize);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(bright, zero)) != 0xFFFF) {
+			break;
+		}
+	}
+	while (i > start) {
+		i -= m_sampleSize;
+		if (IsBright(row, i)) {
+			return (UINT)(width - 1 - i / m_pixelSize);
+		}
+	}
+
+	return maxPixels;
+}
+
+void CLetterboxDetector::Update(const Bars_t& bars)
+{
+	if (bars.left < m_bars.left || bars.top < m_bars.top) {
+		// content has appeared in the bars, it is shown at once
+		m_bars.left   = m_bars.right  = std::min(bars.left, m_bars.left);
+		m_bars.top    = m_bars.bottom = std::min(bars.top, m_bars.top);
+		m_stableFrames = 0;
+		return;
+	}
+
+	if (bars == m_bars) {
+		m_stableFrames = 0;
+		return;
+	}
+
+	// the bars are larger, they are cropped if they stay so
+	auto IsNear = [](const UINT a, const UINT b) {
+		return (a > b ? a - b : b - a) <= NEAR_BARS;
+	};
+
+	if (m_stableFrames && IsNear(bars.left, m_candidate.left) && IsNear(bars.top, m_candidate.top)) {
+		m_candidate.left = m_candidate.right  = std::min(bars.left, m_candidate.left);
+		m_candidate.top  = m_candidate.bottom = std::min(bars.top, m_candidate.top);
+		m_stableFrames++;
+	} else {
+		m_candidate = bars;
+		m_stableFrames = 1;
+	}
+
+	if (m_stableFrames >= STABLE_FRAMES) {
+		m_bars = m_candidate;
+		m_stableFrames = 0;
+	}
+}
+
+bool CLetterboxDetector::SetFormat(const FmtConvParams_t& params, const bool bFullRange)
+{
+	UINT black = (bFullRange || params.CSType == CS_RGB) ? 0 : 16;
+	UINT shift = 0;
+
+	m_sampleSize = 1;
+	m_pixelSize  = 1;
+	m_mask       = 0xFFFFFFFF;
+	m_countScale = 1;
+
+	switch (params.cformat) {
+	case CF_NV12:
+	case CF_YV12:
+	case CF_YV16:
+	case CF_YV24:
+	case CF_YUV420P8:
+	case CF_YUV422P8:
+	case CF_YUV444P8:
+	case CF_Y8:
+		break;
+	case CF_P010:
+	case CF_P016:
+	case CF_P210:
+	case CF_P216:
+	case CF_YUV420P16:
+	case CF_YUV422P16:
+	case CF_YUV444P16:
+	case CF_Y16:
+		m_sampleSize = m_pixelSize = 2;
+		shift = 8;
+		break;
+	case CF_YUV420P10:
+	case CF_YUV422P10:
+	case CF_YUV444P10:
+	case CF_Y10:
+		m_sampleSize = m_pixelSize = 2;
+		shift = 2;
+		break;
+	case CF_YUY2:
+		m_pixelSize = 2;
+		m_mask = 0x00FF00FF; // Y0 U Y1 V
+		break;
+	case CF_AYUV:
+		m_pixelSize = 4;
+		m_mask = 0x00FF0000; // V U Y A
+		break;
+	case CF_XRGB32:
+	case CF_ARGB32:
+		m_pixelSize = 4;
+		m_mask = 0x00FFFFFF; // B G R A
+		m_countScale = 3;
+		break;
+	default:
+		m_sampleSize = 0;
+		Reset();
+		return false;
+	}
+
+	m_threshold = (black + BLACK_MARGIN) << shift;
+	Reset();
+
+	return true;
+}
+
+void CLetterboxDetector::Detect(const BYTE* src, const int pitch, const UINT width, const UINT height)
+{
+	if (!m_sampleSize || width < 64 || height < 64) {
+		return;
+	}
+	if (width != m_width || height != m_height) {
+		Reset();
+		m_width  = width;
+		m_height = height;
+	}
+
+	const size_t lineSize = (size_t)width * m_pixelSize;
+	auto Row = [&](const UINT y) {
+		return src + (ptrdiff_t)pitch * y;
+	};
+
+	// the bars are at most a third of the frame, if there are no content rows
+	// the frame is black or very dark and tells nothing about the bars
+	const UINT maxLines = height / 3;
+	UINT top = 0;
+	while (top < maxLines && !IsContentRow(Row(top), lineSize)) {
+		top++;
+	}
+	if (top == maxLines) {
+		return;
+	}
+	UINT bottom = 0;
+	while (bottom < maxLines && !IsContentRow(Row(height - 1 - bottom), lineSize)) {
+		bottom++;
+	}
+	if (bottom == maxLines) {
+		return;
+	}
+
+	const UINT maxColumns = width / 3;
+	UINT left  = maxColumns;
+	UINT right = maxColumns;
+	for (UINT y = top; y < height - bottom && (left || right); y += ROW_STEP) {
+		const BYTE* row = Row(y);
+		left  = FindLeft(row, left);
+		right = FindRight(row, width, right);
+	}
+	if (left == maxColumns || right == maxColumns) {
+		return;
+	}
+
+	// the bars are cropped symmetrically, so a subtitle or a logo in one of them uncrops both,
+	// even lines and columns keep the chroma of 4:2:0 and 4:2:2 frames aligned
+	Bars_t bars;
+	const UINT v = std::min(top, bottom);
+	const UINT h = std::min(left, right);
+	if (v >= height / 100) {
+		bars.top = bars.bottom = v & ~1u;
+	}
+	if (h >= width / 100) {
+		bars.left = bars.right = h & ~1u;
+	}
+
+	Update(bars);
+}
+
+void CLetterboxDetector::Reset()
+{
+	m_bars = {};
+	m_candidate = {};
+	m_stableFrames = 0;
+}
+
+RECT CLetterboxDetector::GetActiveRect() const
+{
+	return { (LONG)m_bars.left, (LONG)m_bars.top, (LONG)(m_width - m_bars.right), (LONG)(m_height - m_bars.bottom) };
+}
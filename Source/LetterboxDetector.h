@@ -0,0 +1,83 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+
+struct FmtConvParams_t;
+
+// Finds the black bars of letterboxed and pillarboxed software-decoded frames by the luma
+// (or RGB) samples, so that the bars do not have to be uploaded and processed.
+// The bars are cropped only after they have been the same for STABLE_FRAMES frames,
+// content that appears in the bars uncrops the image at once. Black and very dark frames
+// (fades, dark scenes) do not change anything.
+class CLetterboxDetector
+{
+public:
+	static constexpr UINT STABLE_FRAMES = 48;
+	static constexpr UINT ROW_STEP      = 8;  // the rows that are searched for pillarbox bars
+	static constexpr UINT MARGIN        = 8;  // lines and columns of the bars around the active area that the scalers can read
+	static constexpr UINT BLACK_MARGIN  = 16; // samples above black + BLACK_MARGIN (8-bit scale) are content
+
+	struct Bars_t {
+		UINT left   = 0;
+		UINT top    = 0;
+		UINT right  = 0;
+		UINT bottom = 0;
+
+		bool operator==(const Bars_t& other) const {
+			return left == other.left && top == other.top && right == other.right && bottom == other.bottom;
+		}
+	};
+
+private:
+	// the layout of the samples that are compared with the threshold
+	UINT     m_sampleSize = 0;  // 1 or 2 bytes, 0 - the format is not supported
+	UINT     m_pixelSize  = 0;  // bytes
+	uint32_t m_mask       = 0;  // the bytes of each 4 bytes that are compared, for 8-bit samples
+	UINT     m_threshold  = 0;
+	UINT     m_countScale = 1;  // compared samples per pixel
+
+	UINT   m_width  = 0;
+	UINT   m_height = 0;
+	Bars_t m_bars;
+	Bars_t m_candidate;
+	UINT   m_stableFrames = 0;
+
+	size_t CountBright(const BYTE* p, const size_t size) const;
+	bool IsBright(const BYTE* p, const size_t pos) const;
+	bool IsContentRow(const BYTE* row, const size_t lineSize) const;
+	UINT FindLeft(const BYTE* row, const UINT maxPixels) const;
+	UINT FindRight(const BYTE* row, const UINT width, const UINT maxPixels) const;
+	void Update(const Bars_t& bars);
+
+public:
+	// returns false if the bars of the format are not detected
+	bool SetFormat(const FmtConvParams_t& params, const bool bFullRange);
+
+	// src is the first line of the frame (of the luma plane for planar formats), pitch can be negative
+	void Detect(const BYTE* src, const int pitch, const UINT width, const UINT height);
+
+	// the frame is not cropped until the bars are found again
+	void Reset();
+
+	bool IsCropped() const { return !(m_bars == Bars_t{}); }
+	const Bars_t& GetBars() const { return m_bars; }
+	RECT GetActiveRect() const;
+};
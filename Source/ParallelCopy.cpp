@@ -0,0 +1,182 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "stdafx.h"
+#include "Utils/CPUInfo.h"
+#include "ParallelCopy.h"
+
+CParallelCopy::~CParallelCopy()
+{
+	StopThreads();
+}
+
+void CParallelCopy::StartThreads()
+{
+	ASSERT(m_threads.empty());
+
+	m_bExit = false;
+	for (UINT i = 1; i < m_nThreads; i++) {
+		m_threads.emplace_back([this] { ThreadProc(); });
+	}
+}
+
+void CParallelCopy::StopThreads()
+{
+	if (m_threads.empty()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bExit = true;
+	}
+	m_condStart.notify_all();
+
+	for (auto& thread : m_threads) {
+		thread.join();
+	}
+	m_threads.clear();
+}
+
+void CParallelCopy::SetThreads(const int threads)
+{
+	UINT nThreads;
+	if (threads == UPLOAD_THREADS_AUTO) {
+		// memory bandwidth is usually saturated by four threads
+		nThreads = std::clamp(CPUInfo::GetProcessorNumber() / 2, 1ul, 4ul);
+	} else {
+		nThreads = std::clamp(threads, 1, UPLOAD_THREADS_MAX);
+	}
+
+	if (nThreads != m_nThreads) {
+		StopThreads();
+		m_nThreads = nThreads;
+		StartThreads();
+		DLog(L"CParallelCopy::SetThreads() : {} threads", m_nThreads);
+	}
+}
+
+void CParallelCopy::RunStripe(const Job_t& job, const UINT stripe)
+{
+	const UINT first = stripe * job.stripeLines;
+	const UINT lines = std::min(job.stripeLines, job.lines - first);
+
+	if (job.pLinesFn) {
+		(*job.pLinesFn)(first, lines);
+		return;
+	}
+
+	job.fn(lines, job.dst + (size_t)first * job.dst_pitch, job.dst_pitch, job.src + (ptrdiff_t)first * job.src_pitch, job.src_pitch);
+}
+
+void CParallelCopy::ThreadProc()
+{
+	SetThreadName(DWORD(-1), "Upload Copy Thread");
+
+	uint64_t jobIndex = 0;
+
+	for (;;) {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condStart.wait(lock, [&] { return m_bExit || m_jobIndex != jobIndex; });
+		if (m_bExit) {
+			break;
+		}
+		jobIndex = m_jobIndex;
+
+		while (m_nextStripe < m_job.stripes) {
+			const UINT stripe = m_nextStripe++;
+			const Job_t job = m_job;
+			lock.unlock();
+
+			RunStripe(job, stripe);
+
+			lock.lock();
+			if (++m_doneStripes == job.stripes) {
+				m_condDone.notify_one();
+			}
+		}
+	}
+}
+
+void CParallelCopy::CopyPlane(CopyFrameDataFn fn, const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch)
+{
+	const size_t size = (size_t)lines * dst_pitch;
+
+	if (m_threads.empty() || size < m_minParallelSize || lines < m_nThreads * 2) {
+		fn(lines, dst, dst_pitch, src, src_pitch);
+		return;
+	}
+
+	Job_t job;
+	job.fn          = fn;
+	job.lines       = lines;
+	job.dst         = dst;
+	job.dst_pitch   = dst_pitch;
+	job.src         = src;
+	job.src_pitch   = src_pitch;
+	job.stripeLines = (lines + m_nThreads - 1) / m_nThreads;
+	job.stripes     = (lines + job.stripeLines - 1) / job.stripeLines;
+
+	RunJob(job);
+}
+
+void CParallelCopy::Run(const UINT lines, const std::function<void(UINT first, UINT count)>& fn)
+{
+	if (!lines) {
+		return;
+	}
+
+	if (m_threads.empty() || lines < m_nThreads * 2) {
+		fn(0, lines);
+		return;
+	}
+
+	Job_t job;
+	job.pLinesFn    = &fn;
+	job.lines       = lines;
+	// smaller stripes balance the load when the lines are not equally expensive
+	job.stripeLines = std::max((lines + m_nThreads * 4 - 1) / (m_nThreads * 4), 1u);
+	job.stripes     = (lines + job.stripeLines - 1) / job.stripeLines;
+
+	RunJob(job);
+}
+
+void CParallelCopy::RunJob(const Job_t& job)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_job = job;
+	m_nextStripe  = 0;
+	m_doneStripes = 0;
+	m_jobIndex++;
+	m_condStart.notify_all();
+
+	// the calling thread works too
+	while (m_nextStripe < job.stripes) {
+		const UINT stripe = m_nextStripe++;
+		lock.unlock();
+
+		RunStripe(job, stripe);
+
+		lock.lock();
+		m_doneStripes++;
+	}
+
+	m_condDone.wait(lock, [&] { return m_doneStripes == job.stripes; });
+}
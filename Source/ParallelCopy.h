@@ -0,0 +1,79 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "Helper.h"
+#include "IVideoRenderer.h"
+
+// Splits a plane copy into horizontal stripes and runs them on persistent worker threads.
+// The copy function must process each line independently (all CopyFrameDataFn except CopyFrameYV12).
+// Run() uses the same threads for any other work that can be split by lines.
+class CParallelCopy
+{
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_condStart;
+	std::condition_variable m_condDone;
+
+	struct Job_t {
+		CopyFrameDataFn fn = nullptr;
+		UINT   lines       = 0;
+		BYTE*  dst         = nullptr;
+		UINT   dst_pitch   = 0;
+		const BYTE* src    = nullptr;
+		int    src_pitch   = 0;
+		UINT   stripeLines = 0;
+		UINT   stripes     = 0;
+		const std::function<void(UINT first, UINT count)>* pLinesFn = nullptr; // Run()
+	} m_job;
+
+	UINT m_nextStripe   = 0; // protected by m_mutex
+	UINT m_doneStripes  = 0; // protected by m_mutex
+	uint64_t m_jobIndex = 0; // protected by m_mutex
+	bool m_bExit        = false;
+
+	UINT m_nThreads = 1; // including the calling thread
+	size_t m_minParallelSize = 2 * 1024 * 1024;
+
+	void ThreadProc();
+	void RunStripe(const Job_t& job, const UINT stripe);
+	void RunJob(const Job_t& job);
+	void StartThreads();
+	void StopThreads();
+
+public:
+	CParallelCopy() = default;
+	~CParallelCopy();
+
+	// threads: UPLOAD_THREADS_AUTO or the number of threads including the calling thread
+	void SetThreads(const int threads);
+	UINT GetThreads() const { return m_nThreads; }
+	// planes smaller than this are copied on the calling thread
+	void SetMinParallelSize(const size_t size) { m_minParallelSize = size; }
+
+	void CopyPlane(CopyFrameDataFn fn, const UINT lines, BYTE* dst, UINT dst_pitch, const BYTE* src, int src_pitch);
+	// calls fn for consecutive ranges of lines, returns when all lines are done
+	void Run(const UINT lines, const std::function<void(UINT first, UINT count)>& fn);
+};
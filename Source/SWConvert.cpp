@@ -0,0 +1,732 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "stdafx.h"
+#include <numbers>
+#include <emmintrin.h>
+#include <DirectXPackedVector.h>
+#include "SWConvert.h"
+
+#define COEF_SHIFT   18 // fraction bits of the matrix coefficients
+#define WEIGHT_SHIFT 14 // fraction bits of the resize weights
+#define LUT_SHIFT    6  // fraction bits of the 3D LUT nodes
+
+//
+// CSWColorConvert
+//
+
+static inline int16_t Expand8(const unsigned v)
+{
+	return (int16_t)((v << 6) | (v >> 2));
+}
+
+static inline int16_t Expand10(unsigned v)
+{
+	v &= 0x3ff;
+	return (int16_t)((v << 4) | (v >> 6));
+}
+
+static inline int16_t Expand16(const unsigned v)
+{
+	return (int16_t)(v >> 2);
+}
+
+static void ReadSamples(const BYTE* src, const int bits, const UINT step, const UINT count, int16_t* dst)
+{
+	if (bits == 8) {
+		for (UINT i = 0; i < count; i++) {
+			dst[i] = Expand8(src[i * step]);
+		}
+	} else {
+		const uint16_t* src16 = (const uint16_t*)src;
+		if (bits == 10) {
+			for (UINT i = 0; i < count; i++) {
+				dst[i] = Expand10(src16[i * step]);
+			}
+		} else {
+			for (UINT i = 0; i < count; i++) {
+				dst[i] = Expand16(src16[i * step]);
+			}
+		}
+	}
+}
+
+// left (co-sited) chroma
+static void UpsampleChromaH(const int16_t* src, const UINT srcWidth, int16_t* dst, const UINT dstWidth, const bool nearest)
+{
+	for (UINT x = 0; x < dstWidth; x++) {
+		const UINT i = x / 2;
+		if ((x & 1) && !nearest) {
+			const UINT i2 = std::min(i + 1, srcWidth - 1);
+			dst[x] = (int16_t)((src[i] + src[i2] + 1) >> 1);
+		} else {
+			dst[x] = src[i];
+		}
+	}
+}
+
+bool CSWColorConvert::IsFormatSupported(const ColorFormat_t cformat)
+{
+	switch (cformat) {
+	case CF_NV12:
+	case CF_P010:
+	case CF_P016:
+	case CF_P210:
+	case CF_P216:
+	case CF_YUY2:
+	case CF_AYUV:
+	case CF_Y410:
+	case CF_Y416:
+	case CF_YV12:
+	case CF_YV16:
+	case CF_YV24:
+	case CF_YUV420P8:
+	case CF_YUV422P8:
+	case CF_YUV444P8:
+	case CF_YUV420P10:
+	case CF_YUV420P16:
+	case CF_YUV422P10:
+	case CF_YUV422P16:
+	case CF_YUV444P10:
+	case CF_YUV444P16:
+	case CF_GBRP8:
+	case CF_GBRP10:
+	case CF_GBRP16:
+	case CF_RGB24:
+	case CF_XRGB32:
+	case CF_ARGB32:
+	case CF_Y8:
+	case CF_Y10:
+	case CF_Y16:
+		return true;
+	}
+	return false;
+}
+
+bool CSWColorConvert::IsLutRequired(const ColorChain_t& chain)
+{
+	return chain.bConvertHDRtoSDR || chain.bConvertHLGtoPQ || chain.gammaToLinear > 0.0f || chain.hdr10.bEnable;
+}
+
+HRESULT CSWColorConvert::Init(const FmtConvParams_t& params, const UINT width, const UINT height, const int chromaScaling, const mp_cmat& cmatrix, const ColorChain_t* pChain)
+{
+	if (!IsFormatSupported(params.cformat) || !width || !height) {
+		return E_INVALIDARG;
+	}
+
+	m_cformat = params.cformat;
+	m_width   = width;
+	m_height  = height;
+	m_bChromaNearest = (chromaScaling == CHROMA_Nearest);
+
+	// out = (m * in / 16383 + c) * 255
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			const double k = cmatrix.m[i][j] * 255.0 / 16383.0 * (1 << COEF_SHIFT);
+			m_coefs[i][j] = (int16_t)std::clamp(std::lround(k), -24576l, 24576l); // no int32 overflow for any input
+		}
+		const double c = cmatrix.c[i] * 255.0 * (1 << COEF_SHIFT);
+		m_offsets[i] = (int32_t)std::clamp(std::llround(c), -(1ll << 28), 1ll << 28) + (1 << (COEF_SHIFT - 1));
+	}
+
+	m_lut.clear();
+	m_lutSize = 0;
+
+	if (pChain) {
+		std::vector<uint16_t> lut;
+		HRESULT hr = BakeColorLut3D(*pChain, SW_LUT3D_SIZE, lut);
+		if (FAILED(hr)) {
+			return hr;
+		}
+
+		const size_t nodes = (size_t)SW_LUT3D_SIZE * SW_LUT3D_SIZE * SW_LUT3D_SIZE;
+		m_lut.resize(nodes * 3);
+		for (size_t i = 0; i < nodes; i++) {
+			for (int c = 0; c < 3; c++) {
+				const float v = DirectX::PackedVector::XMConvertHalfToFloat(lut[i * 4 + c]);
+				m_lut[i * 3 + c] = (int16_t)std::lround((v > 0.0f ? std::min(v, 1.0f) : 0.0f) * (255 << LUT_SHIFT)); // NaN gives 0
+			}
+		}
+		m_lutSize = SW_LUT3D_SIZE;
+	}
+
+	return S_OK;
+}
+
+void CSWColorConvert::GetPlanes(BYTE* data, const int pitch, const UINT lines, SWPlanes_t& planes) const
+{
+	planes = {};
+
+	const int absPitch = abs(pitch);
+	const int h = (int)lines;
+
+	switch (m_cformat) {
+	case CF_RGB24:
+	case CF_XRGB32:
+	case CF_ARGB32:
+		// bottom-up if the pitch is negative
+		planes.data[0]  = (pitch < 0) ? data + absPitch * (h - 1) : data;
+		planes.pitch[0] = pitch;
+		return;
+	case CF_NV12:
+	case CF_P010:
+	case CF_P016:
+	case CF_P210:
+	case CF_P216:
+		planes.data[0]  = data;
+		planes.pitch[0] = absPitch;
+		planes.data[1]  = data + absPitch * h;
+		planes.pitch[1] = absPitch;
+		return;
+	case CF_YUY2:
+	case CF_AYUV:
+	case CF_Y410:
+	case CF_Y416:
+	case CF_Y8:
+	case CF_Y10:
+	case CF_Y16:
+		planes.data[0]  = data;
+		planes.pitch[0] = absPitch;
+		return;
+	}
+
+	// three planes
+	const auto& params = GetFmtConvParams(m_cformat);
+	const int divW = (params.Subsampling == 444) ? 1 : 2;
+	const int divH = (params.Subsampling == 420) ? 2 : 1;
+	const int chromaPitch = absPitch / divW;
+
+	BYTE* plane2 = data + absPitch * h;
+	BYTE* plane3 = plane2 + chromaPitch * (h / divH);
+
+	planes.data[0]  = data;
+	planes.pitch[0] = absPitch;
+	planes.pitch[1] = planes.pitch[2] = chromaPitch;
+
+	switch (m_cformat) {
+	case CF_YV12:
+	case CF_YV16:
+	case CF_YV24:
+		planes.data[1] = plane3; // U
+		planes.data[2] = plane2; // V
+		break;
+	default:
+		planes.data[1] = plane2;
+		planes.data[2] = plane3;
+	}
+}
+
+void CSWColorConvert::UnpackLine(const SWPlanes_t& src, const UINT y, int16_t* Y, int16_t* U, int16_t* V, int16_t* tmp) const
+{
+	const UINT w = m_width;
+	const BYTE* line = src.data[0] + (ptrdiff_t)src.pitch[0] * y;
+
+	// packed formats
+	switch (m_cformat) {
+	case CF_RGB24:
+		// texture values are R, G, B
+		ReadSamples(line + 2, 8, 3, w, Y);
+		ReadSamples(line + 1, 8, 3, w, U);
+		ReadSamples(line + 0, 8, 3, w, V);
+		return;
+	case CF_XRGB32:
+	case CF_ARGB32:
+		ReadSamples(line + 2, 8, 4, w, Y);
+		ReadSamples(line + 1, 8, 4, w, U);
+		ReadSamples(line + 0, 8, 4, w, V);
+		return;
+	case CF_AYUV:
+		ReadSamples(line + 2, 8, 4, w, Y);
+		ReadSamples(line + 1, 8, 4, w, U);
+		ReadSamples(line + 0, 8, 4, w, V);
+		return;
+	case CF_Y410: {
+		const uint32_t* p = (const uint32_t*)line;
+		for (UINT x = 0; x < w; x++) {
+			const uint32_t v = p[x];
+			U[x] = Expand10(v);
+			Y[x] = Expand10(v >> 10);
+			V[x] = Expand10(v >> 20);
+		}
+		return;
+	}
+	case CF_Y416:
+		ReadSamples(line + 2, 16, 4, w, Y);
+		ReadSamples(line + 0, 16, 4, w, U);
+		ReadSamples(line + 4, 16, 4, w, V);
+		return;
+	case CF_Y8:
+	case CF_Y10:
+	case CF_Y16:
+		ReadSamples(line, (m_cformat == CF_Y8) ? 8 : (m_cformat == CF_Y10) ? 10 : 16, 1, w, Y);
+		memset(U, 0, w * sizeof(int16_t));
+		memset(V, 0, w * sizeof(int16_t));
+		return;
+	case CF_YUY2: {
+		const UINT cw = (w + 1) / 2;
+		ReadSamples(line, 8, 2, w, Y);
+		ReadSamples(line + 1, 8, 4, cw, tmp);
+		ReadSamples(line + 3, 8, 4, cw, tmp + cw);
+		UpsampleChromaH(tmp, cw, U, w, m_bChromaNearest);
+		UpsampleChromaH(tmp + cw, cw, V, w, m_bChromaNearest);
+		return;
+	}
+	}
+
+	// planar and semi-planar formats
+	const auto& params = GetFmtConvParams(m_cformat);
+	const bool semiPlanar = !src.data[2];
+	const int  bits = params.CDepth; // 16 for P01x and P21x, they are MSB aligned
+	const UINT sampleSize = (bits > 8) ? 2 : 1;
+	const bool divW = params.Subsampling != 444;
+	const bool divH = params.Subsampling == 420;
+	const UINT cw = divW ? (w + 1) / 2 : w;
+
+	if (m_cformat == CF_GBRP8 || m_cformat == CF_GBRP10 || m_cformat == CF_GBRP16) {
+		// texture values are R, G, B
+		ReadSamples(src.data[2] + (ptrdiff_t)src.pitch[2] * y, bits, 1, w, Y);
+		ReadSamples(line, bits, 1, w, U);
+		ReadSamples(src.data[1] + (ptrdiff_t)src.pitch[1] * y, bits, 1, w, V);
+		return;
+	}
+
+	ReadSamples(line, bits, 1, w, Y);
+
+	auto ReadChroma = [&](const UINT cy, int16_t* cu, int16_t* cv) {
+		if (semiPlanar) {
+			const BYTE* p = src.data[1] + (ptrdiff_t)src.pitch[1] * cy;
+			ReadSamples(p, bits, 2, cw, cu);
+			ReadSamples(p + sampleSize, bits, 2, cw, cv);
+		} else {
+			ReadSamples(src.data[1] + (ptrdiff_t)src.pitch[1] * cy, bits, 1, cw, cu);
+			ReadSamples(src.data[2] + (ptrdiff_t)src.pitch[2] * cy, bits, 1, cw, cv);
+		}
+	};
+
+	int16_t* cu = divW ? tmp : U;
+	int16_t* cv = divW ? tmp + cw : V;
+
+	if (divH) {
+		// center (MPEG-2) vertical chroma position
+		const UINT ch = std::max(m_height / 2, 1u);
+		const UINT k = std::min(y / 2, ch - 1);
+		ReadChroma(k, cu, cv);
+
+		const UINT k2 = (y & 1) ? std::min(k + 1, ch - 1) : (k ? k - 1 : 0);
+		if (!m_bChromaNearest && k2 != k) {
+			int16_t* cu2 = tmp + cw * 2;
+			int16_t* cv2 = tmp + cw * 3;
+			ReadChroma(k2, cu2, cv2);
+			for (UINT i = 0; i < cw; i++) {
+				cu[i] = (int16_t)((cu[i] * 3 + cu2[i] + 2) >> 2);
+				cv[i] = (int16_t)((cv[i] * 3 + cv2[i] + 2) >> 2);
+			}
+		}
+	} else {
+		ReadChroma(y, cu, cv);
+	}
+
+	if (divW) {
+		UpsampleChromaH(cu, cw, U, w, m_bChromaNearest);
+		UpsampleChromaH(cv, cw, V, w, m_bChromaNearest);
+	}
+}
+
+void CSWColorConvert::MatrixLine(const int16_t* Y, const int16_t* U, const int16_t* V, BYTE* dst) const
+{
+	const UINT w = m_width;
+	UINT x = 0;
+
+	__m128i kYU[3], kV[3], off[3];
+	for (int i = 0; i < 3; i++) {
+		kYU[i] = _mm_set1_epi32((int)((uint32_t)(uint16_t)m_coefs[i][1] << 16 | (uint16_t)m_coefs[i][0]));
+		kV[i]  = _mm_set1_epi32((int)(uint16_t)m_coefs[i][2]);
+		off[i] = _mm_set1_epi32(m_offsets[i]);
+	}
+	const __m128i zero  = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi8(-1);
+
+	for (; x + 8 <= w; x += 8) {
+		const __m128i y = _mm_loadu_si128((const __m128i*)(Y + x));
+		const __m128i u = _mm_loadu_si128((const __m128i*)(U + x));
+		const __m128i v = _mm_loadu_si128((const __m128i*)(V + x));
+
+		const __m128i yu_lo = _mm_unpacklo_epi16(y, u);
+		const __m128i yu_hi = _mm_unpackhi_epi16(y, u);
+		const __m128i v_lo  = _mm_unpacklo_epi16(v, zero);
+		const __m128i v_hi  = _mm_unpackhi_epi16(v, zero);
+
+		__m128i c[3];
+		for (int i = 0; i < 3; i++) {
+			__m128i lo = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(yu_lo, kYU[i]), _mm_madd_epi16(v_lo, kV[i])), off[i]);
+			__m128i hi = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(yu_hi, kYU[i]), _mm_madd_epi16(v_hi, kV[i])), off[i]);
+			lo = _mm_srai_epi32(lo, COEF_SHIFT);
+			hi = _mm_srai_epi32(hi, COEF_SHIFT);
+			c[i] = _mm_packus_epi16(_mm_packs_epi32(lo, hi), zero); // R, G, B
+		}
+
+		const __m128i bg = _mm_unpacklo_epi8(c[2], c[1]);
+		const __m128i ra = _mm_unpacklo_epi8(c[0], alpha);
+		_mm_storeu_si128((__m128i*)(dst + x * 4), _mm_unpacklo_epi16(bg, ra));
+		_mm_storeu_si128((__m128i*)(dst + x * 4 + 16), _mm_unpackhi_epi16(bg, ra));
+	}
+
+	for (; x < w; x++) {
+		for (int i = 0; i < 3; i++) {
+			const int32_t sum = m_coefs[i][0] * Y[x] + m_coefs[i][1] * U[x] + m_coefs[i][2] * V[x] + m_offsets[i];
+			dst[x * 4 + 2 - i] = (BYTE)std::clamp(sum >> COEF_SHIFT, 0, 255);
+		}
+		dst[x * 4 + 3] = 0xFF;
+	}
+}
+
+void CSWColorConvert::LutLine(const int16_t* Y, const int16_t* U, const int16_t* V, BYTE* dst) const
+{
+	const int n = (int)m_lutSize;
+	const int last = n - 1;
+	const int16_t* lut = m_lut.data();
+	const int strideG = n * 3;
+	const int strideB = n * n * 3;
+
+	for (UINT x = 0; x < m_width; x++) {
+		// 14-bit input, the top value 16383 stays in the last cell
+		const int pr = std::clamp<int>(Y[x], 0, 16383) * last;
+		const int pg = std::clamp<int>(U[x], 0, 16383) * last;
+		const int pb = std::clamp<int>(V[x], 0, 16383) * last;
+		const int fr = pr & 0x3fff;
+		const int fg = pg & 0x3fff;
+		const int fb = pb & 0x3fff;
+
+		const int16_t* c000 = lut + (pb >> 14) * strideB + (pg >> 14) * strideG + (pr >> 14) * 3;
+		const int16_t* c111 = c000 + strideB + strideG + 3;
+
+		// tetrahedral interpolation, the same cells as SampleColorLut3D()
+		const int16_t* c1;
+		const int16_t* c2;
+		int f0, f1, f2;
+		if (fr >= fg) {
+			if (fg >= fb) {      // r > g > b
+				c1 = c000 + 3; c2 = c000 + 3 + strideG; f0 = fr; f1 = fg; f2 = fb;
+			}
+			else if (fr >= fb) { // r > b > g
+				c1 = c000 + 3; c2 = c000 + 3 + strideB; f0 = fr; f1 = fb; f2 = fg;
+			}
+			else {               // b > r > g
+				c1 = c000 + strideB; c2 = c000 + strideB + 3; f0 = fb; f1 = fr; f2 = fg;
+			}
+		}
+		else {
+			if (fb >= fg) {      // b > g > r
+				c1 = c000 + strideB; c2 = c000 + strideB + strideG; f0 = fb; f1 = fg; f2 = fr;
+			}
+			else if (fb >= fr) { // g > b > r
+				c1 = c000 + strideG; c2 = c000 + strideG + strideB; f0 = fg; f1 = fb; f2 = fr;
+			}
+			else {               // g > r > b
+				c1 = c000 + strideG; c2 = c000 + strideG + 3; f0 = fg; f1 = fr; f2 = fb;
+			}
+		}
+
+		for (int i = 0; i < 3; i++) {
+			const int sum = (0x4000 - f0) * c000[i] + (f0 - f1) * c1[i] + (f1 - f2) * c2[i] + f2 * c111[i];
+			const int v = (sum + (1 << (13 + LUT_SHIFT))) >> (14 + LUT_SHIFT);
+			dst[x * 4 + 2 - i] = (BYTE)std::clamp(v, 0, 255);
+		}
+		dst[x * 4 + 3] = 0xFF;
+	}
+}
+
+void CSWColorConvert::Convert(const SWPlanes_t& src, const UINT first, const UINT count, BYTE* dst, const UINT dst_pitch) const
+{
+	const UINT w = m_width;
+	std::vector<int16_t> buffer((size_t)w * 7);
+	int16_t* Y   = buffer.data();
+	int16_t* U   = Y + w;
+	int16_t* V   = U + w;
+	int16_t* tmp = V + w;
+
+	dst += (size_t)first * dst_pitch;
+
+	for (UINT y = first; y < first + count; y++) {
+		UnpackLine(src, y, Y, U, V, tmp);
+		if (m_lutSize) {
+			LutLine(Y, U, V, dst);
+		} else {
+			MatrixLine(Y, U, V, dst);
+		}
+		dst += dst_pitch;
+	}
+}
+
+//
+// CSWResampler
+//
+
+static double Sinc(const double x)
+{
+	if (x == 0.0) {
+		return 1.0;
+	}
+	const double px = x * std::numbers::pi;
+	return sin(px) / px;
+}
+
+// Mitchell-Netravali family
+static double CubicBC(double x, const double B, const double C)
+{
+	x = fabs(x);
+	if (x < 1.0) {
+		return ((12 - 9 * B - 6 * C) * x * x * x + (-18 + 12 * B + 6 * C) * x * x + (6 - 2 * B)) / 6;
+	}
+	if (x < 2.0) {
+		return ((-B - 6 * C) * x * x * x + (6 * B + 30 * C) * x * x + (-12 * B - 48 * C) * x + (8 * B + 24 * C)) / 6;
+	}
+	return 0.0;
+}
+
+// Keys cubic with the "a" parameter
+static double CubicKeys(double x, const double a)
+{
+	x = fabs(x);
+	if (x < 1.0) {
+		return ((a + 2) * x - (a + 3)) * x * x + 1;
+	}
+	if (x < 2.0) {
+		return (((x - 5) * x + 8) * x - 4) * a;
+	}
+	return 0.0;
+}
+
+static double FilterSupport(const SWFilter_t filter)
+{
+	switch (filter) {
+	case SWFILTER_Box:      return 0.5;
+	case SWFILTER_Bilinear:
+	case SWFILTER_Hamming:  return 1.0;
+	case SWFILTER_Lanczos3: return 3.0;
+	default:                return 2.0;
+	}
+}
+
+static double FilterValue(const SWFilter_t filter, const double x)
+{
+	switch (filter) {
+	case SWFILTER_Box:          return (x >= -0.5 && x < 0.5) ? 1.0 : 0.0;
+	case SWFILTER_Bilinear:     return std::max(1.0 - fabs(x), 0.0);
+	case SWFILTER_Hamming:      return (fabs(x) < 1.0) ? Sinc(x) * (0.54 + 0.46 * cos(x * std::numbers::pi)) : 0.0;
+	case SWFILTER_Mitchell:     return CubicBC(x, 1.0 / 3, 1.0 / 3);
+	case SWFILTER_CatmullRom:   return CubicKeys(x, -0.5);
+	case SWFILTER_BicubicSharp: return CubicKeys(x, -1.5);
+	case SWFILTER_Lanczos2:     return (fabs(x) < 2.0) ? Sinc(x) * Sinc(x / 2) : 0.0;
+	case SWFILTER_Lanczos3:     return (fabs(x) < 3.0) ? Sinc(x) * Sinc(x / 3) : 0.0;
+	}
+	return 0.0;
+}
+
+void CSWResampler::InitAxis(Axis_t& axis, const UINT srcSize, const UINT dstSize, const SWFilter_t filter)
+{
+	const double scale  = (double)srcSize / dstSize;
+	const double fscale = std::max(scale, 1.0); // the filter is stretched for downscaling
+	const double support = FilterSupport(filter) * fscale;
+
+	UINT taps = (UINT)ceil(support) * 2 + 1;
+	taps = std::min(taps, srcSize);
+
+	axis.srcSize = srcSize;
+	axis.dstSize = dstSize;
+	axis.taps    = taps;
+	axis.start.resize(dstSize);
+	axis.weights.assign((size_t)dstSize * taps, 0);
+
+	std::vector<double> w(taps);
+
+	for (UINT i = 0; i < dstSize; i++) {
+		const double center = (i + 0.5) * scale;
+		int first = (int)floor(center - support + 0.5);
+		int last  = (int)floor(center + support + 0.5); // exclusive
+		first = std::max(first, 0);
+		last  = std::min(last, (int)srcSize);
+		if (last - first > (int)taps) {
+			const int excess = last - first - taps;
+			first += excess / 2;
+			last = first + taps;
+		}
+
+		// keep the whole set inside the source, weights outside of [first, last) are zero
+		const UINT start = std::min((UINT)first, srcSize - taps);
+		axis.start[i] = start;
+
+		double sum = 0.0;
+		for (UINT t = 0; t < taps; t++) {
+			const int s = (int)(start + t);
+			w[t] = (s >= first && s < last) ? FilterValue(filter, (s + 0.5 - center) / fscale) : 0.0;
+			sum += w[t];
+		}
+		if (sum == 0.0) {
+			// can only happen with the box filter, use the nearest source pixel
+			const UINT s = std::min((UINT)center, srcSize - 1);
+			for (UINT t = 0; t < taps; t++) {
+				w[t] = (start + t == s) ? 1.0 : 0.0;
+			}
+			sum = 1.0;
+		}
+
+		int16_t* iw = &axis.weights[(size_t)i * taps];
+		int isum = 0;
+		UINT tmax = 0;
+		for (UINT t = 0; t < taps; t++) {
+			iw[t] = (int16_t)std::lround(w[t] / sum * (1 << WEIGHT_SHIFT));
+			isum += iw[t];
+			if (iw[t] > iw[tmax]) {
+				tmax = t;
+			}
+		}
+		iw[tmax] += (int16_t)((1 << WEIGHT_SHIFT) - isum); // exact unity gain
+	}
+}
+
+HRESULT CSWResampler::Init(const UINT srcWidth, const UINT srcHeight, const UINT dstWidth, const UINT dstHeight, const CRect& clip,
+	const SWFilter_t filterX, const SWFilter_t filterY)
+{
+	m_axisX = {};
+	m_axisY = {};
+
+	if (!srcWidth || !srcHeight || !dstWidth || !dstHeight || clip.IsRectEmpty()
+			|| clip.left < 0 || clip.top < 0 || clip.right > (LONG)dstWidth || clip.bottom > (LONG)dstHeight) {
+		return E_INVALIDARG;
+	}
+
+	InitAxis(m_axisX, srcWidth, dstWidth, filterX);
+	InitAxis(m_axisY, srcHeight, dstHeight, filterY);
+
+	m_clip = clip;
+	m_tempPitch = ALIGN(clip.Width() * 4, 16);
+	m_temp.resize((size_t)m_tempPitch * srcHeight);
+
+	return S_OK;
+}
+
+void CSWResampler::PassX(const BYTE* src, const int src_pitch, const UINT first, const UINT count)
+{
+	const UINT taps = m_axisX.taps;
+	const __m128i zero  = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi32(1 << (WEIGHT_SHIFT - 1));
+
+	for (UINT y = first; y < first + count; y++) {
+		const BYTE* s = src + (ptrdiff_t)src_pitch * y;
+		uint32_t* d = (uint32_t*)(m_temp.data() + (size_t)m_tempPitch * y);
+
+		for (LONG x = m_clip.left; x < m_clip.right; x++) {
+			const uint32_t* p = (const uint32_t*)s + m_axisX.start[x];
+			const int16_t* w = &m_axisX.weights[(size_t)x * taps];
+
+			__m128i acc = round;
+			UINT t = 0;
+			for (; t + 2 <= taps; t += 2) {
+				const __m128i p01 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(p[t]), _mm_cvtsi32_si128(p[t + 1]));
+				const __m128i w01 = _mm_set1_epi32((int)((uint32_t)(uint16_t)w[t + 1] << 16 | (uint16_t)w[t]));
+				acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi8(p01, zero), w01));
+			}
+			if (t < taps) {
+				const __m128i p0 = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(p[t]), zero), zero);
+				acc = _mm_add_epi32(acc, _mm_madd_epi16(p0, _mm_set1_epi32((uint16_t)w[t])));
+			}
+			acc = _mm_srai_epi32(acc, WEIGHT_SHIFT);
+			acc = _mm_packs_epi32(acc, acc);
+			*d++ = (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(acc, acc));
+		}
+	}
+}
+
+void CSWResampler::PassY(BYTE* dst, const int dst_pitch, const UINT first, const UINT count) const
+{
+	const UINT taps  = m_axisY.taps;
+	const UINT bytes = m_clip.Width() * 4;
+	const __m128i zero  = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi32(1 << (WEIGHT_SHIFT - 1));
+
+	for (UINT line = first; line < first + count; line++) {
+		const UINT y = m_clip.top + line;
+		const BYTE* rows = m_temp.data() + (size_t)m_tempPitch * m_axisY.start[y];
+		const int16_t* w = &m_axisY.weights[(size_t)y * taps];
+		BYTE* d = dst + (ptrdiff_t)dst_pitch * line;
+
+		UINT i = 0;
+		for (; i + 16 <= bytes; i += 16) {
+			__m128i acc0 = round, acc1 = round, acc2 = round, acc3 = round;
+			for (UINT t = 0; t < taps; t += 2) {
+				const __m128i a = _mm_loadu_si128((const __m128i*)(rows + (size_t)m_tempPitch * t + i));
+				__m128i b, w01;
+				if (t + 1 < taps) {
+					b = _mm_loadu_si128((const __m128i*)(rows + (size_t)m_tempPitch * (t + 1) + i));
+					w01 = _mm_set1_epi32((int)((uint32_t)(uint16_t)w[t + 1] << 16 | (uint16_t)w[t]));
+				} else {
+					b = zero;
+					w01 = _mm_set1_epi32((uint16_t)w[t]);
+				}
+				const __m128i lo = _mm_unpacklo_epi8(a, b);
+				const __m128i hi = _mm_unpackhi_epi8(a, b);
+				acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w01));
+				acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w01));
+				acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w01));
+				acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w01));
+			}
+			const __m128i r01 = _mm_packs_epi32(_mm_srai_epi32(acc0, WEIGHT_SHIFT), _mm_srai_epi32(acc1, WEIGHT_SHIFT));
+			const __m128i r23 = _mm_packs_epi32(_mm_srai_epi32(acc2, WEIGHT_SHIFT), _mm_srai_epi32(acc3, WEIGHT_SHIFT));
+			_mm_storeu_si128((__m128i*)(d + i), _mm_packus_epi16(r01, r23));
+		}
+		for (; i < bytes; i++) {
+			int sum = 1 << (WEIGHT_SHIFT - 1);
+			for (UINT t = 0; t < taps; t++) {
+				sum += w[t] * rows[(size_t)m_tempPitch * t + i];
+			}
+			d[i] = (BYTE)std::clamp(sum >> WEIGHT_SHIFT, 0, 255);
+		}
+	}
+}
+
+//
+// Rotation
+//
+
+void RotateFrameRGB32(
+	const BYTE* src, const int src_pitch, const UINT srcWidth, const UINT srcHeight,
+	BYTE* dst, const int dst_pitch, const int rotation, const bool flip,
+	const UINT first, const UINT count)
+{
+	const UINT dstWidth = (rotation == 90 || rotation == 270) ? srcHeight : srcWidth;
+
+	for (UINT dy = first; dy < first + count; dy++) {
+		uint32_t* d = (uint32_t*)(dst + (ptrdiff_t)dst_pitch * dy);
+		for (UINT dx = 0; dx < dstWidth; dx++) {
+			UINT sx, sy;
+			switch (rotation) {
+			case 90:  sx = dy;                sy = srcHeight - 1 - dx; break;
+			case 180: sx = srcWidth - 1 - dx; sy = srcHeight - 1 - dy; break;
+			case 270: sx = srcWidth - 1 - dy; sy = dx;                 break;
+			default:  sx = dx;                sy = dy;                 break;
+			}
+			if (flip) {
+				sx = srcWidth - 1 - sx;
+			}
+			d[dx] = *((const uint32_t*)(src + (ptrdiff_t)src_pitch * sy) + sx);
+		}
+	}
+}
@@ -0,0 +1,124 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+
+#include "Helper.h"
+#include "ColorLut.h"
+
+// CPU versions of the colour conversion and resize passes for the software video processor.
+// Every kernel works on a range of output lines, so the work can be split with CParallelCopy::Run().
+// The SSE2 code gives the same result as the scalar code.
+
+#define SW_LUT3D_SIZE 33
+
+struct SWPlanes_t {
+	const BYTE* data[3] = {};
+	int pitch[3] = {};
+};
+
+// Converts a system memory frame to X8R8G8B8.
+// Samples are expanded to 14-bit texture values, chroma is upsampled to the luma size,
+// then the colour matrix is applied in fixed point or the colour chain is sampled from a 3D LUT.
+class CSWColorConvert
+{
+	ColorFormat_t m_cformat = CF_NONE;
+	UINT m_width  = 0;
+	UINT m_height = 0;
+	bool m_bChromaNearest = false;
+
+	int16_t m_coefs[3][3] = {}; // 14-bit input, 18-bit fraction
+	int32_t m_offsets[3]  = {};
+
+	std::vector<int16_t> m_lut; // SW_LUT3D_SIZE^3 RGB nodes, 8-bit output with 6-bit fraction
+	UINT m_lutSize = 0;
+
+	void UnpackLine(const SWPlanes_t& src, const UINT y, int16_t* Y, int16_t* U, int16_t* V, int16_t* tmp) const;
+	void MatrixLine(const int16_t* Y, const int16_t* U, const int16_t* V, BYTE* dst) const;
+	void LutLine(const int16_t* Y, const int16_t* U, const int16_t* V, BYTE* dst) const;
+
+public:
+	static bool IsFormatSupported(const ColorFormat_t cformat);
+	// chain stages other than the matrix need the 3D LUT
+	static bool IsLutRequired(const ColorChain_t& chain);
+
+	// cmatrix converts texture values to RGB as in the conversion shader, but without the GBRP swizzle.
+	// pChain - the colour chain to bake into the 3D LUT, nullptr - use the matrix only.
+	HRESULT Init(const FmtConvParams_t& params, const UINT width, const UINT height, const int chromaScaling, const mp_cmat& cmatrix, const ColorChain_t* pChain);
+	bool IsLutUsed() const { return m_lutSize > 0; }
+
+	// plane pointers of a sample, pitch is the luma pitch as in CopySample,
+	// lines is the height of the luma plane in the buffer, it can be larger than the frame height
+	void GetPlanes(BYTE* data, const int pitch, const UINT lines, SWPlanes_t& planes) const;
+
+	void Convert(const SWPlanes_t& src, const UINT first, const UINT count, BYTE* dst, const UINT dst_pitch) const;
+};
+
+enum SWFilter_t {
+	SWFILTER_Box = 0, // nearest-neighbor for upscaling
+	SWFILTER_Bilinear,
+	SWFILTER_Hamming,
+	SWFILTER_Mitchell,
+	SWFILTER_CatmullRom,
+	SWFILTER_BicubicSharp,
+	SWFILTER_Lanczos2,
+	SWFILTER_Lanczos3,
+};
+
+// Separable two pass resize of X8R8G8B8 images with 14-bit integer weights.
+class CSWResampler
+{
+	struct Axis_t {
+		UINT srcSize = 0;
+		UINT dstSize = 0;
+		UINT taps    = 0;
+		std::vector<UINT> start;      // first source pixel of each destination pixel
+		std::vector<int16_t> weights; // dstSize * taps, the sum of each set is 1 << 14
+	};
+	Axis_t m_axisX;
+	Axis_t m_axisY;
+
+	CRect m_clip; // the part of the destination that is calculated
+	std::vector<BYTE> m_temp; // horizontal pass output, m_clip.Width() x srcHeight
+	UINT m_tempPitch = 0;
+
+	static void InitAxis(Axis_t& axis, const UINT srcSize, const UINT dstSize, const SWFilter_t filter);
+
+public:
+	// clip - the visible part of the dstWidth x dstHeight destination
+	HRESULT Init(const UINT srcWidth, const UINT srcHeight, const UINT dstWidth, const UINT dstHeight, const CRect& clip,
+		const SWFilter_t filterX, const SWFilter_t filterY);
+	bool IsInit() const { return m_axisX.dstSize > 0; }
+
+	UINT GetSrcHeight() const { return m_axisY.srcSize; }
+	UINT GetClipHeight() const { return m_clip.Height(); }
+
+	// source lines to the intermediate buffer
+	void PassX(const BYTE* src, const int src_pitch, const UINT first, const UINT count);
+	// clip lines from the intermediate buffer, dst points to the top left of the clip
+	void PassY(BYTE* dst, const int dst_pitch, const UINT first, const UINT count) const;
+};
+
+// Copies the rectangle of an X8R8G8B8 image with a horizontal flip and then a clockwise rotation,
+// as the DX9 and DX11 processors do. first and count are destination lines.
+void RotateFrameRGB32(
+	const BYTE* src, const int src_pitch, const UINT srcWidth, const UINT srcHeight,
+	BYTE* dst, const int dst_pitch, const int rotation, const bool flip,
+	const UINT first, const UINT count);
@@ -0,0 +1,1194 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "stdafx.h"
+#include <Mferror.h>
+#include "Times.h"
+#include "VideoRenderer.h"
+#include "../Include/Version.h"
+#include "SWVideoProcessor.h"
+#include "Shaders.h"
+#include "Utils/CPUInfo.h"
+
+struct SWScaling_t {
+	SWFilter_t filter;
+	const wchar_t* description;
+};
+
+// Jinc2 is not separable, Lanczos2 is the closest of the separable filters
+static const SWScaling_t s_UpscalingSW[UPSCALE_COUNT] = {
+	{SWFILTER_Box,        L"Nearest-neighbor"  },
+	{SWFILTER_Mitchell,   L"Mitchell-Netravali"},
+	{SWFILTER_CatmullRom, L"Catmull-Rom"       },
+	{SWFILTER_Lanczos2,   L"Lanczos2"          },
+	{SWFILTER_Lanczos3,   L"Lanczos3"          },
+	{SWFILTER_Lanczos2,   L"Lanczos2"          },
+};
+
+static const SWScaling_t s_DownscalingSW[DOWNSCALE_COUNT] = {
+	{SWFILTER_Box,          L"Box"          },
+	{SWFILTER_Bilinear,     L"Bilinear"     },
+	{SWFILTER_Hamming,      L"Hamming"      },
+	{SWFILTER_CatmullRom,   L"Bicubic"      },
+	{SWFILTER_BicubicSharp, L"Bicubic sharp"},
+	{SWFILTER_Lanczos3,     L"Lanczos"      }
+};
+
+// darkens the rectangle as the D3DCOLOR_ARGB(80, 0, 0, 0) stats background does
+static void DarkenRect(BYTE* bits, const UINT pitch, const UINT width, const UINT height, RECT rect)
+{
+	rect.left   = std::clamp(rect.left,   0l, (LONG)width);
+	rect.right  = std::clamp(rect.right,  0l, (LONG)width);
+	rect.top    = std::clamp(rect.top,    0l, (LONG)height);
+	rect.bottom = std::clamp(rect.bottom, 0l, (LONG)height);
+
+	for (LONG y = rect.top; y < rect.bottom; y++) {
+		BYTE* p = bits + (size_t)pitch * y + rect.left * 4;
+		for (LONG x = rect.left * 4; x < rect.right * 4; x++) {
+			*p = (BYTE)((*p * (255 - 80) + 127) / 255);
+			p++;
+		}
+	}
+}
+
+CSWVideoProcessor::CSWVideoProcessor(CMpcVideoRenderer* pFilter, const Settings_t& config, HRESULT& hr)
+	: CVideoProcessor(pFilter)
+{
+	m_bShowStats           = config.bShowStats;
+	m_iResizeStats         = config.iResizeStats;
+	m_iChromaScaling       = config.iChromaScaling;
+	m_iUpscaling           = config.iUpscaling;
+	m_iDownscaling         = config.iDownscaling;
+	m_bInterpolateAt50pct  = config.bInterpolateAt50pct;
+	m_bAdjustPresentTime   = config.bAdjustPresentTime;
+	m_bHdrPassthrough      = false;
+	m_iHdrToggleDisplay    = HDRTD_Disabled;
+	m_bConvertToSdr        = true; // GDI output is always SDR
+	m_iSDRDisplayNits      = config.iSDRDisplayNits;
+
+	m_nCurrentAdapter = 0;
+	m_strAdapterDescription = L"none (software)";
+
+	// conversion and scaling are limited by the CPU, not by the memory bandwidth
+	m_Workers.SetThreads(std::clamp((int)CPUInfo::GetProcessorNumber(), 1, UPLOAD_THREADS_MAX));
+
+	// set default ProcAmp ranges and values
+	SetDefaultDXVA2ProcAmpRanges(m_DXVA2ProcAmpRanges);
+	SetDefaultDXVA2ProcAmpValues(m_DXVA2ProcAmpValues);
+
+	hr = S_OK;
+}
+
+CSWVideoProcessor::~CSWVideoProcessor()
+{
+	m_pFilter->m_pSubPicQueue.Release();
+	m_pSubPicAllocator.Release();
+
+	ReleaseVP();
+	ReleaseDib();
+
+	if (m_hStatsFont) {
+		DeleteObject(m_hStatsFont);
+	}
+}
+
+HRESULT CSWVideoProcessor::Init(const HWND hwnd, const bool displayHdrChanged, bool* pChangeDevice/* = nullptr*/)
+{
+	DLog(L"CSWVideoProcessor::Init()");
+
+	m_hWnd = hwnd;
+
+	if (pChangeDevice) {
+		*pChangeDevice = false;
+	}
+
+	if (m_srcParams.cformat) {
+		UpdateStatsStatic();
+	}
+
+	return S_OK;
+}
+
+void CSWVideoProcessor::ReleaseVP()
+{
+	DLog(L"CSWVideoProcessor::ReleaseVP()");
+
+	m_pFilter->ResetStreamingTimes2();
+	m_RenderStats.Reset();
+	m_RenderLatency.Reset();
+
+	m_Frame.clear();
+	m_Rotated.clear();
+	m_FramePitch  = 0;
+	m_bFrameReady = false;
+	m_ResamplerParams = {};
+	m_strCorrection = nullptr;
+
+	m_srcParams = {};
+	m_srcWidth  = 0;
+	m_srcHeight = 0;
+}
+
+void CSWVideoProcessor::ReleaseDib()
+{
+	if (m_hDibDC) {
+		SelectObject(m_hDibDC, m_hOldBitmap);
+		DeleteDC(m_hDibDC);
+		m_hDibDC = nullptr;
+	}
+	if (m_hDib) {
+		DeleteObject(m_hDib);
+		m_hDib = nullptr;
+	}
+	m_hOldBitmap = nullptr;
+	m_pDibBits   = nullptr;
+	m_DibWidth   = 0;
+	m_DibHeight  = 0;
+	m_DibPitch   = 0;
+}
+
+HRESULT CSWVideoProcessor::CheckDib(const UINT width, const UINT height)
+{
+	if (m_pDibBits && width == m_DibWidth && height == m_DibHeight) {
+		return S_OK;
+	}
+
+	ReleaseDib();
+
+	if (!width || !height) {
+		return E_ABORT;
+	}
+
+	BITMAPINFO bmi = {};
+	bmi.bmiHeader.biSize        = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth       = width;
+	bmi.bmiHeader.biHeight      = -(LONG)height; // top-down
+	bmi.bmiHeader.biPlanes      = 1;
+	bmi.bmiHeader.biBitCount    = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	m_hDibDC = CreateCompatibleDC(nullptr);
+	if (!m_hDibDC) {
+		return E_FAIL;
+	}
+
+	m_hDib = CreateDIBSection(m_hDibDC, &bmi, DIB_RGB_COLORS, (void**)&m_pDibBits, nullptr, 0);
+	if (!m_hDib || !m_pDibBits) {
+		DLog(L"CSWVideoProcessor::CheckDib() : CreateDIBSection() failed for {}x{}", width, height);
+		ReleaseDib();
+		return E_OUTOFMEMORY;
+	}
+	m_hOldBitmap = SelectObject(m_hDibDC, m_hDib);
+
+	m_DibWidth  = width;
+	m_DibHeight = height;
+	m_DibPitch  = width * 4;
+
+	return S_OK;
+}
+
+HRESULT CSWVideoProcessor::UpdateConvertParams()
+{
+	mp_csp_params csp_params;
+	set_colorspace(m_srcExFmt, csp_params.color);
+	csp_params.brightness = DXVA2FixedToFloat(m_DXVA2ProcAmpValues.Brightness) / 255;
+	csp_params.contrast = DXVA2FixedToFloat(m_DXVA2ProcAmpValues.Contrast);
+	csp_params.hue = DXVA2FixedToFloat(m_DXVA2ProcAmpValues.Hue) / 180 * acos(-1);
+	csp_params.saturation = DXVA2FixedToFloat(m_DXVA2ProcAmpValues.Saturation);
+	csp_params.gray = m_srcParams.CSType == CS_GRAY;
+
+	csp_params.input_bits = csp_params.texture_bits = m_srcParams.CDepth;
+
+	mp_cmat cmatrix;
+	mp_get_csp_matrix(&csp_params, &cmatrix);
+
+	ColorChain_t chain;
+	GetColorChain(chain, m_srcExFmt, cmatrix, SHADER_CONVERT_TO_SDR, 10000.0f / m_iSDRDisplayNits);
+
+	m_strCorrection = nullptr;
+	const bool bUseLut = CSWColorConvert::IsLutRequired(chain);
+	if (bUseLut) {
+		if (m_srcExFmt.VideoTransferFunction == MFVideoTransFunc_2084) {
+			m_strCorrection = L"PQ to SDR";
+		}
+		else if (m_srcExFmt.VideoTransferFunction == MFVideoTransFunc_HLG) {
+			m_strCorrection = L"HLG to SDR";
+		}
+		else {
+			m_strCorrection = L"Fix BT.2020";
+		}
+	}
+
+	HRESULT hr = m_Convert.Init(m_srcParams, m_srcWidth, m_srcHeight, m_iChromaScaling, cmatrix, bUseLut ? &chain : nullptr);
+	DLogIf(FAILED(hr), L"CSWVideoProcessor::UpdateConvertParams() : m_Convert.Init() failed with error {}", HR2Str(hr));
+
+	return hr;
+}
+
+void CSWVideoProcessor::UpdateRenderRect()
+{
+	m_renderRect.IntersectRect(m_videoRect, m_windowRect);
+	UpdateScalingStrings();
+}
+
+SWFilter_t CSWVideoProcessor::GetScalingFilter(const UINT srcSize, const UINT dstSize)
+{
+	const UINT k = m_bInterpolateAt50pct ? 2 : 1;
+
+	return (srcSize == dstSize) ? SWFILTER_Box
+		: (srcSize > k * dstSize)
+		? s_DownscalingSW[m_iDownscaling].filter
+		: s_UpscalingSW[m_iUpscaling].filter;
+}
+
+void CSWVideoProcessor::UpdateScalingStrings()
+{
+	const int w2 = m_videoRect.Width();
+	const int h2 = m_videoRect.Height();
+	const int k = m_bInterpolateAt50pct ? 2 : 1;
+	int w1, h1;
+	if (m_iRotation == 90 || m_iRotation == 270) {
+		w1 = m_srcRectHeight;
+		h1 = m_srcRectWidth;
+	} else {
+		w1 = m_srcRectWidth;
+		h1 = m_srcRectHeight;
+	}
+	m_strShaderX = (w1 == w2) ? nullptr
+		: (w1 > k * w2)
+		? s_DownscalingSW[m_iDownscaling].description
+		: s_UpscalingSW[m_iUpscaling].description;
+	m_strShaderY = (h1 == h2) ? nullptr
+		: (h1 > k * h2)
+		? s_DownscalingSW[m_iDownscaling].description
+		: s_UpscalingSW[m_iUpscaling].description;
+}
+
+void CSWVideoProcessor::CalcStatsParams()
+{
+	if (!m_windowRect.IsRectEmpty()) {
+		if (m_hStatsFont) {
+			DeleteObject(m_hStatsFont);
+		}
+		m_hStatsFont = CreateFontW(-m_StatsFontH, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET,
+			OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, NONANTIALIASED_QUALITY, FIXED_PITCH | FF_MODERN, L"Consolas");
+
+		HDC hdc = CreateCompatibleDC(nullptr);
+		if (hdc) {
+			HGDIOBJ hOldFont = SelectObject(hdc, m_hStatsFont);
+			TEXTMETRICW tm = {};
+			if (GetTextMetricsW(hdc, &tm)) {
+				m_StatsRect.right  = m_StatsRect.left + 61 * tm.tmAveCharWidth + 5 + 3;
+				m_StatsRect.bottom = m_StatsRect.top + 19 * tm.tmHeight + 5 + 3;
+			}
+			SelectObject(hdc, hOldFont);
+			DeleteDC(hdc);
+		}
+
+		CalcGraphParams();
+	}
+}
+
+BOOL CSWVideoProcessor::VerifyMediaType(const CMediaType* pmt)
+{
+	const auto& FmtParams = GetFmtConvParams(pmt);
+	if (!CSWColorConvert::IsFormatSupported(FmtParams.cformat)) {
+		return FALSE;
+	}
+
+	const BITMAPINFOHEADER* pBIH = GetBIHfromVIHs(pmt);
+	if (!pBIH) {
+		return FALSE;
+	}
+
+	if (pBIH->biWidth <= 0 || !pBIH->biHeight || (!pBIH->biSizeImage && pBIH->biCompression != BI_RGB)) {
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+BOOL CSWVideoProcessor::GetAlignmentSize(const CMediaType& mt, SIZE& Size)
+{
+	if (InitMediaType(&mt)) {
+		const auto& FmtParams = GetFmtConvParams(&mt);
+
+		// system memory frames can use any pitch, only keep the DWORD alignment of DIBs
+		if (FmtParams.cformat == CF_RGB24) {
+			Size.cx = ALIGN(Size.cx, 4);
+		}
+
+		if (FmtParams.cformat == CF_RGB24 || FmtParams.cformat == CF_XRGB32 || FmtParams.cformat == CF_ARGB32) {
+			Size.cy = -abs(Size.cy); // only for biCompression == BI_RGB
+		} else {
+			Size.cy = abs(Size.cy); // need additional checks
+		}
+
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+BOOL CSWVideoProcessor::InitMediaType(const CMediaType* pmt)
+{
+	DLog(L"CSWVideoProcessor::InitMediaType()");
+
+	if (!VerifyMediaType(pmt)) {
+		return FALSE;
+	}
+
+	ReleaseVP();
+
+	const auto& FmtParams = GetFmtConvParams(pmt);
+
+	const BITMAPINFOHEADER* pBIH = nullptr;
+	m_decExFmt.value = 0;
+
+	if (pmt->formattype == FORMAT_VideoInfo2) {
+		const VIDEOINFOHEADER2* vih2 = (VIDEOINFOHEADER2*)pmt->pbFormat;
+		pBIH = &vih2->bmiHeader;
+		m_srcRect = vih2->rcSource;
+		m_srcAspectRatioX = vih2->dwPictAspectRatioX;
+		m_srcAspectRatioY = vih2->dwPictAspectRatioY;
+		if (FmtParams.CSType == CS_YUV && (vih2->dwControlFlags & (AMCONTROL_USED | AMCONTROL_COLORINFO_PRESENT))) {
+			m_decExFmt.value = vih2->dwControlFlags;
+			m_decExFmt.SampleFormat = AMCONTROL_USED | AMCONTROL_COLORINFO_PRESENT; // ignore other flags
+		}
+		m_bInterlaced = (vih2->dwInterlaceFlags & AMINTERLACE_IsInterlaced);
+		m_rtAvgTimePerFrame = vih2->AvgTimePerFrame;
+	}
+	else if (pmt->formattype == FORMAT_VideoInfo) {
+		const VIDEOINFOHEADER* vih = (VIDEOINFOHEADER*)pmt->pbFormat;
+		pBIH = &vih->bmiHeader;
+		m_srcRect = vih->rcSource;
+		m_srcAspectRatioX = 0;
+		m_srcAspectRatioY = 0;
+		m_bInterlaced = 0;
+		m_rtAvgTimePerFrame = vih->AvgTimePerFrame;
+	}
+	else {
+		return FALSE;
+	}
+
+	m_pFilter->m_FrameStats.SetStartFrameDuration(m_rtAvgTimePerFrame);
+	m_pFilter->m_bValidBuffer = false;
+
+	UINT biWidth  = pBIH->biWidth;
+	UINT biHeight = labs(pBIH->biHeight);
+
+	m_srcLines = biHeight * FmtParams.PitchCoeff / 2;
+	m_srcPitch = biWidth * FmtParams.Packsize;
+	switch (FmtParams.cformat) {
+	case CF_Y8:
+	case CF_NV12:
+	case CF_RGB24:
+		m_srcPitch = ALIGN(m_srcPitch, 4);
+		break;
+	}
+	if (pBIH->biCompression == BI_RGB && pBIH->biHeight > 0) {
+		m_srcPitch = -m_srcPitch;
+	}
+
+	UINT origW = biWidth;
+	UINT origH = biHeight;
+	if (pmt->FormatLength() == 112 + sizeof(VR_Extradata)) {
+		const VR_Extradata* vrextra = reinterpret_cast<VR_Extradata*>(pmt->pbFormat + 112);
+		if (vrextra->QueryWidth == pBIH->biWidth && vrextra->QueryHeight == pBIH->biHeight && vrextra->Compression == pBIH->biCompression) {
+			origW  = vrextra->FrameWidth;
+			origH = abs(vrextra->FrameHeight);
+		}
+	}
+
+	if (m_srcRect.IsRectNull()) {
+		m_srcRect.SetRect(0, 0, origW, origH);
+	}
+	m_srcRectWidth  = m_srcRect.Width();
+	m_srcRectHeight = m_srcRect.Height();
+
+	m_srcExFmt = SpecifyExtendedFormat(m_decExFmt, FmtParams, m_srcRectWidth, m_srcRectHeight);
+
+	const auto frm_gcd = std::gcd(m_srcRectWidth, m_srcRectHeight);
+	const auto srcFrameARX = m_srcRectWidth / frm_gcd;
+	const auto srcFrameARY = m_srcRectHeight / frm_gcd;
+
+	if (!m_srcAspectRatioX || !m_srcAspectRatioY) {
+		m_srcAspectRatioX = srcFrameARX;
+		m_srcAspectRatioY = srcFrameARY;
+		m_srcAnamorphic = false;
+	}
+	else {
+		const auto ar_gcd = std::gcd(m_srcAspectRatioX, m_srcAspectRatioY);
+		m_srcAspectRatioX /= ar_gcd;
+		m_srcAspectRatioY /= ar_gcd;
+		m_srcAnamorphic = (srcFrameARX != m_srcAspectRatioX || srcFrameARY != m_srcAspectRatioY);
+	}
+
+	m_srcParams = FmtParams;
+	m_srcWidth  = origW;
+	m_srcHeight = origH;
+
+	// set default ProcAmp ranges
+	SetDefaultDXVA2ProcAmpRanges(m_DXVA2ProcAmpRanges);
+
+	HRESULT hr = UpdateConvertParams();
+	if (SUCCEEDED(hr)) {
+		m_FramePitch = m_srcWidth * 4;
+		m_Frame.assign((size_t)m_FramePitch * m_srcHeight, 0);
+
+		UpdateScalingStrings();
+		UpdateStatsStatic();
+
+		m_pFilter->m_inputMT = *pmt;
+
+		return TRUE;
+	}
+
+	ReleaseVP();
+
+	return FALSE;
+}
+
+HRESULT CSWVideoProcessor::ProcessSample(IMediaSample* pSample)
+{
+	REFERENCE_TIME rtStart, rtEnd;
+	if (FAILED(pSample->GetTime(&rtStart, &rtEnd))) {
+		rtStart = m_pFilter->m_FrameStats.GeTimestamp();
+	}
+
+	m_rtStart = rtStart;
+	CRefTime rtClock(rtStart);
+
+	HRESULT hr = CopySample(pSample);
+	if (FAILED(hr)) {
+		m_RenderStats.failed++;
+		return hr;
+	}
+	hr = Render(1, rtStart);
+	m_pFilter->m_DrawStats.Add(GetPreciseTick());
+	if (m_pFilter->m_filterState == State_Running) {
+		m_pFilter->StreamTime(rtClock);
+	}
+
+	m_RenderStats.syncoffset = rtClock - rtStart;
+
+	int so = (int)std::clamp(m_RenderStats.syncoffset, -UNITS, UNITS);
+#if SYNC_OFFSET_EX
+	m_SyncDevs.Add(so - m_Syncs.Last());
+#endif
+	m_Syncs.Add(so);
+
+	return hr;
+}
+
+HRESULT CSWVideoProcessor::CopySample(IMediaSample* pSample)
+{
+	uint64_t tick = GetPreciseTick();
+
+	// there is no deinterlacer, the fields are weaved
+	m_bFieldsFrame = false;
+	m_bDoubleFrames = false;
+	if (m_bInterlaced) {
+		if (CComQIPtr<IMediaSample2> pMS2 = pSample) {
+			AM_SAMPLE2_PROPERTIES props;
+			if (SUCCEEDED(pMS2->GetProperties(sizeof(props), (BYTE*)&props))) {
+				m_bFieldsFrame = (props.dwTypeSpecificFlags & AM_VIDEO_FLAG_WEAVE) == 0;
+			}
+		}
+	}
+
+	m_FieldDrawn = 0;
+
+	if (CComQIPtr<IMediaSideData> pMediaSideData = pSample) {
+		size_t size = 0;
+		MediaSideData3DOffset* offset = nullptr;
+		HRESULT hr = pMediaSideData->GetSideData(IID_MediaSideData3DOffset, (const BYTE**)&offset, &size);
+		if (SUCCEEDED(hr) && size == sizeof(MediaSideData3DOffset) && offset->offset_count > 0 && offset->offset[0]) {
+			m_nStereoSubtitlesOffsetInPixels = offset->offset[0];
+		}
+	}
+
+	if (m_iSrcFromGPU != 0) {
+		m_iSrcFromGPU = 0;
+		UpdateStatsStatic();
+	}
+
+	BYTE* data = nullptr;
+	const long size = pSample->GetActualDataLength();
+	if (size <= 0 || S_OK != pSample->GetPointer(&data)) {
+		return S_FALSE;
+	}
+	if (m_srcParams.cformat == CF_NONE || m_Frame.empty()) {
+		return E_FAIL;
+	}
+	if ((size_t)size < (size_t)abs(m_srcPitch) * m_srcLines) {
+		DLog(L"CSWVideoProcessor::CopySample() : the sample is too small ({} bytes)", size);
+		return E_UNEXPECTED;
+	}
+
+	SWPlanes_t planes;
+	m_Convert.GetPlanes(data, m_srcPitch, m_srcLines * 2 / m_srcParams.PitchCoeff, planes);
+
+	m_Workers.Run(m_srcHeight, [&](UINT first, UINT count) {
+		m_Convert.Convert(planes, first, count, m_Frame.data(), m_FramePitch);
+	});
+	m_bFrameReady = true;
+
+	m_RenderStats.copyticks = GetPreciseTick() - tick;
+	m_RenderLatency.copy.Add(m_RenderStats.copyticks);
+
+	return S_OK;
+}
+
+HRESULT CSWVideoProcessor::Process(BYTE* dst, const UINT dst_pitch, const CRect& clipRect, const CRect& srcRect, const CRect& dstRect)
+{
+	CRect clip;
+	if (!m_bFrameReady || !clip.IntersectRect(clipRect, dstRect)) {
+		return S_FALSE;
+	}
+
+	const BYTE* src = m_Frame.data() + (size_t)m_FramePitch * srcRect.top + srcRect.left * 4;
+	int  src_pitch  = m_FramePitch;
+	UINT srcW = srcRect.Width();
+	UINT srcH = srcRect.Height();
+
+	if (m_iRotation || m_bFlip) {
+		const UINT rotW = (m_iRotation == 90 || m_iRotation == 270) ? srcH : srcW;
+		const UINT rotH = (m_iRotation == 90 || m_iRotation == 270) ? srcW : srcH;
+		m_Rotated.resize((size_t)rotW * rotH * 4);
+
+		m_Workers.Run(rotH, [&](UINT first, UINT count) {
+			RotateFrameRGB32(src, src_pitch, srcW, srcH, m_Rotated.data(), rotW * 4, m_iRotation, m_bFlip, first, count);
+		});
+
+		src       = m_Rotated.data();
+		src_pitch = rotW * 4;
+		srcW      = rotW;
+		srcH      = rotH;
+	}
+
+	const UINT dstW = dstRect.Width();
+	const UINT dstH = dstRect.Height();
+	CRect rClip(clip);
+	rClip.OffsetRect(-dstRect.left, -dstRect.top);
+	const SWFilter_t filterX = GetScalingFilter(srcW, dstW);
+	const SWFilter_t filterY = GetScalingFilter(srcH, dstH);
+
+	auto& p = m_ResamplerParams;
+	if (p.srcW != srcW || p.srcH != srcH || p.dstW != dstW || p.dstH != dstH || p.clip != rClip || p.filterX != filterX || p.filterY != filterY) {
+		HRESULT hr = m_Resampler.Init(srcW, srcH, dstW, dstH, rClip, filterX, filterY);
+		if (FAILED(hr)) {
+			p = {};
+			return hr;
+		}
+		p.srcW = srcW;
+		p.srcH = srcH;
+		p.dstW = dstW;
+		p.dstH = dstH;
+		p.clip = rClip;
+		p.filterX = filterX;
+		p.filterY = filterY;
+	}
+
+	m_Workers.Run(srcH, [&](UINT first, UINT count) {
+		m_Resampler.PassX(src, src_pitch, first, count);
+	});
+
+	BYTE* out = dst + (size_t)dst_pitch * clip.top + clip.left * 4;
+	m_Workers.Run(clip.Height(), [&](UINT first, UINT count) {
+		m_Resampler.PassY(out, dst_pitch, first, count);
+	});
+
+	return S_OK;
+}
+
+void CSWVideoProcessor::ClearOutput()
+{
+	GdiFlush();
+	memset(m_pDibBits, 0, (size_t)m_DibPitch * m_DibHeight);
+}
+
+void CSWVideoProcessor::DrawSubtitles()
+{
+	CComPtr<ISubPic> pSubPic = m_pFilter->GetSubPic(m_rtStart);
+	if (pSubPic) {
+		RECT rcSource, rcDest;
+		HRESULT hr = pSubPic->GetSourceAndDest(m_windowRect, m_videoRect, &rcSource, &rcDest, FALSE, {}, 0, FALSE);
+		if (SUCCEEDED(hr)) {
+			SubPicDesc target;
+			target.w     = m_DibWidth;
+			target.h     = m_DibHeight;
+			target.bpp   = 32;
+			target.pitch = m_DibPitch;
+			target.bits  = m_pDibBits;
+			hr = pSubPic->AlphaBlt(&rcSource, &rcDest, &target);
+		}
+	}
+}
+
+void CSWVideoProcessor::DrawAlphaBitmap()
+{
+	const SIZE windowSize = m_windowRect.Size();
+	const CRect rSrc(m_AlphaBitmapRectSrc);
+	const CRect rDst(
+		(LONG)(m_AlphaBitmapNRectDest.left   * windowSize.cx),
+		(LONG)(m_AlphaBitmapNRectDest.top    * windowSize.cy),
+		(LONG)(m_AlphaBitmapNRectDest.right  * windowSize.cx),
+		(LONG)(m_AlphaBitmapNRectDest.bottom * windowSize.cy)
+	);
+
+	CRect rClip;
+	if (rSrc.IsRectEmpty() || !rClip.IntersectRect(rDst, CRect(0, 0, m_DibWidth, m_DibHeight))) {
+		return;
+	}
+
+	// nearest-neighbor, pre-multiplied source with the inverse alpha as in AlphaBlt() of the DX9 processor
+	for (LONG y = rClip.top; y < rClip.bottom; y++) {
+		const LONG sy = std::clamp(rSrc.top + (LONG)((int64_t)(y - rDst.top) * rSrc.Height() / rDst.Height()), 0l, (LONG)m_AlphaBitmapHeight - 1);
+		const uint32_t* s = &m_AlphaBitmap[(size_t)m_AlphaBitmapWidth * sy];
+		uint32_t* d = (uint32_t*)(m_pDibBits + (size_t)m_DibPitch * y);
+
+		for (LONG x = rClip.left; x < rClip.right; x++) {
+			const LONG sx = std::clamp(rSrc.left + (LONG)((int64_t)(x - rDst.left) * rSrc.Width() / rDst.Width()), 0l, (LONG)m_AlphaBitmapWidth - 1);
+			const uint32_t c = s[sx];
+			const UINT a = c >> 24;
+			uint32_t r = 0;
+			for (int i = 0; i < 24; i += 8) {
+				const UINT v = ((c >> i) & 0xff) + (((d[x] >> i) & 0xff) * a + 127) / 255;
+				r |= std::min(v, 255u) << i;
+			}
+			d[x] = r;
+		}
+	}
+}
+
+void CSWVideoProcessor::Present()
+{
+	HDC hdc = GetDC(m_hWnd);
+	if (hdc) {
+		BitBlt(hdc, m_windowRect.left, m_windowRect.top, m_DibWidth, m_DibHeight, m_hDibDC, 0, 0, SRCCOPY);
+		ReleaseDC(m_hWnd, hdc);
+	}
+}
+
+HRESULT CSWVideoProcessor::Render(int field, const REFERENCE_TIME frameStartTime)
+{
+	uint64_t tick1 = GetPreciseTick();
+
+	if (field) {
+		m_FieldDrawn = field;
+	}
+
+	HRESULT hr = CheckDib(m_windowRect.Width(), m_windowRect.Height());
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	ClearOutput();
+
+	if (!m_renderRect.IsRectEmpty()) {
+		hr = Process(m_pDibBits, m_DibPitch, CRect(0, 0, m_DibWidth, m_DibHeight), m_srcRect, m_videoRect);
+	}
+
+	const uint64_t tickSubs = GetPreciseTick();
+	DrawSubtitles();
+	m_RenderStats.substicks = GetPreciseTick() - tickSubs;
+	m_RenderLatency.subs.Add(m_RenderStats.substicks);
+
+	if (m_bShowStats) {
+		hr = DrawStats();
+	}
+
+	if (m_bAlphaBitmapEnable) {
+		DrawAlphaBitmap();
+	}
+
+	uint64_t tick2 = GetPreciseTick();
+	m_RenderStats.paintticks = tick2 - tick1;
+	m_RenderLatency.paint.Add(m_RenderStats.paintticks);
+
+	if (m_bAdjustPresentTime) {
+		SyncFrameToStreamTime(frameStartTime);
+	}
+
+	Present();
+	m_RenderStats.presentticks = GetPreciseTick() - tick2;
+	m_RenderLatency.present.Add(m_RenderStats.presentticks);
+
+	return S_OK;
+}
+
+HRESULT CSWVideoProcessor::FillBlack()
+{
+	HRESULT hr = CheckDib(m_windowRect.Width(), m_windowRect.Height());
+	if (FAILED(hr)) {
+		return hr;
+	}
+
+	ClearOutput();
+
+	if (m_bShowStats) {
+		hr = DrawStats();
+	}
+
+	if (m_bAlphaBitmapEnable) {
+		DrawAlphaBitmap();
+	}
+
+	Present();
+
+	return S_OK;
+}
+
+void CSWVideoProcessor::SetVideoRect(const CRect& videoRect)
+{
+	m_videoRect = videoRect;
+	UpdateRenderRect();
+}
+
+HRESULT CSWVideoProcessor::SetWindowRect(const CRect& windowRect)
+{
+	m_windowRect = windowRect;
+	UpdateRenderRect();
+
+	if (!m_windowRect.IsRectEmpty()) {
+		UpdateStatsByWindow();
+	}
+
+	return S_OK;
+}
+
+HRESULT CSWVideoProcessor::Reset()
+{
+	// there is no device to lose
+	return S_OK;
+}
+
+HRESULT CSWVideoProcessor::GetCurentImage(long *pDIBImage)
+{
+	UINT w = m_srcRectWidth;
+	UINT h = m_srcRectHeight;
+	if (m_srcAnamorphic) {
+		w = MulDiv(h, m_srcAspectRatioX, m_srcAspectRatioY);
+	}
+	if (m_iRotation == 90 || m_iRotation == 270) {
+		std::swap(w, h);
+	}
+	const CRect imageRect(0, 0, w, h);
+
+	const UINT dib_bitdepth = 32;
+	const UINT dib_pitch    = CalcDibRowPitch(w, dib_bitdepth);
+
+	BITMAPINFOHEADER* pBIH = (BITMAPINFOHEADER*)pDIBImage;
+	ZeroMemory(pBIH, sizeof(BITMAPINFOHEADER));
+	pBIH->biSize      = sizeof(BITMAPINFOHEADER);
+	pBIH->biWidth     = w;
+	pBIH->biHeight    = -(LONG)h; // top-down RGB bitmap
+	pBIH->biPlanes    = 1;
+	pBIH->biBitCount  = dib_bitdepth;
+	pBIH->biSizeImage = dib_pitch * h;
+
+	BYTE* dst = (BYTE*)(pBIH + 1);
+	ZeroMemory(dst, pBIH->biSizeImage);
+
+	HRESULT hr = Process(dst, dib_pitch, imageRect, m_srcRect, imageRect);
+
+	// the resampler is set up for the window again on the next frame
+
+	return SUCCEEDED(hr) ? S_OK : hr;
+}
+
+HRESULT CSWVideoProcessor::GetDisplayedImage(BYTE **ppDib, unsigned *pSize)
+{
+	if (!m_pDibBits) {
+		return E_ABORT;
+	}
+
+	const UINT width  = m_DibWidth;
+	const UINT height = m_DibHeight;
+
+	const UINT dib_bitdepth = 32;
+	const UINT dib_pitch    = CalcDibRowPitch(width, dib_bitdepth);
+	const UINT dib_size	    = dib_pitch * height;
+
+	*pSize = sizeof(BITMAPINFOHEADER) + dib_size;
+	BYTE* p = (BYTE*)LocalAlloc(LMEM_FIXED, *pSize); // only this allocator can be used
+	if (!p) {
+		return E_OUTOFMEMORY;
+	}
+
+	BITMAPINFOHEADER* pBIH = (BITMAPINFOHEADER*)p;
+	ZeroMemory(pBIH, sizeof(BITMAPINFOHEADER));
+	pBIH->biSize      = sizeof(BITMAPINFOHEADER);
+	pBIH->biWidth     = width;
+	pBIH->biHeight    = -(LONG)height; // top-down RGB bitmap
+	pBIH->biBitCount  = dib_bitdepth;
+	pBIH->biPlanes    = 1;
+	pBIH->biSizeImage = dib_size;
+
+	GdiFlush();
+	CopyPlaneAsIs(height, (BYTE*)(pBIH + 1), dib_pitch, m_pDibBits, m_DibPitch);
+
+	*ppDib = p;
+
+	return S_OK;
+}
+
+HRESULT CSWVideoProcessor::GetVPInfo(std::wstring& str)
+{
+	str = L"Software";
+	str += std::format(L"\nGraphics adapter: {}", m_strAdapterDescription);
+	str += std::format(L"\nVideoProcessor  : CPU, {} threads", m_Workers.GetThreads());
+
+	str.append(m_strStatsDispInfo);
+
+	AppendLatencyInfo(str);
+
+#ifdef _DEBUG
+	str.append(L"\n\nDEBUG info:");
+	str += std::format(L"\nSource tex size: {}x{}", m_srcWidth, m_srcHeight);
+	str += std::format(L"\nSource rect    : {},{},{},{} - {}x{}", m_srcRect.left, m_srcRect.top, m_srcRect.right, m_srcRect.bottom, m_srcRect.Width(), m_srcRect.Height());
+	str += std::format(L"\nVideo rect     : {},{},{},{} - {}x{}", m_videoRect.left, m_videoRect.top, m_videoRect.right, m_videoRect.bottom, m_videoRect.Width(), m_videoRect.Height());
+	str += std::format(L"\nWindow rect    : {},{},{},{} - {}x{}", m_windowRect.left, m_windowRect.top, m_windowRect.right, m_windowRect.bottom, m_windowRect.Width(), m_windowRect.Height());
+#endif
+
+	return S_OK;
+}
+
+void CSWVideoProcessor::Configure(const Settings_t& config)
+{
+	bool changeConvert     = false;
+	bool changeScaling     = false;
+	bool changeResizeStats = false;
+
+	// settings that do not require preparation
+	m_bShowStats           = config.bShowStats;
+	m_bAdjustPresentTime   = config.bAdjustPresentTime;
+
+	// checking what needs to be changed
+
+	if (config.iResizeStats != m_iResizeStats) {
+		m_iResizeStats = config.iResizeStats;
+		changeResizeStats = true;
+	}
+
+	if (config.iChromaScaling != m_iChromaScaling) {
+		m_iChromaScaling = config.iChromaScaling;
+		changeConvert = (m_srcParams.Subsampling == 420 || m_srcParams.Subsampling == 422);
+	}
+
+	if (config.iSDRDisplayNits != m_iSDRDisplayNits) {
+		m_iSDRDisplayNits = config.iSDRDisplayNits;
+		changeConvert = SourceIsPQorHLG();
+	}
+
+	if (config.iUpscaling != m_iUpscaling || config.iDownscaling != m_iDownscaling || config.bInterpolateAt50pct != m_bInterpolateAt50pct) {
+		m_iUpscaling          = config.iUpscaling;
+		m_iDownscaling        = config.iDownscaling;
+		m_bInterpolateAt50pct = config.bInterpolateAt50pct;
+		changeScaling = true;
+	}
+
+	if (!m_pFilter->GetActive()) {
+		return;
+	}
+
+	// apply new settings
+
+	if (changeConvert && m_srcParams.cformat) {
+		UpdateConvertParams();
+	}
+
+	if (changeScaling) {
+		UpdateScalingStrings();
+	}
+
+	if (changeResizeStats) {
+		UpdateStatsByWindow();
+		UpdateStatsByDisplay();
+	}
+
+	UpdateStatsStatic();
+}
+
+void CSWVideoProcessor::SetRotation(int value)
+{
+	m_iRotation = value;
+	UpdateScalingStrings();
+}
+
+void CSWVideoProcessor::SetStereo3dTransform(int value)
+{
+	// not supported
+	m_iStereo3dTransform = 0;
+}
+
+void CSWVideoProcessor::Flush()
+{
+	m_rtStart = 0;
+}
+
+ISubPicAllocator* CSWVideoProcessor::GetSubPicAllocator()
+{
+	if (!m_pSubPicAllocator) {
+		m_pSubPicAllocator = new CMemSubPicAllocator({ 1280, 720 });
+	}
+	return m_pSubPicAllocator;
+}
+
+void CSWVideoProcessor::UpdateStatsStatic()
+{
+	if (m_srcParams.cformat) {
+		m_strStatsHeader = std::format(L"MPC VR {}, Software, Windows {}", _CRT_WIDE(VERSION_STR), GetWindowsVersion());
+
+		UpdateStatsInputFmt();
+
+		m_strStatsVProc = std::format(L"\nVideoProcessor: CPU, {} threads", m_Workers.GetThreads());
+		if (m_srcParams.Subsampling == 420 || m_srcParams.Subsampling == 422) {
+			m_strStatsVProc.append(L", Chroma scaling: ");
+			m_strStatsVProc.append(m_iChromaScaling == CHROMA_Nearest ? L"Nearest-neighbor" : L"Bilinear");
+		}
+		m_strStatsVProc.append(L"\nInternalFormat: X8R8G8B8");
+
+		if (SourceIsHDR()) {
+			m_strStatsHDR.assign(L"\nHDR processing: Convert to SDR");
+		} else {
+			m_strStatsHDR.clear();
+		}
+
+		m_strStatsPresent.assign(L"\nPresentation  : GDI");
+	}
+	else {
+		m_strStatsHeader = L"Error";
+		m_strStatsVProc.clear();
+		m_strStatsInputFmt.clear();
+		m_strStatsHDR.clear();
+		m_strStatsPresent.clear();
+	}
+}
+
+HRESULT CSWVideoProcessor::DrawStats()
+{
+	if (m_windowRect.IsRectEmpty() || !m_hDibDC) {
+		return E_ABORT;
+	}
+
+	std::wstring str;
+	str.reserve(700);
+	str.assign(m_strStatsHeader);
+	str.append(m_strStatsDispInfo);
+	str += std::format(L"\nGraph. Adapter: {}", m_strAdapterDescription);
+
+	wchar_t frametype = m_bFieldsFrame ? 'i' : 'p';
+	str += std::format(
+		L"\nFrame rate    : {:7.3f}{},{:7.3f}",
+		m_pFilter->m_FrameStats.GetAverageFps(),
+		frametype,
+		m_pFilter->m_DrawStats.GetAverageFps()
+	);
+
+	str.append(m_strStatsInputFmt);
+
+	str.append(m_strStatsVProc);
+
+	const int dstW = m_videoRect.Width();
+	const int dstH = m_videoRect.Height();
+	if (m_iRotation) {
+		str += std::format(L"\nScaling       : {}x{} r{}°> {}x{}", m_srcRectWidth, m_srcRectHeight, m_iRotation, dstW, dstH);
+	} else {
+		str += std::format(L"\nScaling       : {}x{} -> {}x{}", m_srcRectWidth, m_srcRectHeight, dstW, dstH);
+	}
+	if (m_srcRectWidth != dstW || m_srcRectHeight != dstH) {
+		str += L' ';
+		if (m_strShaderX) {
+			str.append(m_strShaderX);
+			if (m_strShaderY && m_strShaderY != m_strShaderX) {
+				str += L'/';
+				str.append(m_strShaderY);
+			}
+		} else if (m_strShaderY) {
+			str.append(m_strShaderY);
+		}
+	}
+
+	if (m_strCorrection) {
+		str += std::format(L"\nPostProcessing: {}", m_strCorrection);
+	}
+	str.append(m_strStatsHDR);
+	str.append(m_strStatsPresent);
+
+	str += std::format(L"\nFrames: {:5}, skipped: {}/{}, failed: {}",
+		m_pFilter->m_FrameStats.GetFrames(), m_pFilter->m_DrawStats.m_dropped, m_RenderStats.dropped2, m_RenderStats.failed);
+	str += std::format(L"\nTimes(ms): Copy{:3}, Paint{:3}, Present{:3}",
+		m_RenderStats.copyticks    * 1000 / GetPreciseTicksPerSecondI(),
+		m_RenderStats.paintticks   * 1000 / GetPreciseTicksPerSecondI(),
+		m_RenderStats.presentticks * 1000 / GetPreciseTicksPerSecondI());
+	AppendLatencyStats(str);
+	str += std::format(L"\nSync offset   : {:+3} ms", (m_RenderStats.syncoffset + 5000) / 10000);
+
+	const bool bGraph = CheckGraphPlacement();
+
+	// the bits are changed directly, GDI must finish the previous drawing
+	GdiFlush();
+	DarkenRect(m_pDibBits, m_DibPitch, m_DibWidth, m_DibHeight, m_StatsRect);
+	if (bGraph) {
+		DarkenRect(m_pDibBits, m_DibPitch, m_DibWidth, m_DibHeight, m_GraphRect);
+	}
+
+	HGDIOBJ hOldFont = SelectObject(m_hDibDC, m_hStatsFont);
+	SetBkMode(m_hDibDC, TRANSPARENT);
+	SetTextColor(m_hDibDC, RGB(255, 255, 255));
+	RECT rcText = { m_StatsTextPoint.x, m_StatsTextPoint.y, m_StatsRect.right, m_StatsRect.bottom };
+	DrawTextW(m_hDibDC, str.c_str(), (int)str.size(), &rcText, DT_LEFT | DT_TOP | DT_NOPREFIX | DT_NOCLIP);
+	SelectObject(m_hDibDC, hOldFont);
+
+	static int col = m_StatsRect.right;
+	if (--col < m_StatsRect.left) {
+		col = m_StatsRect.right;
+	}
+	const RECT rcTick = { col, m_StatsRect.bottom - 11, col + 5, m_StatsRect.bottom - 1 };
+	HBRUSH hBrush = CreateSolidBrush(RGB(128, 255, 128));
+	FillRect(m_hDibDC, &rcTick, hBrush);
+	DeleteObject(hBrush);
+
+	if (bGraph) {
+		HPEN hPenLine = CreatePen(PS_SOLID, 1, RGB(100, 100, 255));
+		HPEN hPenAxis = CreatePen(PS_SOLID, 1, RGB(150, 150, 255));
+		HPEN hPenSync = CreatePen(PS_SOLID, 1, RGB(100, 200, 100));
+		HGDIOBJ hOldPen = SelectObject(m_hDibDC, hPenLine);
+
+		const int linestep = 20 * m_Yscale;
+		for (int y = m_GraphRect.top + (m_Yaxis - m_GraphRect.top) % (linestep); y < m_GraphRect.bottom; y += linestep) {
+			SelectObject(m_hDibDC, (y == m_Yaxis) ? hPenAxis : hPenLine);
+			MoveToEx(m_hDibDC, m_GraphRect.left, y, nullptr);
+			LineTo(m_hDibDC, m_GraphRect.right, y);
+		}
+
+		std::vector<POINT> points(m_Syncs.Size());
+		const int* data = m_Syncs.Data();
+		UINT idx = m_Syncs.OldestIndex();
+		int x = m_GraphRect.left;
+		for (auto& pt : points) {
+			pt = { x, m_Yaxis - data[idx] * m_Yscale / 10000 };
+			x += m_Xstep;
+			if (++idx == points.size()) {
+				idx = 0;
+			}
+		}
+		SelectObject(m_hDibDC, hPenSync);
+		Polyline(m_hDibDC, points.data(), (int)points.size());
+
+		SelectObject(m_hDibDC, hOldPen);
+		DeleteObject(hPenLine);
+		DeleteObject(hPenAxis);
+		DeleteObject(hPenSync);
+	}
+
+	GdiFlush();
+
+	return S_OK;
+}
+
+// IMFVideoProcessor
+
+STDMETHODIMP CSWVideoProcessor::SetProcAmpValues(DWORD dwFlags, DXVA2_ProcAmpValues *pValues)
+{
+	CheckPointer(pValues, E_POINTER);
+	if (m_srcParams.cformat == CF_NONE) {
+		return MF_E_TRANSFORM_TYPE_NOT_SET;
+	}
+
+	if (dwFlags & DXVA2_ProcAmp_Mask) {
+		CAutoLock cRendererLock(&m_pFilter->m_RendererLock);
+
+		if (dwFlags & DXVA2_ProcAmp_Brightness) {
+			m_DXVA2ProcAmpValues.Brightness.ll = std::clamp(pValues->Brightness.ll, m_DXVA2ProcAmpRanges[0].MinValue.ll, m_DXVA2ProcAmpRanges[0].MaxValue.ll);
+		}
+		if (dwFlags & DXVA2_ProcAmp_Contrast) {
+			m_DXVA2ProcAmpValues.Contrast.ll = std::clamp(pValues->Contrast.ll, m_DXVA2ProcAmpRanges[1].MinValue.ll, m_DXVA2ProcAmpRanges[1].MaxValue.ll);
+		}
+		if (dwFlags & DXVA2_ProcAmp_Hue) {
+			m_DXVA2ProcAmpValues.Hue.ll = std::clamp(pValues->Hue.ll, m_DXVA2ProcAmpRanges[2].MinValue.ll, m_DXVA2ProcAmpRanges[2].MaxValue.ll);
+		}
+		if (dwFlags & DXVA2_ProcAmp_Saturation) {
+			m_DXVA2ProcAmpValues.Saturation.ll = std::clamp(pValues->Saturation.ll, m_DXVA2ProcAmpRanges[3].MinValue.ll, m_DXVA2ProcAmpRanges[3].MaxValue.ll);
+		}
+
+		UpdateConvertParams();
+	}
+
+	return S_OK;
+}
+
+// IMFVideoMixerBitmap
+
+STDMETHODIMP CSWVideoProcessor::SetAlphaBitmap(const MFVideoAlphaBitmap *pBmpParms)
+{
+	CheckPointer(pBmpParms, E_POINTER);
+	CAutoLock cRendererLock(&m_pFilter->m_RendererLock);
+
+	if (pBmpParms->GetBitmapFromDC && pBmpParms->bitmap.hdc) {
+		HBITMAP hBitmap = (HBITMAP)GetCurrentObject(pBmpParms->bitmap.hdc, OBJ_BITMAP);
+		if (!hBitmap) {
+			return E_INVALIDARG;
+		}
+		DIBSECTION info = {0};
+		if (!::GetObjectW(hBitmap, sizeof(DIBSECTION), &info)) {
+			return E_INVALIDARG;
+		}
+		BITMAP& bm = info.dsBm;
+		if (!bm.bmWidth || !bm.bmHeight || bm.bmBitsPixel != 32 || !bm.bmBits) {
+			return E_INVALIDARG;
+		}
+
+		m_AlphaBitmapWidth  = bm.bmWidth;
+		m_AlphaBitmapHeight = bm.bmHeight;
+		m_AlphaBitmap.resize((size_t)bm.bmWidth * bm.bmHeight);
+		CopyPlaneAsIs(bm.bmHeight, (BYTE*)m_AlphaBitmap.data(), bm.bmWidth * 4, (const BYTE*)bm.bmBits, bm.bmWidthBytes);
+	} else {
+		return E_INVALIDARG;
+	}
+
+	m_bAlphaBitmapEnable = true;
+	m_AlphaBitmapRectSrc = { 0, 0, (LONG)m_AlphaBitmapWidth, (LONG)m_AlphaBitmapHeight };
+	m_AlphaBitmapNRectDest = { 0, 0, 1, 1 };
+
+	return UpdateAlphaBitmapParameters(&pBmpParms->params);
+}
+
+STDMETHODIMP CSWVideoProcessor::UpdateAlphaBitmapParameters(const MFVideoAlphaBitmapParams *pBmpParms)
+{
+	CheckPointer(pBmpParms, E_POINTER);
+	CAutoLock cRendererLock(&m_pFilter->m_RendererLock);
+
+	if (m_bAlphaBitmapEnable) {
+		if (pBmpParms->dwFlags & MFVideoAlphaBitmap_SrcRect) {
+			m_AlphaBitmapRectSrc = pBmpParms->rcSrc;
+		}
+		if (pBmpParms->dwFlags & MFVideoAlphaBitmap_DestRect) {
+			m_AlphaBitmapNRectDest = pBmpParms->nrcDest;
+		}
+		DWORD validFlags = MFVideoAlphaBitmap_SrcRect|MFVideoAlphaBitmap_DestRect;
+
+		return ((pBmpParms->dwFlags & validFlags) == validFlags) ? S_OK : S_FALSE;
+	} else {
+		return MF_E_NOT_INITIALIZED;
+	}
+}
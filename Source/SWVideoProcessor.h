@@ -0,0 +1,156 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+
+#include "IVideoRenderer.h"
+#include "Helper.h"
+#include "VideoProcessor.h"
+#include "ParallelCopy.h"
+#include "SWConvert.h"
+#include "SubPic/MemSubPic.h"
+
+// Video processor without Direct3D. Frames are converted and scaled on the CPU
+// into a DIB section, which is drawn to the window with GDI.
+class CSWVideoProcessor
+	: public CVideoProcessor
+{
+private:
+	CParallelCopy m_Workers;
+
+	// Input parameters
+	CSWColorConvert m_Convert;
+	const wchar_t* m_strCorrection = nullptr;
+	bool m_bFieldsFrame = false; // the last frame is interlaced, only for statistics
+
+	// converted source frame, X8R8G8B8 m_srcWidth x m_srcHeight
+	std::vector<BYTE> m_Frame;
+	UINT m_FramePitch = 0;
+	bool m_bFrameReady = false;
+
+	// rotated or flipped m_srcRect
+	std::vector<BYTE> m_Rotated;
+
+	CSWResampler m_Resampler;
+	struct {
+		UINT srcW = 0, srcH = 0;
+		UINT dstW = 0, dstH = 0;
+		CRect clip;
+		SWFilter_t filterX = SWFILTER_Box;
+		SWFilter_t filterY = SWFILTER_Box;
+	} m_ResamplerParams;
+
+	// window size output
+	HDC     m_hDibDC      = nullptr;
+	HBITMAP m_hDib        = nullptr;
+	HGDIOBJ m_hOldBitmap  = nullptr;
+	BYTE*   m_pDibBits    = nullptr;
+	UINT    m_DibWidth    = 0;
+	UINT    m_DibHeight   = 0;
+	UINT    m_DibPitch    = 0;
+
+	// AlphaBitmap
+	std::vector<uint32_t> m_AlphaBitmap;
+	UINT m_AlphaBitmapWidth  = 0;
+	UINT m_AlphaBitmapHeight = 0;
+
+	// Statistics
+	HFONT m_hStatsFont = nullptr;
+
+	// SubPic
+	CComPtr<CMemSubPicAllocator> m_pSubPicAllocator;
+
+public:
+	CSWVideoProcessor(CMpcVideoRenderer* pFilter, const Settings_t& config, HRESULT& hr);
+	~CSWVideoProcessor() override;
+
+	int Type() override { return VP_SW; }
+
+	HRESULT Init(const HWND hwnd, const bool displayHdrChanged, bool* pChangeDevice = nullptr) override;
+
+private:
+	void ReleaseVP();
+	void ReleaseDib();
+	HRESULT CheckDib(const UINT width, const UINT height);
+
+	HRESULT UpdateConvertParams();
+
+	void UpdateRenderRect();
+	void UpdateScalingStrings();
+	SWFilter_t GetScalingFilter(const UINT srcSize, const UINT dstSize);
+
+	void CalcStatsParams() override;
+
+public:
+	BOOL VerifyMediaType(const CMediaType* pmt) override;
+	BOOL InitMediaType(const CMediaType* pmt) override;
+
+	BOOL GetAlignmentSize(const CMediaType& mt, SIZE& Size) override;
+
+	HRESULT ProcessSample(IMediaSample* pSample) override;
+	HRESULT CopySample(IMediaSample* pSample);
+	// Render: 1 - render progressive frame, 0 or other - forced repeat of render.
+	HRESULT Render(int field, const REFERENCE_TIME frameStartTime) override;
+	HRESULT FillBlack() override;
+
+	void SetVideoRect(const CRect& videoRect)      override;
+	HRESULT SetWindowRect(const CRect& windowRect) override;
+	HRESULT Reset() override;
+
+	HRESULT GetCurentImage(long *pDIBImage) override;
+	HRESULT GetDisplayedImage(BYTE **ppDib, unsigned *pSize) override;
+	HRESULT GetVPInfo(std::wstring& str) override;
+
+	// Settings
+	void Configure(const Settings_t& config) override;
+
+	void SetRotation(int value) override;
+	void SetStereo3dTransform(int value) override;
+
+	void Flush() override;
+
+	void ClearPreScaleShaders() override {}
+	void ClearPostScaleShaders() override {}
+
+	HRESULT AddPreScaleShader(const std::wstring& name, const std::string& srcCode) override { return E_NOTIMPL; }
+	HRESULT AddPostScaleShader(const std::wstring& name, const std::string& srcCode) override { return E_NOTIMPL; }
+
+	ISubPicAllocator* GetSubPicAllocator() override;
+
+private:
+	// dst is a top-down X8R8G8B8 image of dstRect.right x dstRect.bottom or larger
+	HRESULT Process(BYTE* dst, const UINT dst_pitch, const CRect& clipRect, const CRect& srcRect, const CRect& dstRect);
+
+	void ClearOutput();
+	void DrawSubtitles();
+	void DrawAlphaBitmap();
+	void Present();
+
+	void UpdateStatsStatic();
+	HRESULT DrawStats();
+
+public:
+	// IMFVideoProcessor
+	STDMETHODIMP SetProcAmpValues(DWORD dwFlags, DXVA2_ProcAmpValues *pValues) override;
+
+	// IMFVideoMixerBitmap
+	STDMETHODIMP SetAlphaBitmap(const MFVideoAlphaBitmap *pBmpParms) override;
+	STDMETHODIMP UpdateAlphaBitmapParameters(const MFVideoAlphaBitmapParams *pBmpParms) override;
+};
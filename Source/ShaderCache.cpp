@@ -0,0 +1,368 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "stdafx.h"
+#include <fstream>
+#include <charconv>
+#include "Utils/Hash.h"
+#include "ShaderCache.h"
+
+namespace fs = std::filesystem;
+
+constexpr uint32_t SHADER_CACHE_MAGIC = 0x43535652; // "RVSC"
+constexpr wchar_t  SHADER_CACHE_EXT[] = L".cso";
+constexpr wchar_t  SHADER_CACHE_VERFILE[] = L"cache.ver";
+constexpr wchar_t  SHADER_CACHE_INDEX[] = L"permutations.idx";
+
+struct ShaderCacheHeader_t {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t key;      // primary hash, also the file name
+	uint64_t check;    // secondary hash of the key data to catch collisions
+	uint64_t keySize;
+	uint64_t blobSize;
+};
+
+CShaderCache::CShaderCache(const fs::path& dir, const std::string_view compilerId, const uint64_t maxSize)
+	: m_dir(dir)
+	, m_compilerId(compilerId)
+	, m_maxSize(maxSize)
+{
+}
+
+void CShaderCache::Init()
+{
+	// called under lock
+	if (m_bReady) {
+		return;
+	}
+	m_bReady = true;
+
+	std::error_code ec;
+	fs::create_directories(m_dir, ec);
+	if (ec) {
+		DLog(L"CShaderCache::Init() : failed to create {}", m_dir.wstring());
+		m_dir.clear();
+		return;
+	}
+
+	// versioned invalidation: remove all entries if the cache version or the compiler changed
+	const std::string verStr = std::format("{}\n{}", SHADER_CACHE_VERSION, m_compilerId);
+	std::string fileVerStr;
+	{
+		std::ifstream verFile(m_dir / SHADER_CACHE_VERFILE, std::ios::binary);
+		if (verFile) {
+			fileVerStr.assign(std::istreambuf_iterator<char>(verFile), std::istreambuf_iterator<char>());
+		}
+	}
+	if (fileVerStr != verStr) {
+		DLogIf(fileVerStr.size(), L"CShaderCache::Init() : cache version changed, clearing");
+		for (const auto& entry : fs::directory_iterator(m_dir, ec)) {
+			if (entry.is_regular_file(ec) && entry.path().extension() == SHADER_CACHE_EXT) {
+				fs::remove(entry.path(), ec);
+			}
+		}
+		fs::remove(m_dir / SHADER_CACHE_INDEX, ec);
+		std::ofstream verFile(m_dir / SHADER_CACHE_VERFILE, std::ios::binary | std::ios::trunc);
+		verFile.write(verStr.data(), verStr.size());
+	}
+
+	LoadIndex();
+	UpdateTotalSize();
+	Trim();
+}
+
+void CShaderCache::LoadIndex()
+{
+	// called under lock
+	m_indexKeys.clear();
+
+	std::ifstream file(m_dir / SHADER_CACHE_INDEX);
+	if (!file) {
+		return;
+	}
+
+	// the index lists the entries generated by the same cache version and compiler,
+	// each line is "key hash name"
+	std::string version, compilerId, line;
+	std::getline(file, version);
+	std::getline(file, compilerId);
+	if (version != std::to_string(SHADER_CACHE_VERSION) || compilerId != m_compilerId) {
+		DLog(L"CShaderCache::LoadIndex() : the index is outdated");
+		return;
+	}
+
+	while (std::getline(file, line)) {
+		uint64_t key = 0;
+		const auto [ptr, ec] = std::from_chars(line.data(), line.data() + line.size(), key, 16);
+		if (ec == std::errc() && ptr == line.data() + 16) {
+			m_indexKeys.emplace(key);
+		}
+	}
+
+	DLog(L"CShaderCache::LoadIndex() : {} pre-generated shaders", m_indexKeys.size());
+}
+
+void CShaderCache::UpdateTotalSize()
+{
+	// called under lock
+	m_totalSize = 0;
+
+	std::error_code ec;
+	for (const auto& entry : fs::directory_iterator(m_dir, ec)) {
+		if (entry.is_regular_file(ec) && entry.path().extension() == SHADER_CACHE_EXT && !IsIndexed(entry.path())) {
+			m_totalSize += entry.file_size(ec);
+		}
+	}
+}
+
+void CShaderCache::Trim()
+{
+	// called under lock
+	if (m_totalSize <= m_maxSize || m_dir.empty()) {
+		return;
+	}
+
+	struct Entry_t {
+		fs::path path;
+		fs::file_time_type time;
+		uint64_t size;
+	};
+	std::vector<Entry_t> entries;
+
+	std::error_code ec;
+	for (const auto& entry : fs::directory_iterator(m_dir, ec)) {
+		if (entry.is_regular_file(ec) && entry.path().extension() == SHADER_CACHE_EXT && !IsIndexed(entry.path())) {
+			entries.emplace_back(entry.path(), entry.last_write_time(ec), entry.file_size(ec));
+		}
+	}
+	std::sort(entries.begin(), entries.end(), [](const Entry_t& a, const Entry_t& b) { return a.time < b.time; });
+
+	// remove the least recently used entries down to 3/4 of the limit
+	const uint64_t targetSize = m_maxSize / 4 * 3;
+	for (const auto& entry : entries) {
+		if (m_totalSize <= targetSize) {
+			break;
+		}
+		if (fs::remove(entry.path, ec)) {
+			m_totalSize -= std::min(m_totalSize, entry.size);
+		}
+	}
+}
+
+fs::path CShaderCache::GetFilePath(const uint64_t key) const
+{
+	return m_dir / std::format(L"{:016x}{}", key, SHADER_CACHE_EXT);
+}
+
+bool CShaderCache::IsIndexed(const fs::path& path) const
+{
+	// the file name is the key
+	const std::string name = path.stem().string();
+	if (m_indexKeys.empty() || name.size() != 16) {
+		return false;
+	}
+	uint64_t key = 0;
+	const auto [ptr, ec] = std::from_chars(name.data(), name.data() + name.size(), key, 16);
+
+	return ec == std::errc() && ptr == name.data() + name.size() && m_indexKeys.contains(key);
+}
+
+uint64_t CShaderCache::GetKey(const std::string_view keyData) const
+{
+	return hash_fnv1a64(keyData, hash_fnv1a64(m_compilerId));
+}
+
+static uint64_t GetCheckHash(const std::string_view keyData)
+{
+	// same data, different seed
+	return hash_fnv1a64(keyData, FNV1A64_OFFSET ^ 0x5bd1e9955bd1e995ull);
+}
+
+bool CShaderCache::Load(const std::string_view keyData, std::vector<BYTE>& blob)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Init();
+
+	if (m_dir.empty()) {
+		return false;
+	}
+
+	const uint64_t key = GetKey(keyData);
+	const fs::path path = GetFilePath(key);
+
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		m_nMisses++;
+		return false;
+	}
+
+	ShaderCacheHeader_t header = {};
+	file.read((char*)&header, sizeof(header));
+	if (!file
+			|| header.magic != SHADER_CACHE_MAGIC
+			|| header.version != SHADER_CACHE_VERSION
+			|| header.key != key
+			|| header.check != GetCheckHash(keyData)
+			|| header.keySize != keyData.size()
+			|| header.blobSize == 0 || header.blobSize > 16 * 1024 * 1024) {
+		DLog(L"CShaderCache::Load() : invalid entry {}", path.filename().wstring());
+		m_nMisses++;
+		return false;
+	}
+
+	blob.resize((size_t)header.blobSize);
+	file.read((char*)blob.data(), blob.size());
+	if (!file) {
+		blob.clear();
+		m_nMisses++;
+		return false;
+	}
+	file.close();
+
+	// update the time for LRU trimming
+	std::error_code ec;
+	fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+	m_nHits++;
+	return true;
+}
+
+void CShaderCache::Store(const std::string_view keyData, const BYTE* data, const size_t size)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Init();
+
+	if (m_dir.empty() || !data || !size) {
+		return;
+	}
+
+	ShaderCacheHeader_t header = {};
+	header.magic    = SHADER_CACHE_MAGIC;
+	header.version  = SHADER_CACHE_VERSION;
+	header.key      = GetKey(keyData);
+	header.check    = GetCheckHash(keyData);
+	header.keySize  = keyData.size();
+	header.blobSize = size;
+
+	const fs::path path = GetFilePath(header.key);
+	// write to a temporary file, then rename, so that a half-written entry is never read
+	fs::path tmpPath = path;
+	tmpPath += L".tmp";
+	{
+		std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			return;
+		}
+		file.write((const char*)&header, sizeof(header));
+		file.write((const char*)data, size);
+		if (!file) {
+			file.close();
+			std::error_code ec;
+			fs::remove(tmpPath, ec);
+			return;
+		}
+	}
+
+	std::error_code ec;
+	const uint64_t oldSize = fs::exists(path, ec) ? fs::file_size(path, ec) : 0;
+	fs::rename(tmpPath, path, ec);
+	if (ec) {
+		fs::remove(tmpPath, ec);
+		return;
+	}
+
+	if (!m_indexKeys.contains(header.key)) {
+		m_totalSize += sizeof(header) + size;
+		m_totalSize -= std::min(m_totalSize, oldSize);
+		Trim();
+	}
+}
+
+void CShaderCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::error_code ec;
+	if (!m_dir.empty()) {
+		for (const auto& entry : fs::directory_iterator(m_dir, ec)) {
+			if (entry.is_regular_file(ec) && entry.path().extension() == SHADER_CACHE_EXT) {
+				fs::remove(entry.path(), ec);
+			}
+		}
+		fs::remove(m_dir / SHADER_CACHE_INDEX, ec);
+	}
+	m_indexKeys.clear();
+	m_totalSize = 0;
+}
+
+bool CShaderCache::SetIndex(const std::vector<ShaderIndexEntry_t>& entries)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Init();
+
+	if (m_dir.empty()) {
+		return false;
+	}
+
+	std::string str = std::format("{}\n{}\n", SHADER_CACHE_VERSION, m_compilerId);
+	for (const auto& entry : entries) {
+		str += std::format("{:016x} {:016x} {}\n", entry.key, entry.hash, entry.name);
+	}
+
+	const fs::path path = m_dir / SHADER_CACHE_INDEX;
+	fs::path tmpPath = path;
+	tmpPath += L".tmp";
+	{
+		std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+		file.write(str.data(), str.size());
+		if (!file) {
+			file.close();
+			std::error_code ec;
+			fs::remove(tmpPath, ec);
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	fs::rename(tmpPath, path, ec);
+	if (ec) {
+		fs::remove(tmpPath, ec);
+		return false;
+	}
+
+	m_indexKeys.clear();
+	for (const auto& entry : entries) {
+		m_indexKeys.emplace(entry.key);
+	}
+	// the entries that are no longer listed are trimmed as usual
+	UpdateTotalSize();
+	Trim();
+
+	return true;
+}
+
+size_t CShaderCache::GetIndexSize()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Init();
+
+	return m_indexKeys.size();
+}
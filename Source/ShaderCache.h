@@ -0,0 +1,79 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <unordered_set>
+
+// Increase when the cache file format or the way the key is built changes.
+#define SHADER_CACHE_VERSION 1
+
+// An entry of the index of pre-generated shaders, see CShaderCache::SetIndex().
+struct ShaderIndexEntry_t {
+	uint64_t key;     // the cache key, it depends on the compiler
+	uint64_t hash;    // the hash of the key data only, it stays the same when the compiler changes
+	std::string name; // the permutation that the shader was generated for
+};
+
+// Content-addressed on-disk cache of compiled shader blobs.
+// The key is a hash of the data passed by the caller (shader source, defines, target)
+// together with the compiler identifier, so a compiler update invalidates all entries.
+// The entries listed in the index of pre-generated shaders are not trimmed
+// and do not count towards the size limit.
+// The class does not depend on Direct3D.
+class CShaderCache
+{
+	std::filesystem::path m_dir;
+	std::string m_compilerId;
+	uint64_t m_maxSize   = 0;
+	uint64_t m_totalSize = 0;
+	bool m_bReady        = false;
+	std::mutex m_mutex;
+
+	std::unordered_set<uint64_t> m_indexKeys;
+
+	uint64_t m_nHits   = 0;
+	uint64_t m_nMisses = 0;
+
+	void Init();
+	void LoadIndex();
+	void UpdateTotalSize();
+	void Trim();
+	std::filesystem::path GetFilePath(const uint64_t key) const;
+	bool IsIndexed(const std::filesystem::path& path) const;
+
+public:
+	CShaderCache(const std::filesystem::path& dir, const std::string_view compilerId, const uint64_t maxSize);
+
+	bool Load(const std::string_view keyData, std::vector<BYTE>& blob);
+	void Store(const std::string_view keyData, const BYTE* data, const size_t size);
+	void Clear();
+
+	uint64_t GetKey(const std::string_view keyData) const;
+	// replaces the index of pre-generated shaders, the entries must have been stored
+	bool SetIndex(const std::vector<ShaderIndexEntry_t>& entries);
+	size_t GetIndexSize();
+
+	uint64_t GetHits() const { return m_nHits; }
+	uint64_t GetMisses() const { return m_nMisses; }
+	uint64_t GetTotalSize() const { return m_totalSize; }
+};
@@ -0,0 +1,136 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "stdafx.h"
+#include "ShaderCompileQueue.h"
+
+CShaderCompileQueue::CShaderCompileQueue(CompileFn compileFn)
+	: m_compileFn(std::move(compileFn))
+{
+}
+
+CShaderCompileQueue::~CShaderCompileQueue()
+{
+	if (m_thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_bExit = true;
+		}
+		m_condStart.notify_one();
+		m_thread.join();
+	}
+}
+
+void CShaderCompileQueue::ThreadProc()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	for (;;) {
+		m_condStart.wait(lock, [this] { return m_bExit || m_bPending; });
+		if (m_bExit) {
+			break;
+		}
+
+		const uint64_t id = m_requestId;
+		const std::vector<Source_t> sources = std::move(m_sources);
+		m_sources.clear();
+		m_bPending = false;
+		m_runningId = id;
+		lock.unlock();
+
+		Result_t result;
+		result.id = id;
+		result.hrs.resize(sources.size(), E_ABORT);
+		result.blobs.resize(sources.size());
+		for (size_t i = 0; i < sources.size(); i++) {
+			result.hrs[i] = m_compileFn(sources[i], result.blobs[i]);
+		}
+
+		lock.lock();
+		m_runningId = 0;
+		// a newer request or Cancel() discards the result
+		if (id == m_requestId) {
+			m_result = std::move(result);
+			m_bReady = true;
+		}
+		m_condDone.notify_all();
+	}
+}
+
+uint64_t CShaderCompileQueue::Submit(std::vector<Source_t>&& sources)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_sources = std::move(sources);
+	m_bPending = true;
+	m_requestId++;
+	m_bReady = false;
+	m_result = {};
+
+	if (!m_thread.joinable()) {
+		m_thread = std::thread([this] { ThreadProc(); });
+	}
+	m_condStart.notify_one();
+
+	return m_requestId;
+}
+
+void CShaderCompileQueue::Cancel()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_sources.clear();
+	m_bPending = false;
+	m_requestId++;
+	m_bReady = false;
+	m_result = {};
+	m_condDone.notify_all();
+}
+
+bool CShaderCompileQueue::GetResult(Result_t& result)
+{
+	if (!m_bReady) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_bReady) {
+		return false;
+	}
+	result = std::move(m_result);
+	m_result = {};
+	m_bReady = false;
+
+	return true;
+}
+
+bool CShaderCompileQueue::IsBusy()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_bPending || (m_runningId && m_runningId == m_requestId);
+}
+
+void CShaderCompileQueue::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	m_condDone.wait(lock, [this] { return !m_bPending && !(m_runningId && m_runningId == m_requestId); });
+}
@@ -0,0 +1,82 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Compiles shaders on a worker thread, so that the thread that delivers the frames does not wait
+// for the compiler. Only the latest request matters: a new request replaces the one that has not
+// been started, and the results of the older requests are discarded.
+// The compiler is a function passed by the owner, the class does not depend on Direct3D.
+class CShaderCompileQueue
+{
+public:
+	struct Source_t {
+		std::string code;
+		LPCSTR target = nullptr;
+	};
+
+	typedef std::function<HRESULT(const Source_t& source, std::vector<BYTE>& blob)> CompileFn;
+
+	struct Result_t {
+		uint64_t id = 0;
+		std::vector<HRESULT> hrs; // for each source
+		std::vector<std::vector<BYTE>> blobs;
+	};
+
+private:
+	const CompileFn m_compileFn;
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_condStart;
+	std::condition_variable m_condDone;
+
+	std::vector<Source_t> m_sources;     // protected by m_mutex
+	bool     m_bPending   = false;       // protected by m_mutex
+	uint64_t m_requestId  = 0;           // the latest request, protected by m_mutex
+	uint64_t m_runningId  = 0;           // protected by m_mutex
+	Result_t m_result;                   // protected by m_mutex
+	std::atomic<bool> m_bReady = false;  // m_result is the result of the latest request
+	bool     m_bExit      = false;
+
+	void ThreadProc();
+
+public:
+	CShaderCompileQueue(CompileFn compileFn);
+	// waits for the compilation that is running
+	~CShaderCompileQueue();
+
+	// returns the id of the request, the worker thread is started by the first request
+	uint64_t Submit(std::vector<Source_t>&& sources);
+	// discards the latest request and its result
+	void Cancel();
+	// returns true once when the result of the latest request is ready, it can be called on every frame
+	bool GetResult(Result_t& result);
+	// true if the latest request has not been compiled yet
+	bool IsBusy();
+	// waits until the latest request has been compiled
+	void Wait();
+};
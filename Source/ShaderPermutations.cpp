@@ -0,0 +1,257 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "stdafx.h"
+#include <atomic>
+#include <thread>
+#include <unordered_set>
+#include "Utils/Hash.h"
+#include "Helper.h"
+#include "IVideoRenderer.h"
+#include "ShaderCache.h"
+#include "Shaders.h"
+#include "ShaderPermutations.h"
+
+static const SIZE s_DefaultFrameSizes[] = {
+	{  720,  480 },
+	{  720,  576 },
+	{ 1280,  720 },
+	{ 1920, 1080 },
+	{ 3840, 2160 },
+};
+
+// the colorimetry of nearly all videos, other transfer functions are compiled when they are needed
+static const struct {
+	UINT primaries;
+	UINT transfer;
+} s_Colorimetry[] = {
+	{ DXVA2_VideoPrimaries_BT709, DXVA2_VideoTransFunc_709 },
+	{ MFVideoPrimaries_BT2020,    DXVA2_VideoTransFunc_709 },
+	{ MFVideoPrimaries_BT2020,    MFVideoTransFunc_2084 },
+	{ MFVideoPrimaries_BT2020,    MFVideoTransFunc_HLG },
+};
+
+static const UINT s_ChromaLocations420[] = {
+	DXVA2_VideoChromaSubsampling_MPEG2,
+	DXVA2_VideoChromaSubsampling_MPEG1,
+	DXVA2_VideoChromaSubsampling_Cosited,
+};
+
+std::string ConvertShaderPermutation_t::GetName() const
+{
+	return std::format("{} {} {}x{} chroma:{}/{} prim:{} trc:{} convert:{}{}{}",
+		bDX11 ? "DX11" : "DX9", ConvertWideToUtf8(GetFmtConvParams(cformat).str), width, height,
+		exFmt.VideoChromaSubsampling, chromaScaling, exFmt.VideoPrimaries, exFmt.VideoTransferFunction,
+		convertType, blendDeinterlace ? " blend" : "", bTrcLut ? " lut" : "");
+}
+
+// Returns true if the renderer converts the format with the shader, not with the video processor.
+// Mirrors the selection in InitMediaType() of the video processors.
+static bool IsShaderFormat(const Settings_t& sets, const FmtConvParams_t& params)
+{
+	if (sets.bUseD3D11) {
+		if (params.DX11Format == DXGI_FORMAT_UNKNOWN) {
+			return false;
+		}
+		if (params.CSType == CS_RGB) {
+			return true; // the D3D11 video processor is not used for RGB on Nvidia
+		}
+		if (params.VP11Format == DXGI_FORMAT_UNKNOWN && GetPlanarVP11Format(params.cformat) == DXGI_FORMAT_UNKNOWN) {
+			return true;
+		}
+		switch (params.cformat) {
+		case CF_NV12:
+		case CF_YV12:
+		case CF_YUV420P8:   return !sets.VPFmts.bNV12;
+		case CF_P010:
+		case CF_P016:
+		case CF_YUV420P10:
+		case CF_YUV420P16:  return !sets.VPFmts.bP01x;
+		case CF_YUY2:
+		case CF_YV16:
+		case CF_YUV422P8:   return !sets.VPFmts.bYUY2;
+		default:            return !sets.VPFmts.bOther;
+		}
+	}
+
+	if (params.D3DFormat == D3DFMT_UNKNOWN) {
+		return false;
+	}
+	if (params.DXVA2Format == D3DFMT_UNKNOWN) {
+		return true;
+	}
+	switch (params.cformat) {
+	case CF_NV12: return !sets.VPFmts.bNV12;
+	case CF_P010:
+	case CF_P016: return !sets.VPFmts.bP01x;
+	case CF_YUY2: return !sets.VPFmts.bYUY2;
+	default:      return !sets.VPFmts.bOther;
+	}
+}
+
+void EnumConvertShaderPermutations(const Settings_t& sets, const std::vector<SIZE>& frameSizes, std::vector<ConvertShaderPermutation_t>& permutations)
+{
+	permutations.clear();
+
+	if (sets.bUseSoftware) {
+		return;
+	}
+	const bool bDX11 = sets.bUseD3D11;
+
+	// see UpdateConvertColorShader(), with an HDR display Direct3D 11 passes PQ through and converts HLG to PQ
+	std::vector<int> convertTypes = { sets.bConvertToSdr ? SHADER_CONVERT_TO_SDR : SHADER_CONVERT_NONE };
+	if (bDX11 && (sets.bHdrPassthrough || sets.bHdrLocalToneMapping || sets.iHdrToggleDisplay != HDRTD_Disabled)) {
+		if (sets.bConvertToSdr) {
+			convertTypes.emplace_back(SHADER_CONVERT_NONE);
+		}
+		convertTypes.emplace_back(SHADER_CONVERT_TO_PQ);
+	}
+
+	for (const auto& params : GetFmtConvMapping()) {
+		if (params.cformat == CF_NONE || !IsShaderFormat(sets, params)) {
+			continue;
+		}
+
+		const bool bPlanes = bDX11 ? !!params.pDX11Planes : !!params.pDX9Planes;
+		std::vector<UINT> chromaLocations = { DXVA2_VideoChromaSubsampling_MPEG2 };
+		std::vector<bool> blends = { false };
+		if (params.Subsampling == 420) {
+			chromaLocations.assign(std::begin(s_ChromaLocations420), std::end(s_ChromaLocations420));
+			if (bPlanes) {
+				blends.emplace_back(true); // the shader for interlaced frames
+			}
+		}
+
+		for (const auto& size : frameSizes) {
+			for (const auto& colorimetry : s_Colorimetry) {
+				for (const auto chromaLocation : chromaLocations) {
+					for (const auto convertType : convertTypes) {
+						for (const bool blend : blends) {
+							ConvertShaderPermutation_t permutation = {};
+							permutation.bDX11   = bDX11;
+							permutation.cformat = params.cformat;
+							permutation.width   = size.cx;
+							permutation.height  = size.cy;
+							permutation.exFmt.VideoChromaSubsampling = chromaLocation;
+							permutation.exFmt.VideoPrimaries         = colorimetry.primaries;
+							permutation.exFmt.VideoTransferFunction  = colorimetry.transfer;
+							permutation.chromaScaling    = sets.iChromaScaling;
+							permutation.convertType      = convertType;
+							permutation.blendDeinterlace = blend;
+							permutation.bTrcLut          = sets.bTransferLut;
+							permutations.emplace_back(permutation);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+HRESULT PrecompileConvertShaders(const Settings_t& sets, const std::vector<SIZE>& frameSizes)
+{
+	CShaderCache* pShaderCache = GetShaderCache();
+	if (!pShaderCache) {
+		DLog(L"PrecompileConvertShaders() : the shader cache is not available");
+		return E_FAIL;
+	}
+
+	std::vector<ConvertShaderPermutation_t> permutations;
+	if (frameSizes.size()) {
+		EnumConvertShaderPermutations(sets, frameSizes, permutations);
+	} else {
+		EnumConvertShaderPermutations(sets, { std::begin(s_DefaultFrameSizes), std::end(s_DefaultFrameSizes) }, permutations);
+	}
+
+	// many permutations give the same code, e.g. the chroma location and the conversion do not change
+	// the shaders of 4:4:4 and SDR formats, so the shaders are identified by the hash of the code
+	struct Shader_t {
+		std::string code;
+		LPCSTR target;
+		ShaderIndexEntry_t entry;
+		bool bCompiled;
+	};
+	std::vector<Shader_t> shaders;
+	std::unordered_set<uint64_t> hashes;
+
+	for (const auto& permutation : permutations) {
+		const auto& params = GetFmtConvParams(permutation.cformat);
+		// see CreateEx() of Tex9Video_t and Tex11Video_t, YUY2 is a texture of half width on Direct3D 9
+		const UINT texW = (!permutation.bDX11 && params.pDX9Planes && params.D3DFormat == D3DFMT_YUY2) ? permutation.width / 2 : permutation.width;
+		const RECT rect = { 0, 0, (LONG)permutation.width, (LONG)permutation.height };
+
+		Shader_t shader = {};
+		shader.target = GetShaderConvertColorTarget(permutation.bDX11);
+		GetShaderConvertColorCode(permutation.bDX11, permutation.width, texW, permutation.height, rect, params,
+			permutation.exFmt, nullptr, permutation.chromaScaling, permutation.convertType, permutation.blendDeinterlace,
+			permutation.bTrcLut, false, shader.code);
+
+		const std::string keyData = GetShaderKeyData(shader.code, nullptr, shader.target);
+		shader.entry.hash = hash_fnv1a64(keyData);
+		if (hashes.contains(shader.entry.hash)) {
+			continue;
+		}
+		shader.entry.key  = pShaderCache->GetKey(keyData);
+		shader.entry.name = permutation.GetName();
+		hashes.emplace(shader.entry.hash);
+		shaders.emplace_back(std::move(shader));
+	}
+
+	DLog(L"PrecompileConvertShaders() : {} permutations, {} shaders", permutations.size(), shaders.size());
+
+	// the shaders that are in the cache already are only loaded
+	const uint64_t nHits = pShaderCache->GetHits();
+
+	std::atomic<size_t> next = 0;
+	auto CompileShaders = [&] {
+		for (size_t i = next++; i < shaders.size(); i = next++) {
+			ID3DBlob* pShaderCode = nullptr;
+			shaders[i].bCompiled = SUCCEEDED(CompileShader(shaders[i].code, nullptr, shaders[i].target, &pShaderCode));
+			SAFE_RELEASE(pShaderCode);
+		}
+	};
+
+	const UINT nThreads = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+	std::vector<std::thread> threads;
+	for (UINT i = 1; i < nThreads; i++) {
+		threads.emplace_back(CompileShaders);
+	}
+	CompileShaders();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	std::vector<ShaderIndexEntry_t> entries;
+	for (const auto& shader : shaders) {
+		if (shader.bCompiled) {
+			entries.emplace_back(shader.entry);
+		}
+	}
+
+	const size_t nLoaded = (size_t)(pShaderCache->GetHits() - nHits);
+	DLog(L"PrecompileConvertShaders() : {} shaders compiled, {} were in the cache, {} failed",
+		entries.size() - nLoaded, nLoaded, shaders.size() - entries.size());
+
+	if (!pShaderCache->SetIndex(entries)) {
+		return E_FAIL;
+	}
+
+	return (entries.size() == shaders.size()) ? S_OK : S_FALSE;
+}
@@ -0,0 +1,51 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+
+#include "Helper.h"
+
+struct Settings_t;
+
+// The parameters of GetShaderConvertColor() that change the code of the shader.
+struct ConvertShaderPermutation_t {
+	bool          bDX11;
+	ColorFormat_t cformat;
+	UINT          width;  // frame size
+	UINT          height;
+	DXVA2_ExtendedFormat exFmt;
+	int           chromaScaling;
+	int           convertType;
+	bool          blendDeinterlace;
+	bool          bTrcLut;
+
+	std::string GetName() const;
+};
+
+// Lists the colour conversion shaders that the renderer can create with the settings
+// for the formats of the format table and the frame sizes. The shaders of the formats
+// that go to the video processor and the Dolby Vision shaders, which depend on the
+// metadata of the stream, are not listed.
+void EnumConvertShaderPermutations(const Settings_t& sets, const std::vector<SIZE>& frameSizes, std::vector<ConvertShaderPermutation_t>& permutations);
+
+// Compiles the listed shaders that are not in the shader cache yet and replaces the index
+// of pre-generated shaders, so that they are not trimmed from the cache.
+// The default frame sizes are used if frameSizes is empty.
+HRESULT PrecompileConvertShaders(const Settings_t& sets, const std::vector<SIZE>& frameSizes);
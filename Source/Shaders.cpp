@@ -20,27 +20,90 @@
 
 #include "stdafx.h"
 #include <D3Dcompiler.h>
+#include <ShlObj.h>
+#include <mutex>
 #include "Helper.h"
 #include "resource.h"
 #include "IVideoRenderer.h"
+#include "ShaderCache.h"
+#include "ColorLut.h"
+#include "DoviLut.h"
 #include "Shaders.h"
 
+#define SHADER_CACHE_MAXSIZE (32 * 1024 * 1024)
 
-HRESULT CompileShader(const std::string& srcCode, const D3D_SHADER_MACRO* pDefines, LPCSTR pTarget, ID3DBlob** ppShaderBlob)
+
+static std::string GetCompilerId(HMODULE hModule)
 {
-	//ASSERT(*ppShaderBlob == nullptr);
+	// the time stamp and the image size from the PE header identify the compiler build
+	auto pDosHeader = (const IMAGE_DOS_HEADER*)hModule;
+	auto pNtHeaders = (const IMAGE_NT_HEADERS*)((const BYTE*)hModule + pDosHeader->e_lfanew);
+
+	return std::format("d3dcompiler_47 {:08x} {:08x}", pNtHeaders->FileHeader.TimeDateStamp, pNtHeaders->OptionalHeader.SizeOfImage);
+}
 
+// the statics are initialized once, so shaders can be compiled by several threads
+static HMODULE GetD3dcompilerDll()
+{
 	static HMODULE s_hD3dcompilerDll = LoadLibraryW(L"d3dcompiler_47.dll");
-	static pD3DCompile s_fnD3DCompile = nullptr;
+	return s_hD3dcompilerDll;
+}
+
+CShaderCache* GetShaderCache()
+{
+	static std::unique_ptr<CShaderCache> s_pShaderCache;
+	static std::once_flag s_flag;
+
+	std::call_once(s_flag, [&] {
+		HMODULE hD3dcompilerDll = GetD3dcompilerDll();
+		PWSTR pszPath = nullptr;
+		if (hD3dcompilerDll && SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, &pszPath))) {
+			std::filesystem::path dir(pszPath);
+			dir /= L"MPC-BE Filters\\MPC Video Renderer\\ShaderCache";
+			s_pShaderCache = std::make_unique<CShaderCache>(dir, GetCompilerId(hD3dcompilerDll), SHADER_CACHE_MAXSIZE);
+		}
+		CoTaskMemFree(pszPath);
+	});
+
+	return s_pShaderCache.get();
+}
 
-	if (s_hD3dcompilerDll && !s_fnD3DCompile) {
-		s_fnD3DCompile = (pD3DCompile)GetProcAddress(s_hD3dcompilerDll, "D3DCompile");
+std::string GetShaderKeyData(const std::string& srcCode, const D3D_SHADER_MACRO* pDefines, LPCSTR pTarget)
+{
+	// cache key: target, defines and source code
+	std::string keyData(pTarget);
+	keyData += '\n';
+	for (auto pDef = pDefines; pDef && pDef->Name; pDef++) {
+		keyData += std::format("#define {} {}\n", pDef->Name, pDef->Definition ? pDef->Definition : "");
 	}
+	keyData += srcCode;
+
+	return keyData;
+}
+
+HRESULT CompileShader(const std::string& srcCode, const D3D_SHADER_MACRO* pDefines, LPCSTR pTarget, ID3DBlob** ppShaderBlob)
+{
+	//ASSERT(*ppShaderBlob == nullptr);
+
+	static HMODULE s_hD3dcompilerDll = GetD3dcompilerDll();
+	static pD3DCompile s_fnD3DCompile = s_hD3dcompilerDll ? (pD3DCompile)GetProcAddress(s_hD3dcompilerDll, "D3DCompile") : nullptr;
+	static decltype(&D3DCreateBlob) s_fnD3DCreateBlob = s_hD3dcompilerDll ? (decltype(&D3DCreateBlob))GetProcAddress(s_hD3dcompilerDll, "D3DCreateBlob") : nullptr;
 
 	if (!s_fnD3DCompile) {
 		return E_FAIL;
 	}
 
+	const std::string keyData = GetShaderKeyData(srcCode, pDefines, pTarget);
+
+	CShaderCache* pShaderCache = s_fnD3DCreateBlob ? GetShaderCache() : nullptr;
+	if (pShaderCache) {
+		std::vector<BYTE> blob;
+		if (pShaderCache->Load(keyData, blob) && SUCCEEDED(s_fnD3DCreateBlob(blob.size(), ppShaderBlob))) {
+			memcpy((*ppShaderBlob)->GetBufferPointer(), blob.data(), blob.size());
+			return S_OK;
+		}
+	}
+
 	ID3DBlob* pErrorBlob = nullptr;
 	HRESULT hr = s_fnD3DCompile(
 		srcCode.c_str(), srcCode.size(), nullptr, pDefines, nullptr,
@@ -56,12 +119,35 @@ HRESULT CompileShader(const std::string& srcCode, const D3D_SHADER_MACRO* pDefin
 			DLog(L"Unexpected compiler error");
 		}
 	}
+	else if (pShaderCache) {
+		pShaderCache->Store(keyData, (const BYTE*)(*ppShaderBlob)->GetBufferPointer(), (*ppShaderBlob)->GetBufferSize());
+	}
 
 	SAFE_RELEASE(pErrorBlob);
 
 	return hr;
 }
 
+HRESULT CompileShader(const std::string& srcCode, const D3D_SHADER_MACRO* pDefines, LPCSTR pTarget, std::vector<BYTE>& blob)
+{
+	ID3DBlob* pShaderCode = nullptr;
+	HRESULT hr = CompileShader(srcCode, pDefines, pTarget, &pShaderCode);
+	if (S_OK == hr) {
+		const BYTE* data = (const BYTE*)pShaderCode->GetBufferPointer();
+		blob.assign(data, data + pShaderCode->GetBufferSize());
+		pShaderCode->Release();
+	}
+
+	return hr;
+}
+
+bool LoadCachedShader(const std::string& srcCode, const D3D_SHADER_MACRO* pDefines, LPCSTR pTarget, std::vector<BYTE>& blob)
+{
+	CShaderCache* pShaderCache = GetShaderCache();
+
+	return pShaderCache && pShaderCache->Load(GetShaderKeyData(srcCode, pDefines, pTarget), blob);
+}
+
 const char code_CatmullRom_weights[] =
 	"float2 t2 = t * t;\n"
 	"float2 t3 = t * t2;\n"
@@ -550,9 +636,131 @@ void ShaderDoviReshape(std::string& code)
 	);
 }
 
+void ShaderTrcLut(const bool bDX11, std::string& code)
+{
+	// two point loads and the interpolation in full precision, the filtering units
+	// of the GPU interpolate with a few bits of the fraction
+	if (bDX11) {
+		code.append(
+			"Texture2D<float> texTrc : register(t3);\n"
+			"float3 TrcLut(float3 x)\n"
+			"{\n"
+			"    const float3 pos = saturate(x) * (TRC_LUT_SIZE - 1);\n"
+			"    const int3 i = min((int3)pos, TRC_LUT_SIZE - 2);\n"
+			"    const float3 f = pos - i;\n"
+			"    float3 y;\n"
+			"    [unroll]\n"
+			"    for (int c = 0; c < 3; c++) {\n"
+			"        const float y0 = texTrc.Load(int3(i[c], 0, 0));\n"
+			"        const float y1 = texTrc.Load(int3(i[c] + 1, 0, 0));\n"
+			"        y[c] = y0 + f[c] * (y1 - y0);\n"
+			"    }\n"
+			"    return y;\n"
+			"}\n"
+		);
+	} else {
+		code.append(
+			"sampler sTrc : register(s3);\n"
+			"float3 TrcLut(float3 x)\n"
+			"{\n"
+			"    const float3 pos = saturate(x) * (TRC_LUT_SIZE - 1);\n"
+			"    const float3 i = min(floor(pos), TRC_LUT_SIZE - 2);\n"
+			"    const float3 f = pos - i;\n"
+			"    float3 y;\n"
+			"    [unroll]\n"
+			"    for (int c = 0; c < 3; c++) {\n"
+			"        const float y0 = tex2Dlod(sTrc, float4((i[c] + 0.5) / TRC_LUT_SIZE, 0.5, 0, 0)).r;\n"
+			"        const float y1 = tex2Dlod(sTrc, float4((i[c] + 1.5) / TRC_LUT_SIZE, 0.5, 0, 0)).r;\n"
+			"        y[c] = y0 + f[c] * (y1 - y0);\n"
+			"    }\n"
+			"    return y;\n"
+			"}\n"
+		);
+	}
+}
+
+void ShaderDoviReshapeLut(const bool bDX11, std::string& code)
+{
+	// the tables of BakeDoviReshapeLut(), one row per component
+	if (bDX11) {
+		code.append(
+			"Texture2D<float> texDovi : register(t4);\n"
+			"float3 DoviReshapeLut(float3 x)\n"
+			"{\n"
+			"    const float3 pos = saturate(x) * (DOVI_LUT_SIZE - 1);\n"
+			"    const int3 i = min((int3)pos, DOVI_LUT_SIZE - 2);\n"
+			"    const float3 f = pos - i;\n"
+			"    float3 y;\n"
+			"    [unroll]\n"
+			"    for (int c = 0; c < 3; c++) {\n"
+			"        const float y0 = texDovi.Load(int3(i[c], c, 0));\n"
+			"        const float y1 = texDovi.Load(int3(i[c] + 1, c, 0));\n"
+			"        y[c] = y0 + f[c] * (y1 - y0);\n"
+			"    }\n"
+			"    return y;\n"
+			"}\n"
+		);
+	} else {
+		code.append(
+			"sampler sDovi : register(s4);\n"
+			"float3 DoviReshapeLut(float3 x)\n"
+			"{\n"
+			"    const float3 pos = saturate(x) * (DOVI_LUT_SIZE - 1);\n"
+			"    const float3 i = min(floor(pos), DOVI_LUT_SIZE - 2);\n"
+			"    const float3 f = pos - i;\n"
+			"    float3 y;\n"
+			"    [unroll]\n"
+			"    for (int c = 0; c < 3; c++) {\n"
+			"        const float v = (c + 0.5) / 3;\n"
+			"        const float y0 = tex2Dlod(sDovi, float4((i[c] + 0.5) / DOVI_LUT_SIZE, v, 0, 0)).r;\n"
+			"        const float y1 = tex2Dlod(sDovi, float4((i[c] + 1.5) / DOVI_LUT_SIZE, v, 0, 0)).r;\n"
+			"        y[c] = y0 + f[c] * (y1 - y0);\n"
+			"    }\n"
+			"    return y;\n"
+			"}\n"
+		);
+	}
+}
+
 //////////////////////////////
 
-HRESULT GetShaderConvertColor(
+mp_csp_trc GetShaderConvertColorTrc(
+	const DXVA2_ExtendedFormat exFmt,
+	const MediaSideDataDOVIMetadata* const pDoviMetadata,
+	const int convertType)
+{
+	// the same conditions as in GetShaderConvertColorCode()
+	const bool bConvertHDRtoSDR = (convertType == SHADER_CONVERT_TO_SDR && (exFmt.VideoTransferFunction == MFVideoTransFunc_2084 || exFmt.VideoTransferFunction == MFVideoTransFunc_HLG || pDoviMetadata));
+	const bool bApplyHLG = (exFmt.VideoTransferFunction == MFVideoTransFunc_HLG && !pDoviMetadata);
+	const bool bConvertHLGtoPQ = (convertType == SHADER_CONVERT_TO_PQ && bApplyHLG);
+
+	if (pDoviMetadata) {
+		return MP_CSP_TRC_PQ;
+	}
+	if (bApplyHLG && (bConvertHDRtoSDR || bConvertHLGtoPQ)) {
+		return MP_CSP_TRC_HLG;
+	}
+	if (bConvertHDRtoSDR) {
+		return MP_CSP_TRC_PQ;
+	}
+	if (exFmt.VideoPrimaries == MFVideoPrimaries_BT2020) {
+		switch (exFmt.VideoTransferFunction) {
+		case DXVA2_VideoTransFunc_18:   return MP_CSP_TRC_GAMMA18;
+		case DXVA2_VideoTransFunc_20:   return MP_CSP_TRC_GAMMA20;
+		case MFVideoTransFunc_HLG: // HLG compatible with SDR
+		case DXVA2_VideoTransFunc_22:
+		case DXVA2_VideoTransFunc_709:
+		case DXVA2_VideoTransFunc_240M:
+		case DXVA2_VideoTransFunc_sRGB: return MP_CSP_TRC_GAMMA22;
+		case DXVA2_VideoTransFunc_28:   return MP_CSP_TRC_GAMMA28;
+		case MFVideoTransFunc_26:       return MP_CSP_TRC_GAMMA26;
+		}
+	}
+
+	return MP_CSP_TRC_AUTO;
+}
+
+void GetShaderConvertColorCode(
 	const bool bDX11,
 	const UINT width,
 	const long texW, long texH,
@@ -563,11 +771,10 @@ HRESULT GetShaderConvertColor(
 	const int chromaScaling,
 	const int convertType,
 	const bool blendDeinterlace,
-	ID3DBlob** ppCode)
+	const bool bTrcLut,
+	const bool bDoviLut,
+	std::string& code)
 {
-	DLog(L"GetShaderConvertColor() started for {} {}x{} extfmt:{:#010x} chroma:{}", fmtParams.str, texW, texH, exFmt.value, chromaScaling);
-
-	std::string code;
 	HRESULT hr = S_OK;
 	LPVOID data;
 	DWORD size;
@@ -576,6 +783,7 @@ HRESULT GetShaderConvertColor(
 	const bool bConvertHDRtoSDR = (convertType == SHADER_CONVERT_TO_SDR && (exFmt.VideoTransferFunction == MFVideoTransFunc_2084 || exFmt.VideoTransferFunction == MFVideoTransFunc_HLG || pDoviMetadata));
 	const bool bApplyHLG = (exFmt.VideoTransferFunction == MFVideoTransFunc_HLG && !pDoviMetadata);
 	const bool bConvertHLGtoPQ = (convertType == SHADER_CONVERT_TO_PQ && bApplyHLG);
+	const mp_csp_trc trcLut = bTrcLut ? GetShaderConvertColorTrc(exFmt, pDoviMetadata, convertType) : MP_CSP_TRC_AUTO;
 
 	if (bApplyHLG) {
 		hr = GetDataFromResource(data, size, IDF_HLSL_HLG);
@@ -658,17 +866,11 @@ HRESULT GetShaderConvertColor(
 	}
 
 	bool has_mmr = false;
+	bool bDoviReshapeLut = false;
 
 	if (pDoviMetadata) {
 		if (bDX11) {
-			for (const auto& curve : pDoviMetadata->Mapping.curves) {
-				for (uint8_t i = 0; i < (curve.num_pivots - 1); i++) {
-					if (curve.mapping_idc[i] == 1) {
-						has_mmr = true;
-						break;
-					}
-				}
-			}
+			has_mmr = DoviHasMMR(*pDoviMetadata);
 
 			if (has_mmr) {
 				code.append(
@@ -742,12 +944,29 @@ HRESULT GetShaderConvertColor(
 				"PS_DOVI_POLY_CURVE curves[3] : register(c5);\n"
 			);
 		}
+
+		// the MMR pieces depend on all three components and are computed from the constants
+		bDoviReshapeLut = bDoviLut && !has_mmr;
+		if (bDoviReshapeLut) {
+			code += std::format("#define DOVI_LUT_SIZE {}\n", DOVI_LUT_SIZE);
+			ShaderDoviReshapeLut(bDX11, code);
+		}
+	}
+
+	if (trcLut != MP_CSP_TRC_AUTO) {
+		code += std::format("#define TRC_LUT_SIZE {}\n", TRC_LUT1D_SIZE);
+		ShaderTrcLut(bDX11, code);
 	}
 
 	ShaderGetPixels(bDX11, fmtParams, exFmt.VideoChromaSubsampling, chromaScaling, blendDeinterlace, code);
 
 	if (pDoviMetadata) {
-		if (has_mmr) {
+		if (bDoviReshapeLut) {
+			code.append(
+				"// dovi reshape\n"
+				"color.rgb = DoviReshapeLut(color.rgb);\n"
+			);
+		} else if (has_mmr) {
 			ShaderDoviReshape(code);
 		} else {
 			ShaderDoviReshapePoly(code);
@@ -781,9 +1000,10 @@ HRESULT GetShaderConvertColor(
 		code.append("};\n");
 
 		// PQ EOTF
-		code.append(
-			"color = max(color, 0.0);\n"
-			"color = ST2084ToLinear(color, 1.0);\n"
+		code.append("color = max(color, 0.0);\n");
+		code.append(trcLut == MP_CSP_TRC_PQ
+			? "color.rgb = TrcLut(color.rgb);\n"
+			: "color = ST2084ToLinear(color, 1.0);\n"
 		);
 
 		// LMS matrix
@@ -796,28 +1016,31 @@ HRESULT GetShaderConvertColor(
 		);
 	}
 
+	LPCSTR strHLGtoLinear = (trcLut == MP_CSP_TRC_HLG)
+		? "color.rgb = HLG_OOTF(TrcLut(color.rgb));\n"
+		: "color.rgb = HLGtoLinear(color.rgb);\n";
+
 	if (bConvertHDRtoSDR) {
 		if (bApplyHLG) {
-			code.append(
-				"color = saturate(color);\n"
-				"color.rgb = HLGtoLinear(color.rgb);\n"
-				"color = LinearToST2084(color, 1000.0);\n"
-			);
+			code.append("color = saturate(color);\n");
+			code.append(strHLGtoLinear);
+			code.append("color = LinearToST2084(color, 1000.0);\n");
 		}
+		code.append("color = saturate(color);\n");
+		code.append(trcLut == MP_CSP_TRC_PQ
+			? "color.rgb = TrcLut(color.rgb) * LuminanceScale;\n"
+			: "color = ST2084ToLinear(color, LuminanceScale);\n"
+		);
 		code.append(
-			"color = saturate(color);\n"
-			"color = ST2084ToLinear(color, LuminanceScale);\n"
 			"color.rgb = ToneMappingHable(color.rgb);\n"
 			"color.rgb = mul(matrix_conv_prim, color.rgb);\n"
 		);
 		isLinear = true;
 	}
 	else if (bConvertHLGtoPQ) {
-		code.append(
-			"color = saturate(color);\n"
-			"color.rgb = HLGtoLinear(color.rgb);\n"
-			"color = LinearToST2084(color, 1000.0);\n"
-		);
+		code.append("color = saturate(color);\n");
+		code.append(strHLGtoLinear);
+		code.append("color = LinearToST2084(color, 1000.0);\n");
 	}
 	else if (bBT2020Primaries) {
 		std::string toLinear;
@@ -835,6 +1058,9 @@ HRESULT GetShaderConvertColor(
 		}
 
 		if (toLinear.size()) {
+			if (trcLut != MP_CSP_TRC_AUTO) {
+				toLinear = "color.rgb = TrcLut(color.rgb);\n";
+			}
 			code.append("color = saturate(color);\n");
 			code.append(toLinear);
 			code.append(
@@ -853,8 +1079,27 @@ HRESULT GetShaderConvertColor(
 	}
 
 	code.append("return color;\n}");
+}
+
+HRESULT GetShaderConvertColor(
+	const bool bDX11,
+	const UINT width,
+	const long texW, long texH,
+	const RECT rect,
+	const FmtConvParams_t& fmtParams,
+	const DXVA2_ExtendedFormat exFmt,
+	const MediaSideDataDOVIMetadata* const pDoviMetadata,
+	const int chromaScaling,
+	const int convertType,
+	const bool blendDeinterlace,
+	const bool bTrcLut,
+	const bool bDoviLut,
+	ID3DBlob** ppCode)
+{
+	DLog(L"GetShaderConvertColor() started for {} {}x{} extfmt:{:#010x} chroma:{}", fmtParams.str, texW, texH, exFmt.value, chromaScaling);
 
-	LPCSTR target = bDX11 ? "ps_4_0" : "ps_3_0";
+	std::string code;
+	GetShaderConvertColorCode(bDX11, width, texW, texH, rect, fmtParams, exFmt, pDoviMetadata, chromaScaling, convertType, blendDeinterlace, bTrcLut, bDoviLut, code);
 
-	return CompileShader(code, nullptr, target, ppCode);
+	return CompileShader(code, nullptr, GetShaderConvertColorTarget(bDX11), ppCode);
 }
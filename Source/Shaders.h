@@ -57,7 +57,45 @@ enum :int {
 	SHADER_CONVERT_TO_PQ,
 };
 
+class CShaderCache;
+
+// returns nullptr if d3dcompiler_47.dll or the cache folder is not available
+CShaderCache* GetShaderCache();
+// the data that identifies a compiled shader in the cache
+std::string GetShaderKeyData(const std::string& srcCode, const D3D_SHADER_MACRO* pDefines, LPCSTR pTarget);
+
 HRESULT CompileShader(const std::string& srcCode, const D3D_SHADER_MACRO* pDefines, LPCSTR pTarget, ID3DBlob** ppCode);
+HRESULT CompileShader(const std::string& srcCode, const D3D_SHADER_MACRO* pDefines, LPCSTR pTarget, std::vector<BYTE>& blob);
+// returns false if the shader is not in the cache, the shader is not compiled
+bool LoadCachedShader(const std::string& srcCode, const D3D_SHADER_MACRO* pDefines, LPCSTR pTarget, std::vector<BYTE>& blob);
+
+inline LPCSTR GetShaderConvertColorTarget(const bool bDX11) { return bDX11 ? "ps_4_0" : "ps_3_0"; }
+
+// The transfer function that the conversion shader linearizes per channel, MP_CSP_TRC_AUTO if there is none.
+// With bTrcLut the shader samples it from the table of BakeTrcLut1D() bound to t3 (Direct3D 11) or s3 (Direct3D 9)
+// instead of computing the curve. HLG is the inverse OETF, the OOTF is computed in the shader.
+mp_csp_trc GetShaderConvertColorTrc(
+	const DXVA2_ExtendedFormat exFmt,
+	const MediaSideDataDOVIMetadata* const pDoviMetadata,
+	const int convertType);
+
+// the source code of the shader returned by GetShaderConvertColor()
+// With bDoviLut the shader samples the Dolby Vision polynomial reshaping from the tables
+// of BakeDoviReshapeLut() bound to t4 or s4, unless the metadata has MMR pieces.
+void GetShaderConvertColorCode(
+	const bool bDX11,
+	const UINT width,
+	const long texW, long texH,
+	const RECT rect,
+	const FmtConvParams_t& fmtParams,
+	const DXVA2_ExtendedFormat exFmt,
+	const MediaSideDataDOVIMetadata* const pDoviMetadata,
+	const int chromaScaling,
+	const int convertType,
+	const bool blendDeinterlace,
+	const bool bTrcLut,
+	const bool bDoviLut,
+	std::string& code);
 
 HRESULT GetShaderConvertColor(
 	const bool bDX11,
@@ -70,4 +108,6 @@ HRESULT GetShaderConvertColor(
 	const int chromaScaling,
 	const int convertType,
 	const bool blendDeinterlace,
+	const bool bTrcLut,
+	const bool bDoviLut,
 	ID3DBlob** ppCode);
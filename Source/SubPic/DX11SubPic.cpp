@@ -144,6 +144,7 @@ CDX11SubPic::CDX11SubPic(MemPic_t&& pMemPic, CDX11SubPicAllocator *pAllocator)
 {
 	m_maxsize.SetSize(m_MemPic.w, m_MemPic.h);
 	m_rcDirty.SetRect(0, 0, m_maxsize.cx, m_maxsize.cy);
+	MemPicContentChanged(m_MemPic);
 }
 
 CDX11SubPic::~CDX11SubPic()
@@ -211,6 +212,7 @@ STDMETHODIMP CDX11SubPic::CopyTo(ISubPic* pSubPic)
 		src += m_MemPic.w;
 		dst += pDstMemPic->w;
 	}
+	MemPicContentChanged(*pDstMemPic);
 
 	return S_OK;
 }
@@ -239,6 +241,7 @@ STDMETHODIMP CDX11SubPic::ClearDirtyRect()
 	}
 
 	m_rcDirty.SetRectEmpty();
+	MemPicContentChanged(m_MemPic);
 
 	return S_OK;
 }
@@ -257,6 +260,9 @@ STDMETHODIMP CDX11SubPic::Lock(SubPicDesc& spd)
 	spd.bits    = (BYTE*)m_MemPic.data.get();
 	spd.vidrect = m_vidrect;
 
+	// the caller writes to the picture directly
+	MemPicContentChanged(m_MemPic);
+
 	return S_OK;
 }
 
@@ -267,6 +273,7 @@ STDMETHODIMP CDX11SubPic::Unlock(RECT* pDirtyRect)
 	} else {
 		m_rcDirty = CRect(CPoint(0, 0), m_size);
 	}
+	MemPicContentChanged(m_MemPic);
 
 	return S_OK;
 }
@@ -314,6 +321,11 @@ void CDX11SubPicAllocator::GetStats(int& _nFree, int& _nAlloc)
 	_nAlloc = (int)m_AllocatedSurfaces.size();
 }
 
+void CDX11SubPicAllocator::GetUploadStats(uint64_t& uploadedBytes, uint64_t& reusedBytes, uint32_t& uploads, uint32_t& reuses)
+{
+	m_UploadTracker.GetStats(uploadedBytes, reusedBytes, uploads, reuses);
+}
+
 void CDX11SubPicAllocator::ClearCache()
 {
 	// Clear the allocator of any remaining subpics
@@ -326,6 +338,7 @@ void CDX11SubPicAllocator::ClearCache()
 
 	m_pOutputShaderResource.Release();
 	m_pOutputTexture.Release();
+	m_UploadTracker.Reset();
 }
 
 // ISubPicAllocator
@@ -417,6 +430,8 @@ HRESULT CDX11SubPicAllocator::CreateOutputTex()
 	texDesc.Format         = DXGI_FORMAT_B8G8R8A8_UNORM;
 	texDesc.SampleDesc     = { 1, 0 };
 
+	m_UploadTracker.Reset();
+
 	hr = m_pDevice->CreateTexture2D(&texDesc, nullptr, &m_pOutputTexture);
 	if (FAILED(hr)) {
 		return hr;
@@ -504,7 +519,10 @@ HRESULT CDX11SubPicAllocator::Render(const MemPic_t& memPic, const CRect& dirtyR
 	m_pOutputTexture->GetDesc(&texDesc);
 
 	uint32_t* src = memPic.data.get() + memPic.w * copyRect.top + copyRect.left;
-	if (texDesc.Usage == D3D11_USAGE_DYNAMIC) {
+	if (m_UploadTracker.IsResident(memPic, copyRect)) {
+		// unchanged since the last upload, the texture already has it
+	}
+	else if (texDesc.Usage == D3D11_USAGE_DYNAMIC) {
 		// workaround for an Intel driver bug where frequent UpdateSubresource calls caused high memory consumption
 		D3D11_MAPPED_SUBRESOURCE mr;
 		hr = pDeviceContext->Map(m_pOutputTexture, 0, D3D11_MAP_WRITE_DISCARD, 0, &mr);
@@ -518,11 +536,17 @@ HRESULT CDX11SubPicAllocator::Render(const MemPic_t& memPic, const CRect& dirtyR
 				dst += mr.RowPitch;
 			}
 			pDeviceContext->Unmap(m_pOutputTexture, 0);
+
+			m_UploadTracker.Uploaded(memPic, copyRect);
+		} else {
+			m_UploadTracker.Reset();
 		}
 	}
 	else {
 		D3D11_BOX dstBox = { copyRect.left, copyRect.top, 0, copyRect.right, copyRect.bottom, 1 };
 		pDeviceContext->UpdateSubresource(m_pOutputTexture, 0, &dstBox, src, memPic.w * 4, 0);
+
+		m_UploadTracker.Uploaded(memPic, copyRect);
 	}
 
 	const float src_dx = 1.0f / texDesc.Width;
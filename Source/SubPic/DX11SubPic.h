@@ -20,6 +20,7 @@
 #pragma once
 
 #include "SubPicImpl.h"
+#include "SubPicUploadTracker.h"
 #include <deque>
 #include <d3d11_1.h>
 
@@ -28,12 +29,6 @@
 
 class CDX11SubPicAllocator;
 
-struct MemPic_t {
-	std::unique_ptr<uint32_t[]> data;
-	UINT w = 0;
-	UINT h = 0;
-};
-
 class CDX11SubPic : public CSubPicImpl
 {
 	MemPic_t m_MemPic;
@@ -71,6 +66,9 @@ class CDX11SubPicAllocator : public CSubPicAllocatorImpl, public CCritSec
 	CComPtr<ID3D11SamplerState> m_pSamplerPoint;
 	CComPtr<ID3D11SamplerState> m_pSamplerLinear;
 
+	// the picture whose content is in m_pOutputTexture
+	CSubPicUploadTracker m_UploadTracker;
+
 	bool Alloc(bool fStatic, ISubPic** ppSubPic) override;
 
 	HRESULT CreateOutputTex();
@@ -86,6 +84,8 @@ public:
 	HRESULT Render(const MemPic_t& memPic, const CRect& dirtyRect, const CRect& srcRect, const CRect& dstRect);
 
 	void GetStats(int& _nFree, int& _nAlloc);
+	// Bytes copied to the texture and bytes that were not copied again because the texture already had them.
+	void GetUploadStats(uint64_t& uploadedBytes, uint64_t& reusedBytes, uint32_t& uploads, uint32_t& reuses);
 
 	CDX11SubPicAllocator(ID3D11Device* pDevice, SIZE maxsize);
 	~CDX11SubPicAllocator();
@@ -0,0 +1,254 @@
+/*
+ * (C) 2025 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "stdafx.h"
+#include "MemSubPic.h"
+#include "Helper.h"
+
+//
+// CMemSubPic
+//
+
+CMemSubPic::CMemSubPic(SIZE maxsize)
+{
+	m_buffer.resize((size_t)maxsize.cx * maxsize.cy);
+	m_maxsize = maxsize;
+	m_rcDirty.SetRect(0, 0, maxsize.cx, maxsize.cy);
+}
+
+// ISubPic
+
+STDMETHODIMP_(void*) CMemSubPic::GetObject()
+{
+	return (void*)m_buffer.data();
+}
+
+STDMETHODIMP CMemSubPic::GetDesc(SubPicDesc& spd)
+{
+	spd.type    = 0;
+	spd.w       = m_size.cx;
+	spd.h       = m_size.cy;
+	spd.bpp     = 32;
+	spd.pitch   = m_maxsize.cx * 4;
+	spd.bits    = (BYTE*)m_buffer.data();
+	spd.vidrect = m_vidrect;
+
+	return S_OK;
+}
+
+STDMETHODIMP CMemSubPic::CopyTo(ISubPic* pSubPic)
+{
+	HRESULT hr;
+	if (FAILED(hr = __super::CopyTo(pSubPic))) {
+		return hr;
+	}
+
+	if (m_rcDirty.IsRectEmpty()) {
+		return S_FALSE;
+	}
+
+	SubPicDesc dst;
+	if (FAILED(pSubPic->GetDesc(dst)) || !dst.bits || dst.bpp != 32) {
+		return E_FAIL;
+	}
+
+	CSize maxsize;
+	pSubPic->GetMaxSize(&maxsize);
+	const UINT w = std::min(m_maxsize.cx, maxsize.cx);
+	const UINT h = std::min(m_maxsize.cy, maxsize.cy);
+
+	for (UINT y = 0; y < h; y++) {
+		memcpy(dst.bits + (size_t)dst.pitch * y, &m_buffer[(size_t)m_maxsize.cx * y], w * 4);
+	}
+
+	return S_OK;
+}
+
+STDMETHODIMP CMemSubPic::ClearDirtyRect()
+{
+	if (m_rcDirty.IsRectEmpty()) {
+		return S_FALSE;
+	}
+
+	return S_OK; // will be cleared in Lock
+}
+
+STDMETHODIMP CMemSubPic::Lock(SubPicDesc& spd)
+{
+	if (!m_rcDirty.IsRectEmpty()) {
+		uint32_t* ptr = &m_buffer[(size_t)m_maxsize.cx * m_rcDirty.top + m_rcDirty.left];
+		const UINT dirtyW = m_rcDirty.Width();
+		UINT dirtyH = m_rcDirty.Height();
+
+		while (dirtyH-- > 0) {
+			fill_u32(ptr, m_bInvAlpha ? 0x00000000 : 0xFF000000, dirtyW);
+			ptr += m_maxsize.cx;
+		}
+
+		m_rcDirty.SetRectEmpty();
+	}
+
+	return GetDesc(spd);
+}
+
+STDMETHODIMP CMemSubPic::Unlock(RECT* pDirtyRect)
+{
+	if (pDirtyRect) {
+		m_rcDirty = *pDirtyRect;
+		if (!m_rcDirty.IsRectEmpty()) {
+			m_rcDirty.InflateRect(1, 1);
+			m_rcDirty &= CRect(CPoint(0, 0), m_size);
+		}
+	} else {
+		m_rcDirty.SetRect(0, 0, m_size.cx, m_size.cy);
+	}
+
+	return S_OK;
+}
+
+STDMETHODIMP CMemSubPic::AlphaBlt(RECT* pSrc, RECT* pDst, SubPicDesc* pTarget)
+{
+	if (!pSrc || !pDst || !pTarget) {
+		return E_POINTER;
+	}
+	if (!pTarget->bits || pTarget->bpp != 32) {
+		return E_INVALIDARG;
+	}
+
+	const CRect rSrc(*pSrc);
+	const CRect rDst(*pDst);
+	if (rSrc.IsRectEmpty() || rDst.IsRectEmpty()) {
+		return S_FALSE;
+	}
+
+	CRect rClip;
+	if (!rClip.IntersectRect(rDst, CRect(0, 0, pTarget->w, pTarget->h))) {
+		return S_FALSE;
+	}
+
+	// the same border as in CDX9SubPic::AlphaBlt
+	const uint32_t transparent = m_bInvAlpha ? 0x00000000 : 0xFF000000;
+	const int maxX = m_size.cx - 1;
+	const int maxY = m_size.cy - 1;
+	auto Pixel = [&](const int x, const int y) {
+		return (x < 0 || y < 0 || x > maxX || y > maxY) ? transparent : m_buffer[(size_t)m_maxsize.cx * y + x];
+	};
+
+	// 16.16 source position of the centre of each destination pixel
+	const int64_t stepX = ((int64_t)rSrc.Width() << 16) / rDst.Width();
+	const int64_t stepY = ((int64_t)rSrc.Height() << 16) / rDst.Height();
+	const bool bScale = rSrc.Size() != rDst.Size();
+
+	for (int y = rClip.top; y < rClip.bottom; y++) {
+		uint32_t* dst = (uint32_t*)(pTarget->bits + (ptrdiff_t)pTarget->pitch * y);
+
+		const int64_t sy = ((int64_t)rSrc.top << 16) + (stepY * (2 * (y - rDst.top) + 1) >> 1) - 0x8000;
+		const int y0 = (int)(sy >> 16);
+		const UINT fy = (UINT)(sy >> 8) & 0xff;
+
+		for (int x = rClip.left; x < rClip.right; x++) {
+			uint32_t s;
+			if (bScale) {
+				const int64_t sx = ((int64_t)rSrc.left << 16) + (stepX * (2 * (x - rDst.left) + 1) >> 1) - 0x8000;
+				const int x0 = (int)(sx >> 16);
+				const UINT fx = (UINT)(sx >> 8) & 0xff;
+
+				const uint32_t p00 = Pixel(x0, y0);
+				const uint32_t p01 = Pixel(x0 + 1, y0);
+				const uint32_t p10 = Pixel(x0, y0 + 1);
+				const uint32_t p11 = Pixel(x0 + 1, y0 + 1);
+				s = 0;
+				for (int c = 0; c < 32; c += 8) {
+					const UINT top = ((p00 >> c) & 0xff) * (256 - fx) + ((p01 >> c) & 0xff) * fx;
+					const UINT bot = ((p10 >> c) & 0xff) * (256 - fx) + ((p11 >> c) & 0xff) * fx;
+					s |= ((top * (256 - fy) + bot * fy + 0x8000) >> 16) << c;
+				}
+			} else {
+				s = Pixel(x - rDst.left + rSrc.left, y - rDst.top + rSrc.top);
+			}
+
+			if (s == transparent) {
+				continue;
+			}
+
+			// pre-multiplied source, the destination is multiplied by the (inverse) alpha
+			const UINT a = m_bInvAlpha ? 255 - (s >> 24) : (s >> 24);
+			const uint32_t d = dst[x];
+			uint32_t r = d & 0xff000000;
+			for (int c = 0; c < 24; c += 8) {
+				const UINT v = ((s >> c) & 0xff) + (((d >> c) & 0xff) * a + 127) / 255;
+				r |= std::min(v, 255u) << c;
+			}
+			dst[x] = r;
+		}
+	}
+
+	return S_OK;
+}
+
+//
+// CMemSubPicAllocator
+//
+
+CMemSubPicAllocator::CMemSubPicAllocator(SIZE maxsize)
+	: CSubPicAllocatorImpl(maxsize, false)
+	, m_maxsize(maxsize)
+{
+}
+
+// ISubPicAllocator
+
+STDMETHODIMP CMemSubPicAllocator::ChangeDevice(IUnknown* pDev)
+{
+	// there is no device
+	return S_FALSE;
+}
+
+STDMETHODIMP CMemSubPicAllocator::SetMaxTextureSize(SIZE MaxTextureSize)
+{
+	CAutoLock cAutoLock(this);
+	m_maxsize = MaxTextureSize;
+
+	SetCurSize(MaxTextureSize);
+	SetCurVidRect(CRect(0,0, MaxTextureSize.cx, MaxTextureSize.cy));
+
+	return S_OK;
+}
+
+// ISubPicAllocatorImpl
+
+bool CMemSubPicAllocator::Alloc(bool fStatic, ISubPic** ppSubPic)
+{
+	if (!ppSubPic) {
+		return false;
+	}
+
+	CAutoLock cAutoLock(this);
+
+	*ppSubPic = new(std::nothrow) CMemSubPic(m_maxsize);
+	if (!(*ppSubPic)) {
+		return false;
+	}
+
+	(*ppSubPic)->AddRef();
+	(*ppSubPic)->SetInverseAlpha(m_bInvAlpha);
+
+	return true;
+}
@@ -0,0 +1,62 @@
+/*
+ * (C) 2025 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "SubPicImpl.h"
+
+// CMemSubPic - a subpicture in system memory for the software video processor
+
+class CMemSubPic : public CSubPicImpl
+{
+	std::vector<uint32_t> m_buffer; // A8R8G8B8, pre-multiplied, m_maxsize.cx pitch
+
+public:
+	CMemSubPic(SIZE maxsize);
+
+	// ISubPic
+protected:
+	STDMETHODIMP_(void*) GetObject() override; // returns the buffer
+public:
+	STDMETHODIMP GetDesc(SubPicDesc& spd) override;
+	STDMETHODIMP CopyTo(ISubPic* pSubPic) override;
+	STDMETHODIMP ClearDirtyRect() override;
+	STDMETHODIMP Lock(SubPicDesc& spd) override;
+	STDMETHODIMP Unlock(RECT* pDirtyRect) override;
+	// pTarget must be a 32-bit image, the source is scaled bilinearly
+	STDMETHODIMP AlphaBlt(RECT* pSrc, RECT* pDst, SubPicDesc* pTarget) override;
+};
+
+// CMemSubPicAllocator
+
+class CMemSubPicAllocator : public CSubPicAllocatorImpl, public CCritSec
+{
+	CSize m_maxsize;
+
+	// CSubPicAllocatorImpl
+	bool Alloc(bool fStatic, ISubPic** ppSubPic) override;
+
+public:
+	CMemSubPicAllocator(SIZE maxsize);
+
+	// ISubPicAllocator
+	STDMETHODIMP ChangeDevice(IUnknown* pDev) override;
+	STDMETHODIMP SetMaxTextureSize(SIZE MaxTextureSize) override;
+};
@@ -149,6 +149,7 @@ CSubPicQueue::CSubPicQueue(int nMaxSubPic, bool bDisableAnim, bool bAllowDropSub
 	, m_nMaxSubPic(nMaxSubPic)
 	, m_bDisableAnim(bDisableAnim)
 	, m_bAllowDropSubPic(bAllowDropSubPic)
+	, m_queue(std::max(nMaxSubPic, 1))
 {
 	if (phr && FAILED(*phr)) {
 		return;
@@ -208,41 +209,27 @@ STDMETHODIMP CSubPicQueue::SetTime(REFERENCE_TIME rtNow)
 
 STDMETHODIMP CSubPicQueue::Invalidate(REFERENCE_TIME rtInvalidate)
 {
-	std::unique_lock<std::mutex> lock(m_mutexQueue);
-
 #if SUBPIC_TRACE_LEVEL > 0
 	DLog(L"Invalidate: %f", double(rtInvalidate) / 10000000.0);
 #endif
 
-	m_bInvalidate = true;
 	m_rtInvalidate = rtInvalidate;
+	m_bInvalidate = true;
 	m_rtNowLast = LONGLONG_ERROR;
 
-	{
-		std::lock_guard<std::mutex> lock(m_mutexSubpic);
-		if (m_pSubPic && m_pSubPic->GetStop() > rtInvalidate) {
-			m_pSubPic.Release();
-		}
-	}
+	// m_pSubPic belongs to the render thread, it is dropped on the next lookup
+	REFERENCE_TIME rtPending = m_rtInvalidateSubPic;
+	while (rtInvalidate < rtPending && !m_rtInvalidateSubPic.compare_exchange_weak(rtPending, rtInvalidate));
 
-	while (m_queue.size() && m_queue.back()->GetStop() > rtInvalidate) {
-#if SUBPIC_TRACE_LEVEL > 2
-		const CComPtr<ISubPic>& pSubPic = m_queue.back();
-		REFERENCE_TIME rtStart = pSubPic->GetStart();
-		REFERENCE_TIME rtStop = pSubPic->GetStop();
-		REFERENCE_TIME rtSegmentStop = pSubPic->GetSegmentStop();
-		DLog(L"  %f -> %f -> %f", double(rtStart) / 10000000.0, double(rtStop) / 10000000.0, double(rtSegmentStop) / 10000000.0);
-#endif
-		m_queue.pop_back();
-	}
+	// The subpics are only marked here, the renderer thread releases them from the back
+	// and LookupSubPic skips them at the front
+	m_queue.Invalidate(rtInvalidate);
 
 	// If we invalidate in the past, always give the queue a chance to re-render the modified subtitles
 	if (rtInvalidate >= 0 && rtInvalidate < m_rtNow) {
 		m_rtNow = rtInvalidate;
 	}
 
-	lock.unlock();
-	m_condQueueFull.notify_one();
 	m_runQueueEvent.Set();
 
 	return S_OK;
@@ -258,97 +245,100 @@ STDMETHODIMP_(bool) CSubPicQueue::LookupSubPic(REFERENCE_TIME rtNow, bool bAdvis
 {
 	bool bStopSearch = false;
 
-	{
-		std::lock_guard<std::mutex> lock(m_mutexSubpic);
+	const REFERENCE_TIME rtInvalidate = m_rtInvalidateSubPic.exchange(MAXLONGLONG);
+	if (m_pSubPic && m_pSubPic->GetStop() > rtInvalidate) {
+		m_pSubPic.Release();
+	}
 
-		// See if we can reuse the latest subpic
-		if (m_pSubPic) {
-			REFERENCE_TIME rtSegmentStart = m_pSubPic->GetSegmentStart();
-			REFERENCE_TIME rtSegmentStop = m_pSubPic->GetSegmentStop();
+	// See if we can reuse the latest subpic
+	if (m_pSubPic) {
+		REFERENCE_TIME rtSegmentStart = m_pSubPic->GetSegmentStart();
+		REFERENCE_TIME rtSegmentStop = m_pSubPic->GetSegmentStop();
 
-			if (rtSegmentStart <= rtNow && rtNow < rtSegmentStop) {
-				ppSubPic = m_pSubPic;
+		if (rtSegmentStart <= rtNow && rtNow < rtSegmentStop) {
+			ppSubPic = m_pSubPic;
 
-				REFERENCE_TIME rtStart = m_pSubPic->GetStart();
-				REFERENCE_TIME rtStop = m_pSubPic->GetStop();
+			REFERENCE_TIME rtStart = m_pSubPic->GetStart();
+			REFERENCE_TIME rtStop = m_pSubPic->GetStop();
 
-				if (rtStart <= rtNow && rtNow < rtStop) {
+			if (rtStart <= rtNow && rtNow < rtStop) {
 #if SUBPIC_TRACE_LEVEL > 2
-					DLog(L"LookupSubPic: Exact match on the latest subpic");
+				DLog(L"LookupSubPic: Exact match on the latest subpic");
 #endif
-					bStopSearch = true;
-				} else {
+				bStopSearch = true;
+			} else {
 #if SUBPIC_TRACE_LEVEL > 2
-					DLog(L"LookupSubPic: Possible match on the latest subpic");
+				DLog(L"LookupSubPic: Possible match on the latest subpic");
 #endif
-				}
-			} else if (rtSegmentStop <= rtNow) {
-				m_pSubPic.Release();
 			}
+		} else if (rtSegmentStop <= rtNow) {
+			m_pSubPic.Release();
 		}
 	}
 
 	bool bTryBlocking = bAdviseBlocking || !m_bAllowDropSubPic;
 	while (!bStopSearch) {
 		// Look for the subpic in the queue
-		{
-			std::unique_lock<std::mutex> lock(m_mutexQueue);
-
 #if SUBPIC_TRACE_LEVEL > 2
-			DLog(L"LookupSubPic: Searching the queue");
+		DLog(L"LookupSubPic: Searching the queue");
 #endif
 
-			while (m_queue.size() && !bStopSearch) {
-				const CComPtr<ISubPic>& pSubPic = m_queue.front();
-				REFERENCE_TIME rtSegmentStart = pSubPic->GetSegmentStart();
+		CSubPicRing<ISubPic>::Entry entry;
+		while (!bStopSearch && m_queue.PeekFront(entry)) {
+			bool bRemoveFromQueue = true;
+			bool bUseSubPic = false;
+			bool bStop = false;
 
-				if (rtSegmentStart > rtNow) {
+			if (entry.bInvalid) {
+				// dropped by Invalidate
+			} else if (entry.rtSegmentStart > rtNow) {
 #if SUBPIC_TRACE_LEVEL > 2
-					DLog(L"rtSegmentStart > rtNow, stopping the search");
+				DLog(L"rtSegmentStart > rtNow, stopping the search");
 #endif
-					bStopSearch = true;
-				} else { // rtSegmentStart <= rtNow
-					bool bRemoveFromQueue = true;
-					REFERENCE_TIME rtStart = pSubPic->GetStart();
-					REFERENCE_TIME rtStop = pSubPic->GetStop();
-					REFERENCE_TIME rtSegmentStop = pSubPic->GetSegmentStop();
-
-					if (rtSegmentStop <= rtNow) {
+				bRemoveFromQueue = false;
+				bStop = true;
+			} else { // rtSegmentStart <= rtNow
+				if (entry.rtSegmentStop <= rtNow) {
 #if SUBPIC_TRACE_LEVEL > 2
-						DLog(L"Removing old subpic (rtNow=%f): %f -> %f -> %f",
-							  double(rtNow) / 10000000.0, double(rtStart) / 10000000.0,
-							  double(rtStop) / 10000000.0, double(rtSegmentStop) / 10000000.0);
+					DLog(L"Removing old subpic (rtNow=%f): %f -> %f -> %f",
+						  double(rtNow) / 10000000.0, double(entry.rtStart) / 10000000.0,
+						  double(entry.rtStop) / 10000000.0, double(entry.rtSegmentStop) / 10000000.0);
 #endif
-					} else { // rtNow < rtSegmentStop
-						if (rtStart <= rtNow && rtNow < rtStop) {
+				} else { // rtNow < rtSegmentStop
+					if (entry.rtStart <= rtNow && rtNow < entry.rtStop) {
 #if SUBPIC_TRACE_LEVEL > 2
-							DLog(L"Exact match found in the queue");
+						DLog(L"Exact match found in the queue");
 #endif
-							ppSubPic = pSubPic;
-							bStopSearch = true;
-						} else if (rtNow >= rtStop) {
-							// Reuse old subpic
-							ppSubPic = pSubPic;
-						} else { // rtNow < rtStart
-							if (!ppSubPic || ppSubPic->GetStop() <= rtNow) {
-								// Should be really rare that we use a subpic in advance
-								// unless we mispredicted the timing slightly
-								ppSubPic = pSubPic;
-							} else {
-								bRemoveFromQueue = false;
-							}
-							bStopSearch = true;
+						bUseSubPic = true;
+						bStop = true;
+					} else if (rtNow >= entry.rtStop) {
+						// Reuse old subpic
+						bUseSubPic = true;
+					} else { // rtNow < rtStart
+						if (!ppSubPic || ppSubPic->GetStop() <= rtNow) {
+							// Should be really rare that we use a subpic in advance
+							// unless we mispredicted the timing slightly
+							bUseSubPic = true;
+						} else {
+							bRemoveFromQueue = false;
 						}
+						bStop = true;
 					}
+				}
+			}
 
-					if (bRemoveFromQueue) {
-						m_queue.pop_front();
-					}
+			if (bRemoveFromQueue) {
+				CComPtr<ISubPic> pSubPic;
+				if (!m_queue.PopFront(entry, pSubPic)) {
+					// the renderer thread changed the queue meanwhile, look again
+					continue;
+				}
+				if (bUseSubPic) {
+					ppSubPic = pSubPic;
 				}
 			}
 
-			lock.unlock();
-			m_condQueueFull.notify_one();
+			bStopSearch = bStop;
 		}
 
 		// If we didn't get any subpic yet and blocking is advised, just try harder to get one
@@ -370,15 +360,20 @@ STDMETHODIMP_(bool) CSubPicQueue::LookupSubPic(REFERENCE_TIME rtNow, bool bAdvis
 				pSubPicProviderWithSharedLock->Unlock();
 
 				if (!bStopSearch) {
-					std::unique_lock<std::mutex> lock(m_mutexQueue);
-
 					auto queueReady = [this, rtNow]() {
-						return ((int)m_queue.size() == m_nMaxSubPic)
-							   || (m_queue.size() && m_queue.back()->GetStop() > rtNow);
+						CSubPicRing<ISubPic>::Entry back;
+						return (m_queue.GetCount() == m_queue.GetCapacity())
+							   || (m_queue.GetBack(back) && back.rtStop > rtNow);
 					};
 
 					auto duration = bAdviseBlocking ? std::chrono::milliseconds(m_rtTimePerFrame / 10000) : std::chrono::seconds(1);
-					m_condQueueReady.wait_for(lock, duration, queueReady);
+					const auto deadline = std::chrono::steady_clock::now() + duration;
+					while (!queueReady()) {
+						const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+						if (timeout <= 0 || !m_queueReadyEvent.Wait((DWORD)timeout)) {
+							break;
+						}
+					}
 				}
 			}
 		} else {
@@ -388,7 +383,6 @@ STDMETHODIMP_(bool) CSubPicQueue::LookupSubPic(REFERENCE_TIME rtNow, bool bAdvis
 
 	if (ppSubPic) {
 		// Save the subpic for later reuse
-		std::lock_guard<std::mutex> lock(m_mutexSubpic);
 		m_pSubPic = ppSubPic;
 
 #if SUBPIC_TRACE_LEVEL > 0
@@ -412,13 +406,13 @@ STDMETHODIMP_(bool) CSubPicQueue::LookupSubPic(REFERENCE_TIME rtNow, bool bAdvis
 
 STDMETHODIMP CSubPicQueue::GetStats(int& nSubPics, REFERENCE_TIME& rtNow, REFERENCE_TIME& rtStart, REFERENCE_TIME& rtStop)
 {
-	std::lock_guard<std::mutex> lock(m_mutexQueue);
+	CSubPicRing<ISubPic>::Entry front, back;
 
-	nSubPics = (int)m_queue.size();
+	nSubPics = (int)m_queue.GetCount();
 	rtNow = m_rtNow;
-	if (nSubPics) {
-		rtStart = m_queue.front()->GetStart();
-		rtStop = m_queue.back()->GetStop();
+	if (m_queue.GetEntry(0, front) && m_queue.GetBack(back)) {
+		rtStart = front.rtStart;
+		rtStop = back.rtStop;
 	} else {
 		rtStart = rtStop = 0;
 	}
@@ -428,15 +422,12 @@ STDMETHODIMP CSubPicQueue::GetStats(int& nSubPics, REFERENCE_TIME& rtNow, REFERE
 
 STDMETHODIMP CSubPicQueue::GetStats(int nSubPic, REFERENCE_TIME& rtStart, REFERENCE_TIME& rtStop)
 {
-	std::lock_guard<std::mutex> lock(m_mutexQueue);
-
 	HRESULT hr = E_INVALIDARG;
 
-	if (nSubPic >= 0 && nSubPic < (int)m_queue.size()) {
-		auto it = m_queue.cbegin();
-		std::advance(it, nSubPic);
-		rtStart = (*it)->GetStart();
-		rtStop  = (*it)->GetStop();
+	CSubPicRing<ISubPic>::Entry entry;
+	if (nSubPic >= 0 && m_queue.GetEntry(nSubPic, entry)) {
+		rtStart = entry.rtStart;
+		rtStop  = entry.rtStop;
 		hr = S_OK;
 	} else {
 		rtStart = rtStop = -1;
@@ -449,30 +440,36 @@ STDMETHODIMP CSubPicQueue::GetStats(int nSubPic, REFERENCE_TIME& rtStart, REFERE
 
 bool CSubPicQueue::EnqueueSubPic(CComPtr<ISubPic>& pSubPic, bool bBlocking)
 {
-	auto canAddToQueue = [this]() {
-		return (int)m_queue.size() < m_nMaxSubPic;
-	};
-
 	bool bAdded = false;
 
-	std::unique_lock<std::mutex> lock(m_mutexQueue);
-	if (bBlocking) {
-		// Wait for enough room in the queue
-		m_condQueueFull.wait(lock, canAddToQueue);
-	}
+	for (;;) {
+		const uint32_t spaceCounter = m_queue.GetSpaceCounter();
+		m_queue.ReclaimInvalidated();
 
-	if (canAddToQueue()) {
 		if (m_bInvalidate && pSubPic->GetStop() > m_rtInvalidate) {
 #if SUBPIC_TRACE_LEVEL > 1
 			DLog(L"Subtitle Renderer Thread: Dropping rendered subpic because of invalidation");
 #endif
-		} else {
-			m_queue.emplace_back(pSubPic);
-			lock.unlock();
-			m_condQueueReady.notify_one();
+			pSubPic.Release();
+			break;
+		}
+
+		if (m_queue.Push(pSubPic)) {
+			// Invalidate() could run between the check above and the push
+			if (m_bInvalidate) {
+				m_queue.Invalidate(m_rtInvalidate);
+			}
+			m_queueReadyEvent.Set();
 			bAdded = true;
+			break;
 		}
-		pSubPic.Release();
+
+		if (!bBlocking) {
+			break;
+		}
+
+		// Wait for enough room in the queue
+		m_queue.WaitForSpace(spaceCounter);
 	}
 
 	return bAdded;
@@ -482,12 +479,11 @@ REFERENCE_TIME CSubPicQueue::GetCurrentRenderingTime()
 {
 	REFERENCE_TIME rtNow = -1;
 
-	{
-		std::lock_guard<std::mutex> lock(m_mutexQueue);
+	m_queue.ReclaimInvalidated();
 
-		if (m_queue.size()) {
-			rtNow = m_queue.back()->GetStop();
-		}
+	CSubPicRing<ISubPic>::Entry back;
+	if (m_queue.GetBack(back)) {
+		rtNow = back.rtStop;
 	}
 
 	return std::max(rtNow, m_rtNow);
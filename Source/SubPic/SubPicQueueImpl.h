@@ -23,10 +23,10 @@
 
 #include <memory>
 #include <mutex>
-#include <deque>
-#include <condition_variable>
+#include <atomic>
 
 #include "ISubPic.h"
+#include "SubPicRing.h"
 
 class CSubPicQueueImpl : public CUnknown, public ISubPicQueue
 {
@@ -134,20 +134,18 @@ protected:
 
 	bool m_bExitThread = false;
 
-	CComPtr<ISubPic> m_pSubPic;
-	std::deque<CComQIPtr<ISubPic>> m_queue;
+	CComPtr<ISubPic> m_pSubPic; // used by LookupSubPic only
+	std::atomic<REFERENCE_TIME> m_rtInvalidateSubPic = MAXLONGLONG; // pending invalidation of m_pSubPic
 
-	std::mutex m_mutexSubpic; // to protect m_pSubPic
-	std::mutex m_mutexQueue; // to protect m_queue
-	std::condition_variable m_condQueueFull;
-	std::condition_variable m_condQueueReady;
+	CSubPicRing<ISubPic> m_queue; // the renderer thread produces, LookupSubPic consumes
 
+	CAMEvent m_queueReadyEvent;
 	CAMEvent m_runQueueEvent;
 
 	REFERENCE_TIME m_rtNowLast = LONGLONG_ERROR;
 
-	bool m_bInvalidate = false;
-	REFERENCE_TIME m_rtInvalidate = 0;
+	std::atomic<bool> m_bInvalidate = false;
+	std::atomic<REFERENCE_TIME> m_rtInvalidate = 0;
 
 	bool EnqueueSubPic(CComPtr<ISubPic>& pSubPic, bool bBlocking);
 	REFERENCE_TIME GetCurrentRenderingTime();
@@ -0,0 +1,222 @@
+/*
+ * (C) 2025 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+//
+// Bounded lock-free queue of subpictures for one producer (the subtitle renderer thread)
+// and one consumer (the video render thread).
+//
+// Head, tail and a generation are packed in one 64-bit word, so that the consumer popping the front and
+// the producer retracting invalidated subpictures from the back can never take the same slot.
+// The timings are copied into the slots on push, the queue never calls into a subpicture
+// it does not own. Invalidate() only marks slots and can be called from any thread.
+//
+
+template <class T>
+class CSubPicRing
+{
+public:
+	struct Entry {
+		REFERENCE_TIME rtStart;
+		REFERENCE_TIME rtStop;
+		REFERENCE_TIME rtSegmentStart;
+		REFERENCE_TIME rtSegmentStop;
+		bool bInvalid;
+		uint64_t state; // queue state the entry was read at, for PopFront
+	};
+
+private:
+	struct Slot {
+		std::atomic<uint64_t> tag = 0; // (sequence << 1) | invalid
+		std::atomic<REFERENCE_TIME> rtStart = 0;
+		std::atomic<REFERENCE_TIME> rtStop = 0;
+		std::atomic<REFERENCE_TIME> rtSegmentStart = 0;
+		std::atomic<REFERENCE_TIME> rtSegmentStop = 0;
+		std::atomic<T*> pSubPic = nullptr; // owned reference while the slot is between head and tail
+	};
+
+	std::unique_ptr<Slot[]> m_slots;
+	const uint32_t m_capacity;
+	const uint32_t m_seqModulo; // sequence numbers wrap at a multiple of the capacity
+
+	// head:24 | tail:24 | generation:16. The generation changes when the producer retracts the back,
+	// so that the consumer can not pop a slot that was retracted and refilled since it was peeked.
+	std::atomic<uint64_t> m_state = 0;
+	std::atomic<uint32_t> m_spaceCounter = 0; // changes whenever room may have appeared
+
+	static uint32_t Head(const uint64_t state) { return (uint32_t)(state >> 40); }
+	static uint32_t Tail(const uint64_t state) { return (uint32_t)(state >> 16) & 0xffffff; }
+	static uint64_t Gen(const uint64_t state)  { return state & 0xffff; }
+	static uint64_t State(const uint32_t head, const uint32_t tail, const uint64_t gen) {
+		return ((uint64_t)head << 40) | ((uint64_t)tail << 16) | (gen & 0xffff);
+	}
+
+	uint32_t Next(const uint32_t seq) const { return (seq + 1 == m_seqModulo) ? 0 : seq + 1; }
+	uint32_t Prev(const uint32_t seq) const { return (seq == 0) ? m_seqModulo - 1 : seq - 1; }
+	uint32_t Count(const uint64_t state) const { return (Tail(state) + m_seqModulo - Head(state)) % m_seqModulo; }
+
+	Slot& GetSlot(const uint32_t seq) { return m_slots[seq % m_capacity]; }
+
+	void NotifySpace() {
+		m_spaceCounter.fetch_add(1);
+		m_spaceCounter.notify_one();
+	}
+
+public:
+	CSubPicRing(const uint32_t capacity)
+		: m_slots(std::make_unique<Slot[]>(capacity))
+		, m_capacity(capacity)
+		, m_seqModulo((0x1000000u / capacity) * capacity)
+	{
+		ASSERT(capacity > 0 && capacity <= 0x1000);
+	}
+
+	// the threads must be stopped
+	~CSubPicRing() {
+		const uint64_t state = m_state.load();
+		for (uint32_t seq = Head(state); seq != Tail(state); seq = Next(seq)) {
+			GetSlot(seq).pSubPic.load()->Release();
+		}
+	}
+
+	uint32_t GetCapacity() const { return m_capacity; }
+
+	uint32_t GetCount() const { return Count(m_state.load()); }
+
+	// Any thread, for statistics. Returns false if there is no such entry.
+	bool GetEntry(const uint32_t index, Entry& entry) {
+		const uint64_t state = m_state.load();
+		if (index >= Count(state)) {
+			return false;
+		}
+		Slot& slot = GetSlot((Head(state) + index) % m_seqModulo);
+		entry.bInvalid       = slot.tag.load() & 1;
+		entry.rtStart        = slot.rtStart.load();
+		entry.rtStop         = slot.rtStop.load();
+		entry.rtSegmentStart = slot.rtSegmentStart.load();
+		entry.rtSegmentStop  = slot.rtSegmentStop.load();
+		entry.state = state;
+		return true;
+	}
+
+	bool GetBack(Entry& entry) {
+		const uint32_t count = GetCount();
+		return count && GetEntry(count - 1, entry);
+	}
+
+	// Marks the subpictures at the back that stop after rtInvalidate. Any thread.
+	void Invalidate(const REFERENCE_TIME rtInvalidate) {
+		const uint64_t state = m_state.load();
+		for (uint32_t seq = Tail(state); seq != Head(state); ) {
+			seq = Prev(seq);
+			Slot& slot = GetSlot(seq);
+			uint64_t tag = slot.tag.load();
+			if ((tag >> 1) != seq) {
+				break; // consumed and reused meanwhile
+			}
+			if (slot.rtStop.load() <= rtInvalidate) {
+				break;
+			}
+			// fails harmlessly if the slot is being reused
+			slot.tag.compare_exchange_strong(tag, tag | 1);
+		}
+		NotifySpace();
+	}
+
+	//
+	// Producer
+	//
+
+	// Takes the reference from pSubPic on success. Fails if the queue is full.
+	bool Push(CComPtr<T>& pSubPic) {
+		uint64_t state = m_state.load();
+		if (Count(state) >= m_capacity) {
+			return false;
+		}
+		const uint32_t tail = Tail(state);
+
+		// the slot after the tail is free and stays free while only the head moves
+		Slot& slot = GetSlot(tail);
+		slot.pSubPic        = pSubPic.p;
+		slot.rtStart        = pSubPic->GetStart();
+		slot.rtStop         = pSubPic->GetStop();
+		slot.rtSegmentStart = pSubPic->GetSegmentStart();
+		slot.rtSegmentStop  = pSubPic->GetSegmentStop();
+		slot.tag            = (uint64_t)tail << 1;
+
+		while (!m_state.compare_exchange_weak(state, State(Head(state), Next(tail), Gen(state)))) {
+			ASSERT(Tail(state) == tail);
+		}
+
+		pSubPic.Detach();
+		return true;
+	}
+
+	// Releases the invalidated subpictures at the back of the queue.
+	void ReclaimInvalidated() {
+		uint64_t state = m_state.load();
+		while (Tail(state) != Head(state)) {
+			const uint32_t last = Prev(Tail(state));
+			Slot& slot = GetSlot(last);
+			if (!(slot.tag.load() & 1)) {
+				break;
+			}
+			T* pSubPic = slot.pSubPic.load();
+			if (m_state.compare_exchange_weak(state, State(Head(state), last, Gen(state) + 1))) {
+				pSubPic->Release();
+				state = m_state.load();
+			}
+		}
+	}
+
+	uint32_t GetSpaceCounter() const { return m_spaceCounter.load(); }
+
+	// Blocks while the space counter is equal to spaceCounter.
+	void WaitForSpace(const uint32_t spaceCounter) {
+		m_spaceCounter.wait(spaceCounter);
+	}
+
+	//
+	// Consumer
+	//
+
+	bool PeekFront(Entry& entry) {
+		return GetEntry(0, entry);
+	}
+
+	// Removes the entry read by PeekFront and returns its subpicture.
+	// Fails if the queue changed since then, the entry has to be peeked again.
+	bool PopFront(const Entry& entry, CComPtr<T>& pSubPic) {
+		const uint32_t head = Head(entry.state);
+		// the slot can not be refilled before the head moves or the generation changes
+		T* p = GetSlot(head).pSubPic.load();
+		uint64_t state = entry.state;
+		if (!m_state.compare_exchange_strong(state, State(Next(head), Tail(state), Gen(state)))) {
+			return false;
+		}
+		pSubPic.Attach(p);
+		NotifySpace();
+		return true;
+	}
+};
@@ -0,0 +1,101 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+struct MemPic_t {
+	std::unique_ptr<uint32_t[]> data;
+	UINT w = 0;
+	UINT h = 0;
+	uint64_t generation = 0; // changes with the content, unique across all pictures
+};
+
+// Gives the picture a new generation, so that the allocator uploads it again.
+inline void MemPicContentChanged(MemPic_t& memPic)
+{
+	static std::atomic<uint64_t> s_generation = 0;
+	memPic.generation = ++s_generation;
+}
+
+//
+// Remembers which picture and which rectangle of it the output texture of the subpicture
+// allocator holds, so that an unchanged picture is not copied to the texture again.
+// Counts the uploaded and the reused bytes. Does not depend on Direct3D.
+//
+
+class CSubPicUploadTracker
+{
+	struct {
+		const uint32_t* data = nullptr;
+		uint64_t generation = 0;
+		RECT rect = {};
+	} m_resident;
+
+	std::atomic<uint64_t> m_nUploadedBytes = 0;
+	std::atomic<uint64_t> m_nReusedBytes   = 0;
+	std::atomic<uint32_t> m_nUploads       = 0;
+	std::atomic<uint32_t> m_nReuses        = 0;
+
+	static uint64_t GetBytes(const RECT& rect)
+	{
+		return (uint64_t)(rect.right - rect.left) * (rect.bottom - rect.top) * 4;
+	}
+
+public:
+	// Returns true and counts the reuse if the texture already has the rectangle of the picture.
+	// Otherwise the caller uploads the rectangle and calls Uploaded(), or Reset() if that fails.
+	bool IsResident(const MemPic_t& memPic, const RECT& copyRect)
+	{
+		const bool bEmpty = copyRect.right <= copyRect.left || copyRect.bottom <= copyRect.top;
+		const bool bResident = m_resident.data == memPic.data.get() && m_resident.generation == memPic.generation
+			&& (bEmpty || (copyRect.left >= m_resident.rect.left && copyRect.top >= m_resident.rect.top
+				&& copyRect.right <= m_resident.rect.right && copyRect.bottom <= m_resident.rect.bottom));
+		if (bResident) {
+			m_nReusedBytes += bEmpty ? 0 : GetBytes(copyRect);
+			m_nReuses++;
+		}
+		return bResident;
+	}
+
+	void Uploaded(const MemPic_t& memPic, const RECT& copyRect)
+	{
+		m_resident = { memPic.data.get(), memPic.generation, copyRect };
+		m_nUploadedBytes += GetBytes(copyRect);
+		m_nUploads++;
+	}
+
+	// the content of the texture is unknown or the texture is recreated
+	void Reset()
+	{
+		m_resident = {};
+	}
+
+	void GetStats(uint64_t& uploadedBytes, uint64_t& reusedBytes, uint32_t& uploads, uint32_t& reuses) const
+	{
+		uploadedBytes = m_nUploadedBytes;
+		reusedBytes   = m_nReusedBytes;
+		uploads       = m_nUploads;
+		reuses        = m_nReuses;
+	}
+};
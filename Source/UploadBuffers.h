@@ -0,0 +1,64 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+
+#include <vector>
+#include <limits>
+
+// A video processor that can upload the sample buffers of CCustomAllocator directly,
+// so that the decoded frames are not copied again by the CPU. The allocator places
+// each buffer at GetAlignment() and reports the buffers after each allocation.
+class CUploadBuffers
+{
+public:
+	virtual ~CUploadBuffers() = default;
+
+	// the alignment of the address of each buffer, e.g. the page size
+	virtual LONG GetAlignment() = 0;
+
+	// the buffers of size bytes stay valid until ReleaseBuffers()
+	virtual void SetBuffers(const std::vector<BYTE*>& buffers, const LONG size) = 0;
+	virtual void ReleaseBuffers() = 0;
+};
+
+// The layout of the sample buffers of CCustomAllocator: each buffer of size bytes follows
+// a prefix of prefix bytes, and the prefixes start at the alignment. The buffers can be
+// given to CUploadBuffers when they start at its alignment too.
+struct SampleBuffersLayout_t {
+	LONG alignment   = 1;
+	LONG alignedSize = 0;     // the distance of the buffers
+	bool bUpload     = false; // the buffers start at uploadAlignment
+};
+
+// uploadAlignment is 0 without CUploadBuffers, returns false if the size does not fit in LONG
+inline bool GetSampleBuffersLayout(const LONG size, const LONG prefix, const LONG alignment, const LONG uploadAlignment, SampleBuffersLayout_t& layout)
+{
+	layout.bUpload = uploadAlignment > 0 && alignment > 0 && prefix % uploadAlignment == 0 && uploadAlignment % alignment == 0;
+	layout.alignment = layout.bUpload ? uploadAlignment : std::max(alignment, 1);
+
+	const int64_t alignedSize = ((int64_t)size + prefix + layout.alignment - 1) / layout.alignment * layout.alignment;
+	if (alignedSize > std::numeric_limits<LONG>::max()) {
+		return false;
+	}
+	layout.alignedSize = (LONG)alignedSize;
+
+	return true;
+}
@@ -0,0 +1,95 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+//
+// FNV-1a 64-bit hash. Not cryptographic, used for cache keys and change detection.
+//
+
+constexpr uint64_t FNV1A64_OFFSET = 0xcbf29ce484222325ull;
+constexpr uint64_t FNV1A64_PRIME  = 0x00000100000001b3ull;
+
+inline uint64_t hash_fnv1a64(const void* data, const size_t size, uint64_t hash = FNV1A64_OFFSET)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; i++) {
+		hash ^= p[i];
+		hash *= FNV1A64_PRIME;
+	}
+	return hash;
+}
+
+inline uint64_t hash_fnv1a64(const std::string_view sv, uint64_t hash = FNV1A64_OFFSET)
+{
+	return hash_fnv1a64(sv.data(), sv.size(), hash);
+}
+
+template <typename T>
+inline uint64_t hash_fnv1a64_value(const T& value, uint64_t hash = FNV1A64_OFFSET)
+{
+	return hash_fnv1a64(&value, sizeof(value), hash);
+}
+
+//
+// Hashes 8 bytes per step, for change detection of blocks where the byte-wise FNV-1a is too slow.
+// The result is not the same as hash_fnv1a64() of the data.
+//
+
+constexpr uint64_t HASH_MIX64_MULTIPLIER = 0x9e3779b97f4a7c15ull;
+
+inline uint64_t hash_mix64(const void* data, const size_t size, uint64_t hash = FNV1A64_OFFSET)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+	size_t i = 0;
+	if (size >= 64) {
+		// four lanes, so that the multiplications do not wait for each other
+		uint64_t lanes[4] = { hash, hash + 1, hash + 2, hash + 3 };
+		for (; i + 32 <= size; i += 32) {
+			for (int k = 0; k < 4; k++) {
+				uint64_t word;
+				memcpy(&word, p + i + k * 8, 8);
+				lanes[k] = (lanes[k] ^ word) * HASH_MIX64_MULTIPLIER;
+				lanes[k] ^= lanes[k] >> 32;
+			}
+		}
+		for (int k = 0; k < 4; k++) {
+			hash = (hash ^ lanes[k]) * HASH_MIX64_MULTIPLIER;
+			hash ^= hash >> 32;
+		}
+	}
+	for (; i + 8 <= size; i += 8) {
+		uint64_t word;
+		memcpy(&word, p + i, 8);
+		hash = (hash ^ word) * HASH_MIX64_MULTIPLIER;
+		hash ^= hash >> 32;
+	}
+	if (i < size) {
+		uint64_t word = 0;
+		memcpy(&word, p + i, size - i);
+		hash = (hash ^ word ^ ((uint64_t)(size - i) << 56)) * HASH_MIX64_MULTIPLIER;
+		hash ^= hash >> 32;
+	}
+	return hash;
+}
@@ -68,6 +68,7 @@ DEFINE_MEDIATYPE_GUID(MEDIASUBTYPE_Y42B,      0x42323459);
 DEFINE_MEDIATYPE_GUID(MEDIASUBTYPE_444P,      0x50343434);
 DEFINE_MEDIATYPE_GUID(MEDIASUBTYPE_Y210,      0x30313259);
 DEFINE_MEDIATYPE_GUID(MEDIASUBTYPE_Y216,      0x36313259);
+DEFINE_MEDIATYPE_GUID(MEDIASUBTYPE_v210,      0x30313276);
 DEFINE_MEDIATYPE_GUID(MEDIASUBTYPE_Y410,      0x30313459);
 DEFINE_MEDIATYPE_GUID(MEDIASUBTYPE_Y416,      0x36313459);
 DEFINE_MEDIATYPE_GUID(MEDIASUBTYPE_YUV444P16, 0x10003359); // Y3[0][16]
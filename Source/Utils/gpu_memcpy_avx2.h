@@ -0,0 +1,102 @@
+/*
+ * (C) 2025 see Authors.txt
+ *
+ * This file is part of MPC-BE.
+ *
+ * MPC-BE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MPC-BE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <immintrin.h>
+
+// gpu_memcpy_avx2 is an AVX2 version of gpu_memcpy.
+// The source is read with 32 byte streaming loads (VMOVNTDQA ymm), every loop reads
+// four whole cache lines before it writes them.
+// Misaligned heads and tails are copied with unaligned loads and stores,
+// so unlike gpu_memcpy it does not fall back to memcpy for unaligned pointers.
+inline void *gpu_memcpy_avx2(void *d, const void *s, size_t size)
+{
+    if (d == nullptr || s == nullptr)
+        return nullptr;
+
+    if (size < 64)
+    {
+        return memcpy(d, s, size);
+    }
+
+    const BYTE *pSrc = (const BYTE *)s;
+    BYTE *pTrg = (BYTE *)d;
+    const BYTE *const pSrcEnd = pSrc + size;
+
+    // Make sure source is synced - doesn't hurt if not needed.
+    _mm_sfence();
+
+    // Copy the head up to the 32 byte aligned source address
+    const size_t head = (0 - (size_t)pSrc) & 31;
+    if (head)
+    {
+        _mm256_storeu_si256((__m256i *)pTrg, _mm256_loadu_si256((const __m256i *)pSrc));
+        pSrc += head;
+        pTrg += head;
+    }
+
+    // Copy 256 bytes every loop
+    while ((size_t)(pSrcEnd - pSrc) >= 256)
+    {
+        const __m256i ymm0 = _mm256_stream_load_si256((const __m256i *)pSrc);
+        const __m256i ymm1 = _mm256_stream_load_si256((const __m256i *)pSrc + 1);
+        const __m256i ymm2 = _mm256_stream_load_si256((const __m256i *)pSrc + 2);
+        const __m256i ymm3 = _mm256_stream_load_si256((const __m256i *)pSrc + 3);
+        const __m256i ymm4 = _mm256_stream_load_si256((const __m256i *)pSrc + 4);
+        const __m256i ymm5 = _mm256_stream_load_si256((const __m256i *)pSrc + 5);
+        const __m256i ymm6 = _mm256_stream_load_si256((const __m256i *)pSrc + 6);
+        const __m256i ymm7 = _mm256_stream_load_si256((const __m256i *)pSrc + 7);
+
+        _ReadWriteBarrier();
+
+        // the destination can be misaligned after the head, unaligned stores to cached memory are cheap
+        _mm256_storeu_si256((__m256i *)pTrg, ymm0);
+        _mm256_storeu_si256((__m256i *)pTrg + 1, ymm1);
+        _mm256_storeu_si256((__m256i *)pTrg + 2, ymm2);
+        _mm256_storeu_si256((__m256i *)pTrg + 3, ymm3);
+        _mm256_storeu_si256((__m256i *)pTrg + 4, ymm4);
+        _mm256_storeu_si256((__m256i *)pTrg + 5, ymm5);
+        _mm256_storeu_si256((__m256i *)pTrg + 6, ymm6);
+        _mm256_storeu_si256((__m256i *)pTrg + 7, ymm7);
+
+        pSrc += 256;
+        pTrg += 256;
+    }
+
+    // Copy in 32 byte steps
+    while ((size_t)(pSrcEnd - pSrc) >= 32)
+    {
+        _mm256_storeu_si256((__m256i *)pTrg, _mm256_stream_load_si256((const __m256i *)pSrc));
+        pSrc += 32;
+        pTrg += 32;
+    }
+
+    // Copy the tail as the last 32 bytes, they overlap the bytes that are already copied
+    const size_t tail = pSrcEnd - pSrc;
+    if (tail)
+    {
+        _mm256_storeu_si256((__m256i *)(pTrg + tail - 32), _mm256_loadu_si256((const __m256i *)(pSrcEnd - 32)));
+    }
+
+    _mm256_zeroupper();
+
+    return d;
+}
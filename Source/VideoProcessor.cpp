@@ -25,8 +25,14 @@
 #include "VideoRenderer.h"
 
 #include "VideoProcessor.h"
+#include "Shaders.h"
 #include <shellscalingapi.h>
 
+HRESULT CVideoProcessor::CompileShaderSource(const CShaderCompileQueue::Source_t& source, std::vector<BYTE>& blob)
+{
+    return CompileShader(source.code, nullptr, source.target, blob);
+}
+
 HRESULT CVideoProcessor::GetVideoSize(long* pWidth, long* pHeight)
 {
     CheckPointer(pWidth, E_POINTER);
@@ -170,11 +176,11 @@ void CVideoProcessor::SetDisplayInfo(const DisplayConfig_t& dc, const bool prima
 {
     if (dc.refreshRate.Numerator)
     {
-        m_uHalfRefreshPeriodMs = (UINT32)(500ull * dc.refreshRate.Denominator / dc.refreshRate.Numerator);
+        m_rtHalfRefreshPeriod = (REFERENCE_TIME)(UNITS / 2 * (uint64_t)dc.refreshRate.Denominator / dc.refreshRate.Numerator);
     }
     else
     {
-        m_uHalfRefreshPeriodMs = 0;
+        m_rtHalfRefreshPeriod = 0;
     }
 
     m_strStatsDispInfo.assign(L"\nDisplay: ");
@@ -216,6 +222,62 @@ void CVideoProcessor::SetDisplayInfo(const DisplayConfig_t& dc, const bool prima
     }
 }
 
+void CVideoProcessor::AppendLatencyStats(std::wstring& str)
+{
+    const double percentiles[] = { 99.0 };
+    const double msPerTick = 1000.0 / GetPreciseTicksPerSecondI();
+    uint64_t copy, paint, present;
+    uint64_t count;
+
+    m_RenderLatency.copy.GetPercentiles(percentiles, &copy, 1, count);
+    m_RenderLatency.paint.GetPercentiles(percentiles, &paint, 1, count);
+    m_RenderLatency.present.GetPercentiles(percentiles, &present, 1, count);
+
+    str += std::format(L"\n p99/max : Copy{:4.1f}/{:<4.1f}, Paint{:4.1f}/{:<4.1f}, Present{:4.1f}/{:<4.1f}",
+                       copy * msPerTick, m_RenderLatency.copy.GetMax() * msPerTick,
+                       paint * msPerTick, m_RenderLatency.paint.GetMax() * msPerTick,
+                       present * msPerTick, m_RenderLatency.present.GetMax() * msPerTick);
+}
+
+void CVideoProcessor::AppendLatencyInfo(std::wstring& str)
+{
+    const double percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+    const double msPerTick = 1000.0 / GetPreciseTicksPerSecondI();
+
+    const std::pair<const wchar_t*, const CLatencyHistogram&> stages[] = {
+        { L"Copy    ", m_RenderLatency.copy },
+        { L"Subtitle", m_RenderLatency.subs },
+        { L"Paint   ", m_RenderLatency.paint },
+        { L"Present ", m_RenderLatency.present },
+    };
+
+    str.append(L"\n\nTimes(ms) :   p50    p90    p99  p99.9    max  frames");
+    for (const auto& [name, histogram] : stages)
+    {
+        uint64_t values[std::size(percentiles)];
+        uint64_t count;
+        histogram.GetPercentiles(percentiles, values, (unsigned)std::size(percentiles), count);
+        if (count)
+        {
+            str += std::format(L"\n{}  : {:6.2f} {:6.2f} {:6.2f} {:6.2f} {:6.2f} {:7}", name,
+                               values[0] * msPerTick, values[1] * msPerTick, values[2] * msPerTick, values[3] * msPerTick,
+                               histogram.GetMax() * msPerTick, count);
+        }
+    }
+}
+
+void CVideoProcessor::AppendUploadInfo(std::wstring& str)
+{
+    const uint64_t uploaded = m_DirtyRows.GetBytesUploaded();
+    const uint64_t skipped = m_DirtyRows.GetBytesSkipped();
+
+    if (uploaded || skipped)
+    {
+        str += std::format(L"\n\nUpload    : {:.1f} MB copied, {:.1f} MB of unchanged lines skipped ({:.1f}%)",
+                           uploaded / 1048576.0, skipped / 1048576.0, skipped * 100.0 / (uploaded + skipped));
+    }
+}
+
 void CVideoProcessor::UpdateStatsInputFmt()
 {
     m_strStatsInputFmt.assign(L"\nInput format  : ");
@@ -239,6 +301,10 @@ void CVideoProcessor::UpdateStatsInputFmt()
     {
         m_strStatsInputFmt += std::format(L" ({}:{})", m_srcAspectRatioX, m_srcAspectRatioY);
     }
+    if (m_iSrcFromGPU == 0 && m_strCopyKernel)
+    {
+        m_strStatsInputFmt += std::format(L"\n  Copy kernel: {}", m_strCopyKernel);
+    }
 
     if (m_srcParams.CSType == CS_YUV)
     {
@@ -318,13 +384,14 @@ void CVideoProcessor::SyncFrameToStreamTime(const REFERENCE_TIME frameStartTime)
     {
         if (SUCCEEDED(m_pFilter->StreamTime(m_streamTime)) && frameStartTime > m_streamTime)
         {
-            const auto sleepTime = (frameStartTime - m_streamTime) / 10000LL - m_uHalfRefreshPeriodMs;
-            if (sleepTime > 0 && sleepTime < 42)
+            const REFERENCE_TIME waitTime = frameStartTime - m_streamTime - m_rtHalfRefreshPeriod;
+            if (waitTime > 0 && waitTime < 42 * 10000)
             {
                 // We are waiting for Preset to display the frame at the required display refresh interval.
                 // This is relevant for displays with high frame rates (for example 144 Hz).
                 // But no longer than 41 ms to avoid problems with the DVD-Video menu.
-                Sleep(static_cast<DWORD>(sleepTime));
+                // Sleep() can wake up several milliseconds late, the scheduler is accurate to a fraction of a millisecond.
+                m_FrameScheduler.WaitFor(waitTime);
             }
         }
     }
@@ -358,6 +425,24 @@ bool CVideoProcessor::CheckDoviMetadata(const MediaSideDataDOVIMetadata* pDOVIMe
     return true;
 }
 
+void CVideoProcessor::SetCopyPlaneKernel(const FmtConvParams_t& params, const int vp)
+{
+    // the fastest kernel, the sample buffers are usually aligned as it requires
+    const auto& copyKernel = GetCopyPlaneKernel(params, vp, 64);
+    m_pCopyPlaneFn = copyKernel.fn;
+    m_pCopyPlaneUnalignedFn = GetCopyPlaneKernel(params, vp, 1).fn;
+    m_copyPlaneAlign = copyKernel.align;
+    m_strCopyKernel = copyKernel.name;
+}
+
+void CVideoProcessor::ResetCopyPlaneKernel()
+{
+    m_pCopyPlaneFn = CopyPlaneAsIs;
+    m_pCopyPlaneUnalignedFn = CopyPlaneAsIs;
+    m_copyPlaneAlign = 1;
+    m_strCopyKernel = nullptr;
+}
+
 // IUnknown
 
 STDMETHODIMP CVideoProcessor::QueryInterface(REFIID riid, void** ppv)
@@ -23,9 +23,15 @@
 #include <evr9.h>
 #include "DisplayConfig.h"
 #include "FrameStats.h"
+#include "FrameScheduler.h"
+#include "DirtyRows.h"
+#include "UploadBuffers.h"
+#include "ShaderCompileQueue.h"
+#include "DoviLut.h"
 #include "SubPic/ISubPic.h"
 
 enum : int {
+	VP_SW = 1, // software
 	VP_DX9 = 9,
 	VP_DX11 = 11
 };
@@ -70,11 +76,21 @@ protected:
 	int  m_iHdrOsdBrightness               = 0;
 	bool m_bConvertToSdr                   = true;
 	int  m_iSDRDisplayNits                 = SDR_NITS_DEF;
+	bool m_bTransferLut                    = false;
+	bool m_bHdrSceneAdaptive               = false;
 
 	bool m_bVPScalingUseShaders = false;
 
 	CopyFrameDataFn m_pCopyPlaneFn = CopyPlaneAsIs;
+	CopyFrameDataFn m_pCopyPlaneUnalignedFn = CopyPlaneAsIs; // for a source that is not aligned as m_pCopyPlaneFn requires
+	UINT            m_copyPlaneAlign = 1; // of the source pointer and pitch of m_pCopyPlaneFn
 	CopyFrameDataFn m_pCopyGpuFn   = CopyPlaneAsIs;
+	UnpackPackedFn  m_pUnpackFn    = nullptr; // packed 4:2:2 to the P210 or P216 planes instead of m_pCopyPlaneFn
+	const wchar_t*  m_strCopyKernel = nullptr; // the name of m_pCopyPlaneFn or m_pUnpackFn for the statistics
+	CDirtyRows      m_DirtyRows; // skips the unchanged lines of software-decoded frames
+
+	// compiles the colour conversion shaders that are not in the shader cache, see UpdateConvertColorShader()
+	CShaderCompileQueue m_ConvertShaderQueue;
 
 	// Input parameters
 	FmtConvParams_t m_srcParams = GetFmtConvParams(CF_NONE);
@@ -106,14 +122,20 @@ protected:
 	DXVA2_ValueRange m_DXVA2ProcAmpRanges[4] = {};
 	DXVA2_ProcAmpValues m_DXVA2ProcAmpValues = {};
 
-	struct DOVIMetadata {
-		MediaSideDataDOVIMetadata msd = {};
-		bool bValid = false;
-		bool bHasMMR = false;
-	} m_Dovi;
+	DoviState_t m_Dovi;
+	CDoviLutCache m_DoviLutCache;
 
 	bool CheckDoviMetadata(const MediaSideDataDOVIMetadata* pDOVIMetadata, const uint8_t maxReshapeMethon);
 
+	// selects m_pCopyPlaneFn and m_pCopyPlaneUnalignedFn, sets m_strCopyKernel
+	void SetCopyPlaneKernel(const FmtConvParams_t& params, const int vp);
+	void ResetCopyPlaneKernel();
+	// m_pCopyPlaneFn, or m_pCopyPlaneUnalignedFn if src or src_pitch is not aligned as m_pCopyPlaneFn requires
+	CopyFrameDataFn GetCopyPlaneFn(const BYTE* src, const int src_pitch) const
+	{
+		return (((uintptr_t)src | (UINT)abs(src_pitch)) & (m_copyPlaneAlign - 1)) ? m_pCopyPlaneUnalignedFn : m_pCopyPlaneFn;
+	}
+
 	HWND m_hWnd = nullptr;
 	UINT m_nCurrentAdapter; // set it in subclasses
 	DWORD m_VendorId = 0;
@@ -123,7 +145,7 @@ protected:
 	int m_FieldDrawn = 0;
 	bool m_bDoubleFrames = false;
 
-	UINT32 m_uHalfRefreshPeriodMs = 0;
+	REFERENCE_TIME m_rtHalfRefreshPeriod = 0;
 
 	bool m_bAllowDeepColorBitmaps = false;
 
@@ -134,6 +156,7 @@ protected:
 
 	// Statistics
 	CRenderStats m_RenderStats;
+	CRenderLatency m_RenderLatency;
 	std::wstring m_strStatsHeader;
 	std::wstring m_strStatsInputFmt;
 	std::wstring m_strStatsVProc;
@@ -160,7 +183,9 @@ protected:
 
 	int m_nStereoSubtitlesOffsetInPixels = 4;
 
-	CVideoProcessor(CMpcVideoRenderer* pFilter) : m_pFilter(pFilter) {}
+	CVideoProcessor(CMpcVideoRenderer* pFilter) : m_pFilter(pFilter), m_ConvertShaderQueue(CompileShaderSource) {}
+
+	static HRESULT CompileShaderSource(const CShaderCompileQueue::Source_t& source, std::vector<BYTE>& blob);
 
 public:
 	virtual ~CVideoProcessor() = default;
@@ -172,6 +197,9 @@ public:
 	virtual IDirect3DDeviceManager9* GetDeviceManager9() { return nullptr; }
 	UINT GetCurrentAdapter() { return m_nCurrentAdapter; }
 
+	// for the sample buffers of the custom allocator, nullptr if they are copied
+	virtual std::shared_ptr<CUploadBuffers> GetUploadBuffers() { return nullptr; }
+
 	virtual BOOL VerifyMediaType(const CMediaType* pmt) = 0;
 	virtual BOOL InitMediaType(const CMediaType* pmt) = 0;
 
@@ -240,8 +268,15 @@ protected:
 	}
 
 	void UpdateStatsInputFmt();
+	// p99 and max of the copy, paint and present times for the statistics
+	void AppendLatencyStats(std::wstring& str);
+	// all percentiles of all stages for GetVPInfo
+	void AppendLatencyInfo(std::wstring& str);
+	// uploaded and skipped bytes of software-decoded frames for GetVPInfo
+	void AppendUploadInfo(std::wstring& str);
 
 	CRefTime m_streamTime;
+	CFrameScheduler m_FrameScheduler;
 	void SyncFrameToStreamTime(const REFERENCE_TIME frameStartTime);
 
 public:
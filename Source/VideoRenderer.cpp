@@ -31,6 +31,7 @@
 #define WM_SWITCH_FULLSCREEN (WM_APP + 0x1000)
 #define OPT_REGKEY_VIDEORENDERER L"Software\\MPC-BE Filters\\MPC Video Renderer"
 #define OPT_UseD3D11 L"UseD3D11"
+#define OPT_UseSoftwareRenderer L"UseSoftwareRenderer"
 #define OPT_ShowStatistics L"ShowStatistics"
 #define OPT_ResizeStatistics L"ResizeStatistics"
 #define OPT_TextureFormat L"TextureFormat"
@@ -63,6 +64,11 @@
 #define OPT_ConvertToSdr L"ConvertToSdr"
 #define OPT_UseD3DFullscreen L"UseD3DFullscreen"
 #define OPT_DisplayNits L"DisplayNits"
+#define OPT_UploadThreads L"UploadThreads"
+#define OPT_CropBlackBars L"CropBlackBars"
+#define OPT_ZeroCopyUpload L"ZeroCopyUpload"
+#define OPT_TransferLut L"TransferLut"
+#define OPT_HdrSceneAdaptive L"HdrSceneAdaptive"
 static std::atomic_int g_nInstance = 0;
 static const wchar_t g_szClassName[] = L"VRWindow";
 LPCWSTR g_pszOldParentWndProc = L"OldParentWndProc";
@@ -159,6 +165,10 @@ CMpcVideoRenderer::CMpcVideoRenderer(LPUNKNOWN pUnk, HRESULT *phr)
         {
             m_Sets.bUseD3D11 = !!dw;
         }
+        if (ERROR_SUCCESS == key.QueryDWORDValue(OPT_UseSoftwareRenderer, dw))
+        {
+            m_Sets.bUseSoftware = !!dw;
+        }
         if (ERROR_SUCCESS == key.QueryDWORDValue(OPT_ShowStatistics, dw))
         {
             m_Sets.bShowStats = !!dw;
@@ -295,6 +305,26 @@ CMpcVideoRenderer::CMpcVideoRenderer(LPUNKNOWN pUnk, HRESULT *phr)
         {
             m_Sets.iSDRDisplayNits = discard<int>(dw, SDR_NITS_DEF, SDR_NITS_MIN, SDR_NITS_MAX);
         }
+        if (ERROR_SUCCESS == key.QueryDWORDValue(OPT_UploadThreads, dw))
+        {
+            m_Sets.iUploadThreads = discard<int>(dw, UPLOAD_THREADS_AUTO, UPLOAD_THREADS_AUTO, UPLOAD_THREADS_MAX);
+        }
+        if (ERROR_SUCCESS == key.QueryDWORDValue(OPT_CropBlackBars, dw))
+        {
+            m_Sets.bCropBlackBars = !!dw;
+        }
+        if (ERROR_SUCCESS == key.QueryDWORDValue(OPT_ZeroCopyUpload, dw))
+        {
+            m_Sets.bZeroCopyUpload = !!dw;
+        }
+        if (ERROR_SUCCESS == key.QueryDWORDValue(OPT_TransferLut, dw))
+        {
+            m_Sets.bTransferLut = !!dw;
+        }
+        if (ERROR_SUCCESS == key.QueryDWORDValue(OPT_HdrSceneAdaptive, dw))
+        {
+            m_Sets.bHdrSceneAdaptive = !!dw;
+        }
     }
     if (!IsWindows10OrGreater())
     {
@@ -303,7 +333,12 @@ CMpcVideoRenderer::CMpcVideoRenderer(LPUNKNOWN pUnk, HRESULT *phr)
         m_Sets.iHdrToggleDisplay = HDRTD_Disabled;
     }
     HRESULT hr = S_FALSE;
-    if (m_Sets.bUseD3D11 && IsWindows7SP1OrGreater())
+    if (m_Sets.bUseSoftware)
+    {
+        m_VideoProcessor.reset(new CSWVideoProcessor(this, m_Sets, hr));
+        DLogIf(S_OK == hr, L"Software video processor initialization successfully!");
+    }
+    if (!m_VideoProcessor && m_Sets.bUseD3D11 && IsWindows7SP1OrGreater())
     {
         m_VideoProcessor.reset(new CDX11VideoProcessor(this, m_Sets, hr));
         if (SUCCEEDED(hr))
@@ -324,6 +359,12 @@ CMpcVideoRenderer::CMpcVideoRenderer(LPUNKNOWN pUnk, HRESULT *phr)
             hr = m_VideoProcessor->Init(::GetForegroundWindow(), false);
         }
         DLogIf(S_OK == hr, L"Direct3D9 initialization successfully!");
+        if (FAILED(hr))
+        {
+            // no usable Direct3D device, for example in a virtual machine or a remote session
+            m_VideoProcessor.reset(new CSWVideoProcessor(this, m_Sets, hr));
+            DLogIf(S_OK == hr, L"Software video processor initialization successfully!");
+        }
     }
     *phr = hr;
     return;
@@ -1182,6 +1223,7 @@ STDMETHODIMP CMpcVideoRenderer::SaveSettings()
     if (ERROR_SUCCESS == key.Create(HKEY_CURRENT_USER, OPT_REGKEY_VIDEORENDERER))
     {
         key.SetDWORDValue(OPT_UseD3D11, m_Sets.bUseD3D11);
+        key.SetDWORDValue(OPT_UseSoftwareRenderer, m_Sets.bUseSoftware);
         key.SetDWORDValue(OPT_ShowStatistics, m_Sets.bShowStats);
         key.SetDWORDValue(OPT_ResizeStatistics, m_Sets.iResizeStats);
         key.SetDWORDValue(OPT_TextureFormat, m_Sets.iTexFormat);
@@ -1213,6 +1255,11 @@ STDMETHODIMP CMpcVideoRenderer::SaveSettings()
         key.SetDWORDValue(OPT_HdrOsdBrightness, m_Sets.iHdrOsdBrightness);
         key.SetDWORDValue(OPT_ConvertToSdr, m_Sets.bConvertToSdr);
         key.SetDWORDValue(OPT_DisplayNits, m_Sets.iSDRDisplayNits);
+        key.SetDWORDValue(OPT_UploadThreads, m_Sets.iUploadThreads);
+        key.SetDWORDValue(OPT_CropBlackBars, m_Sets.bCropBlackBars);
+        key.SetDWORDValue(OPT_ZeroCopyUpload, m_Sets.bZeroCopyUpload);
+        key.SetDWORDValue(OPT_TransferLut, m_Sets.bTransferLut);
+        key.SetDWORDValue(OPT_HdrSceneAdaptive, m_Sets.bHdrSceneAdaptive);
     }
     return S_OK;
 }
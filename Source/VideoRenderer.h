@@ -32,6 +32,7 @@ unsigned int GetAutoSwapUiMsg();
 #include "IVideoRenderer.h"
 #include "DX9VideoProcessor.h"
 #include "DX11VideoProcessor.h"
+#include "SWVideoProcessor.h"
 #include "../Include/ISubRender.h"
 #include "../Include/ISubRender11.h"
 #include "../Include/ID3DFullscreenControl.h"
@@ -49,6 +50,7 @@ const AMOVIESETUP_MEDIATYPE sudPinTypesIn[] = {
 	{&MEDIATYPE_Video, &MEDIASUBTYPE_AYUV},
 	{&MEDIATYPE_Video, &MEDIASUBTYPE_Y210}, //experimental
 	{&MEDIATYPE_Video, &MEDIASUBTYPE_Y216}, //experimental
+	{&MEDIATYPE_Video, &MEDIASUBTYPE_v210},
 	{&MEDIATYPE_Video, &MEDIASUBTYPE_Y410},
 	{&MEDIATYPE_Video, &MEDIASUBTYPE_Y416},
 	{&MEDIATYPE_Video, &MEDIASUBTYPE_YV12},
@@ -95,6 +97,7 @@ private:
 	friend class CVideoProcessor;
 	friend class CDX9VideoProcessor;
 	friend class CDX11VideoProcessor;
+	friend class CSWVideoProcessor;
 
 	// Options
 	Settings_t m_Sets;
@@ -222,3 +222,8 @@ void CVideoRendererInputPin::ClearNewMediaType()
 		m_pCustomAllocator->ClearNewMediaType();
 	}
 }
+
+std::shared_ptr<CUploadBuffers> CVideoRendererInputPin::GetUploadBuffers()
+{
+	return m_pBaseRenderer->m_VideoProcessor->GetUploadBuffers();
+}
@@ -27,6 +27,7 @@
 
 class CMpcVideoRenderer;
 class CCustomAllocator;
+class CUploadBuffers;
 
 class CVideoRendererInputPin
 	: public CRendererInputPin
@@ -77,5 +78,7 @@ public:
 
 	void SetNewMediaType(const CMediaType& mt);
 	void ClearNewMediaType();
+
+	std::shared_ptr<CUploadBuffers> GetUploadBuffers();
 };
 
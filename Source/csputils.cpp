@@ -6,6 +6,7 @@
 #include <stdint.h>
 #include <math.h>
 #include <assert.h>
+#include <memory>
 
 #include "csputils.h"
 
@@ -225,6 +226,72 @@ bool mp_trc_is_hdr(enum mp_csp_trc trc)
     return mp_trc_nom_peak(trc) > 1.0;
 }
 
+// The camera log curves are not used by the renderer.
+bool mp_trc_has_linearize(enum mp_csp_trc trc)
+{
+    switch (trc) {
+    case MP_CSP_TRC_BT_1886:
+    case MP_CSP_TRC_SRGB:
+    case MP_CSP_TRC_LINEAR:
+    case MP_CSP_TRC_GAMMA18:
+    case MP_CSP_TRC_GAMMA20:
+    case MP_CSP_TRC_GAMMA22:
+    case MP_CSP_TRC_GAMMA24:
+    case MP_CSP_TRC_GAMMA26:
+    case MP_CSP_TRC_GAMMA28:
+    case MP_CSP_TRC_PRO_PHOTO:
+    case MP_CSP_TRC_PQ:
+    case MP_CSP_TRC_HLG:
+    case MP_CSP_TRC_ST428:
+        return true;
+    }
+
+    return false;
+}
+
+// Converts a signal value in the range 0..1 to linear light. The result is scaled
+// as in the conversion shader: 1.0 is 10000 cd/m^2 for PQ, and HLG gives 0..12
+// (the inverse OETF without the OOTF). Other curves give 0..1.
+double mp_trc_linearize(enum mp_csp_trc trc, double x)
+{
+    x = (x < 0.0) ? 0.0 : (x > 1.0) ? 1.0 : x;
+
+    switch (trc) {
+    case MP_CSP_TRC_BT_1886:   return pow(x, 2.4);
+    case MP_CSP_TRC_SRGB:      return (x <= 0.04045) ? x / 12.92 : pow((x + 0.055) / 1.055, 2.4);
+    case MP_CSP_TRC_LINEAR:    return x;
+    case MP_CSP_TRC_GAMMA18:   return pow(x, 1.8);
+    case MP_CSP_TRC_GAMMA20:   return pow(x, 2.0);
+    case MP_CSP_TRC_GAMMA22:   return pow(x, 2.2);
+    case MP_CSP_TRC_GAMMA24:   return pow(x, 2.4);
+    case MP_CSP_TRC_GAMMA26:   return pow(x, 2.6);
+    case MP_CSP_TRC_GAMMA28:   return pow(x, 2.8);
+    case MP_CSP_TRC_PRO_PHOTO: return (x <= 0.03125) ? x / 16.0 : pow(x, 1.8);
+    case MP_CSP_TRC_PQ: {
+        // SMPTE ST 2084
+        const double m1 = 2610.0 / 16384.0;
+        const double m2 = 2523.0 / 4096.0 * 128.0;
+        const double c1 = 3424.0 / 4096.0;
+        const double c2 = 2413.0 / 4096.0 * 32.0;
+        const double c3 = 2392.0 / 4096.0 * 32.0;
+        const double p = pow(x, 1.0 / m2);
+        const double n = p - c1;
+        return (n > 0.0) ? pow(n / (c2 - c3 * p), 1.0 / m1) : 0.0;
+    }
+    case MP_CSP_TRC_HLG: {
+        // ARIB STD-B67
+        const double a = 0.17883277;
+        const double b = 0.28466892;
+        const double c = 0.55991073;
+        return (x <= 0.5) ? 4.0 * x * x : exp((x - c) / a) + b;
+    }
+    case MP_CSP_TRC_ST428:     return pow(x, 2.6) * 52.37 / 48.0;
+    }
+
+    assert(0);
+    return x;
+}
+
 // Compute the RGB/XYZ matrix as described here:
 // http://www.brucelindbloom.com/index.html?Eqn_RGB_XYZ_Matrix.html
 void mp_get_rgb2xyz_matrix(struct mp_csp_primaries space, float m[3][3])
@@ -389,7 +456,7 @@ static void luma_coeffs(struct mp_cmat *mat, float lr, float lg, float lb)
 }
 
 // get the coefficients of the yuv -> rgb conversion matrix
-void mp_get_csp_matrix(struct mp_csp_params *params, struct mp_cmat *m)
+void mp_calc_csp_matrix(struct mp_csp_params *params, struct mp_cmat *m)
 {
     enum mp_csp colorspace = params->color.space;
     if (colorspace <= MP_CSP_AUTO || colorspace >= MP_CSP_COUNT)
@@ -467,7 +534,7 @@ void mp_get_csp_matrix(struct mp_csp_params *params, struct mp_cmat *m)
         yuvfull = {  0*s, 255*s, 255*s, 128*s },
         anyfull = {  0*s, 255*s, 255*s/2, 0 }, // cmax picked to make cmul=ymul
         yuvlev;
-    switch (levels_in) {
+    switch ((int)levels_in) { // int, -1 is not a value of the enum
     case MP_CSP_LEVELS_TV: yuvlev = yuvlim; break;
     case MP_CSP_LEVELS_PC: yuvlev = yuvfull; break;
     case -1: yuvlev = anyfull; break;
@@ -508,6 +575,60 @@ void mp_get_csp_matrix(struct mp_csp_params *params, struct mp_cmat *m)
     }
 }
 
+// The matrices without the picture adjustments, for each colorspace, levels and bit depth
+// where the input and texture bits are the same. The table is filled on the first use
+// by mp_calc_csp_matrix(), so the values are the same as computed ones.
+#define CSP_MATRIX_MAX_BITS 16
+
+struct mp_csp_matrix_table {
+    struct mp_cmat m[MP_CSP_COUNT][MP_CSP_LEVELS_COUNT][MP_CSP_LEVELS_COUNT][2][CSP_MATRIX_MAX_BITS + 1];
+};
+
+static const mp_csp_matrix_table& mp_get_csp_matrix_table()
+{
+    static const auto table = [] {
+        auto t = std::make_unique<mp_csp_matrix_table>();
+        for (int space = 0; space < MP_CSP_COUNT; space++) {
+            for (int levels = 0; levels < MP_CSP_LEVELS_COUNT; levels++) {
+                for (int levels_out = 0; levels_out < MP_CSP_LEVELS_COUNT; levels_out++) {
+                    for (int is_float = 0; is_float < 2; is_float++) {
+                        for (int bits = 0; bits <= CSP_MATRIX_MAX_BITS; bits++) {
+                            struct mp_csp_params params;
+                            params.color.space = (enum mp_csp)space;
+                            params.color.levels = (enum mp_csp_levels)levels;
+                            params.levels_out = (enum mp_csp_levels)levels_out;
+                            params.is_float = !!is_float;
+                            params.input_bits = params.texture_bits = bits;
+                            mp_calc_csp_matrix(&params, &t->m[space][levels][levels_out][is_float][bits]);
+                        }
+                    }
+                }
+            }
+        }
+        return t;
+    }();
+
+    return *table;
+}
+
+void mp_get_csp_matrix(struct mp_csp_params *params, struct mp_cmat *m)
+{
+    const struct mp_csp_params def;
+    const bool bDefault = params->brightness == def.brightness && params->contrast == def.contrast
+                       && params->hue == def.hue && params->saturation == def.saturation && !params->gray;
+    const unsigned space = params->color.space;
+    const unsigned levels = params->color.levels;
+    const unsigned levels_out = params->levels_out;
+    const unsigned bits = params->input_bits;
+
+    if (bDefault && space < MP_CSP_COUNT && levels < MP_CSP_LEVELS_COUNT && levels_out < MP_CSP_LEVELS_COUNT
+            && bits <= CSP_MATRIX_MAX_BITS && params->texture_bits == params->input_bits) {
+        *m = mp_get_csp_matrix_table().m[space][levels][levels_out][params->is_float][bits];
+    } else {
+        mp_calc_csp_matrix(params, m);
+    }
+}
+
 void mp_invert_cmat(struct mp_cmat *out, struct mp_cmat *in)
 {
     *out = *in;
@@ -546,7 +667,7 @@ void transpose_matrix3x3(float(&t)[3][3], const float(&m)[3][3])
     }
 }
 
-void GetColorspaceGamutConversionMatrix(float matrix[3][3], mp_csp_prim csp_in, mp_csp_prim csp_out)
+void CalcColorspaceGamutConversionMatrix(float matrix[3][3], mp_csp_prim csp_in, mp_csp_prim csp_out)
 {
 	float matrix_rgb2xyz_in[3][3];
 	mp_get_rgb2xyz_matrix(mp_get_csp_primaries(csp_in), matrix_rgb2xyz_in);
@@ -555,3 +676,27 @@ void GetColorspaceGamutConversionMatrix(float matrix[3][3], mp_csp_prim csp_in,
 	mp_invert_matrix3x3(matrix);
 	mp_mul_matrix3x3(matrix, matrix_rgb2xyz_in);
 }
+
+void GetColorspaceGamutConversionMatrix(float matrix[3][3], mp_csp_prim csp_in, mp_csp_prim csp_out)
+{
+	if ((unsigned)csp_in >= MP_CSP_PRIM_COUNT || (unsigned)csp_out >= MP_CSP_PRIM_COUNT) {
+		CalcColorspaceGamutConversionMatrix(matrix, csp_in, csp_out);
+		return;
+	}
+
+	// all pairs of primaries, filled on the first use
+	struct matrix_table_t {
+		float m[MP_CSP_PRIM_COUNT][MP_CSP_PRIM_COUNT][3][3];
+	};
+	static const auto table = [] {
+		auto t = std::make_unique<matrix_table_t>();
+		for (int in = 0; in < MP_CSP_PRIM_COUNT; in++) {
+			for (int out = 0; out < MP_CSP_PRIM_COUNT; out++) {
+				CalcColorspaceGamutConversionMatrix(t->m[in][out], (mp_csp_prim)in, (mp_csp_prim)out);
+			}
+		}
+		return t;
+	}();
+
+	memcpy(matrix, table->m[csp_in][csp_out], sizeof(table->m[csp_in][csp_out]));
+}
@@ -142,6 +142,8 @@ struct mp_csp_primaries {
 struct mp_csp_primaries mp_get_csp_primaries(enum mp_csp_prim csp);
 float mp_trc_nom_peak(enum mp_csp_trc trc);
 bool mp_trc_is_hdr(enum mp_csp_trc trc);
+bool mp_trc_has_linearize(enum mp_csp_trc trc);
+double mp_trc_linearize(enum mp_csp_trc trc, double x);
 
 /* Color conversion matrix: RGB = m * YUV + c
  * m is in row-major matrix, with m[row][col], e.g.:
@@ -164,7 +166,10 @@ struct mp_cmat {
 void mp_get_rgb2xyz_matrix(struct mp_csp_primaries space, float m[3][3]);
 
 double mp_get_csp_mul(enum mp_csp csp, int input_bits, int texture_bits);
+// Without the picture adjustments the matrix is taken from a table that is filled on the first use.
 void mp_get_csp_matrix(struct mp_csp_params *params, struct mp_cmat *out);
+// Computes the matrix without the table.
+void mp_calc_csp_matrix(struct mp_csp_params *params, struct mp_cmat *out);
 
 void mp_invert_matrix3x3(float m[3][3]);
 void mp_invert_cmat(struct mp_cmat *out, struct mp_cmat *in);
@@ -176,4 +181,7 @@ void mp_invert_cmat(struct mp_cmat *out, struct mp_cmat *in);
 void mul_matrix3x3(float(&c)[3][3], const float(&a)[3][3], const float(&b)[3][3]);
 void transpose_matrix3x3(float(&t)[3][3], const float(&m)[3][3]);
 
+// The matrices of all pairs of primaries are taken from a table that is filled on the first use.
 void GetColorspaceGamutConversionMatrix(float matrix[3][3], mp_csp_prim csp_in, mp_csp_prim csp_out);
+// Computes the matrix without the table.
+void CalcColorspaceGamutConversionMatrix(float matrix[3][3], mp_csp_prim csp_in, mp_csp_prim csp_out);
@@ -22,6 +22,7 @@
 #include <InitGuid.h>
 #include "VideoRenderer.h"
 #include "PropPage.h"
+#include "ShaderPermutations.h"
 
 #include "../external/minhook/include/MinHook.h"
 
@@ -129,3 +130,41 @@ void CALLBACK OpenConfiguration(HWND hwnd, HINSTANCE hinst, LPSTR lpszCmdLine, i
 	}
 	delete pInstance;
 }
+
+// Compiles the colour conversion shaders for the current settings into the shader cache.
+// rundll32.exe MpcVideoRenderer64.ax,PrecompileShaders [1920x1080 3840x2160 ...]
+void CALLBACK PrecompileShaders(HWND hwnd, HINSTANCE hinst, LPSTR lpszCmdLine, int nCmdShow)
+{
+	Settings_t sets;
+
+	// the renderer reads the settings from the registry
+	HRESULT hr = S_OK;
+	CUnknown *pInstance = CreateInstance<CMpcVideoRenderer>(nullptr, &hr);
+	if (pInstance) {
+		IVideoRenderer *pVideoRenderer = nullptr;
+		if (SUCCEEDED(hr) && SUCCEEDED(pInstance->NonDelegatingQueryInterface(__uuidof(IVideoRenderer), (void **)&pVideoRenderer))) {
+			pVideoRenderer->GetSettings(sets);
+			pVideoRenderer->Release(); // deletes the instance
+		} else {
+			delete pInstance;
+		}
+	}
+
+	std::vector<SIZE> frameSizes;
+	if (lpszCmdLine) {
+		std::string_view cmdLine(lpszCmdLine);
+		while (cmdLine.size()) {
+			const size_t len = std::min(cmdLine.find(' '), cmdLine.size());
+			const std::string token(cmdLine.substr(0, len));
+			cmdLine.remove_prefix(std::min(len + 1, cmdLine.size()));
+
+			SIZE size = {};
+			if (sscanf_s(token.c_str(), "%ldx%ld", &size.cx, &size.cy) == 2 && size.cx > 0 && size.cy > 0) {
+				frameSizes.emplace_back(size);
+			}
+		}
+	}
+
+	hr = PrecompileConvertShaders(sets, frameSizes);
+	DLog(L"PrecompileShaders() : finished with {}", HR2Str(hr));
+}
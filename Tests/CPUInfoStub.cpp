@@ -0,0 +1,59 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+// CPUInfo for the tests, Utils/CPUInfo.cpp needs the Windows API.
+
+#include "stdafx.h"
+#include <thread>
+#include "Utils/CPUInfo.h"
+
+// the functions of Utils/CPUInfo.h return const values
+#pragma GCC diagnostic ignored "-Wignored-qualifiers"
+
+static int GetCPUFeatures()
+{
+	__builtin_cpu_init();
+
+	int features = 0;
+	if (__builtin_cpu_supports("sse"))    { features |= CPUInfo::CPU_SSE;   }
+	if (__builtin_cpu_supports("sse2"))   { features |= CPUInfo::CPU_SSE2;  }
+	if (__builtin_cpu_supports("sse3"))   { features |= CPUInfo::CPU_SSE3;  }
+	if (__builtin_cpu_supports("ssse3"))  { features |= CPUInfo::CPU_SSSE3; }
+	if (__builtin_cpu_supports("sse4.1")) { features |= CPUInfo::CPU_SSE41; }
+	if (__builtin_cpu_supports("sse4.2")) { features |= CPUInfo::CPU_SSE42; }
+	if (__builtin_cpu_supports("avx"))    { features |= CPUInfo::CPU_AVX;   }
+	if (__builtin_cpu_supports("avx2"))   { features |= CPUInfo::CPU_AVX2;  }
+
+	return features;
+}
+
+static const int nCPUFeatures = GetCPUFeatures();
+
+namespace CPUInfo {
+	const int GetType()              { return PROCESSOR_UNKNOWN; }
+	const int GetFeatures()          { return nCPUFeatures; }
+	const DWORD GetProcessorNumber() { return std::max(std::thread::hardware_concurrency(), 1u); }
+
+	const bool HaveSSSE3()           { return !!(nCPUFeatures & CPU_SSSE3); }
+	const bool HaveSSE41()           { return !!(nCPUFeatures & CPU_SSE41); }
+	const bool HaveSSE42()           { return !!(nCPUFeatures & CPU_SSE42); }
+	const bool HaveAVX()             { return !!(nCPUFeatures & CPU_AVX);   }
+	const bool HaveAVX2()            { return !!(nCPUFeatures & CPU_AVX2);  }
+} // namespace CPUInfo
@@ -0,0 +1,109 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+// Bakes 33^3 lattices of sample colour chains, the size of the software conversion, and checks
+// the CIEDE2000 or dE ITP errors that MeasureColorLut3D() reports against bounds of about twice
+// the measured values. The clipping of the tone mapping and of the gamut conversion bends the
+// chain inside the cells, so the HDR to SDR chains are held to a mean error only.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "Helper.h"
+#include "Shaders.h"
+#include "ColorLut.h"
+
+struct ColorLutCase_t {
+	const char* name;
+	mp_csp colorspace;
+	UINT primaries;
+	UINT transferFunction;
+	int convertType;
+	int toneMappingType; // 0 - no HDR10 pass
+	double maxDE;        // 0 - not checked
+	double meanDE;
+};
+
+static const ColorLutCase_t s_cases[] = {
+	{ "BT.709 SDR",       MP_CSP_BT_709,     MFVideoPrimaries_BT709,  DXVA2_VideoTransFunc_709, SHADER_CONVERT_NONE,   0, 0.1, 0.01 }, // measured 0.056, 0.0054
+	{ "BT.2020 SDR",      MP_CSP_BT_2020_NC, MFVideoPrimaries_BT2020, DXVA2_VideoTransFunc_709, SHADER_CONVERT_NONE,   0, 0.0, 0.25 }, // 4.5, 0.11
+	{ "PQ",               MP_CSP_BT_2020_NC, MFVideoPrimaries_BT2020, MFVideoTransFunc_2084,    SHADER_CONVERT_NONE,   0, 1.0, 0.1  }, // 0.41, 0.048
+	{ "PQ to SDR",        MP_CSP_BT_2020_NC, MFVideoPrimaries_BT2020, MFVideoTransFunc_2084,    SHADER_CONVERT_TO_SDR, 0, 0.0, 0.5  }, // 8.0, 0.24
+	{ "HLG to SDR",       MP_CSP_BT_2020_NC, MFVideoPrimaries_BT2020, MFVideoTransFunc_HLG,     SHADER_CONVERT_TO_SDR, 0, 0.0, 0.3  }, // 5.4, 0.14
+	{ "HLG to PQ",        MP_CSP_BT_2020_NC, MFVideoPrimaries_BT2020, MFVideoTransFunc_HLG,     SHADER_CONVERT_TO_PQ,  0, 0.0, 1.5  }, // 17, 0.70
+	{ "PQ HDR10 ACES",    MP_CSP_BT_2020_NC, MFVideoPrimaries_BT2020, MFVideoTransFunc_2084,    SHADER_CONVERT_NONE,   1, 0.0, 2.0  }, // 28, 1.07
+	{ "PQ HDR10 Hable",   MP_CSP_BT_2020_NC, MFVideoPrimaries_BT2020, MFVideoTransFunc_2084,    SHADER_CONVERT_NONE,   3, 0.0, 1.5  }, // 23, 0.67
+};
+
+int main()
+{
+	const UINT size = 33;
+	std::vector<uint16_t> lut;
+
+	for (const auto& test : s_cases) {
+		mp_csp_params csp_params;
+		csp_params.color.space = test.colorspace;
+		csp_params.input_bits = csp_params.texture_bits = 10;
+		mp_cmat cmatrix;
+		mp_get_csp_matrix(&csp_params, &cmatrix);
+
+		DXVA2_ExtendedFormat exFmt = {};
+		exFmt.VideoPrimaries = test.primaries;
+		exFmt.VideoTransferFunction = test.transferFunction;
+
+		ColorChain_t chain;
+		GetColorChain(chain, exFmt, cmatrix, test.convertType, 10000.0f / 125.0f);
+		if (test.toneMappingType) {
+			SetColorChainHDR10(chain, 4000.0f, 1500.0f, 1000.0f, test.toneMappingType);
+		}
+
+		CHECK(BakeColorLut3D(chain, size, lut) == S_OK);
+		const auto report = MeasureColorLut3D(chain, lut.data(), size, 10000);
+
+		printf("%-16s %s max %.4f mean %.4f\n", test.name, report.bDeltaEITP ? "dE ITP " : "dE 2000", report.maxDE, report.meanDE);
+		if (test.maxDE > 0.0) {
+			CHECK(report.maxDE <= test.maxDE);
+		}
+		CHECK(report.meanDE <= test.meanDE);
+	}
+
+	// the lattice does not depend on the number of threads
+	{
+		mp_csp_params csp_params;
+		csp_params.color.space = MP_CSP_BT_2020_NC;
+		mp_cmat cmatrix;
+		mp_get_csp_matrix(&csp_params, &cmatrix);
+		DXVA2_ExtendedFormat exFmt = {};
+		exFmt.VideoPrimaries = MFVideoPrimaries_BT2020;
+		exFmt.VideoTransferFunction = MFVideoTransFunc_2084;
+		ColorChain_t chain;
+		GetColorChain(chain, exFmt, cmatrix, SHADER_CONVERT_TO_SDR, 10000.0f / 125.0f);
+
+		std::vector<uint16_t> lut1, lut4;
+		CHECK(BakeColorLut3D(chain, 17, lut1, 1) == S_OK);
+		CHECK(BakeColorLut3D(chain, 17, lut4, 4) == S_OK);
+		CHECK(lut1 == lut4);
+
+		CHECK(BakeColorLut3D(chain, COLOR_LUT3D_SIZE_MIN - 1, lut1) == E_INVALIDARG);
+		CHECK(BakeColorLut3D(chain, COLOR_LUT3D_SIZE_MAX + 1, lut1) == E_INVALIDARG);
+	}
+
+	return TestResult();
+}
@@ -0,0 +1,275 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+// Compares every SIMD variant in the kernel tables of CopyKernels.cpp that the processor supports
+// with the scalar variant of its format on pseudo-random frames of random sizes.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "Helper.h"
+#include "Utils/CPUInfo.h"
+
+static uint32_t s_seed = 0x9e3779b9u;
+
+static uint32_t Rand32()
+{
+	s_seed ^= s_seed << 13;
+	s_seed ^= s_seed >> 17;
+	s_seed ^= s_seed << 5;
+	return s_seed;
+}
+
+// a buffer with a pointer aligned to 64 bytes
+class CAlignedBuffer
+{
+	std::vector<BYTE> m_data;
+
+public:
+	BYTE* Fill(const size_t size, const int value)
+	{
+		m_data.resize(size + 63);
+		if (value < 0) {
+			for (auto& b : m_data) {
+				b = (BYTE)Rand32();
+			}
+		} else {
+			memset(m_data.data(), value, m_data.size());
+		}
+		return (BYTE*)ALIGN((uintptr_t)m_data.data(), 64);
+	}
+};
+
+// the bytes per pixel of the source formats of the copy kernels
+static UINT SourceBpp(const ColorFormat_t cformat)
+{
+	switch (cformat) {
+	case CF_RGB24:
+		return 3;
+	case CF_r210:
+		return 4;
+	case CF_RGB48:
+	case CF_BGR48:
+		return 6;
+	case CF_BGRA64:
+	case CF_B64A:
+		return 8;
+	case CF_YUV420P10:
+	case CF_YUV422P10:
+	case CF_YUV444P10:
+	case CF_GBRP10:
+	case CF_Y10:
+		return 2;
+	default:
+		return 1;
+	}
+}
+
+static bool IsSupported(const int features)
+{
+	return (features & CPUInfo::GetFeatures()) == features;
+}
+
+static const CopyKernel_t* FindScalarKernel(const CopyKernel_t& item)
+{
+	for (const auto& ref : GetCopyKernels()) {
+		if (!ref.features && ref.cformat == item.cformat && ref.vp == item.vp && !ref.convert == !item.convert) {
+			return &ref;
+		}
+	}
+	return nullptr;
+}
+
+// Both the kernel and the upload function with non-temporal stores must give the result of the scalar kernel.
+// The source pointer and pitch are aligned as the kernel requires, the kernels of any alignment get unaligned ones.
+static unsigned TestCopyKernel(const CopyKernel_t& item, const CopyKernel_t& ref)
+{
+	CAlignedBuffer src, dst1, dst2;
+	const UINT bpp = SourceBpp(item.cformat);
+	unsigned tests = 0;
+
+	for (unsigned n = 0; n < 64; n++) {
+		const UINT width = 1 + Rand32() % 300;
+		const UINT lines = 1 + Rand32() % 8;
+		const int src_pitch = ALIGN(width * bpp, item.align);
+		const UINT offset = (item.align == 1 && (n & 1)) ? 1 + Rand32() % 15 : 0;
+		const UINT dst_pitch = ALIGN(width * 8, 64) + 64; // enough for any kernel, 8 bytes per pixel
+		const size_t dst_size = (size_t)dst_pitch * lines;
+
+		const BYTE* s = src.Fill((size_t)src_pitch * lines + offset, -1) + offset;
+		BYTE* d1 = dst1.Fill(dst_size, 0);
+		BYTE* d2 = dst2.Fill(dst_size, 0);
+
+		ref.kernel(lines, d1, dst_pitch, s, src_pitch);
+		item.kernel(lines, d2, dst_pitch, s, src_pitch);
+		const bool bKernelOk = memcmp(d1, d2, dst_size) == 0;
+
+		memset(d2, 0, dst_size);
+		item.fn(lines, d2, dst_pitch, s, src_pitch);
+		const bool bStreamOk = memcmp(d1, d2, dst_size) == 0;
+
+		if (!bKernelOk || !bStreamOk) {
+			fprintf(stderr, "%ls%ls differs from %ls for %ux%u\n", bKernelOk ? L"the upload function of " : L"", item.name, ref.name, width, lines);
+			CHECK(bKernelOk && bStreamOk);
+			break;
+		}
+		tests++;
+	}
+
+	return tests;
+}
+
+// Random pitches, aligned and unaligned destinations. Nothing after the last converted pixel of a line must be written.
+static unsigned TestPlanarKernel(const CopyKernel_t& item, const CopyKernel_t& ref)
+{
+	CAlignedBuffer src, dst1, dst2;
+	// NV12, P010 and P016 have a 4:2:0 chroma plane, YUY2, Y210 and Y216 are packed 4:2:2
+	const bool b420 = item.VP11Format == DXGI_FORMAT_NV12 || item.VP11Format == DXGI_FORMAT_P010 || item.VP11Format == DXGI_FORMAT_P016;
+	unsigned tests = 0;
+
+	for (unsigned n = 0; n < 64; n++) {
+		// the 4:2:0 functions convert pairs of lines
+		const UINT lines = b420 ? 2 + Rand32() % 4 * 2 : 1 + Rand32() % 8;
+		const int src_pitch = (int)(4 + Rand32() % 600 * 4);
+		const UINT chroma_lines = b420 ? lines / 2 : lines;
+		const UINT offset = (n & 1) ? (Rand32() % 8) * 2 : 0;
+		// the packed 4:2:2 formats take twice the bytes of the luma line
+		const UINT dst_pitch = ALIGN(src_pitch * 2, 64) + ((n & 2) ? 0 : 16);
+		const size_t dst_size = (size_t)dst_pitch * (lines + chroma_lines) + 64;
+		const size_t chroma_size = (size_t)src_pitch / 2 * chroma_lines;
+
+		const BYTE* sY = src.Fill((size_t)src_pitch * lines + chroma_size * 2, -1);
+		const BYTE* sU = sY + (size_t)src_pitch * lines;
+		const BYTE* sV = sU + chroma_size;
+		BYTE* d1 = dst1.Fill(dst_size, 0xCD);
+		BYTE* d2 = dst2.Fill(dst_size, 0xCD);
+		const size_t uv = (size_t)dst_pitch * lines + 32;
+
+		ref.convert(lines, d1 + offset, d1 + uv + offset, dst_pitch, sY, sU, sV, src_pitch);
+		item.convert(lines, d2 + offset, d2 + uv + offset, dst_pitch, sY, sU, sV, src_pitch);
+
+		if (memcmp(d1, d2, dst_size) != 0) {
+			fprintf(stderr, "%ls differs from %ls for pitch %d x %u\n", item.name, ref.name, src_pitch, lines);
+			CHECK(!"planar conversion differs");
+			break;
+		}
+		tests++;
+	}
+
+	return tests;
+}
+
+// Random widths, aligned and unaligned planes. The samples after the last pair of a line must not be written.
+static unsigned TestUnpackKernel(const UnpackKernel_t& item, const UnpackKernel_t& ref)
+{
+	CAlignedBuffer src, dst1, dst2;
+	unsigned tests = 0;
+
+	for (unsigned n = 0; n < 64; n++) {
+		const UINT width = 2 + Rand32() % 600 * 2;
+		const UINT lines = 1 + Rand32() % 4;
+		const int src_pitch = (item.cformat == CF_V210) ? GetV210Pitch(width) : width * 4;
+		const UINT offset = (n & 1) ? (Rand32() % 8) * 2 : 0;
+		const UINT dstY_pitch  = ALIGN(width * 2, 64) + ((n & 2) ? 0 : 16);
+		const UINT dstUV_pitch = ALIGN(width * 2, 64);
+		const size_t dst_size = (size_t)(dstY_pitch + dstUV_pitch) * lines + 64;
+
+		const BYTE* s = src.Fill((size_t)src_pitch * lines, -1);
+		BYTE* d1 = dst1.Fill(dst_size, 0xCD);
+		BYTE* d2 = dst2.Fill(dst_size, 0xCD);
+		const size_t uv = (size_t)dstY_pitch * lines + 32;
+
+		ref.fn(lines, d1 + offset, dstY_pitch, d1 + uv + offset, dstUV_pitch, s, src_pitch);
+		item.fn(lines, d2 + offset, dstY_pitch, d2 + uv + offset, dstUV_pitch, s, src_pitch);
+
+		if (memcmp(d1, d2, dst_size) != 0) {
+			fprintf(stderr, "%ls differs from %ls for %ux%u\n", item.name, ref.name, width, lines);
+			CHECK(!"unpacked planes differ");
+			break;
+		}
+		tests++;
+	}
+
+	return tests;
+}
+
+// A kernel that needs an aligned source is selected only for a source aligned as it requires.
+static void TestKernelAlignment()
+{
+	FmtConvParams_t params = {};
+
+	for (const auto& item : GetCopyKernels()) {
+		if (item.convert) {
+			continue;
+		}
+		params.cformat = item.cformat;
+		const int vp = item.vp ? item.vp : VP_D3D11;
+
+		CHECK(GetCopyPlaneKernel(params, vp, 1).align == 1);
+		const auto& fastest = GetCopyPlaneKernel(params, vp, 64);
+		CHECK(GetCopyPlaneKernel(params, vp, fastest.align).fn == fastest.fn);
+		if (fastest.align > 1) {
+			CHECK(GetCopyPlaneKernel(params, vp, fastest.align / 2).fn != fastest.fn);
+		}
+	}
+}
+
+int main()
+{
+	TestKernelAlignment();
+
+	unsigned kernels = 0;
+	unsigned tests = 0;
+
+	for (const auto& item : GetCopyKernels()) {
+		if (!item.features) {
+			continue;
+		}
+		const CopyKernel_t* ref = FindScalarKernel(item);
+		CHECK(ref != nullptr);
+		if (!ref || !IsSupported(item.features)) {
+			continue;
+		}
+		tests += item.convert ? TestPlanarKernel(item, *ref) : TestCopyKernel(item, *ref);
+		kernels++;
+	}
+
+	for (const auto& item : GetUnpackKernels()) {
+		if (!item.features) {
+			continue;
+		}
+		const UnpackKernel_t* ref = nullptr;
+		for (const auto& r : GetUnpackKernels()) {
+			if (!r.features && r.cformat == item.cformat) {
+				ref = &r;
+				break;
+			}
+		}
+		CHECK(ref != nullptr);
+		if (!ref || !IsSupported(item.features)) {
+			continue;
+		}
+		tests += TestUnpackKernel(item, *ref);
+		kernels++;
+	}
+
+	printf("%u SIMD kernels, %u frames compared\n", kernels, tests);
+
+	return TestResult();
+}
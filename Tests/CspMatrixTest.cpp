@@ -0,0 +1,183 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+
+// Compares the matrices that mp_get_csp_matrix() and GetColorspaceGamutConversionMatrix() take
+// from their tables with the computed ones bit for bit, fills the tables from several threads
+// at once as the shader precompile threads can, and measures a lookup against the computation.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include <chrono>
+#include <thread>
+#include "csputils.h"
+
+// the first use of the tables is on several threads
+static void TestFirstUse()
+{
+	const int nThreads = 4;
+	std::vector<std::thread> threads;
+	bool bEqual[nThreads] = {};
+
+	for (int i = 0; i < nThreads; i++) {
+		threads.emplace_back([i, &bEqual] {
+			mp_csp_params params;
+			params.color.space = MP_CSP_BT_2020_NC;
+			params.input_bits = params.texture_bits = 10;
+			mp_cmat table, computed;
+			mp_get_csp_matrix(&params, &table);
+			mp_calc_csp_matrix(&params, &computed);
+
+			float gamut[3][3], gamutComputed[3][3];
+			GetColorspaceGamutConversionMatrix(gamut, MP_CSP_PRIM_BT_2020, MP_CSP_PRIM_BT_709);
+			CalcColorspaceGamutConversionMatrix(gamutComputed, MP_CSP_PRIM_BT_2020, MP_CSP_PRIM_BT_709);
+
+			bEqual[i] = !memcmp(&table, &computed, sizeof(table)) && !memcmp(gamut, gamutComputed, sizeof(gamut));
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	for (const bool b : bEqual) {
+		CHECK(b);
+	}
+}
+
+static void TestCspMatrices()
+{
+	int nEntries = 0;
+	int nDiffer = 0;
+	for (int space = 0; space < MP_CSP_COUNT; space++) {
+		for (int levels = 0; levels < MP_CSP_LEVELS_COUNT; levels++) {
+			for (int levelsOut = 0; levelsOut < MP_CSP_LEVELS_COUNT; levelsOut++) {
+				for (const bool bFloat : { false, true }) {
+					for (int bits = 0; bits <= 16; bits++) {
+						mp_csp_params params;
+						params.color.space = (mp_csp)space;
+						params.color.levels = (mp_csp_levels)levels;
+						params.levels_out = (mp_csp_levels)levelsOut;
+						params.is_float = bFloat;
+						params.input_bits = params.texture_bits = bits;
+
+						mp_cmat table, computed;
+						mp_get_csp_matrix(&params, &table);
+						mp_calc_csp_matrix(&params, &computed);
+						nEntries++;
+						nDiffer += memcmp(&table, &computed, sizeof(table)) != 0;
+					}
+				}
+			}
+		}
+	}
+	printf("colorspace matrices: %d table entries, %d differ\n", nEntries, nDiffer);
+	CHECK(nDiffer == 0);
+
+	// the picture adjustments, gray and unequal bits are computed
+	nDiffer = 0;
+	for (int space = 1; space < MP_CSP_COUNT; space++) {
+		for (int k = 0; k < 4; k++) {
+			mp_csp_params params;
+			params.color.space = (mp_csp)space;
+			params.input_bits = 10;
+			params.texture_bits = (k == 3) ? 16 : 10;
+			switch (k) {
+			case 0: params.brightness = 0.1f; break;
+			case 1: params.hue = 0.3f; params.saturation = 1.2f; break;
+			case 2: params.gray = true; break;
+			}
+
+			mp_cmat table, computed;
+			mp_get_csp_matrix(&params, &table);
+			mp_calc_csp_matrix(&params, &computed);
+			nDiffer += memcmp(&table, &computed, sizeof(table)) != 0;
+		}
+	}
+	CHECK(nDiffer == 0);
+}
+
+static void TestGamutMatrices()
+{
+	int nPairs = 0;
+	int nDiffer = 0;
+	for (int in = 0; in < MP_CSP_PRIM_COUNT; in++) {
+		for (int out = 0; out < MP_CSP_PRIM_COUNT; out++) {
+			float table[3][3], computed[3][3];
+			GetColorspaceGamutConversionMatrix(table, (mp_csp_prim)in, (mp_csp_prim)out);
+			CalcColorspaceGamutConversionMatrix(computed, (mp_csp_prim)in, (mp_csp_prim)out);
+			nPairs++;
+			nDiffer += memcmp(table, computed, sizeof(table)) != 0;
+		}
+	}
+	printf("gamut matrices: %d pairs of primaries, %d differ\n", nPairs, nDiffer);
+	CHECK(nDiffer == 0);
+}
+
+template <typename F>
+static double MeasureNs(F fn)
+{
+	const int count = 1000000;
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < count; i++) {
+		fn(i);
+	}
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+}
+
+static void Benchmark()
+{
+	volatile float sink = 0.0f;
+	mp_csp_params params;
+	params.color.space = MP_CSP_BT_2020_NC;
+	mp_cmat m;
+	float gamut[3][3];
+
+	const double cspComputed = MeasureNs([&](const int i) {
+		params.input_bits = params.texture_bits = 8 + (i & 7);
+		mp_calc_csp_matrix(&params, &m);
+		sink = sink + m.c[0];
+	});
+	const double cspTable = MeasureNs([&](const int i) {
+		params.input_bits = params.texture_bits = 8 + (i & 7);
+		mp_get_csp_matrix(&params, &m);
+		sink = sink + m.c[0];
+	});
+	const double gamutComputed = MeasureNs([&](const int i) {
+		CalcColorspaceGamutConversionMatrix(gamut, (mp_csp_prim)(1 + (i & 3)), MP_CSP_PRIM_BT_709);
+		sink = sink + gamut[0][0];
+	});
+	const double gamutTable = MeasureNs([&](const int i) {
+		GetColorspaceGamutConversionMatrix(gamut, (mp_csp_prim)(1 + (i & 3)), MP_CSP_PRIM_BT_709);
+		sink = sink + gamut[0][0];
+	});
+
+	printf("colorspace matrix: computed %.1f ns, table %.1f ns\n", cspComputed, cspTable);
+	printf("gamut matrix: computed %.1f ns, table %.1f ns\n", gamutComputed, gamutTable);
+}
+
+int main()
+{
+	TestFirstUse();
+	TestCspMatrices();
+	TestGamutMatrices();
+	Benchmark();
+
+	return TestResult();
+}
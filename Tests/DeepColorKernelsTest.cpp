@@ -0,0 +1,219 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+// Golden-output test of the deep-colour copy kernels and the R10G10B10A2 converters.
+// The scalar functions are compared with per-pixel formulas of the formats, the SIMD variants
+// with the scalar functions, for all widths of the vector tails and for bottom-up frames.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "Helper.h"
+#include "Utils/CPUInfo.h"
+
+static uint32_t s_seed = 1;
+
+static uint32_t Rand32()
+{
+	s_seed ^= s_seed << 13;
+	s_seed ^= s_seed >> 17;
+	s_seed ^= s_seed << 5;
+	return s_seed;
+}
+
+static uint16_t Get16(const BYTE* p, const int i) { return (uint16_t)(p[i * 2] | (p[i * 2 + 1] << 8)); }
+static uint32_t Get32(const BYTE* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static void Put16(BYTE* p, const int i, const uint32_t v) { p[i * 2] = (BYTE)v; p[i * 2 + 1] = (BYTE)(v >> 8); }
+static void Put32(BYTE* p, const uint32_t v) { Put16(p, 0, v & 0xffff); Put16(p, 1, v >> 16); }
+
+// converts the pixel i of a line of n pixels
+typedef void(*GoldenPixelFn)(const BYTE* line, const UINT i, const UINT n, BYTE* dst);
+
+// RGB48 and b48r to A16B16G16R16. The pixels of the groups of four are copied as 64-bit words,
+// the alpha of the first three is the red of the next pixel, the alpha of the others is 0.
+static void GoldenRGB48(const BYTE* line, const UINT i, const UINT n, BYTE* dst)
+{
+	const BYTE* p = line + i * 6;
+	Put16(dst, 0, Get16(p, 0));
+	Put16(dst, 1, Get16(p, 1));
+	Put16(dst, 2, Get16(p, 2));
+	Put16(dst, 3, (i % 4 != 3 && i < (n & ~3u)) ? Get16(p, 3) : 0);
+}
+
+static void GoldenBGR48(const BYTE* line, const UINT i, const UINT, BYTE* dst)
+{
+	const BYTE* p = line + i * 6;
+	Put16(dst, 0, Get16(p, 2));
+	Put16(dst, 1, Get16(p, 1));
+	Put16(dst, 2, Get16(p, 0));
+	Put16(dst, 3, 0);
+}
+
+static void GoldenBGRA64(const BYTE* line, const UINT i, const UINT, BYTE* dst)
+{
+	const BYTE* p = line + i * 8;
+	Put16(dst, 0, Get16(p, 2));
+	Put16(dst, 1, Get16(p, 1));
+	Put16(dst, 2, Get16(p, 0));
+	Put16(dst, 3, Get16(p, 3));
+}
+
+// b64a is big-endian A R G B
+static void GoldenB64A(const BYTE* line, const UINT i, const UINT, BYTE* dst)
+{
+	const BYTE* p = line + i * 8;
+	Put16(dst, 0, (p[2] << 8) | p[3]);
+	Put16(dst, 1, (p[4] << 8) | p[5]);
+	Put16(dst, 2, (p[6] << 8) | p[7]);
+	Put16(dst, 3, (p[0] << 8) | p[1]);
+}
+
+// r210 is a big-endian word of 2 zero bits and 10-bit R G B, DXGI R10G10B10A2 has R in the low bits
+static void GoldenR210(const BYTE* line, const UINT i, const UINT, BYTE* dst)
+{
+	const BYTE* p = line + i * 4;
+	const uint32_t w = ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+	Put32(dst, ((w >> 20) & 0x3ff) | (((w >> 10) & 0x3ff) << 10) | ((w & 0x3ff) << 20));
+}
+
+// 10-bit samples in the low bits of 16-bit words to 16-bit samples
+static void Golden10to16(const BYTE* line, const UINT i, const UINT, BYTE* dst)
+{
+	Put16(dst, 0, (Get16(line, i) << 6) & 0xffff);
+}
+
+static void GoldenR10G10B10A2toBGR32(const BYTE* line, const UINT i, const UINT, BYTE* dst)
+{
+	const uint32_t t = Get32(line + i * 4);
+	dst[0] = (BYTE)((t >> 22) & 0xff); // the 8 high bits of B
+	dst[1] = (BYTE)((t >> 12) & 0xff);
+	dst[2] = (BYTE)((t >> 2) & 0xff);
+	dst[3] = 0xff;
+}
+
+static void GoldenR10G10B10A2toBGR48(const BYTE* line, const UINT i, const UINT, BYTE* dst)
+{
+	const uint32_t t = Get32(line + i * 4);
+	Put16(dst, 0, ((t >> 20) & 0x3ff) << 6);
+	Put16(dst, 1, ((t >> 10) & 0x3ff) << 6);
+	Put16(dst, 2, (t & 0x3ff) << 6);
+}
+
+static void GoldenR10G10B10A2toBGR64(const BYTE* line, const UINT i, const UINT n, BYTE* dst)
+{
+	GoldenR10G10B10A2toBGR48(line, i, n, dst);
+	Put16(dst, 3, 0xffff);
+}
+
+struct Kernel_t {
+	const char*     name;
+	int             features;
+	CopyFrameDataFn fn;
+	CopyFrameDataFn scalar;
+	GoldenPixelFn   golden;
+	UINT            src_bpp;
+	UINT            dst_bpp;
+	bool            bBottomUp; // accepts a negative pitch
+};
+
+#define KERNEL(fn, features, scalar, golden, src_bpp, dst_bpp, bottomUp) \
+	{ #fn, features, fn, scalar, golden, src_bpp, dst_bpp, bottomUp }
+#define KERNELS(fn, ext, features, golden, src_bpp, dst_bpp, bottomUp) \
+	KERNEL(fn,             0,                 fn, golden, src_bpp, dst_bpp, bottomUp), \
+	KERNEL(fn##_##ext,     features,          fn, golden, src_bpp, dst_bpp, bottomUp), \
+	KERNEL(fn##_AVX2,      CPUInfo::CPU_AVX2, fn, golden, src_bpp, dst_bpp, bottomUp)
+
+static const Kernel_t s_kernels[] = {
+	KERNELS(CopyPlane10to16,           SSE2,  CPUInfo::CPU_SSE2,  Golden10to16,             2, 2, false),
+	KERNELS(CopyFrameR210,             SSE2,  CPUInfo::CPU_SSE2,  GoldenR210,               4, 4, false),
+	KERNELS(CopyFrameRGB48,            SSSE3, CPUInfo::CPU_SSSE3, GoldenRGB48,              6, 8, true),
+	KERNELS(CopyFrameBGR48,            SSSE3, CPUInfo::CPU_SSSE3, GoldenBGR48,              6, 8, true),
+	KERNELS(CopyFrameBGRA64,           SSSE3, CPUInfo::CPU_SSSE3, GoldenBGRA64,             8, 8, true),
+	KERNELS(CopyFrameB64A,             SSSE3, CPUInfo::CPU_SSSE3, GoldenB64A,               8, 8, true),
+	KERNELS(ConvertR10G10B10A2toBGR32, SSE2,  CPUInfo::CPU_SSE2,  GoldenR10G10B10A2toBGR32, 4, 4, true),
+	KERNELS(ConvertR10G10B10A2toBGR48, SSSE3, CPUInfo::CPU_SSSE3, GoldenR10G10B10A2toBGR48, 4, 6, true),
+	KERNELS(ConvertR10G10B10A2toBGR64, SSE2,  CPUInfo::CPU_SSE2,  GoldenR10G10B10A2toBGR64, 4, 8, true),
+};
+
+#undef KERNELS
+#undef KERNEL
+
+// Converts a frame of lines x width pixels with the kernel and compares it with the golden formula of every pixel
+// and with the scalar function. The destination lines have a padding that must not be written.
+static bool TestKernel(const Kernel_t& k, const UINT width, const UINT lines, const bool bBottomUp)
+{
+	const UINT line_size = width * k.src_bpp;
+	const int src_pitch = bBottomUp ? -(int)line_size : (int)line_size;
+	const UINT dst_pitch = width * k.dst_bpp + 16;
+
+	std::vector<BYTE> src((size_t)line_size * lines);
+	for (auto& b : src) {
+		b = (BYTE)Rand32();
+	}
+	std::vector<BYTE> golden((size_t)dst_pitch * lines, 0xCD);
+	std::vector<BYTE> scalar(golden);
+	std::vector<BYTE> result(golden);
+
+	// a bottom-up frame starts with the last line in memory
+	const BYTE* first = bBottomUp ? src.data() + (size_t)line_size * (lines - 1) : src.data();
+	for (UINT y = 0; y < lines; y++) {
+		const BYTE* line = first + (ptrdiff_t)src_pitch * y;
+		for (UINT i = 0; i < width; i++) {
+			k.golden(line, i, width, golden.data() + (size_t)dst_pitch * y + i * k.dst_bpp);
+		}
+	}
+	k.scalar(lines, scalar.data(), dst_pitch, first, src_pitch);
+	k.fn(lines, result.data(), dst_pitch, first, src_pitch);
+
+	if (scalar != golden) {
+		fprintf(stderr, "%s: the scalar function differs from the golden output for %ux%u%s\n", k.name, width, lines, bBottomUp ? " bottom-up" : "");
+		return false;
+	}
+	if (result != golden) {
+		fprintf(stderr, "%s differs from the golden output for %ux%u%s\n", k.name, width, lines, bBottomUp ? " bottom-up" : "");
+		return false;
+	}
+	return true;
+}
+
+int main()
+{
+	unsigned tested = 0;
+
+	for (const auto& k : s_kernels) {
+		if ((k.features & CPUInfo::GetFeatures()) != k.features) {
+			printf("%s is not supported by the processor\n", k.name);
+			continue;
+		}
+		bool bOk = true;
+		// all the tails of 32-byte vectors of four pixel groups
+		for (UINT width = 1; width < 70 && bOk; width++) {
+			bOk = TestKernel(k, width, 3, false);
+			if (bOk && k.bBottomUp) {
+				bOk = TestKernel(k, width, 3, true);
+			}
+		}
+		CHECK(bOk);
+		tested++;
+	}
+
+	printf("%u kernels match the golden output\n", tested);
+
+	return TestResult();
+}
@@ -0,0 +1,186 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+
+// Flips single bits of a 4K BGRA frame and checks that CDirtyRows reports exactly the band
+// of the change, also for moved blocks and lines, short lines and bottom-up frames. Checks
+// the back-off on frames that change completely and the counters, then measures the hashing.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include <chrono>
+#include <random>
+#include "DirtyRows.h"
+
+static std::mt19937_64 s_rng(7);
+
+static bool IsOnlyBand(CDirtyRows& dirtyRows, const CDirtyRows::Result_t result, const UINT line)
+{
+	return result == CDirtyRows::DIRTY_RANGES
+		&& dirtyRows.GetRanges().size() == 1
+		&& dirtyRows.GetRanges()[0].first == line / CDirtyRows::BAND_LINES * CDirtyRows::BAND_LINES;
+}
+
+static void TestBitFlips(std::vector<BYTE>& frame, const UINT lineSize, const UINT lines, CParallelCopy& parallelCopy)
+{
+	CDirtyRows dirtyRows;
+	CHECK(dirtyRows.Compare(frame.data(), lineSize, lineSize, lines, 0.5, &parallelCopy) == CDirtyRows::DIRTY_ALL);
+	CHECK(dirtyRows.Compare(frame.data(), lineSize, lineSize, lines, 0.5, &parallelCopy) == CDirtyRows::DIRTY_NONE);
+
+	int missed = 0;
+	for (int n = 0; n < 2000; n++) {
+		const size_t pos = s_rng() % frame.size();
+		frame[pos] ^= (BYTE)(1u << (s_rng() % 8));
+		const auto result = dirtyRows.Compare(frame.data(), lineSize, lineSize, lines, 0.5, &parallelCopy);
+		if (!IsOnlyBand(dirtyRows, result, (UINT)(pos / lineSize))) {
+			fprintf(stderr, "the flip at %zu was not reported in its band\n", pos);
+			missed++;
+		}
+	}
+	CHECK(missed == 0);
+
+	// two 64-byte blocks of a line swapped
+	BYTE* line = frame.data() + (size_t)lineSize * 100;
+	BYTE block[64];
+	memcpy(block, line, 64);
+	memcpy(line, line + 64, 64);
+	memcpy(line + 64, block, 64);
+	CHECK(IsOnlyBand(dirtyRows, dirtyRows.Compare(frame.data(), lineSize, lineSize, lines, 0.5, &parallelCopy), 100));
+
+	// two lines of a band swapped
+	std::vector<BYTE> temp(lineSize);
+	BYTE* line1 = frame.data() + (size_t)lineSize * 200;
+	BYTE* line2 = line1 + lineSize;
+	memcpy(temp.data(), line1, lineSize);
+	memcpy(line1, line2, lineSize);
+	memcpy(line2, temp.data(), lineSize);
+	CHECK(IsOnlyBand(dirtyRows, dirtyRows.Compare(frame.data(), lineSize, lineSize, lines, 0.5, &parallelCopy), 200));
+
+	// the first line of a bottom-up frame is the last one in memory
+	CDirtyRows bottomUp;
+	BYTE* last = frame.data() + (size_t)lineSize * (lines - 1);
+	bottomUp.Compare(last, -(int)lineSize, lineSize, lines, 0.5, nullptr);
+	frame[5] ^= 1;
+	CHECK(IsOnlyBand(bottomUp, bottomUp.Compare(last, -(int)lineSize, lineSize, lines, 0.5, nullptr), lines - 1));
+}
+
+static void TestLineSizes()
+{
+	const UINT lines = 40;
+	for (const size_t lineSize : { 1, 7, 63, 64, 65, 1023, 1024, 1025, 4097 }) {
+		std::vector<BYTE> frame(lineSize * lines);
+		for (auto& b : frame) {
+			b = (BYTE)s_rng();
+		}
+		CDirtyRows dirtyRows;
+		dirtyRows.Compare(frame.data(), (int)lineSize, lineSize, lines, 1.0, nullptr);
+		for (size_t pos = 0; pos < frame.size(); pos += 1 + s_rng() % 7) {
+			frame[pos] ^= 0x80;
+			if (!IsOnlyBand(dirtyRows, dirtyRows.Compare(frame.data(), (int)lineSize, lineSize, lines, 1.0, nullptr), (UINT)(pos / lineSize))) {
+				fprintf(stderr, "line size %zu: the flip at %zu was not reported in its band\n", lineSize, pos);
+				CHECK(false);
+				break;
+			}
+		}
+	}
+}
+
+static void TestBackOff()
+{
+	const UINT lineSize = 3840 * 4;
+	const UINT lines = 64;
+	const uint64_t frameSize = (uint64_t)lineSize * lines;
+	std::vector<BYTE> frame(frameSize);
+	CDirtyRows dirtyRows;
+
+	// frames that change completely are uploaded in full and are rarely compared
+	const int nFrames = 1000;
+	for (int n = 0; n < nFrames; n++) {
+		for (size_t i = 0; i < frame.size(); i += 8) {
+			frame[i] = (BYTE)s_rng();
+		}
+		CHECK(dirtyRows.Compare(frame.data(), lineSize, lineSize, lines, 0.5, nullptr) == CDirtyRows::DIRTY_ALL);
+	}
+	CHECK(dirtyRows.GetBytesUploaded() == frameSize * nFrames);
+	CHECK(dirtyRows.GetBytesSkipped() == 0);
+
+	// a static frame is found again after at most MAX_PROBE_INTERVAL frames and one to hash it
+	int nFull = 0;
+	while (dirtyRows.Compare(frame.data(), lineSize, lineSize, lines, 0.5, nullptr) == CDirtyRows::DIRTY_ALL && nFull <= 100) {
+		nFull++;
+	}
+	CHECK(nFull <= (int)CDirtyRows::MAX_PROBE_INTERVAL + 1);
+
+	// a partial change counts only its lines
+	dirtyRows.ResetCounters();
+	frame[(size_t)lineSize * 20] ^= 1;
+	CHECK(IsOnlyBand(dirtyRows, dirtyRows.Compare(frame.data(), lineSize, lineSize, lines, 0.5, nullptr), 20));
+	CHECK(dirtyRows.GetBytesUploaded() == (uint64_t)lineSize * CDirtyRows::BAND_LINES);
+	CHECK(dirtyRows.GetBytesSkipped() == frameSize - (uint64_t)lineSize * CDirtyRows::BAND_LINES);
+
+	// more changed lines than maxPartial, or an invalidated destination, upload the whole frame
+	for (UINT line = 0; line < lines; line += 2 * CDirtyRows::BAND_LINES) {
+		frame[(size_t)lineSize * line] ^= 1;
+	}
+	CHECK(dirtyRows.Compare(frame.data(), lineSize, lineSize, lines, 0.25, nullptr) == CDirtyRows::DIRTY_ALL);
+	dirtyRows.Invalidate();
+	CHECK(dirtyRows.Compare(frame.data(), lineSize, lineSize, lines, 0.5, nullptr) == CDirtyRows::DIRTY_ALL);
+	CHECK(dirtyRows.Compare(frame.data(), lineSize, lineSize, lines, 0.5, nullptr) == CDirtyRows::DIRTY_NONE);
+}
+
+static void Benchmark(const std::vector<BYTE>& frame, const UINT lineSize, const UINT lines)
+{
+	CDirtyRows dirtyRows;
+	std::vector<BYTE> copy(frame.size());
+	double hashMs = 1e9;
+	double copyMs = 1e9;
+	for (int n = 0; n < 10; n++) {
+		dirtyRows.Invalidate();
+		auto start = std::chrono::steady_clock::now();
+		dirtyRows.Compare(frame.data(), lineSize, lineSize, lines, 0.5, nullptr);
+		hashMs = std::min(hashMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+		start = std::chrono::steady_clock::now();
+		memcpy(copy.data(), frame.data(), frame.size());
+		copyMs = std::min(copyMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+	printf("4K BGRA, one thread: hash %.2f ms (%.1f GB/s), memcpy %.2f ms\n", hashMs, frame.size() / hashMs / 1e6, copyMs);
+}
+
+int main()
+{
+	const UINT lineSize = 3840 * 4;
+	const UINT lines = 2160;
+	std::vector<BYTE> frame((size_t)lineSize * lines);
+	for (auto& b : frame) {
+		b = (BYTE)s_rng();
+	}
+
+	CParallelCopy parallelCopy;
+	parallelCopy.SetThreads(4);
+
+	TestBitFlips(frame, lineSize, lines, parallelCopy);
+	TestLineSizes();
+	TestBackOff();
+	Benchmark(frame, lineSize, lines);
+
+	return TestResult();
+}
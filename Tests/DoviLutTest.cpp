@@ -0,0 +1,320 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+
+// Bakes sample Dolby Vision mappings and checks the errors that MeasureDoviReshapeLut() reports
+// against the bounds of linear interpolation. A quadratic piece y = c0 + c1*s + c2*s^2 interpolated
+// over cells of h = 1/1023 is off by at most |c2|*h^2/4 = 4.8e-8 for |c2| = 0.2, the float rows
+// and the float sampling add a few 1e-8. On the code values of a 10-bit base layer the rows are
+// sampled, the error is the float rounding. Where the pieces do not join, the cells of the pivots
+// interpolate across the step of the curve.
+// Then checks the fingerprints of the metadata, the state of the video processors between samples
+// with and without metadata, and measures the fingerprint of a sample.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include <chrono>
+#include "Helper.h"
+#include "DoviLut.h"
+
+// four pieces of one quadratic per component, with the pivots between the base layer codes
+static void MakeMetadata(MediaSideDataDOVIMetadata& msd)
+{
+	msd = {};
+	msd.Header.bl_bit_depth    = 10;
+	msd.Header.coef_log2_denom = 23;
+
+	const double coefs[3][3] = {
+		{ 0.02, 0.80,  0.15 },
+		{ 0.00, 1.00,  0.00 },
+		{ 0.05, 1.10, -0.20 },
+	};
+	const double den = (double)(1ll << msd.Header.coef_log2_denom);
+	for (int c = 0; c < 3; c++) {
+		auto& curve = msd.Mapping.curves[c];
+		curve.num_pivots = 5;
+		for (int i = 0; i < curve.num_pivots; i++) {
+			curve.pivots[i] = (uint16_t)(1023 * i / 4);
+		}
+		for (int i = 0; i < curve.num_pivots - 1; i++) {
+			curve.mapping_idc[i] = 0;
+			curve.poly_order[i]  = 2;
+			for (int k = 0; k < 3; k++) {
+				curve.poly_coef[i][k] = llround(coefs[c][k] * den);
+			}
+		}
+	}
+}
+
+static void TestJoinedPieces()
+{
+	MediaSideDataDOVIMetadata msd;
+	MakeMetadata(msd);
+
+	std::vector<float> lut;
+	BakeDoviReshapeLut(msd, lut);
+	CHECK(lut.size() == 3 * DOVI_LUT_SIZE);
+
+	const auto report = MeasureDoviReshapeLut(msd, lut.data(), 100000);
+	printf("joined pieces: max error %.3e at %.6f of component %d, on the code values %.3e\n",
+		report.maxErr, report.maxErrInput, report.maxErrComponent, report.maxErrCodes);
+	CHECK(report.maxErr <= 2e-7);
+	CHECK(report.maxErrCodes <= 1e-7);
+}
+
+static void TestSteps()
+{
+	MediaSideDataDOVIMetadata msd;
+	MakeMetadata(msd);
+
+	// the odd pieces of the first component are raised by 0.002
+	const double step = 0.002;
+	const double den = (double)(1ll << msd.Header.coef_log2_denom);
+	auto& curve = msd.Mapping.curves[0];
+	for (int i = 1; i < curve.num_pivots - 1; i += 2) {
+		curve.poly_coef[i][0] += llround(step * den);
+	}
+
+	std::vector<float> lut;
+	BakeDoviReshapeLut(msd, lut);
+	const auto report = MeasureDoviReshapeLut(msd, lut.data(), 100000);
+	printf("pieces with steps of %.3f: max error %.3e at %.6f of component %d, on the code values %.3e\n",
+		step, report.maxErr, report.maxErrInput, report.maxErrComponent, report.maxErrCodes);
+	CHECK(report.maxErr <= step + 2e-7);
+	CHECK(report.maxErr >= step / 2);
+	CHECK(report.maxErrComponent == 0);
+	CHECK(report.maxErrCodes <= 1e-7);
+}
+
+static void TestCache()
+{
+	MediaSideDataDOVIMetadata msd1, msd2;
+	MakeMetadata(msd1);
+	MakeMetadata(msd2);
+	msd2.Mapping.curves[1].poly_coef[0][0] += 1000;
+
+	const uint64_t hash1 = GetDoviReshapeHash(msd1);
+	const uint64_t hash2 = GetDoviReshapeHash(msd2);
+	CHECK(hash1 != hash2);
+
+	// the pieces after num_pivots are not used and not hashed
+	msd1.Mapping.curves[2].poly_coef[6][1] = 12345;
+	CHECK(GetDoviReshapeHash(msd1) == hash1);
+
+	CDoviLutCache cache(1);
+	std::vector<float> lut1, lut2;
+	BakeDoviReshapeLut(msd1, lut1);
+	BakeDoviReshapeLut(msd2, lut2);
+
+	CHECK(cache.Get(msd1, hash1) == lut1);
+	CHECK(cache.Get(msd1, hash1) == lut1);
+	CHECK(cache.Get(msd2, hash2) == lut2);
+	CHECK(cache.Get(msd1, hash1) == lut1); // the only entry was reused for msd2
+	CHECK(cache.GetHits() == 1 && cache.GetMisses() == 3);
+}
+
+// A block of a scene of profile 8.1 (polynomial) or 7 (MMR). The decoder does not clear the unused entries.
+static void MakeScene(MediaSideDataDOVIMetadata& msd, const bool bMMR, const int scene)
+{
+	memset(&msd, 0xCD, sizeof(msd));
+	msd.Header = {};
+	msd.Header.bl_bit_depth    = 10;
+	msd.Header.coef_log2_denom = 23;
+	msd.Header.vdr_bit_depth   = 12;
+
+	const double ycc[9] = { 1.0, 0.0, 1.575, 1.0, -0.187, -0.468, 1.0, 1.856, 0.0 };
+	auto& color = msd.ColorMetadata;
+	for (int i = 0; i < 9; i++) {
+		color.ycc_to_rgb_matrix[i] = ycc[i];
+		color.rgb_to_lms_matrix[i] = (i % 4 == 0) ? 0.9 : 0.05;
+	}
+	for (int i = 0; i < 3; i++) {
+		color.ycc_to_rgb_offset[i] = i ? 0.5 : 0.0625;
+	}
+	color.source_min_pq = 62;
+	color.source_max_pq = 3079;
+
+	for (int c = 0; c < 3; c++) {
+		auto& curve = msd.Mapping.curves[c];
+		const int pieces = (c == 0) ? 8 : (bMMR ? 1 : 2);
+		curve.num_pivots = pieces + 1;
+		for (int i = 0; i <= pieces; i++) {
+			curve.pivots[i] = (uint16_t)(1023 * i / pieces);
+		}
+		for (int i = 0; i < pieces; i++) {
+			curve.mapping_idc[i] = (bMMR && c) ? 1 : 0;
+			curve.poly_order[i]  = 2;
+			for (int k = 0; k < 3; k++) {
+				curve.poly_coef[i][k] = (int64_t)((k == 1 ? 1.0 : 0.01) * (1 << 23)) + scene * 97 + i;
+			}
+			curve.mmr_order[i]    = 3;
+			curve.mmr_constant[i] = scene;
+			for (int o = 0; o < 3; o++) {
+				for (int k = 0; k < 7; k++) {
+					curve.mmr_coef[i][o][k] = scene * 31 + o * 7 + k;
+				}
+			}
+		}
+	}
+}
+
+static void TestFingerprint()
+{
+	for (const bool bMMR : { false, true }) {
+		MediaSideDataDOVIMetadata msd1, msd2;
+		MakeScene(msd1, bMMR, 1);
+		MakeScene(msd2, bMMR, 1);
+
+		DoviFingerprint_t fp1, fp2;
+		GetDoviFingerprint(msd1, fp1);
+
+		// the entries after the used pieces may hold anything
+		msd2.Mapping.curves[1].pivots[LAV_DOVI_MAX_PIECES] = 1;
+		msd2.Mapping.curves[1].poly_coef[LAV_DOVI_MAX_PIECES - 1][2] = 1;
+		msd2.Mapping.curves[2].mmr_coef[LAV_DOVI_MAX_PIECES - 1][0][0] = 1;
+		GetDoviFingerprint(msd2, fp2);
+		CHECK(fp2.all == fp1.all);
+
+		// each used part changes its hash and the hash of the whole block
+		msd2.ColorMetadata.source_max_pq++;
+		GetDoviFingerprint(msd2, fp2);
+		CHECK(fp2.levels != fp1.levels && fp2.all != fp1.all && !fp2.CurvesChanged(fp1));
+
+		MakeScene(msd2, bMMR, 2);
+		GetDoviFingerprint(msd2, fp2);
+		CHECK(fp2.CurvesChanged(fp1) && fp2.all != fp1.all);
+		CHECK(fp2.yccToRgb == fp1.yccToRgb && fp2.rgbToLms == fp1.rgbToLms);
+		CHECK((fp2.mmr != fp1.mmr) == bMMR);
+	}
+}
+
+enum SampleResult_t {
+	SAMPLE_UNCHANGED, // the metadata of the sample is the applied one
+	SAMPLE_APPLIED,   // new metadata
+	SAMPLE_ENDED,     // the first sample without metadata, the shader is built again
+	SAMPLE_NONE,
+};
+
+// The decisions of CopySample() of the video processors for the Dolby Vision metadata of a sample,
+// pMsd is nullptr for a sample without metadata.
+static SampleResult_t ProcessSample(DoviState_t& state, const MediaSideDataDOVIMetadata* pMsd)
+{
+	if (pMsd) {
+		DoviFingerprint_t fp;
+		GetDoviFingerprint(*pMsd, fp);
+		if (state.IsApplied(fp)) {
+			return SAMPLE_UNCHANGED;
+		}
+		state.msd     = *pMsd;
+		state.fp      = fp;
+		state.bValid  = true;
+		state.bHasMMR = DoviHasMMR(*pMsd);
+		return SAMPLE_APPLIED;
+	}
+
+	return state.End() ? SAMPLE_ENDED : SAMPLE_NONE;
+}
+
+static void TestTransitions()
+{
+	MediaSideDataDOVIMetadata scene1, scene2;
+	MakeScene(scene1, true, 1);
+	MakeScene(scene2, true, 2);
+
+	DoviState_t state;
+	CHECK(ProcessSample(state, nullptr) == SAMPLE_NONE);
+	CHECK(ProcessSample(state, &scene1) == SAMPLE_APPLIED);
+	CHECK(ProcessSample(state, &scene1) == SAMPLE_UNCHANGED);
+	CHECK(state.bValid && state.bHasMMR);
+
+	// the metadata ends once, the frames after it are not reshaped
+	CHECK(ProcessSample(state, nullptr) == SAMPLE_ENDED);
+	CHECK(!state.bValid);
+	CHECK(ProcessSample(state, nullptr) == SAMPLE_NONE);
+	CHECK(state.bHasMMR);
+
+	// the same metadata after a gap is applied again
+	CHECK(ProcessSample(state, &scene1) == SAMPLE_APPLIED);
+	CHECK(ProcessSample(state, &scene1) == SAMPLE_UNCHANGED);
+	CHECK(ProcessSample(state, &scene2) == SAMPLE_APPLIED);
+	CHECK(ProcessSample(state, nullptr) == SAMPLE_ENDED);
+	CHECK(ProcessSample(state, &scene2) == SAMPLE_APPLIED);
+}
+
+// The cost of a sample that repeats the applied metadata. The renderer gets a new copy of the side data
+// with each sample, before the fingerprints the curves were compared and the block was copied.
+static void Benchmark()
+{
+	for (const bool bMMR : { false, true }) {
+		MediaSideDataDOVIMetadata scene, sample, applied;
+		MakeScene(scene, bMMR, 1);
+		MakeScene(applied, bMMR, 1);
+		DoviFingerprint_t appliedFp;
+		GetDoviFingerprint(applied, appliedFp);
+
+		const int nFrames = 200000;
+		uint64_t changes = 0;
+		double copyNs = 1e9, fingerprintNs = 1e9, compareNs = 1e9;
+		for (int repeat = 0; repeat < 5; repeat++) {
+			auto start = std::chrono::steady_clock::now();
+			for (int n = 0; n < nFrames; n++) {
+				memcpy(&sample, &scene, sizeof(sample));
+				changes += sample.Header.bl_bit_depth != 10;
+			}
+			auto end = std::chrono::steady_clock::now();
+			copyNs = std::min(copyNs, std::chrono::duration<double, std::nano>(end - start).count() / nFrames);
+
+			start = std::chrono::steady_clock::now();
+			for (int n = 0; n < nFrames; n++) {
+				memcpy(&sample, &scene, sizeof(sample));
+				DoviFingerprint_t fp;
+				GetDoviFingerprint(sample, fp);
+				changes += fp.all != appliedFp.all;
+			}
+			end = std::chrono::steady_clock::now();
+			fingerprintNs = std::min(fingerprintNs, std::chrono::duration<double, std::nano>(end - start).count() / nFrames);
+
+			start = std::chrono::steady_clock::now();
+			for (int n = 0; n < nFrames; n++) {
+				memcpy(&sample, &scene, sizeof(sample));
+				changes += memcmp(&sample.Mapping.curves, &applied.Mapping.curves, sizeof(sample.Mapping.curves)) != 0;
+				memcpy(&applied, &sample, sizeof(sample));
+			}
+			end = std::chrono::steady_clock::now();
+			compareNs = std::min(compareNs, std::chrono::duration<double, std::nano>(end - start).count() / nFrames);
+		}
+		CHECK(changes == 0);
+		printf("%s, an unchanged sample: fingerprint %.1f ns, memcmp and memcpy %.1f ns\n",
+			bMMR ? "profile 7 (MMR)" : "profile 8.1 (polynomial)", fingerprintNs - copyNs, compareNs - copyNs);
+	}
+}
+
+int main()
+{
+	TestJoinedPieces();
+	TestSteps();
+	TestCache();
+	TestFingerprint();
+	TestTransitions();
+	Benchmark();
+
+	return TestResult();
+}
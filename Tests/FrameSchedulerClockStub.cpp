@@ -0,0 +1,56 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+// CSystemFrameSchedulerClock of FrameSchedulerClock.cpp needs the Windows API,
+// the tests get the same clock on std::chrono::steady_clock.
+
+#include "stdafx.h"
+#include <chrono>
+#include <thread>
+#include "FrameScheduler.h"
+
+CSystemFrameSchedulerClock::CSystemFrameSchedulerClock()
+{
+}
+
+CSystemFrameSchedulerClock::~CSystemFrameSchedulerClock()
+{
+}
+
+uint64_t CSystemFrameSchedulerClock::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t CSystemFrameSchedulerClock::TicksPerSecond()
+{
+	return 1000000000;
+}
+
+void CSystemFrameSchedulerClock::Wait(const uint64_t ticks)
+{
+	std::this_thread::sleep_for(std::chrono::nanoseconds(ticks));
+}
+
+void CSystemFrameSchedulerClock::Pause()
+{
+	std::this_thread::yield();
+}
@@ -0,0 +1,147 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+// Measures the accuracy of CFrameScheduler with a simulated clock whose blocking wait wakes up
+// late by a random delay, as the system timers do. After a few frames the scheduler must have
+// learned the delay: the wake-ups are on time but for the longest delays, and the spin after
+// the blocking wait stays short.
+// The system clock is only checked for sanity, the test machine can be busy.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include <random>
+#include "FrameScheduler.h"
+
+class CSimulatedClock : public CFrameSchedulerClock
+{
+	std::mt19937 m_rng{ 1 };
+	const double m_delay; // mean wake-up delay, in ticks
+
+public:
+	uint64_t m_time   = 0;
+	uint64_t m_nSpins = 0;
+
+	CSimulatedClock(const double delay) : m_delay(delay) {}
+
+	uint64_t Now() override { return m_time; }
+	uint64_t TicksPerSecond() override { return 10000000; }
+
+	void Wait(const uint64_t ticks) override
+	{
+		std::uniform_real_distribution<double> dist(0.5, 1.5);
+		m_time += ticks + (uint64_t)(m_delay * dist(m_rng));
+	}
+
+	void Pause() override { m_time += 10; m_nSpins++; } // 1 us
+};
+
+static void TestSimulated(const double delay)
+{
+	auto pClock = std::make_unique<CSimulatedClock>(delay);
+	CSimulatedClock* const clock = pClock.get();
+	CFrameScheduler scheduler(std::move(pClock));
+
+	const REFERENCE_TIME frame = 10000000 / 60; // 60 Hz
+	const int nFrames = 1000;
+	const int nLearning = 20;
+
+	int64_t maxError = 0;
+	int64_t sumError = 0;
+	int nLate = 0;
+	uint64_t spinTicks = 0;
+	for (int i = 0; i < nFrames; i++) {
+		const uint64_t spins = clock->m_nSpins;
+		scheduler.WaitFor(frame);
+		if (i >= nLearning) {
+			const int64_t error = std::abs(scheduler.GetLastError());
+			maxError = std::max(maxError, error);
+			sumError += error;
+			nLate += error > 10;
+			spinTicks += (clock->m_nSpins - spins) * 10;
+		}
+		// the rendering of the frame
+		clock->m_time += 12345;
+	}
+	const double errorMean = (double)sumError / (nFrames - nLearning);
+	const double spinMean = (double)spinTicks / (nFrames - nLearning);
+
+	printf("wake-up delay %.2f ms: max error %.3f ms, mean error %.4f ms, %d late, mean spin %.3f ms, margin %.3f ms\n",
+		delay / 10000, maxError / 10000.0, errorMean / 10000, nLate, spinMean / 10000, scheduler.GetMargin() / 10000.0);
+
+	// a plain wait would be late by the whole delay, only the rare longest delays are not covered by the margin
+	CHECK(maxError < 5000);
+	CHECK(errorMean < delay / 20);
+	// the margin is limited to 2 ms, the delays above it are always late
+	CHECK(nLate < (nFrames - nLearning) / (1.5 * delay < 20000 ? 10 : 5));
+	// the spin is bounded by the 2 ms limit of the margin and much shorter than a frame
+	CHECK(scheduler.GetMargin() <= 20000);
+	CHECK(spinMean < 20000);
+	// the blocking wait covers most of the frame
+	CHECK(spinMean < frame / 4);
+}
+
+static void TestNoWait()
+{
+	auto pClock = std::make_unique<CSimulatedClock>(5000.0);
+	CSimulatedClock* const clock = pClock.get();
+	CFrameScheduler scheduler(std::move(pClock));
+
+	// a target in the past returns at once and reports the lateness
+	clock->m_time = 100000;
+	scheduler.WaitUntil(90000);
+	CHECK(scheduler.GetLastError() == 10000);
+	CHECK(clock->m_time == 100000);
+
+	scheduler.WaitFor(0);
+	CHECK(scheduler.GetLastError() == 0);
+	CHECK(clock->m_time == 100000);
+
+	// shorter than the margin: spin only
+	scheduler.WaitUntil(100000 + scheduler.GetMargin() / 2);
+	CHECK(clock->m_nSpins > 0);
+	CHECK(scheduler.GetLastError() >= 0 && scheduler.GetLastError() <= 10);
+}
+
+static void TestSystemClock()
+{
+	CFrameScheduler scheduler;
+	CFrameSchedulerClock* clock = scheduler.GetClock();
+
+	const uint64_t start = clock->Now();
+	for (int i = 0; i < 10; i++) {
+		scheduler.WaitFor(20000); // 2 ms
+		CHECK(scheduler.GetLastError() >= 0);
+	}
+	const double elapsed = (double)(clock->Now() - start) / clock->TicksPerSecond();
+	printf("system clock: 10 x 2 ms in %.3f ms\n", elapsed * 1000);
+	CHECK(elapsed >= 0.020);
+}
+
+int main()
+{
+	for (const double delay : { 5000.0, 10000.0, 15000.0 }) { // 0.5 .. 1.5 ms
+		TestSimulated(delay);
+	}
+	TestNoWait();
+	TestSystemClock();
+
+	return TestResult();
+}
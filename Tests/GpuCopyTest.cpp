@@ -0,0 +1,134 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+// Checks CopyGpuFrame_AVX2, the copy-back from DXVA2 and D3D11 decoder surfaces, with every size
+// below 1200 bytes and every source and destination offset within a cache line. The bytes around
+// the destination must stay untouched. Then compares it with CopyGpuFrame_SSE41 on lines and frames.
+// The decoder surfaces are USWC memory, here both read write-back memory.
+
+#include "stdafx.h"
+#include <chrono>
+#include "TestCheck.h"
+#include "Helper.h"
+#include "Utils/CPUInfo.h"
+
+static void TestCorrectness(std::vector<BYTE>& srcBuffer, std::vector<BYTE>& dstBuffer)
+{
+	BYTE* src = (BYTE*)ALIGN((uintptr_t)srcBuffer.data(), 4096);
+	BYTE* dst = (BYTE*)ALIGN((uintptr_t)dstBuffer.data(), 4096);
+	for (size_t i = 0; i < 4096; i++) {
+		src[i] = (BYTE)(i * 131 + 7);
+	}
+
+	unsigned tests = 0;
+	for (UINT size = 1; size < 1200; size++) {
+		for (UINT srcOffset = 0; srcOffset < 64; srcOffset += 3) {
+			for (UINT dstOffset = 0; dstOffset < 64; dstOffset += 5) {
+				BYTE* d = dst + 2048 + dstOffset;
+				memset(dst, 0xCC, 4096);
+				// one line, the pitches are equal
+				CopyGpuFrame_AVX2(1, d, size, src + srcOffset, size);
+
+				if (memcmp(d, src + srcOffset, size) != 0 || d[-1] != 0xCC || d[size] != 0xCC) {
+					fprintf(stderr, "CopyGpuFrame_AVX2 failed for %u bytes, offsets %u and %u\n", size, srcOffset, dstOffset);
+					CHECK(!"CopyGpuFrame_AVX2 failed");
+					return;
+				}
+				tests++;
+			}
+		}
+	}
+
+	// lines with different pitches are copied one by one
+	const UINT lines = 7;
+	const UINT width = 333;
+	memset(dst, 0xCC, 4096);
+	CopyGpuFrame_AVX2(lines, dst + 1, width + 40, src + 3, width + 17);
+	for (UINT y = 0; y < lines; y++) {
+		const BYTE* line = dst + 1 + (size_t)(width + 40) * y;
+		CHECK(memcmp(line, src + 3 + (size_t)(width + 17) * y, width + 17) == 0);
+		CHECK(line[width + 17] == 0xCC);
+	}
+
+	printf("%u copies checked\n", tests);
+}
+
+static double Bandwidth(CopyFrameDataFn fn, BYTE* dst, const BYTE* src, const UINT lines, const UINT pitch)
+{
+	double best = 0;
+	for (int n = 0; n < 5; n++) {
+		const auto start = std::chrono::steady_clock::now();
+		size_t bytes = 0;
+		double seconds;
+		do {
+			fn(lines, dst, pitch, src, pitch);
+			bytes += (size_t)lines * pitch;
+			seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		} while (seconds < 0.02);
+		best = std::max(best, bytes / seconds / 1e9);
+	}
+	return best;
+}
+
+static void Benchmark(std::vector<BYTE>& srcBuffer, std::vector<BYTE>& dstBuffer)
+{
+	BYTE* src = (BYTE*)ALIGN((uintptr_t)srcBuffer.data(), 4096);
+	// a 2 KB page offset between the source and the destination, see gpu_memcpy_sse4.h
+	BYTE* dst = (BYTE*)ALIGN((uintptr_t)dstBuffer.data(), 4096) + 2048;
+
+	const struct {
+		UINT lines;
+		UINT pitch;
+		UINT srcOffset;
+		UINT dstOffset;
+	} cases[] = {
+		{ 1,    1920, 0,  0  },
+		{ 1,    3840, 0,  0  },
+		{ 1,    3840, 4,  4  },
+		{ 1,    7680, 16, 16 },
+		{ 1,    7680, 1,  0  },
+		{ 2160, 3840, 0,  0  },
+		{ 2160, 3840, 1,  1  },
+	};
+
+	printf("write-back memory, GB/s:\n  lines x pitch  offsets   SSE4.1   AVX2\n");
+	for (const auto& test : cases) {
+		const double sse41 = Bandwidth(CopyGpuFrame_SSE41, dst + test.dstOffset, src + test.srcOffset, test.lines, test.pitch);
+		const double avx2 = Bandwidth(CopyGpuFrame_AVX2, dst + test.dstOffset, src + test.srcOffset, test.lines, test.pitch);
+		printf("  %5u x %5u  %2u/%-2u   %6.1f %6.1f\n", test.lines, test.pitch, test.srcOffset, test.dstOffset, sse41, avx2);
+	}
+}
+
+int main()
+{
+	if (!(CPUInfo::GetFeatures() & CPUInfo::CPU_AVX2)) {
+		printf("the processor has no AVX2\n");
+		return 0;
+	}
+
+	std::vector<BYTE> srcBuffer(3840 * 2160 + 8192);
+	std::vector<BYTE> dstBuffer(3840 * 2160 + 8192);
+
+	TestCorrectness(srcBuffer, dstBuffer);
+	Benchmark(srcBuffer, dstBuffer);
+
+	return TestResult();
+}
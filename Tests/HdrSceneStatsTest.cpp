@@ -0,0 +1,226 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+// Replays a synthetic sequence of decimated HDR10 frames through MeasureHdrFrameR10G10B10A2()
+// and CHdrSceneController, and checks the scene cuts and the steadiness within the scenes.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "csputils.h"
+#include "HdrSceneStats.h"
+
+// SMPTE ST 2084, the inverse of mp_trc_linearize(MP_CSP_TRC_PQ)
+static double NitsToPQ(const double nits)
+{
+	const double m1 = 2610.0 / 16384;
+	const double m2 = 2523.0 / 4096 * 128;
+	const double c1 = 3424.0 / 4096;
+	const double c2 = 2413.0 / 4096 * 32;
+	const double c3 = 2392.0 / 4096 * 32;
+
+	const double y = pow(nits / 10000.0, m1);
+	return pow((c1 + c2 * y) / (1 + c3 * y), m2);
+}
+
+static uint32_t NitsToCode(const double nits)
+{
+	return (uint32_t)std::clamp((int)lround(NitsToPQ(nits) * 1023.0), 0, 1023);
+}
+
+static uint32_t PackR10G10B10A2(const double r, const double g, const double b)
+{
+	return NitsToCode(r) | (NitsToCode(g) << 10) | (NitsToCode(b) << 20) | (3u << 30);
+}
+
+struct Scene_t {
+	UINT   frames;
+	double baseNits;      // the average of the diffuse content
+	double highlightNits;
+	double highlightFraction;
+	double flicker;       // the frame to frame variation of the brightness, relative
+	bool   bFade;         // the brightness falls to 1/50 over the scene, without a cut
+};
+
+static const Scene_t s_scenes[] = {
+	{ 120,   5.0,   60.0, 0.01,   0.05, false }, // a dark scene
+	{  96,  80.0, 1500.0, 0.03,   0.08, false }, // a bright scene with specular highlights
+	{  48,  80.0, 1500.0, 0.03,   0.0,  true  }, // a fade of the bright scene
+	{ 120, 200.0, 4000.0, 0.0005, 0.05, false }, // small very bright highlights
+	{ 120,  40.0,  400.0, 0.05,   0.1,  false },
+};
+
+class CSyntheticClip
+{
+	uint32_t m_seed = 1;
+	std::vector<uint32_t> m_frame;
+
+	double Rand01()
+	{
+		m_seed = m_seed * 1664525u + 1013904223u;
+		return (m_seed >> 8) * (1.0 / (1 << 24));
+	}
+
+public:
+	CSyntheticClip() : m_frame(HDR_STATS_WIDTH * HDR_STATS_HEIGHT) {}
+
+	const BYTE* Render(const Scene_t& scene, const UINT frame)
+	{
+		double base = scene.baseNits;
+		if (scene.bFade) {
+			base *= pow(0.02, (double)frame / scene.frames);
+		}
+		base *= 1.0 + scene.flicker * (Rand01() * 2.0 - 1.0);
+
+		for (size_t i = 0; i < m_frame.size(); i++) {
+			double nits = base * (0.3 + 1.4 * Rand01());
+			if (Rand01() < scene.highlightFraction) {
+				nits = scene.highlightNits;
+			}
+			if (i == 7) {
+				nits = 10000.0; // a single hot pixel that the peak ignores
+			}
+			m_frame[i] = PackR10G10B10A2(nits, nits * 0.8, nits * 0.6);
+		}
+
+		return (const BYTE*)m_frame.data();
+	}
+};
+
+static void TestFrameStats()
+{
+	std::vector<uint32_t> frame(HDR_STATS_WIDTH * HDR_STATS_HEIGHT, PackR10G10B10A2(100.0, 50.0, 10.0));
+	const UINT pitch = HDR_STATS_WIDTH * 4;
+
+	HdrFrameStats_t stats;
+	MeasureHdrFrameR10G10B10A2((const BYTE*)frame.data(), pitch, HDR_STATS_WIDTH, HDR_STATS_HEIGHT, stats);
+	CHECK(stats.pixels == HDR_STATS_WIDTH * HDR_STATS_HEIGHT);
+	CHECK(stats.peakPQ == stats.avgPQ);
+	CHECK(fabs(stats.peakNits - 100.0f) < 1.0f); // MaxRGB, 10-bit codes
+
+	// fewer brightest pixels than HDR_STATS_PEAK_IGNORE do not move the peak
+	const UINT ignored = HDR_STATS_WIDTH * HDR_STATS_HEIGHT * HDR_STATS_PEAK_IGNORE / 10000;
+	for (UINT i = 0; i < ignored; i++) {
+		frame[i * 97] = PackR10G10B10A2(10000.0, 10000.0, 10000.0);
+	}
+	MeasureHdrFrameR10G10B10A2((const BYTE*)frame.data(), pitch, HDR_STATS_WIDTH, HDR_STATS_HEIGHT, stats);
+	CHECK(fabs(stats.peakNits - 100.0f) < 1.0f);
+
+	frame[1] = PackR10G10B10A2(10000.0, 10000.0, 10000.0);
+	MeasureHdrFrameR10G10B10A2((const BYTE*)frame.data(), pitch, HDR_STATS_WIDTH, HDR_STATS_HEIGHT, stats);
+	CHECK(stats.peakNits > 9900.0f);
+
+	MeasureHdrFrameR10G10B10A2(nullptr, pitch, HDR_STATS_WIDTH, HDR_STATS_HEIGHT, stats);
+	CHECK(stats.pixels == 0);
+
+	CHdrSceneController controller;
+	CHECK(!controller.Update(stats));
+	CHECK(!controller.IsValid());
+}
+
+static void TestReplay()
+{
+	const float staticPeakNits  = 4000.0f;
+	const float displayMaxNits  = 600.0f;
+	const UINT  settleFrames    = 30;
+
+	CSyntheticClip clip;
+	CHdrSceneController controller;
+
+	std::vector<UINT> expectedCuts;
+	std::vector<UINT> detectedCuts;
+	UINT index = 0;
+
+	for (size_t s = 0; s < std::size(s_scenes); s++) {
+		const auto& scene = s_scenes[s];
+		// the fade starts from the scene before it, the scene after the fade is a cut
+		if (s && !scene.bFade) {
+			expectedCuts.push_back(index);
+		}
+
+		float prevAdapted = 0.0f;
+		float prevAvgPQ = 0.0f;
+		float maxFrameAvgStep = 0.0f;
+		float maxSmoothAvgStep = 0.0f;
+		float maxAdaptedStep = 0.0f;
+
+		for (UINT i = 0; i < scene.frames; i++, index++) {
+			HdrFrameStats_t stats;
+			MeasureHdrFrameR10G10B10A2(clip.Render(scene, i), HDR_STATS_WIDTH * 4, HDR_STATS_WIDTH, HDR_STATS_HEIGHT, stats);
+
+			const float prevFrameAvgPQ = controller.GetAvgPQ();
+			if (controller.Update(stats)) {
+				detectedCuts.push_back(index);
+				// a cut replaces the smoothed values
+				CHECK(controller.GetAvgPQ() == stats.avgPQ);
+				CHECK(controller.GetPeakPQ() == stats.peakPQ);
+			}
+
+			const float adapted = GetHdrSceneAdaptedPeak(controller.GetPeakNits(), staticPeakNits, displayMaxNits);
+			CHECK(adapted >= displayMaxNits && adapted <= staticPeakNits);
+			// the peak ignores the hot pixel
+			CHECK(stats.peakNits < 9000.0f);
+
+			if (i >= settleFrames) {
+				maxFrameAvgStep  = std::max(maxFrameAvgStep, fabsf(stats.avgPQ - prevAvgPQ));
+				maxSmoothAvgStep = std::max(maxSmoothAvgStep, fabsf(controller.GetAvgPQ() - prevFrameAvgPQ));
+				maxAdaptedStep   = std::max(maxAdaptedStep, fabsf(adapted - prevAdapted) / prevAdapted);
+			}
+			prevAdapted = adapted;
+			prevAvgPQ = stats.avgPQ;
+		}
+
+		if (scene.bFade) {
+			// the fade is followed without a cut, the smoothing lags by about its time constant
+			CHECK(controller.GetAvgNits() < scene.baseNits * 0.2);
+		} else if (scene.flicker > 0.0) {
+			// the flicker of the frames is smoothed: the steps of the smoothed average are a fraction
+			// of the steps of the frames, and the tone mapping peak moves by less than 1% per frame
+			CHECK(maxSmoothAvgStep < maxFrameAvgStep * 0.25f);
+			CHECK(maxAdaptedStep < 0.01f);
+		}
+	}
+
+	CHECK(detectedCuts == expectedCuts);
+	if (detectedCuts != expectedCuts) {
+		fprintf(stderr, "cuts at");
+		for (const UINT cut : detectedCuts) {
+			fprintf(stderr, " %u", cut);
+		}
+		fprintf(stderr, ", expected at");
+		for (const UINT cut : expectedCuts) {
+			fprintf(stderr, " %u", cut);
+		}
+		fprintf(stderr, "\n");
+	}
+	CHECK(controller.GetSceneCuts() == expectedCuts.size());
+	CHECK(controller.GetFrames() == index);
+
+	controller.Reset();
+	CHECK(!controller.IsValid() && !controller.GetFrames() && controller.GetPeakNits() == 0.0f);
+}
+
+int main()
+{
+	TestFrameStats();
+	TestReplay();
+
+	return TestResult();
+}
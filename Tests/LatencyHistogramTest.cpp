@@ -0,0 +1,107 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+// Compares the percentiles of CLatencyHistogram with the exact percentiles of log-normal
+// durations and measures the time of Add(). The buckets are 1/8 of a power of two wide,
+// so a percentile must be within 1/16 of the exact value.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include <chrono>
+#include <random>
+#include "FrameStats.h"
+
+static uint64_t ExactPercentile(const std::vector<uint64_t>& sorted, const double percentile)
+{
+	const size_t rank = (size_t)std::ceil(percentile / 100 * sorted.size());
+	return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+static void TestAccuracy()
+{
+	static CLatencyHistogram histogram; // 2 KB
+	std::mt19937_64 rng(3);
+	std::lognormal_distribution<double> dist(10, 1); // about 22000 ticks, 2 ms at 10 MHz
+
+	std::vector<uint64_t> values(1 << 20);
+	for (auto& value : values) {
+		value = (uint64_t)dist(rng);
+	}
+
+	const int nRepeats = 20;
+	const auto start = std::chrono::steady_clock::now();
+	for (int n = 0; n < nRepeats; n++) {
+		for (const auto value : values) {
+			histogram.Add(value);
+		}
+	}
+	const auto end = std::chrono::steady_clock::now();
+	printf("Add() : %.2f ns\n", std::chrono::duration<double, std::nano>(end - start).count() / (nRepeats * values.size()));
+
+	std::sort(values.begin(), values.end());
+
+	const double percentiles[] = { 50, 90, 99, 99.9 };
+	uint64_t pvalues[std::size(percentiles)];
+	uint64_t count = 0;
+	histogram.GetPercentiles(percentiles, pvalues, (unsigned)std::size(percentiles), count);
+	CHECK(count == nRepeats * values.size());
+
+	for (size_t i = 0; i < std::size(percentiles); i++) {
+		const uint64_t exact = ExactPercentile(values, percentiles[i]);
+		const double error = ((double)pvalues[i] - exact) / exact;
+		printf("p%-4g %7llu exact %7llu error %+.2f%%\n", percentiles[i], (unsigned long long)pvalues[i], (unsigned long long)exact, error * 100);
+		CHECK(std::abs(error) <= 1.0 / 16);
+	}
+	CHECK(histogram.GetMax() == values.back());
+
+	histogram.Reset();
+	histogram.GetPercentiles(percentiles, pvalues, 1, count);
+	CHECK(count == 0);
+	CHECK(pvalues[0] == 0);
+	CHECK(histogram.GetMax() == 0);
+}
+
+static void TestSingleValues()
+{
+	// small values have their own buckets, a percentile never exceeds the maximum
+	for (const uint64_t value : { 0ull, 1ull, 7ull, 8ull, 15ull, 16ull, 1000ull, 123456789ull, ~0ull }) {
+		CLatencyHistogram histogram;
+		histogram.Add(value);
+
+		const double percentiles[] = { 0.1, 50, 100 };
+		uint64_t pvalues[std::size(percentiles)];
+		uint64_t count = 0;
+		histogram.GetPercentiles(percentiles, pvalues, (unsigned)std::size(percentiles), count);
+		CHECK(count == 1);
+		for (const auto pvalue : pvalues) {
+			CHECK(pvalue <= value);
+			CHECK(value < 16 ? pvalue == value : pvalue >= value - value / 8);
+		}
+	}
+}
+
+int main()
+{
+	TestAccuracy();
+	TestSingleValues();
+
+	return TestResult();
+}
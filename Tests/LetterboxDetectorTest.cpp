@@ -0,0 +1,263 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+
+// Feeds CLetterboxDetector synthetic letterboxed, pillarboxed and windowboxed frames in the
+// formats it reads and checks the hysteresis: the bars are cropped after exactly STABLE_FRAMES
+// frames, fades and dark scenes change nothing, a subtitle in a bar uncrops at once.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include <chrono>
+#include <random>
+#include "Helper.h"
+#include "LetterboxDetector.h"
+
+static std::mt19937 s_rng(1);
+
+static FmtConvParams_t MakeParams(const ColorFormat_t cformat)
+{
+	FmtConvParams_t params = {};
+	params.cformat = cformat;
+	params.CSType = (cformat == CF_XRGB32) ? CS_RGB : CS_YUV;
+	return params;
+}
+
+// the luma of a frame in the layout of its format
+class CTestFrame
+{
+	const ColorFormat_t m_cformat;
+	const UINT m_pixelSize;
+	const bool m_bBottomUp;
+	std::vector<BYTE> m_buffer;
+
+public:
+	const UINT width;
+	const UINT height;
+	const UINT pitch;
+
+	CTestFrame(const ColorFormat_t cformat, const UINT w, const UINT h, const bool bBottomUp)
+		: m_cformat(cformat)
+		, m_pixelSize((cformat == CF_AYUV || cformat == CF_XRGB32) ? 4 : (cformat == CF_NV12) ? 1 : 2)
+		, m_bBottomUp(bBottomUp)
+		, width(w)
+		, height(h)
+		, pitch(ALIGN(w * m_pixelSize, 32))
+	{
+		m_buffer.resize((size_t)pitch * h);
+	}
+
+	// y8 is the luma on the 8-bit scale of limited range
+	void Set(const UINT x, const UINT y, const int y8)
+	{
+		BYTE* row = m_buffer.data() + (size_t)pitch * (m_bBottomUp ? height - 1 - y : y);
+		switch (m_cformat) {
+		case CF_P010:
+			((uint16_t*)row)[x] = (uint16_t)(y8 << 8);
+			break;
+		case CF_YUV420P10:
+			((uint16_t*)row)[x] = (uint16_t)(y8 << 2);
+			break;
+		case CF_YUY2:
+			row[x * 2] = (BYTE)y8;
+			row[x * 2 + 1] = 200; // bright chroma is not content
+			break;
+		case CF_AYUV:
+			row[x * 4 + 0] = 200;
+			row[x * 4 + 1] = 200;
+			row[x * 4 + 2] = (BYTE)y8;
+			row[x * 4 + 3] = 255;
+			break;
+		case CF_XRGB32:
+			row[x * 4] = row[x * 4 + 1] = row[x * 4 + 2] = (BYTE)std::max(y8 - 16, 0);
+			row[x * 4 + 3] = 255;
+			break;
+		default:
+			row[x] = (BYTE)y8;
+		}
+	}
+
+	// content in [left, right) x [top, bottom), noisy black around it, level dims the content
+	void Fill(const UINT left, const UINT top, const UINT right, const UINT bottom, const double level = 1.0)
+	{
+		for (UINT y = 0; y < height; y++) {
+			for (UINT x = 0; x < width; x++) {
+				int value = 16 + (int)(s_rng() % 3);
+				if (x >= left && x < right && y >= top && y < bottom) {
+					value = 16 + (int)((s_rng() % 220) * level);
+				}
+				Set(x, y, std::min(value, 235));
+			}
+		}
+	}
+
+	void Detect(CLetterboxDetector& detector) const
+	{
+		if (m_bBottomUp) {
+			detector.Detect(m_buffer.data() + (size_t)pitch * (height - 1), -(int)pitch, width, height);
+		} else {
+			detector.Detect(m_buffer.data(), pitch, width, height);
+		}
+	}
+};
+
+static bool IsActiveRect(const CLetterboxDetector& detector, const UINT left, const UINT top, const UINT right, const UINT bottom)
+{
+	const RECT rect = detector.GetActiveRect();
+	return rect.left == (LONG)left && rect.top == (LONG)top && rect.right == (LONG)right && rect.bottom == (LONG)bottom;
+}
+
+static void TestFormat(const ColorFormat_t cformat, const bool bBottomUp)
+{
+	CLetterboxDetector detector;
+	CHECK(detector.SetFormat(MakeParams(cformat), false));
+	CTestFrame frame(cformat, 640, 360, bBottomUp);
+	const UINT w = frame.width;
+	const UINT h = frame.height;
+
+	// 2.39:1 in 16:9, the bars are cropped on the 48th frame
+	for (UINT n = 0; n < CLetterboxDetector::STABLE_FRAMES - 1; n++) {
+		frame.Fill(0, 46, w, h - 46);
+		frame.Detect(detector);
+	}
+	CHECK(!detector.IsCropped());
+	frame.Fill(0, 46, w, h - 46);
+	frame.Detect(detector);
+	CHECK(detector.IsCropped());
+	CHECK(IsActiveRect(detector, 0, 46, w, h - 46));
+
+	// a fade to black and a dark scene keep the crop
+	for (UINT n = 0; n < 100; n++) {
+		frame.Fill(0, 46, w, h - 46, n < 50 ? 1.0 - n / 50.0 : 0.0);
+		frame.Detect(detector);
+	}
+	CHECK(IsActiveRect(detector, 0, 46, w, h - 46));
+
+	// a subtitle in the bottom bar uncrops both bars in the same frame
+	frame.Fill(0, 46, w, h - 46);
+	for (UINT y = h - 30; y < h - 20; y++) {
+		for (UINT x = 200; x < 440; x++) {
+			frame.Set(x, y, 235);
+		}
+	}
+	frame.Detect(detector);
+	CHECK(IsActiveRect(detector, 0, 20, w, h - 20));
+
+	// after the subtitle the larger bars must be stable again
+	for (UINT n = 0; n < CLetterboxDetector::STABLE_FRAMES - 1; n++) {
+		frame.Fill(0, 46, w, h - 46);
+		frame.Detect(detector);
+	}
+	CHECK(IsActiveRect(detector, 0, 20, w, h - 20));
+	frame.Fill(0, 46, w, h - 46);
+	frame.Detect(detector);
+	CHECK(IsActiveRect(detector, 0, 46, w, h - 46));
+
+	// 4:3 in 16:9
+	detector.Reset();
+	for (UINT n = 0; n < CLetterboxDetector::STABLE_FRAMES; n++) {
+		frame.Fill(80, 0, w - 80, h);
+		frame.Detect(detector);
+	}
+	CHECK(IsActiveRect(detector, 80, 0, w - 80, h));
+
+	// windowbox
+	detector.Reset();
+	for (UINT n = 0; n < CLetterboxDetector::STABLE_FRAMES; n++) {
+		frame.Fill(64, 40, w - 64, h - 40);
+		frame.Detect(detector);
+	}
+	CHECK(IsActiveRect(detector, 64, 40, w - 64, h - 40));
+}
+
+static void TestHysteresis()
+{
+	CLetterboxDetector detector;
+	detector.SetFormat(MakeParams(CF_NV12), false);
+	CTestFrame frame(CF_NV12, 640, 360, false);
+
+	// bars that alternate between two sizes are never cropped
+	for (UINT n = 0; n < 4 * CLetterboxDetector::STABLE_FRAMES; n++) {
+		const UINT bar = (n / 10 % 2) ? 46 : 80;
+		frame.Fill(0, bar, frame.width, frame.height - bar);
+		frame.Detect(detector);
+	}
+	CHECK(!detector.IsCropped());
+
+	// bars that move by a line or two (compression artifacts) are cropped by the smallest
+	for (UINT n = 0; n < CLetterboxDetector::STABLE_FRAMES; n++) {
+		const UINT bar = 46 + n % 3;
+		frame.Fill(0, bar, frame.width, frame.height - bar);
+		frame.Detect(detector);
+	}
+	CHECK(IsActiveRect(detector, 0, 46, frame.width, frame.height - 46));
+
+	// black frames do not count for or against the candidate
+	detector.Reset();
+	for (UINT n = 0; n < 2 * CLetterboxDetector::STABLE_FRAMES; n++) {
+		if (n % 2) {
+			frame.Fill(0, 0, 0, 0);
+		} else {
+			frame.Fill(0, 46, frame.width, frame.height - 46);
+		}
+		frame.Detect(detector);
+		CHECK(detector.IsCropped() == (n >= 2 * CLetterboxDetector::STABLE_FRAMES - 2));
+	}
+
+	// formats without detection
+	CLetterboxDetector rgb24;
+	CHECK(!rgb24.SetFormat(MakeParams(CF_RGB24), false));
+}
+
+static void Benchmark()
+{
+	const UINT w = 1920;
+	const UINT h = 1080;
+	std::vector<BYTE> luma((size_t)w * h, 16);
+	for (UINT y = 140; y < h - 140; y++) {
+		for (UINT x = 0; x < w; x++) {
+			luma[(size_t)y * w + x] = (BYTE)(40 + (x * 7 + y * 3) % 180);
+		}
+	}
+
+	CLetterboxDetector detector;
+	detector.SetFormat(MakeParams(CF_NV12), false);
+	const int nFrames = 2000;
+	const auto start = std::chrono::steady_clock::now();
+	for (int n = 0; n < nFrames; n++) {
+		detector.Detect(luma.data(), w, w, h);
+	}
+	const auto end = std::chrono::steady_clock::now();
+	CHECK(IsActiveRect(detector, 0, 140, w, h - 140));
+	printf("Detect() 1920x1080 NV12: %.1f us\n", std::chrono::duration<double, std::micro>(end - start).count() / nFrames);
+}
+
+int main()
+{
+	for (const auto cformat : { CF_NV12, CF_P010, CF_YUV420P10, CF_YUY2, CF_AYUV }) {
+		TestFormat(cformat, false);
+	}
+	TestFormat(CF_XRGB32, true);
+	TestHysteresis();
+	Benchmark();
+
+	return TestResult();
+}
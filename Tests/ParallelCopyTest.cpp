@@ -0,0 +1,128 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+// Checks that CParallelCopy copies every line of a plane once, with any number of threads,
+// and measures the copy of 8K P010 frames to plain memory for 1 to 8 threads.
+
+#include "stdafx.h"
+#include <atomic>
+#include <chrono>
+#include "TestCheck.h"
+#include "ParallelCopy.h"
+
+// fills each line with its number, the last bytes are the padding of the pitch
+static void FillLines(std::vector<BYTE>& plane, const UINT lines, const UINT pitch)
+{
+	plane.resize((size_t)lines * pitch);
+	for (UINT y = 0; y < lines; y++) {
+		memset(plane.data() + (size_t)y * pitch, (BYTE)(y * 7 + 1), pitch);
+	}
+}
+
+static void TestCopyPlane(CParallelCopy& parallelCopy, const UINT lines, const UINT width, const bool bBottomUp)
+{
+	const UINT src_pitch = width + 32;
+	const UINT dst_pitch = ALIGN(width, 64);
+
+	std::vector<BYTE> src, dst((size_t)lines * dst_pitch, 0), ref((size_t)lines * dst_pitch, 0);
+	FillLines(src, lines, src_pitch);
+
+	const BYTE* first = bBottomUp ? src.data() + (size_t)(lines - 1) * src_pitch : src.data();
+	const int pitch = bBottomUp ? -(int)src_pitch : (int)src_pitch;
+
+	CopyPlaneAsIs(lines, ref.data(), dst_pitch, first, pitch);
+	parallelCopy.CopyPlane(CopyPlaneAsIs, lines, dst.data(), dst_pitch, first, pitch);
+	CHECK(dst == ref);
+}
+
+static void TestRun(CParallelCopy& parallelCopy, const UINT lines)
+{
+	std::vector<std::atomic<int>> counts(lines);
+	parallelCopy.Run(lines, [&](UINT first, UINT count) {
+		for (UINT i = first; i < first + count; i++) {
+			counts[i]++;
+		}
+	});
+	bool bOnce = true;
+	for (const auto& count : counts) {
+		bOnce = bOnce && count == 1;
+	}
+	CHECK(bOnce);
+}
+
+// copies the luma and chroma planes of an 8K P010 frame, returns the best time of a few frames in milliseconds
+static double BenchmarkP010(CParallelCopy& parallelCopy, const std::vector<BYTE>& src, std::vector<BYTE>& dst, const UINT pitch, const UINT height)
+{
+	const CopyFrameDataFn fn = CopyPlaneAsIs_Stream; // the copy to the mapped texture
+	double best = 1e9;
+
+	for (int frame = 0; frame < 5; frame++) {
+		const auto start = std::chrono::steady_clock::now();
+		parallelCopy.CopyPlane(fn, height, dst.data(), pitch, src.data(), pitch);
+		parallelCopy.CopyPlane(fn, height / 2, dst.data() + (size_t)pitch * height, pitch, src.data() + (size_t)pitch * height, pitch);
+		const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+		best = std::min(best, time.count());
+	}
+
+	return best;
+}
+
+int main()
+{
+	for (const int threads : { 1, 2, 3, 4, 8, UPLOAD_THREADS_AUTO }) {
+		CParallelCopy parallelCopy;
+		parallelCopy.SetThreads(threads);
+		CHECK(parallelCopy.GetThreads() >= 1);
+
+		for (const UINT lines : { 1u, 2u, 7u, 8u, 100u, 1081u }) {
+			// every plane is split into stripes, the small ones too
+			parallelCopy.SetMinParallelSize(0);
+			TestCopyPlane(parallelCopy, lines, 301, false);
+			TestCopyPlane(parallelCopy, lines, 301, true);
+			parallelCopy.SetMinParallelSize(2 * 1024 * 1024);
+			TestCopyPlane(parallelCopy, lines, 301, false);
+
+			for (int i = 0; i < 20; i++) {
+				TestRun(parallelCopy, lines);
+			}
+		}
+		TestRun(parallelCopy, 0);
+	}
+
+	const UINT width = 7680, height = 4320;
+	const UINT pitch = width * 2;
+	std::vector<BYTE> src((size_t)pitch * height * 3 / 2, 0x40);
+	std::vector<BYTE> dst(src.size(), 0);
+
+	double single = 0;
+	for (const int threads : { 1, 2, 4, 8 }) {
+		CParallelCopy parallelCopy;
+		parallelCopy.SetThreads(threads);
+		const double time = BenchmarkP010(parallelCopy, src, dst, pitch, height);
+		if (threads == 1) {
+			single = time;
+		}
+		printf("8K P010, %d threads: %6.2f ms, x%.2f\n", threads, time, single / time);
+	}
+	CHECK(dst == src);
+	printf("%u processors\n", (unsigned)std::thread::hardware_concurrency());
+
+	return TestResult();
+}
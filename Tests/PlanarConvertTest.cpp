@@ -0,0 +1,218 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+// Checks the conversions of planar YUV to the input formats of the D3D11 video processor against
+// the definitions of the formats, whole frames and in stripes of chroma lines the way
+// CDX11VideoProcessor::MemCopyToTexSrcVideo() calls them, then measures them on 1080p frames.
+
+#include "stdafx.h"
+#include <chrono>
+#include "TestCheck.h"
+#include "Helper.h"
+#include "Utils/CPUInfo.h"
+
+static uint32_t s_seed = 0x6c078965u;
+
+static uint32_t Rand32()
+{
+	s_seed ^= s_seed << 13;
+	s_seed ^= s_seed >> 17;
+	s_seed ^= s_seed << 5;
+	return s_seed;
+}
+
+struct PlanarFormat_t {
+	UINT bytes;    // per sample
+	bool b420;     // 4:2:0 to a semiplanar format, otherwise 4:2:2 to a packed one
+	UINT maxValue; // of the source samples
+	UINT shift;    // to the MSBs of the 16-bit destination samples
+};
+
+static PlanarFormat_t GetPlanarFormat(const CopyKernel_t& item)
+{
+	const UINT maxValue = (item.cformat == CF_YUV420P10 || item.cformat == CF_YUV422P10) ? 1023
+		: (item.cformat == CF_YUV420P16 || item.cformat == CF_YUV422P16) ? 65535 : 255;
+
+	switch (item.VP11Format) {
+	case DXGI_FORMAT_NV12: return { 1, true,  maxValue, 0 };
+	case DXGI_FORMAT_P010: return { 2, true,  maxValue, 6 };
+	case DXGI_FORMAT_P016: return { 2, true,  maxValue, 0 };
+	case DXGI_FORMAT_YUY2: return { 1, false, maxValue, 0 };
+	case DXGI_FORMAT_Y210: return { 2, false, maxValue, 6 };
+	default:               return { 2, false, maxValue, 0 }; // Y216
+	}
+}
+
+static UINT Read(const BYTE* p, const UINT i, const UINT bytes)
+{
+	return bytes == 1 ? p[i] : p[2 * i] | (p[2 * i + 1] << 8);
+}
+
+// the samples of the destination from the definition of the format
+static bool CheckDefinition(const PlanarFormat_t& fmt, const UINT width, const UINT lines,
+	const BYTE* dstY, const BYTE* dstUV, const UINT dst_pitch,
+	const BYTE* srcY, const BYTE* srcU, const BYTE* srcV, const UINT src_pitch)
+{
+	const UINT chroma_pitch = src_pitch / 2;
+	auto sample = [&](const BYTE* plane, const UINT pitch, const UINT y, const UINT x) {
+		return (Read(plane + (size_t)pitch * y, x, fmt.bytes) << fmt.shift) & 0xffff;
+	};
+
+	for (UINT y = 0; y < lines; y++) {
+		const BYTE* line = dstY + (size_t)dst_pitch * y;
+		for (UINT x = 0; x < width; x++) {
+			const UINT Y = sample(srcY, src_pitch, y, x);
+			if (fmt.b420) {
+				// Y plane, then one line of interleaved U and V for two luma lines
+				if (Read(line, x, fmt.bytes) != Y) {
+					return false;
+				}
+				if (!(y & 1) && !(x & 1)) {
+					const BYTE* uv = dstUV + (size_t)dst_pitch * (y / 2);
+					if (Read(uv, x, fmt.bytes) != sample(srcU, chroma_pitch, y / 2, x / 2)
+							|| Read(uv, x + 1, fmt.bytes) != sample(srcV, chroma_pitch, y / 2, x / 2)) {
+						return false;
+					}
+				}
+			} else {
+				// Y0 U Y1 V
+				if (Read(line, x / 2 * 4 + (x & 1) * 2, fmt.bytes) != Y) {
+					return false;
+				}
+				if (!(x & 1)) {
+					if (Read(line, x / 2 * 4 + 1, fmt.bytes) != sample(srcU, chroma_pitch, y, x / 2)
+							|| Read(line, x / 2 * 4 + 3, fmt.bytes) != sample(srcV, chroma_pitch, y, x / 2)) {
+						return false;
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+static unsigned TestConversion(const CopyKernel_t& item)
+{
+	const PlanarFormat_t fmt = GetPlanarFormat(item);
+	const UINT step = fmt.b420 ? 2 : 1;
+	unsigned tests = 0;
+
+	for (UINT width = 2; width <= 200; width += 2) {
+		for (const UINT lines : { 2u, 4u, 6u }) {
+			const UINT src_pitch = width * fmt.bytes;
+			const UINT chroma_pitch = src_pitch / 2;
+			const UINT chroma_lines = lines / step;
+			const UINT dst_line = fmt.b420 ? src_pitch : src_pitch * 2;
+			const UINT dst_pitch = ALIGN(dst_line, 16) + (Rand32() % 2) * 16 + (width % 4 == 2 ? 4 : 0);
+
+			std::vector<BYTE> src((size_t)src_pitch * lines + (size_t)chroma_pitch * chroma_lines * 2);
+			for (size_t i = 0; i < src.size(); i += fmt.bytes) {
+				const UINT value = Rand32() % (fmt.maxValue + 1);
+				src[i] = (BYTE)value;
+				if (fmt.bytes == 2) {
+					src[i + 1] = (BYTE)(value >> 8);
+				}
+			}
+			const BYTE* srcY = src.data();
+			const BYTE* srcU = srcY + (size_t)src_pitch * lines;
+			const BYTE* srcV = srcU + (size_t)chroma_pitch * chroma_lines;
+
+			const size_t dst_size = (size_t)dst_pitch * (lines + chroma_lines) + 64;
+			std::vector<BYTE> frame(dst_size + 64, 0xAB), striped(dst_size + 64, 0xAB);
+			BYTE* f = (BYTE*)ALIGN((uintptr_t)frame.data(), 16);
+			BYTE* s = (BYTE*)ALIGN((uintptr_t)striped.data(), 16);
+			const size_t uv = (size_t)dst_pitch * lines;
+
+			item.convert(lines, f, fmt.b420 ? f + uv : nullptr, dst_pitch, srcY, srcU, srcV, src_pitch);
+
+			// stripes of random numbers of chroma lines, as the upload threads get them
+			for (UINT first = 0; first < chroma_lines; ) {
+				const UINT count = std::min(chroma_lines - first, 1 + Rand32() % 2);
+				item.convert(count * step, s + (size_t)dst_pitch * first * step, fmt.b420 ? s + uv + (size_t)dst_pitch * first : nullptr, dst_pitch,
+					srcY + (size_t)src_pitch * first * step, srcU + (size_t)chroma_pitch * first, srcV + (size_t)chroma_pitch * first, src_pitch);
+				first += count;
+			}
+
+			const bool bDefinition = CheckDefinition(fmt, width, lines, f, f + uv, dst_pitch, srcY, srcU, srcV, src_pitch);
+			const bool bStriped = memcmp(f, s, dst_size) == 0;
+			if (!bDefinition || !bStriped) {
+				fprintf(stderr, "%ls: %s for %ux%u, pitch %u\n", item.name,
+					bDefinition ? "the stripes differ from the frame" : "the output differs from the format", width, lines, dst_pitch);
+				CHECK(bDefinition && bStriped);
+				return tests;
+			}
+			tests++;
+		}
+	}
+
+	return tests;
+}
+
+static double MeasureFrame(const CopyKernel_t& item)
+{
+	const PlanarFormat_t fmt = GetPlanarFormat(item);
+	const UINT width = 1920;
+	const UINT lines = 1080;
+	const UINT src_pitch = width * fmt.bytes;
+	const UINT dst_pitch = fmt.b420 ? src_pitch : src_pitch * 2;
+	const UINT chroma_lines = fmt.b420 ? lines / 2 : lines;
+
+	std::vector<BYTE> src((size_t)src_pitch * (lines + chroma_lines), 1);
+	std::vector<BYTE> dst((size_t)dst_pitch * (lines + chroma_lines) + 64);
+	const BYTE* srcY = src.data();
+	const BYTE* srcU = srcY + (size_t)src_pitch * lines;
+	const BYTE* srcV = srcU + (size_t)src_pitch / 2 * chroma_lines;
+	BYTE* d = (BYTE*)ALIGN((uintptr_t)dst.data(), 64);
+
+	const auto start = std::chrono::steady_clock::now();
+	int frames = 0;
+	double seconds;
+	do {
+		item.convert(lines, d, fmt.b420 ? d + (size_t)dst_pitch * lines : nullptr, dst_pitch, srcY, srcU, srcV, src_pitch);
+		frames++;
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	} while (seconds < 0.1);
+
+	return seconds / frames * 1000;
+}
+
+int main()
+{
+	unsigned tests = 0;
+	for (const auto& item : GetCopyKernels()) {
+		if (item.convert && (item.features & CPUInfo::GetFeatures()) == item.features) {
+			tests += TestConversion(item);
+		}
+	}
+	printf("%u frames checked\n", tests);
+
+	printf("1920x1080, ms:\n");
+	for (const auto& item : GetCopyKernels()) {
+		if (item.convert && (item.cformat == CF_YV12 || item.cformat == CF_YV16)) {
+			continue; // the same functions as YUV420P8 and YUV422P8
+		}
+		if (item.convert && (item.features & CPUInfo::GetFeatures()) == item.features) {
+			printf("  %-28ls %.2f\n", item.name, MeasureFrame(item));
+		}
+	}
+
+	return TestResult();
+}
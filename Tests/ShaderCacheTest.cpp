@@ -0,0 +1,194 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+// Drives CShaderCache the way CompileShader() in Shaders.cpp does, with a stand-in compiler
+// that counts the compilations, and checks the hits, the persistence between instances,
+// the invalidation by the compiler id, the size limit and the rejection of corrupt entries.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include "ShaderCache.h"
+
+namespace fs = std::filesystem;
+
+static int g_nCompiles = 0;
+
+// the blob depends on the source, the size is the same for all the shaders
+static std::vector<BYTE> StandInCompile(const std::string& keyData)
+{
+	g_nCompiles++;
+	std::vector<BYTE> blob(1000);
+	for (size_t i = 0; i < blob.size(); i++) {
+		blob[i] = (BYTE)(keyData[i % keyData.size()] + i);
+	}
+	return blob;
+}
+
+// the same order of the cache and the compiler as in CompileShader()
+static std::vector<BYTE> CompileCached(CShaderCache& cache, const std::string& srcCode, const char* target)
+{
+	const std::string keyData = std::string(target) + '\n' + srcCode;
+
+	std::vector<BYTE> blob;
+	if (cache.Load(keyData, blob)) {
+		return blob;
+	}
+	blob = StandInCompile(keyData);
+	cache.Store(keyData, blob.data(), blob.size());
+
+	return blob;
+}
+
+static fs::path GetEntryPath(const fs::path& dir, CShaderCache& cache, const std::string& keyData)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.cso", (unsigned long long)cache.GetKey(keyData));
+	return dir / name;
+}
+
+static void TestHitsAndPersistence(const fs::path& dir)
+{
+	g_nCompiles = 0;
+	std::vector<BYTE> first;
+	{
+		CShaderCache cache(dir, "compiler 1", 1024 * 1024);
+		first = CompileCached(cache, "float4 main() : SV_Target { return 0; }", "ps_4_0");
+		CHECK(g_nCompiles == 1);
+		CHECK(cache.GetMisses() == 1);
+
+		const auto second = CompileCached(cache, "float4 main() : SV_Target { return 0; }", "ps_4_0");
+		CHECK(g_nCompiles == 1);
+		CHECK(cache.GetHits() == 1);
+		CHECK(second == first);
+
+		// the target is a part of the key
+		CompileCached(cache, "float4 main() : SV_Target { return 0; }", "ps_5_0");
+		CHECK(g_nCompiles == 2);
+	}
+	{
+		// a new instance finds the entries of the previous one
+		CShaderCache cache(dir, "compiler 1", 1024 * 1024);
+		const auto blob = CompileCached(cache, "float4 main() : SV_Target { return 0; }", "ps_4_0");
+		CHECK(g_nCompiles == 2);
+		CHECK(cache.GetHits() == 1);
+		CHECK(blob == first);
+	}
+	{
+		// another compiler invalidates all the entries
+		CShaderCache cache(dir, "compiler 2", 1024 * 1024);
+		const auto blob = CompileCached(cache, "float4 main() : SV_Target { return 0; }", "ps_4_0");
+		CHECK(g_nCompiles == 3);
+		CHECK(cache.GetHits() == 0);
+		CHECK(cache.GetTotalSize() < 2 * 1100);
+		CHECK(blob == first);
+	}
+}
+
+static void TestCorruptEntry(const fs::path& dir)
+{
+	g_nCompiles = 0;
+	CShaderCache cache(dir, "compiler 1", 1024 * 1024);
+	const std::string src = "float4 main() : SV_Target { return 1; }";
+	const auto good = CompileCached(cache, src, "ps_4_0");
+	CHECK(g_nCompiles == 1);
+
+	// truncate the entry
+	const fs::path path = GetEntryPath(dir, cache, std::string("ps_4_0\n") + src);
+	CHECK(fs::exists(path));
+	fs::resize_file(path, fs::file_size(path) - 10);
+	const auto afterTruncate = CompileCached(cache, src, "ps_4_0");
+	CHECK(g_nCompiles == 2);
+	CHECK(afterTruncate == good);
+
+	// overwrite the header
+	{
+		std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+		const char junk[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+		file.seekp(8);
+		file.write(junk, sizeof(junk));
+	}
+	const auto afterJunk = CompileCached(cache, src, "ps_4_0");
+	CHECK(g_nCompiles == 3);
+	CHECK(afterJunk == good);
+	CHECK(cache.GetHits() == 0);
+
+	// the rewritten entry is valid again
+	CompileCached(cache, src, "ps_4_0");
+	CHECK(g_nCompiles == 3);
+	CHECK(cache.GetHits() == 1);
+}
+
+static void TestSizeLimit(const fs::path& dir)
+{
+	g_nCompiles = 0;
+	// room for about 10 entries of 1000 bytes and a header
+	const uint64_t maxSize = 10 * 1100;
+	CShaderCache cache(dir, "compiler 1", maxSize);
+
+	for (int i = 0; i < 20; i++) {
+		CompileCached(cache, "shader " + std::to_string(i), "ps_4_0");
+		CHECK(cache.GetTotalSize() <= maxSize);
+		if (i == 0) {
+			// the modification times must differ for the LRU order
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		}
+		// keep the first shader recently used
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		CompileCached(cache, "shader 0", "ps_4_0");
+	}
+	CHECK(g_nCompiles == 20);
+
+	// the most recently used entries are kept
+	const int nCompiles = g_nCompiles;
+	CompileCached(cache, "shader 0", "ps_4_0");
+	CompileCached(cache, "shader 19", "ps_4_0");
+	CHECK(g_nCompiles == nCompiles);
+
+	// the oldest were removed
+	CompileCached(cache, "shader 1", "ps_4_0");
+	CHECK(g_nCompiles == nCompiles + 1);
+
+	size_t nFiles = 0;
+	for (const auto& entry : fs::directory_iterator(dir)) {
+		nFiles += entry.path().extension() == ".cso";
+	}
+	CHECK(nFiles <= 10);
+	printf("size limit %llu: %zu entries, %llu bytes\n",
+		(unsigned long long)maxSize, nFiles, (unsigned long long)cache.GetTotalSize());
+}
+
+int main()
+{
+	const fs::path root = fs::temp_directory_path() / "ShaderCacheTest";
+	std::error_code ec;
+	fs::remove_all(root, ec);
+
+	TestHitsAndPersistence(root / "persistence");
+	TestCorruptEntry(root / "corrupt");
+	TestSizeLimit(root / "limit");
+
+	fs::remove_all(root, ec);
+
+	return TestResult();
+}
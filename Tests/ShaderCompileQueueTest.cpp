@@ -0,0 +1,299 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+// Runs CShaderCompileQueue with a stand-in compiler whose compilations are held at a gate
+// or delayed, so that the order of the requests and the compilations is under the control of the test.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "ShaderCompileQueue.h"
+
+typedef CShaderCompileQueue::Source_t Source_t;
+
+class CStandInCompiler
+{
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::vector<std::string> m_started; // the code of the compilations in the order they started
+	size_t m_nReleased = 0;
+	size_t m_nFinished = 0;
+	bool   m_bGated = true;
+	std::chrono::microseconds m_maxDelay = {};
+	uint32_t m_seed = 1;
+
+public:
+	// a compilation waits at the gate until it is released, or is delayed by up to maxDelay
+	CStandInCompiler(const bool bGated, const std::chrono::microseconds maxDelay = {})
+		: m_bGated(bGated)
+		, m_maxDelay(maxDelay)
+	{
+	}
+
+	// the code "error" fails, any other code compiles to a copy of itself
+	HRESULT Compile(const Source_t& source, std::vector<BYTE>& blob)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_started.push_back(source.code);
+		const size_t n = m_started.size();
+		m_cond.notify_all();
+		m_cond.wait(lock, [&] { return !m_bGated || m_nReleased >= n; });
+
+		std::chrono::microseconds delay = {};
+		if (m_maxDelay.count()) {
+			m_seed = m_seed * 1664525u + 1013904223u;
+			delay = std::chrono::microseconds((m_seed >> 8) % m_maxDelay.count());
+		}
+		lock.unlock();
+
+		std::this_thread::sleep_for(delay);
+		HRESULT hr = E_FAIL;
+		if (source.code != "error") {
+			blob.assign(source.code.begin(), source.code.end());
+			hr = S_OK;
+		}
+
+		lock.lock();
+		m_nFinished++;
+		m_cond.notify_all();
+
+		return hr;
+	}
+
+	CShaderCompileQueue::CompileFn GetFn()
+	{
+		return [this](const Source_t& source, std::vector<BYTE>& blob) { return Compile(source, blob); };
+	}
+
+	void WaitStarted(const size_t count)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cond.wait(lock, [&] { return m_started.size() >= count; });
+	}
+
+	void WaitFinished(const size_t count)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cond.wait(lock, [&] { return m_nFinished >= count; });
+	}
+
+	// lets the next compilation through the gate
+	void Release()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_nReleased++;
+		m_cond.notify_all();
+	}
+
+	std::vector<std::string> GetStarted()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_started;
+	}
+
+	size_t GetFinished()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_nFinished;
+	}
+};
+
+static std::vector<Source_t> MakeSources(std::initializer_list<const char*> codes)
+{
+	std::vector<Source_t> sources;
+	for (const auto code : codes) {
+		sources.push_back({ code, "ps_4_0" });
+	}
+	return sources;
+}
+
+static std::string ToString(const std::vector<BYTE>& blob)
+{
+	return std::string(blob.begin(), blob.end());
+}
+
+// The result of the queue does not change on its own after the worker has finished the compilation,
+// the worker stores or discards it right after the compiler returns. A correct queue never reports
+// a result here, a queue that stores a stale result does so within the time that it is polled.
+static bool NoResultAppears(CShaderCompileQueue& queue)
+{
+	CShaderCompileQueue::Result_t result;
+	for (int i = 0; i < 50; i++) {
+		if (queue.GetResult(result)) {
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+static void TestCompile()
+{
+	CStandInCompiler compiler(false);
+	CShaderCompileQueue queue(compiler.GetFn());
+
+	CShaderCompileQueue::Result_t result;
+	CHECK(!queue.IsBusy());
+	CHECK(!queue.GetResult(result));
+
+	const uint64_t id = queue.Submit(MakeSources({ "A", "error", "B" }));
+	queue.Wait();
+	CHECK(!queue.IsBusy());
+	CHECK(queue.GetResult(result));
+	CHECK(result.id == id);
+	CHECK(result.hrs.size() == 3 && result.blobs.size() == 3);
+	CHECK(result.hrs[0] == S_OK && ToString(result.blobs[0]) == "A");
+	CHECK(result.hrs[1] == E_FAIL && result.blobs[1].empty());
+	CHECK(result.hrs[2] == S_OK && ToString(result.blobs[2]) == "B");
+	// the result is returned once
+	CHECK(!queue.GetResult(result));
+}
+
+static void TestLatestRequestWins()
+{
+	CStandInCompiler compiler(true);
+	CShaderCompileQueue queue(compiler.GetFn());
+
+	const uint64_t idA = queue.Submit(MakeSources({ "A" }));
+	compiler.WaitStarted(1);
+
+	// B waits for A, C replaces B before it starts
+	const uint64_t idB = queue.Submit(MakeSources({ "B" }));
+	const uint64_t idC = queue.Submit(MakeSources({ "C" }));
+	CHECK(idA < idB && idB < idC);
+	CHECK(queue.IsBusy());
+
+	CShaderCompileQueue::Result_t result;
+	compiler.Release(); // A finishes, its result is discarded
+	compiler.WaitStarted(2);
+	CHECK(queue.IsBusy());
+	CHECK(!queue.GetResult(result));
+
+	compiler.Release();
+	queue.Wait();
+	CHECK(!queue.IsBusy());
+	CHECK(queue.GetResult(result));
+	CHECK(result.id == idC);
+	CHECK(result.hrs.size() == 1 && result.hrs[0] == S_OK && ToString(result.blobs[0]) == "C");
+	CHECK(compiler.GetStarted() == std::vector<std::string>({ "A", "C" }));
+}
+
+static void TestCancel()
+{
+	CStandInCompiler compiler(true);
+	CShaderCompileQueue queue(compiler.GetFn());
+
+	// cancel the running request
+	queue.Submit(MakeSources({ "A" }));
+	compiler.WaitStarted(1);
+	queue.Cancel();
+	CHECK(!queue.IsBusy());
+	queue.Wait(); // returns without waiting for A
+
+	compiler.Release();
+	compiler.WaitFinished(1);
+	CHECK(NoResultAppears(queue));
+
+	// cancel a pending request while another one is running
+	queue.Submit(MakeSources({ "B" }));
+	compiler.WaitStarted(2);
+	queue.Submit(MakeSources({ "C" }));
+	queue.Cancel();
+	CHECK(!queue.IsBusy());
+
+	compiler.Release();
+	compiler.WaitFinished(2);
+	CHECK(NoResultAppears(queue));
+	CHECK(compiler.GetStarted() == std::vector<std::string>({ "A", "B" }));
+
+	// the queue works after Cancel()
+	const uint64_t id = queue.Submit(MakeSources({ "D" }));
+	compiler.Release();
+	queue.Wait();
+	CShaderCompileQueue::Result_t result;
+	CHECK(queue.GetResult(result));
+	CHECK(result.id == id && ToString(result.blobs[0]) == "D");
+}
+
+static void TestShutdownWithPendingCompile()
+{
+	CStandInCompiler compiler(true);
+	std::atomic<bool> bReleased = false;
+	std::thread releaser;
+
+	{
+		CShaderCompileQueue queue(compiler.GetFn());
+		queue.Submit(MakeSources({ "A" }));
+		compiler.WaitStarted(1);
+		queue.Submit(MakeSources({ "B" }));
+
+		// the destructor runs while A is held at the gate and B is pending
+		releaser = std::thread([&] {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			bReleased = true;
+			compiler.Release();
+		});
+	}
+
+	// the destructor waited for A and did not start B
+	CHECK(bReleased);
+	CHECK(compiler.GetFinished() == 1);
+	CHECK(compiler.GetStarted() == std::vector<std::string>({ "A" }));
+	releaser.join();
+
+	// a queue that has never been used has no thread to stop
+	CShaderCompileQueue unused(compiler.GetFn());
+}
+
+static void TestRandomDelays()
+{
+	CStandInCompiler compiler(false, std::chrono::microseconds(500));
+	CShaderCompileQueue queue(compiler.GetFn());
+
+	uint32_t seed = 7;
+	for (int round = 0; round < 20; round++) {
+		uint64_t id = 0;
+		std::string code;
+		const int requests = 1 + round % 7;
+		for (int i = 0; i < requests; i++) {
+			code = std::to_string(round) + "/" + std::to_string(i);
+			id = queue.Submit(MakeSources({ code.c_str(), code.c_str() }));
+			seed = seed * 1664525u + 1013904223u;
+			std::this_thread::sleep_for(std::chrono::microseconds((seed >> 8) % 300));
+		}
+
+		queue.Wait();
+		CShaderCompileQueue::Result_t result;
+		CHECK(queue.GetResult(result));
+		CHECK(result.id == id);
+		CHECK(result.blobs.size() == 2 && ToString(result.blobs[0]) == code && ToString(result.blobs[1]) == code);
+		CHECK(!queue.GetResult(result));
+	}
+}
+
+int main()
+{
+	TestCompile();
+	TestLatestRequestWins();
+	TestCancel();
+	TestShutdownWithPendingCompile();
+	TestRandomDelays();
+
+	return TestResult();
+}
@@ -0,0 +1,181 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+// Compares the upload function of every copy kernel, which writes with non-temporal stores,
+// with the kernel itself at random widths, pitches, destination offsets and bottom-up RGB sources.
+// Nothing outside the lines of the destination must be written. Then measures both on 4K frames
+// in plain (write-back) memory, the write-combined memory of the upload surfaces is not available here.
+
+#include "stdafx.h"
+#include <chrono>
+#include "TestCheck.h"
+#include "Helper.h"
+#include "Utils/CPUInfo.h"
+
+static uint32_t s_seed = 0x2545f491u;
+
+static uint32_t Rand32()
+{
+	s_seed ^= s_seed << 13;
+	s_seed ^= s_seed >> 17;
+	s_seed ^= s_seed << 5;
+	return s_seed;
+}
+
+// the bytes per pixel of the source formats of the copy kernels
+static UINT SourceBpp(const ColorFormat_t cformat)
+{
+	switch (cformat) {
+	case CF_RGB24:
+		return 3;
+	case CF_r210:
+		return 4;
+	case CF_RGB48:
+	case CF_BGR48:
+		return 6;
+	case CF_BGRA64:
+	case CF_B64A:
+		return 8;
+	case CF_YUV420P10:
+	case CF_YUV422P10:
+	case CF_YUV444P10:
+	case CF_GBRP10:
+	case CF_Y10:
+		return 2;
+	default:
+		return 1;
+	}
+}
+
+static bool IsSupported(const int features)
+{
+	return (features & CPUInfo::GetFeatures()) == features;
+}
+
+static const UINT GUARD = 64;
+
+static void TestStreamFunction(const CopyKernel_t& item)
+{
+	const UINT bpp = SourceBpp(item.cformat);
+	// the RGB kernels accept the negative pitch of a bottom-up DIB
+	const bool bBottomUpRGB = item.cformat == CF_NONE || bpp == 3 || bpp >= 6;
+	std::vector<BYTE> src, ref, dst;
+
+	for (unsigned n = 0; n < 200; n++) {
+		const UINT width = 1 + Rand32() % 2000;
+		const UINT lines = 1 + Rand32() % 24;
+		const UINT src_pitch = ALIGN(width * bpp, std::max(item.align, 4u));
+		// 8 bytes per pixel are enough for any kernel, the pitch is a multiple of 16 for the kernels with aligned stores
+		const UINT dst_pitch = ALIGN(width * 8, 16) + (Rand32() % 4) * 16;
+		const UINT offset = (Rand32() % 16) & ~3u; // the mapped surfaces are aligned to 16 bytes at least
+		const bool bBottomUp = bBottomUpRGB && (n & 3) == 3;
+		const size_t dst_size = (size_t)dst_pitch * lines;
+
+		src.resize((size_t)src_pitch * lines + 64);
+		for (auto& b : src) {
+			b = (BYTE)Rand32();
+		}
+		BYTE* s = (BYTE*)ALIGN((uintptr_t)src.data(), 64);
+		const BYTE* first = bBottomUp ? s + (size_t)src_pitch * (lines - 1) : s;
+		const int pitch = bBottomUp ? -(int)src_pitch : (int)src_pitch;
+
+		ref.assign(dst_size + 2 * GUARD + 64, 0xCD);
+		dst.assign(dst_size + 2 * GUARD + 64, 0xCD);
+		BYTE* r = (BYTE*)ALIGN((uintptr_t)ref.data() + GUARD, 64);
+		BYTE* d = (BYTE*)ALIGN((uintptr_t)dst.data() + GUARD, 64) + offset;
+
+		item.kernel(lines, r, dst_pitch, first, pitch);
+		item.fn(lines, d, dst_pitch, first, pitch);
+
+		if (memcmp(r - GUARD, d - GUARD, dst_size + 2 * GUARD) != 0) {
+			fprintf(stderr, "the upload function of %ls differs for %ux%u, pitch %u, offset %u%s\n",
+				item.name, width, lines, dst_pitch, offset, bBottomUp ? ", bottom-up" : "");
+			CHECK(!"the upload function differs from the kernel");
+			break;
+		}
+	}
+}
+
+static double Bandwidth(CopyFrameDataFn fn, const UINT lines, BYTE* dst, const UINT dst_pitch, const BYTE* src, const int src_pitch)
+{
+	fn(lines, dst, dst_pitch, src, src_pitch);
+
+	const int nRepeats = 10;
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < nRepeats; i++) {
+		fn(lines, dst, dst_pitch, src, src_pitch);
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	return (double)dst_pitch * lines * nRepeats / seconds / 1e9;
+}
+
+static void Benchmark()
+{
+	const UINT width = 3840;
+	const UINT height = 2160;
+
+	std::vector<BYTE> src((size_t)width * height * 8 + 64, 1);
+	std::vector<BYTE> dst((size_t)width * height * 8 + 64, 2);
+	const BYTE* s = (BYTE*)ALIGN((uintptr_t)src.data(), 64);
+	BYTE* d = (BYTE*)ALIGN((uintptr_t)dst.data(), 64);
+
+	const struct {
+		ColorFormat_t cformat;
+		const char* name;
+		UINT lines;
+		UINT src_pitch;
+		UINT dst_pitch;
+	} cases[] = {
+		{ CF_NV12,  "NV12 as is",        height * 3 / 2, width,     width },
+		{ CF_P010,  "P010, other pitch", height * 3 / 2, width * 2, width * 2 + 64 },
+		{ CF_RGB48, "RGB48",             height,         width * 6, width * 8 },
+		{ CF_Y10,   "Y10 to 16 bits",    height,         width * 2, width * 2 },
+	};
+
+	printf("4K frames in write-back memory, GB/s of the destination:\n");
+	for (const auto& test : cases) {
+		FmtConvParams_t params = {};
+		params.cformat = test.cformat;
+		const auto& item = GetCopyPlaneKernel(params, VP_D3D11, 64);
+		printf("  %-18s %-26ls cached %5.1f  streamed %5.1f\n", test.name, item.name,
+			Bandwidth(item.kernel, test.lines, d, test.dst_pitch, s, test.src_pitch),
+			Bandwidth(item.fn, test.lines, d, test.dst_pitch, s, test.src_pitch));
+	}
+}
+
+int main()
+{
+	unsigned kernels = 0;
+	for (const auto& item : GetCopyKernels()) {
+		// CopyFrameYV12 has no upload function of its own
+		if (item.convert || item.fn == item.kernel || !IsSupported(item.features)) {
+			continue;
+		}
+		TestStreamFunction(item);
+		kernels++;
+	}
+	printf("%u upload functions compared\n", kernels);
+
+	Benchmark();
+
+	return TestResult();
+}
@@ -0,0 +1,294 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+// Stress test of CSubPicRing: a producer pushes and reclaims, a consumer peeks and pops,
+// and another thread invalidates, as the subtitle renderer thread, the video render thread
+// and the player do. Every subpicture must come out in order and be released exactly once.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include <thread>
+#include "SubPic/SubPicRing.h"
+
+enum : int {
+	ROLE_NONE,
+	ROLE_PRODUCER, // ReclaimInvalidated()
+	ROLE_CONSUMER, // PopFront()
+	ROLE_OWNER,    // the destructor of the queue
+};
+
+static thread_local int t_role = ROLE_NONE;
+
+class CFakeSubPic
+{
+	std::atomic<int> m_refs = 0;
+
+public:
+	REFERENCE_TIME rtStart = 0;
+	REFERENCE_TIME rtStop = 0;
+	std::atomic<int> nReleased = 0; // the releases that reached zero
+	std::atomic<int> nOverReleased = 0;
+	std::atomic<int> releasedBy = ROLE_NONE;
+
+	REFERENCE_TIME GetStart() const { return rtStart; }
+	REFERENCE_TIME GetStop() const { return rtStop; }
+	REFERENCE_TIME GetSegmentStart() const { return rtStart; }
+	REFERENCE_TIME GetSegmentStop() const { return rtStop; }
+
+	unsigned long AddRef() { return ++m_refs; }
+
+	// the object is not deleted, so that a double release is counted instead of corrupting memory
+	unsigned long Release() {
+		const int refs = --m_refs;
+		if (refs == 0) {
+			nReleased++;
+			releasedBy = t_role;
+		} else if (refs < 0) {
+			nOverReleased++;
+		}
+		return (unsigned long)std::max(refs, 0);
+	}
+
+	int GetRefs() const { return m_refs; }
+};
+
+class CStress
+{
+	const uint32_t m_count;
+	std::unique_ptr<CFakeSubPic[]> m_subpics;
+	std::unique_ptr<CSubPicRing<CFakeSubPic>> m_ring;
+	std::atomic<bool> m_bProducerDone = false;
+
+	uint32_t m_nPopped = 0;
+	uint32_t m_nPoppedInvalid = 0;
+	uint32_t m_nBadEntries = 0; // popped subpictures that are not the peeked entry
+	uint32_t m_nOutOfOrder = 0;
+	uint32_t m_nInvalidations = 0;
+	uint32_t m_nReclaimed = 0;
+
+	void Producer() {
+		t_role = ROLE_PRODUCER;
+		for (uint32_t i = 0; i < m_count; i++) {
+			CComPtr<CFakeSubPic> pSubPic(&m_subpics[i]);
+			for (;;) {
+				const uint32_t spaceCounter = m_ring->GetSpaceCounter();
+				m_ring->ReclaimInvalidated();
+				if (m_ring->Push(pSubPic)) {
+					break;
+				}
+				m_ring->WaitForSpace(spaceCounter);
+			}
+		}
+		m_bProducerDone = true;
+	}
+
+	void Consumer() {
+		t_role = ROLE_CONSUMER;
+		REFERENCE_TIME rtLast = -1;
+		uint32_t seed = 3;
+
+		for (;;) {
+			typename CSubPicRing<CFakeSubPic>::Entry entry;
+			if (!m_ring->PeekFront(entry)) {
+				if (m_bProducerDone && !m_ring->GetCount()) {
+					break;
+				}
+				std::this_thread::yield();
+				continue;
+			}
+
+			seed = seed * 1664525u + 1013904223u;
+			if ((seed >> 24) < 8) {
+				std::this_thread::yield(); // widen the window between peek and pop
+			}
+
+			CComPtr<CFakeSubPic> pSubPic;
+			if (!m_ring->PopFront(entry, pSubPic)) {
+				continue;
+			}
+
+			m_nPopped++;
+			if (entry.bInvalid) {
+				m_nPoppedInvalid++;
+			}
+			if (!pSubPic || pSubPic->GetStart() != entry.rtStart || pSubPic->GetStop() != entry.rtStop
+					|| pSubPic->GetSegmentStart() != entry.rtSegmentStart || pSubPic->GetSegmentStop() != entry.rtSegmentStop) {
+				m_nBadEntries++;
+			}
+			if (entry.rtStart <= rtLast) {
+				m_nOutOfOrder++;
+			}
+			rtLast = entry.rtStart;
+		}
+	}
+
+	void Invalidator() {
+		uint32_t seed = 5;
+		while (!m_bProducerDone) {
+			typename CSubPicRing<CFakeSubPic>::Entry back;
+			if (m_ring->GetBack(back)) {
+				seed = seed * 1664525u + 1013904223u;
+				// drops up to the last four subpictures
+				m_ring->Invalidate(back.rtStop - 10 * (1 + (seed >> 8) % 4));
+				m_nInvalidations++;
+			}
+			for (uint32_t i = (seed >> 8) % 64; i; i--) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+public:
+	CStress(const uint32_t capacity, const uint32_t count)
+		: m_count(count)
+		, m_subpics(std::make_unique<CFakeSubPic[]>(count))
+		, m_ring(std::make_unique<CSubPicRing<CFakeSubPic>>(capacity))
+	{
+		for (uint32_t i = 0; i < count; i++) {
+			m_subpics[i].rtStart = i * 10;
+			m_subpics[i].rtStop = i * 10 + 10;
+		}
+	}
+
+	void Run() {
+		std::thread producer([this] { Producer(); });
+		std::thread consumer([this] { Consumer(); });
+		std::thread invalidator([this] { Invalidator(); });
+		producer.join();
+		invalidator.join();
+		consumer.join();
+
+		t_role = ROLE_OWNER;
+		m_ring.reset();
+		t_role = ROLE_NONE;
+	}
+
+	void Check() {
+		uint32_t nReclaimed = 0;
+		uint32_t nLost = 0;
+		uint32_t nReleasedTwice = 0;
+		uint32_t nByConsumer = 0;
+		uint32_t nByOwner = 0;
+
+		for (uint32_t i = 0; i < m_count; i++) {
+			const CFakeSubPic& subpic = m_subpics[i];
+			if (subpic.nReleased == 0 || subpic.GetRefs() > 0) {
+				nLost++;
+			}
+			if (subpic.nReleased > 1 || subpic.nOverReleased) {
+				nReleasedTwice++;
+			}
+			switch (subpic.releasedBy) {
+			case ROLE_PRODUCER: nReclaimed++;  break;
+			case ROLE_CONSUMER: nByConsumer++; break;
+			case ROLE_OWNER:    nByOwner++;    break;
+			}
+		}
+
+		m_nReclaimed = nReclaimed;
+
+		CHECK(nLost == 0);
+		CHECK(nReleasedTwice == 0);
+		CHECK(m_nBadEntries == 0);
+		CHECK(m_nOutOfOrder == 0);
+		CHECK(nByConsumer == m_nPopped);
+		CHECK(m_nPopped + nReclaimed + nByOwner == m_count);
+		CHECK(nByOwner == 0); // the consumer empties the queue
+		if (nLost || nReleasedTwice || m_nBadEntries || m_nOutOfOrder) {
+			fprintf(stderr, "lost %u, released twice %u, bad entries %u, out of order %u\n", nLost, nReleasedTwice, m_nBadEntries, m_nOutOfOrder);
+		}
+	}
+
+	uint32_t GetInvalidations() const { return m_nInvalidations; }
+	uint32_t GetPoppedInvalid() const { return m_nPoppedInvalid; }
+	uint32_t GetReclaimed() const { return m_nReclaimed; }
+};
+
+// the destructor releases the subpictures that are left in the queue
+static void TestDestructor()
+{
+	CFakeSubPic subpics[3];
+	{
+		CSubPicRing<CFakeSubPic> ring(4);
+		for (auto& subpic : subpics) {
+			CComPtr<CFakeSubPic> pSubPic(&subpic);
+			CHECK(ring.Push(pSubPic));
+			CHECK(!pSubPic);
+		}
+		CHECK(ring.GetCount() == 3);
+
+		t_role = ROLE_OWNER;
+	}
+	t_role = ROLE_NONE;
+
+	for (const auto& subpic : subpics) {
+		CHECK(subpic.nReleased == 1 && subpic.GetRefs() == 0 && subpic.releasedBy == ROLE_OWNER);
+	}
+}
+
+// a full queue refuses the push and leaves the reference with the caller
+static void TestFull()
+{
+	CFakeSubPic subpics[3];
+	subpics[1].rtStart = 10;
+	subpics[2].rtStart = 20;
+
+	CSubPicRing<CFakeSubPic> ring(2);
+	CComPtr<CFakeSubPic> pSubPic0(&subpics[0]);
+	CComPtr<CFakeSubPic> pSubPic1(&subpics[1]);
+	CComPtr<CFakeSubPic> pSubPic2(&subpics[2]);
+	CHECK(ring.Push(pSubPic0) && ring.Push(pSubPic1));
+	CHECK(!ring.Push(pSubPic2));
+	CHECK(pSubPic2 && subpics[2].GetRefs() == 1);
+
+	typename CSubPicRing<CFakeSubPic>::Entry entry;
+	CHECK(ring.PeekFront(entry) && entry.rtStart == 0);
+	CComPtr<CFakeSubPic> pFront;
+	CHECK(ring.PopFront(entry, pFront) && pFront == &subpics[0]);
+	// the entry is stale after the pop
+	CComPtr<CFakeSubPic> pStale;
+	CHECK(!ring.PopFront(entry, pStale) && !pStale);
+
+	CHECK(ring.Push(pSubPic2));
+	CHECK(ring.GetBack(entry) && entry.rtStart == 20);
+}
+
+int main()
+{
+	TestDestructor();
+	TestFull();
+
+	uint32_t nInvalidations = 0;
+	uint32_t nPoppedInvalid = 0;
+	uint32_t nReclaimed = 0;
+	for (const uint32_t capacity : { 1u, 2u, 3u, 8u, 32u }) {
+		CStress stress(capacity, 100000);
+		stress.Run();
+		stress.Check();
+		nInvalidations += stress.GetInvalidations();
+		nPoppedInvalid += stress.GetPoppedInvalid();
+		nReclaimed += stress.GetReclaimed();
+	}
+	// the invalidator has to race with the other threads for the test to mean anything
+	CHECK(nInvalidations > 0);
+	printf("invalidations %u, invalid subpictures popped %u, reclaimed %u\n", nInvalidations, nPoppedInvalid, nReclaimed);
+
+	return TestResult();
+}
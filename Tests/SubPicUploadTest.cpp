@@ -0,0 +1,145 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+// Renders subpictures through CSubPicUploadTracker the way CDX11SubPicAllocator::Render() does,
+// with the output texture in plain memory. An unchanged picture must not be uploaded again,
+// a new generation or another picture must be, and the texture must always match the picture.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include "SubPic/SubPicUploadTracker.h"
+
+static const UINT TEX_W = 64;
+static const UINT TEX_H = 32;
+
+class CPlainMemoryAllocator
+{
+	std::vector<uint32_t> m_texture = std::vector<uint32_t>(TEX_W * TEX_H);
+
+public:
+	CSubPicUploadTracker m_tracker;
+
+	void Render(const MemPic_t& memPic, const RECT& copyRect)
+	{
+		if (m_tracker.IsResident(memPic, copyRect)) {
+			return;
+		}
+		for (LONG y = copyRect.top; y < copyRect.bottom; y++) {
+			memcpy(&m_texture[y * TEX_W + copyRect.left], &memPic.data[y * memPic.w + copyRect.left], (copyRect.right - copyRect.left) * 4);
+		}
+		m_tracker.Uploaded(memPic, copyRect);
+	}
+
+	// the texture has the same content as the picture in the rectangle
+	bool Matches(const MemPic_t& memPic, const RECT& rect) const
+	{
+		for (LONG y = rect.top; y < rect.bottom; y++) {
+			if (memcmp(&m_texture[y * TEX_W + rect.left], &memPic.data[y * memPic.w + rect.left], (rect.right - rect.left) * 4)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	uint64_t GetUploadedBytes() const
+	{
+		uint64_t uploadedBytes, reusedBytes;
+		uint32_t uploads, reuses;
+		m_tracker.GetStats(uploadedBytes, reusedBytes, uploads, reuses);
+		return uploadedBytes;
+	}
+};
+
+static MemPic_t CreateMemPic(const uint32_t value)
+{
+	MemPic_t memPic;
+	memPic.data.reset(new uint32_t[TEX_W * TEX_H]);
+	memPic.w = TEX_W;
+	memPic.h = TEX_H;
+	std::fill_n(memPic.data.get(), TEX_W * TEX_H, value);
+	MemPicContentChanged(memPic);
+	return memPic;
+}
+
+int main()
+{
+	const RECT full = { 0, 0, (LONG)TEX_W, (LONG)TEX_H };
+	const RECT part = { 8, 4, 40, 20 };
+	const uint64_t fullBytes = TEX_W * TEX_H * 4;
+	const uint64_t partBytes = 32 * 16 * 4;
+
+	CPlainMemoryAllocator allocator;
+	MemPic_t pic1 = CreateMemPic(0x11111111);
+
+	// the second render of the same picture uploads nothing
+	allocator.Render(pic1, full);
+	CHECK(allocator.GetUploadedBytes() == fullBytes);
+	allocator.Render(pic1, full);
+	CHECK(allocator.GetUploadedBytes() == fullBytes);
+	// a rectangle inside the uploaded one is there as well
+	allocator.Render(pic1, part);
+	CHECK(allocator.GetUploadedBytes() == fullBytes);
+	{
+		uint64_t uploadedBytes, reusedBytes;
+		uint32_t uploads, reuses;
+		allocator.m_tracker.GetStats(uploadedBytes, reusedBytes, uploads, reuses);
+		CHECK(uploads == 1);
+		CHECK(reuses == 2);
+		CHECK(reusedBytes == fullBytes + partBytes);
+	}
+
+	// a new generation forces an upload, as after Lock() and Unlock()
+	std::fill_n(pic1.data.get(), TEX_W * TEX_H, 0x22222222);
+	MemPicContentChanged(pic1);
+	allocator.Render(pic1, part);
+	CHECK(allocator.GetUploadedBytes() == fullBytes + partBytes);
+	CHECK(allocator.Matches(pic1, part));
+
+	// the uploaded rectangle does not contain the full one
+	allocator.Render(pic1, full);
+	CHECK(allocator.GetUploadedBytes() == 2 * fullBytes + partBytes);
+	CHECK(allocator.Matches(pic1, full));
+
+	// another picture with the same generation is uploaded
+	MemPic_t pic2 = CreateMemPic(0x33333333);
+	pic2.generation = pic1.generation;
+	allocator.Render(pic2, full);
+	CHECK(allocator.GetUploadedBytes() == 3 * fullBytes + partBytes);
+	CHECK(allocator.Matches(pic2, full));
+
+	// switching back uploads again, the texture holds one picture only
+	allocator.Render(pic1, full);
+	CHECK(allocator.GetUploadedBytes() == 4 * fullBytes + partBytes);
+	CHECK(allocator.Matches(pic1, full));
+
+	// a recreated texture has nothing
+	allocator.m_tracker.Reset();
+	allocator.Render(pic1, full);
+	CHECK(allocator.GetUploadedBytes() == 5 * fullBytes + partBytes);
+
+	// the generations are unique across the pictures
+	MemPic_t pic3 = CreateMemPic(0);
+	MemPic_t pic4 = CreateMemPic(0);
+	CHECK(pic3.generation != pic4.generation);
+	CHECK(pic3.generation > pic1.generation);
+
+	return TestResult();
+}
@@ -0,0 +1,120 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+
+// Bakes the 1D tables of all transfer functions that mp_trc_linearize() has and checks that
+// the interpolation error stays within GetTrcLut1DErrorBound(), then compares the time of
+// a table lookup with the computation of PQ and gamma 2.2 in single precision.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include <chrono>
+#include "Helper.h"
+#include "Shaders.h"
+#include "ColorLut.h"
+
+static void TestAccuracy()
+{
+	for (const UINT size : { 1024u, (UINT)TRC_LUT1D_SIZE }) {
+		for (int i = MP_CSP_TRC_AUTO; i < MP_CSP_TRC_COUNT; i++) {
+			const mp_csp_trc trc = (mp_csp_trc)i;
+			std::vector<float> lut;
+			const HRESULT hr = BakeTrcLut1D(trc, size, lut);
+			if (!mp_trc_has_linearize(trc)) {
+				CHECK(hr == E_INVALIDARG);
+				continue;
+			}
+			CHECK(hr == S_OK && lut.size() == size);
+
+			const auto report = MeasureTrcLut1D(trc, lut.data(), size, 1000000);
+			printf("trc %2d, %u samples: max error %.3e at %.5f (bound %.3e), max relative error %.3e\n",
+				i, size, report.maxErr, report.maxErrInput, report.errBound, report.maxRelErr);
+			CHECK(report.maxErr <= report.errBound);
+
+			// the ends of the table are exact and the inputs are clamped
+			CHECK(SampleTrcLut1D(lut.data(), size, 0.0f) == lut.front());
+			CHECK(SampleTrcLut1D(lut.data(), size, 1.0f) == lut.back());
+			CHECK(SampleTrcLut1D(lut.data(), size, -0.5f) == lut.front());
+			CHECK(SampleTrcLut1D(lut.data(), size, 1.5f) == lut.back());
+		}
+	}
+
+	std::vector<float> lut;
+	CHECK(BakeTrcLut1D(MP_CSP_TRC_PQ, 1, lut) == E_INVALIDARG);
+}
+
+template <typename F>
+static double MeasureNs(const std::vector<float>& inputs, F fn)
+{
+	volatile float sink = 0.0f;
+	float sum = 0.0f;
+	const auto start = std::chrono::steady_clock::now();
+	for (const float x : inputs) {
+		sum += fn(x);
+	}
+	const auto end = std::chrono::steady_clock::now();
+	sink = sum;
+	(void)sink;
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / inputs.size();
+}
+
+static void Benchmark()
+{
+	std::vector<float> inputs(1 << 24);
+	uint32_t seed = 1;
+	for (auto& x : inputs) {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		x = (seed >> 8) * (1.0f / (1 << 24));
+	}
+
+	// the same computation as st2084.hlsl
+	const float m1 = 2610.0f / 16384;
+	const float m2 = 2523.0f / 4096 * 128;
+	const float c1 = 3424.0f / 4096;
+	const float c2 = 2413.0f / 4096 * 32;
+	const float c3 = 2392.0f / 4096 * 32;
+
+	std::vector<float> lutPQ, lutGamma;
+	BakeTrcLut1D(MP_CSP_TRC_PQ, TRC_LUT1D_SIZE, lutPQ);
+	BakeTrcLut1D(MP_CSP_TRC_GAMMA22, TRC_LUT1D_SIZE, lutGamma);
+
+	const double pq = MeasureNs(inputs, [&](const float x) {
+		const float p = powf(x, 1 / m2);
+		return powf(std::max(p - c1, 0.0f) / (c2 - c3 * p), 1 / m1);
+	});
+	const double pqTable = MeasureNs(inputs, [&](const float x) { return SampleTrcLut1D(lutPQ.data(), TRC_LUT1D_SIZE, x); });
+	const double gamma = MeasureNs(inputs, [](const float x) { return powf(x, 2.2f); });
+	const double gammaTable = MeasureNs(inputs, [&](const float x) { return SampleTrcLut1D(lutGamma.data(), TRC_LUT1D_SIZE, x); });
+
+	printf("PQ: computed %.2f ns, table %.2f ns\n", pq, pqTable);
+	printf("gamma 2.2: computed %.2f ns, table %.2f ns\n", gamma, gammaTable);
+}
+
+int main()
+{
+	TestAccuracy();
+	Benchmark();
+
+	return TestResult();
+}
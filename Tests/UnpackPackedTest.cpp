@@ -0,0 +1,179 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+
+// Checks every variant of the unpacking of v210, Y210 and Y216 lines to P210 and P216 planes
+// against the sample order of the formats, including the bytes after the unpacked pixels,
+// then measures the variants on 2160p frames.
+
+#include "stdafx.h"
+#include <chrono>
+#include "TestCheck.h"
+#include "Helper.h"
+#include "Utils/CPUInfo.h"
+
+static uint32_t s_seed = 12345;
+
+static uint32_t Rand32()
+{
+	s_seed ^= s_seed << 13;
+	s_seed ^= s_seed >> 17;
+	s_seed ^= s_seed << 5;
+	return s_seed;
+}
+
+static int GetSourcePitch(const ColorFormat_t cformat, const UINT width)
+{
+	return (cformat == CF_V210) ? (int)GetV210Pitch(width) : (int)(width * 4 + (Rand32() % 3) * 8);
+}
+
+// the pixels of a line in the order of the definition of the format
+static void ReferenceLine(const ColorFormat_t cformat, const BYTE* src, const UINT pairs, uint16_t* Y, uint16_t* UV)
+{
+	if (cformat == CF_V210) {
+		// three 10-bit samples in each 32-bit word, Cb0 Y0 Cr0 Y1 Cb1 Y2 Cr1 Y3 Cb2 Y4 Cr2 Y5 for 6 pixels
+		auto Sample = [&](const UINT index) {
+			uint32_t word;
+			memcpy(&word, src + index / 3 * 4, 4);
+			return (uint16_t)(((word >> (10 * (index % 3))) & 0x3ff) << 6);
+		};
+		for (UINT x = 0; x < pairs * 2; x++) {
+			Y[x] = Sample(x / 6 * 12 + 1 + x % 6 * 2);
+		}
+		for (UINT c = 0; c < pairs; c++) {
+			UV[c * 2]     = Sample(c / 3 * 12 + c % 3 * 4);
+			UV[c * 2 + 1] = Sample(c / 3 * 12 + c % 3 * 4 + 2);
+		}
+	} else {
+		// Y0 U Y1 V
+		const uint16_t* src16 = (const uint16_t*)src;
+		for (UINT p = 0; p < pairs; p++) {
+			Y[p * 2]      = src16[p * 4];
+			UV[p * 2]     = src16[p * 4 + 1];
+			Y[p * 2 + 1]  = src16[p * 4 + 2];
+			UV[p * 2 + 1] = src16[p * 4 + 3];
+		}
+	}
+}
+
+static unsigned TestKernel(const UnpackKernel_t& item)
+{
+	const BYTE guard = 0xCD;
+	unsigned tests = 0;
+
+	for (int n = 0; n < 4000; n++) {
+		const UINT width = 2 + Rand32() % 900 * 2;
+		const UINT lines = 1 + Rand32() % 5;
+		const int src_pitch = GetSourcePitch(item.cformat, width);
+
+		// the destination pitches are usually those of a texture, sometimes smaller than the source
+		UINT dstY_pitch = width * 2 + (Rand32() % 4) * 16 + ((Rand32() & 1) ? 2 * (Rand32() % 8) : 0);
+		UINT dstUV_pitch = (Rand32() & 3) ? dstY_pitch : width * 2 + (Rand32() % 4) * 32;
+		if (Rand32() % 4 == 0) {
+			dstY_pitch = dstUV_pitch = ALIGN(width * 2, 64);
+		}
+
+		std::vector<BYTE> src((size_t)src_pitch * lines + 32);
+		for (auto& b : src) {
+			b = (BYTE)Rand32();
+		}
+		const BYTE* s = (const BYTE*)ALIGN((uintptr_t)src.data(), 32);
+
+		const UINT offset = (Rand32() & 1) ? 0 : (Rand32() % 8) * 2;
+		std::vector<BYTE> dst((size_t)(dstY_pitch + dstUV_pitch) * lines + 256, guard);
+		BYTE* dstY = (BYTE*)ALIGN((uintptr_t)dst.data(), 64) + offset;
+		BYTE* dstUV = dstY + (size_t)dstY_pitch * lines + 32;
+
+		item.fn(lines, dstY, dstY_pitch, dstUV, dstUV_pitch, s, src_pitch);
+
+		// the pixel pairs that fit in the source and both destination lines
+		const UINT srcPairs = (item.cformat == CF_V210) ? (UINT)src_pitch / 16 * 3 : (UINT)src_pitch / 8;
+		const UINT pairs = std::min({ srcPairs, dstY_pitch / 4, dstUV_pitch / 4 });
+		std::vector<uint16_t> Y(pairs * 2 + 6), UV(pairs * 2 + 6);
+
+		for (UINT line = 0; line < lines; line++) {
+			ReferenceLine(item.cformat, s + (size_t)src_pitch * line, pairs, Y.data(), UV.data());
+			const BYTE* lineY = dstY + (size_t)dstY_pitch * line;
+			const BYTE* lineUV = dstUV + (size_t)dstUV_pitch * line;
+
+			bool bGuard = true;
+			for (UINT b = pairs * 4; b < dstY_pitch; b++) {
+				bGuard &= lineY[b] == guard;
+			}
+			for (UINT b = pairs * 4; b < dstUV_pitch; b++) {
+				bGuard &= lineUV[b] == guard;
+			}
+			const bool bEqual = memcmp(lineY, Y.data(), pairs * 4) == 0 && memcmp(lineUV, UV.data(), pairs * 4) == 0;
+			if (!bEqual || !bGuard) {
+				fprintf(stderr, "%ls: %s, width %u, pitches %u %u\n", item.name,
+					bEqual ? "the bytes after the line were written" : "the samples differ", width, dstY_pitch, dstUV_pitch);
+				CHECK(bEqual && bGuard);
+				return tests;
+			}
+		}
+		tests++;
+	}
+
+	return tests;
+}
+
+static double MeasureFrame(const UnpackKernel_t& item)
+{
+	const UINT width = 3840;
+	const UINT lines = 2160;
+	const int src_pitch = (item.cformat == CF_V210) ? (int)GetV210Pitch(width) : (int)width * 4;
+	std::vector<BYTE> src((size_t)src_pitch * lines);
+	for (auto& b : src) {
+		b = (BYTE)Rand32();
+	}
+	std::vector<BYTE> dstY((size_t)width * 2 * lines), dstUV((size_t)width * 2 * lines);
+
+	const auto start = std::chrono::steady_clock::now();
+	int frames = 0;
+	double seconds;
+	do {
+		item.fn(lines, dstY.data(), width * 2, dstUV.data(), width * 2, src.data(), src_pitch);
+		frames++;
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	} while (seconds < 0.2);
+
+	return seconds / frames * 1000;
+}
+
+int main()
+{
+	unsigned tests = 0;
+	for (const auto& item : GetUnpackKernels()) {
+		if ((item.features & CPUInfo::GetFeatures()) == item.features) {
+			tests += TestKernel(item);
+		}
+	}
+	printf("%u frames checked\n", tests);
+
+	printf("3840x2160, ms:\n");
+	for (const auto& item : GetUnpackKernels()) {
+		if (item.cformat != CF_Y216 && (item.features & CPUInfo::GetFeatures()) == item.features) {
+			printf("  %-28ls %.2f\n", item.name, MeasureFrame(item));
+		}
+	}
+
+	return TestResult();
+}
@@ -0,0 +1,212 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+
+// Lays out the sample buffers the way CCustomAllocator::Alloc() does and gives them to a
+// plain-memory stand-in of CDX9UploadBuffers. Checks the alignment of the buffers, their lookup
+// by pointer, the layouts that must fall back to the CPU copy and the release of the buffers.
+
+#include "stdafx.h"
+#include "TestCheck.h"
+#include <cstdlib>
+#include "UploadBuffers.h"
+
+// CDX9UploadBuffers with memcpy instead of the user memory textures and UpdateSurface()
+class CPlainUploadBuffers : public CUploadBuffers
+{
+	std::vector<BYTE*> m_buffers;
+	LONG m_size = 0;
+
+public:
+	int m_nReleased = 0;
+
+	LONG GetAlignment() override { return 4096; }
+
+	void SetBuffers(const std::vector<BYTE*>& buffers, const LONG size) override
+	{
+		m_buffers = buffers;
+		m_size = size;
+	}
+
+	void ReleaseBuffers() override
+	{
+		m_buffers.clear();
+		m_size = 0;
+		m_nReleased++;
+	}
+
+	// dst has the lines of width texels of lineSize bytes
+	HRESULT Upload(const BYTE* pBuffer, const UINT pitch, const UINT lineSize, const UINT firstLine, const UINT numLines,
+		const UINT width, BYTE* dst, const UINT dst_pitch)
+	{
+		if (std::find(m_buffers.cbegin(), m_buffers.cend(), pBuffer) == m_buffers.cend()) {
+			return E_FAIL;
+		}
+
+		const UINT texelSize = lineSize / width;
+		if (!texelSize || texelSize * width != lineSize || pitch % texelSize) {
+			return E_FAIL;
+		}
+		const UINT height = (UINT)m_size / pitch;
+		if (height < firstLine + numLines) {
+			return E_FAIL;
+		}
+
+		for (UINT y = firstLine; y < firstLine + numLines; y++) {
+			memcpy(dst + (size_t)dst_pitch * y, pBuffer + (size_t)pitch * y, lineSize);
+		}
+		return S_OK;
+	}
+};
+
+// the memory of the samples of CCustomAllocator::Alloc(), VirtualAlloc() returns whole pages
+class CTestAllocator
+{
+	BYTE* m_pBuffer = nullptr;
+
+public:
+	std::vector<BYTE*> buffers;
+
+	~CTestAllocator() { Free(); }
+
+	bool Alloc(const LONG size, const LONG prefix, const LONG alignment, const LONG count, CPlainUploadBuffers* pUploadBuffers)
+	{
+		Free();
+
+		SampleBuffersLayout_t layout;
+		if (!GetSampleBuffersLayout(size, prefix, alignment, pUploadBuffers ? pUploadBuffers->GetAlignment() : 0, layout)) {
+			return false;
+		}
+		const size_t total = (size_t)layout.alignedSize * count;
+		m_pBuffer = (BYTE*)std::aligned_alloc(65536, (total + 65535) / 65536 * 65536);
+
+		BYTE* pNext = m_pBuffer;
+		for (LONG i = 0; i < count; i++, pNext += layout.alignedSize) {
+			buffers.emplace_back(pNext + prefix);
+		}
+		if (pUploadBuffers && layout.bUpload) {
+			pUploadBuffers->SetBuffers(buffers, size);
+		}
+		return true;
+	}
+
+	void Free()
+	{
+		buffers.clear();
+		std::free(m_pBuffer);
+		m_pBuffer = nullptr;
+	}
+};
+
+static void TestLayout()
+{
+	SampleBuffersLayout_t layout;
+
+	// the buffers start at the upload alignment
+	CHECK(GetSampleBuffersLayout(1920 * 1080 * 2, 0, 16, 4096, layout));
+	CHECK(layout.bUpload && layout.alignment == 4096 && layout.alignedSize == 4149248);
+
+	// a prefix that is not a multiple of the upload alignment, or an allocator alignment that
+	// the upload alignment does not include, keep the allocator layout
+	CHECK(GetSampleBuffersLayout(100, 64, 16, 4096, layout));
+	CHECK(!layout.bUpload && layout.alignment == 16 && layout.alignedSize == 176);
+	CHECK(GetSampleBuffersLayout(100, 0, 3, 4096, layout));
+	CHECK(!layout.bUpload && layout.alignment == 3 && layout.alignedSize == 102);
+
+	// without CUploadBuffers
+	CHECK(GetSampleBuffersLayout(100, 8, 1, 0, layout));
+	CHECK(!layout.bUpload && layout.alignedSize == 108);
+
+	// overflow
+	CHECK(!GetSampleBuffersLayout(std::numeric_limits<LONG>::max() - 10, 0, 4096, 0, layout));
+	CHECK(!GetSampleBuffersLayout(std::numeric_limits<LONG>::max() - 10, 100, 1, 0, layout));
+}
+
+static void TestUpload()
+{
+	CPlainUploadBuffers uploadBuffers;
+	int nAllocs = 0;
+
+	for (const LONG size : { 1920 * 1080 * 2, 1280 * 720 * 4, 4097, 100 }) {
+		for (const LONG count : { 1, 3, 8 }) {
+			CTestAllocator allocator;
+			CHECK(allocator.Alloc(size, 0, 16, count, &uploadBuffers));
+			nAllocs++;
+
+			// 1 line of size bytes
+			std::vector<BYTE> dst(size);
+			for (BYTE* pBuffer : allocator.buffers) {
+				CHECK((uintptr_t)pBuffer % uploadBuffers.GetAlignment() == 0);
+				memset(pBuffer, 0x5A, size);
+				memset(dst.data(), 0, size);
+				CHECK(uploadBuffers.Upload(pBuffer, size, size, 0, 1, size, dst.data(), size) == S_OK);
+				CHECK(dst.front() == 0x5A && dst.back() == 0x5A);
+			}
+			// not the start of a sample buffer
+			CHECK(uploadBuffers.Upload(allocator.buffers[0] + 1, size, size, 0, 1, size, dst.data(), size) == E_FAIL);
+
+			uploadBuffers.ReleaseBuffers();
+			CHECK(uploadBuffers.Upload(allocator.buffers[0], size, size, 0, 1, size, dst.data(), size) == E_FAIL);
+		}
+	}
+	CHECK(uploadBuffers.m_nReleased == nAllocs);
+
+	// the buffers of an incompatible prefix are not given to the video processor
+	CTestAllocator allocator;
+	CHECK(allocator.Alloc(4096, 64, 16, 2, &uploadBuffers));
+	CHECK(uploadBuffers.Upload(allocator.buffers[0], 4096, 4096, 0, 1, 4096, nullptr, 0) == E_FAIL);
+}
+
+static void TestLines()
+{
+	// a 1080p RGB32 frame with a pitch of 2048 texels, the lines of the letterbox crop are transferred
+	const UINT width = 1920;
+	const UINT height = 1080;
+	const UINT pitch = 2048 * 4;
+	CPlainUploadBuffers uploadBuffers;
+	CTestAllocator allocator;
+	CHECK(allocator.Alloc(pitch * height, 0, 16, 2, &uploadBuffers));
+
+	BYTE* pBuffer = allocator.buffers[1];
+	for (UINT y = 0; y < height; y++) {
+		memset(pBuffer + (size_t)pitch * y, y & 0xFF, pitch);
+	}
+	std::vector<BYTE> dst((size_t)width * 4 * height, 0xEE);
+	CHECK(uploadBuffers.Upload(pBuffer, pitch, width * 4, 140, 800, width, dst.data(), width * 4) == S_OK);
+	CHECK(dst[(size_t)width * 4 * 139] == 0xEE);
+	CHECK(dst[(size_t)width * 4 * 140] == 140);
+	CHECK(dst[(size_t)width * 4 * 940 - 1] == (939 & 0xFF));
+	CHECK(dst[(size_t)width * 4 * 940] == 0xEE);
+
+	// lines past the buffer, and a pitch that is not a whole number of texels
+	CHECK(uploadBuffers.Upload(pBuffer, pitch, width * 4, 1000, 100, width, dst.data(), width * 4) == E_FAIL);
+	CHECK(uploadBuffers.Upload(pBuffer, pitch + 2, width * 4, 0, 100, width, dst.data(), width * 4) == E_FAIL);
+	CHECK(uploadBuffers.Upload(pBuffer, pitch, width * 4 + 2, 0, 100, width, dst.data(), width * 4) == E_FAIL);
+}
+
+int main()
+{
+	TestLayout();
+	TestUpload();
+	TestLines();
+
+	return TestResult();
+}
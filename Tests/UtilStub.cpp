@@ -0,0 +1,35 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+// The functions of Utils/Util.cpp that the tested sources call, it needs the Windows API.
+
+#include "stdafx.h"
+#include <pthread.h>
+#include "Utils/Util.h"
+
+void SetThreadName(DWORD dwThreadID, const char* threadName)
+{
+	if (dwThreadID == DWORD(-1)) {
+		// the name of a Linux thread is at most 15 characters
+		char name[16] = {};
+		strncpy(name, threadName, sizeof(name) - 1);
+		pthread_setname_np(pthread_self(), name);
+	}
+}
@@ -0,0 +1,82 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+// The subset of std::format that the tested code uses, for the compilers without <format>.
+// Supports "{}" and "{:0Nx}" replacement fields, "{{" and "}}" are not supported.
+
+#pragma once
+
+#include <sstream>
+#include <iomanip>
+
+namespace std {
+	namespace format_fallback {
+		template <typename C>
+		void put(basic_ostringstream<C>& os, const C* fmt)
+		{
+			os << fmt;
+		}
+
+		template <typename C, typename T, typename... Args>
+		void put(basic_ostringstream<C>& os, const C* fmt, const T& value, const Args&... args)
+		{
+			while (*fmt && *fmt != '{') {
+				os << *fmt++;
+			}
+			if (!*fmt) {
+				return;
+			}
+			const C* end = fmt;
+			while (*end && *end != '}') {
+				end++;
+			}
+			const basic_string<C> spec(fmt + 1, end);
+			if (spec.size() > 1 && spec.back() == 'x') {
+				// ":0Nx"
+				const int width = spec.size() > 2 ? stoi(string(spec.begin() + 2, spec.end() - 1)) : 0;
+				os << hex << setfill(C('0')) << setw(width) << value << dec;
+			} else {
+				os << value;
+			}
+			put(os, *end ? end + 1 : end, args...);
+		}
+	}
+
+	template <typename... Args>
+	string format(const char* fmt, const Args&... args)
+	{
+		ostringstream os;
+		format_fallback::put(os, fmt, args...);
+		return os.str();
+	}
+
+	template <typename... Args>
+	wstring format(const wchar_t* fmt, const Args&... args)
+	{
+		wostringstream os;
+		format_fallback::put(os, fmt, args...);
+		return os.str();
+	}
+
+	// Utils/Util.h only declares the debug log with these
+	template <typename... Args> wstring vformat(wstring_view fmt, Args&&... args);
+	template <typename... Args> int make_wformat_args(Args&... args);
+}
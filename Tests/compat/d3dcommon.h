@@ -0,0 +1,38 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+// The part of the Windows SDK headers that Source/Shaders.h needs, including DirectXMath.h
+// that the precompiled header of the renderer provides.
+
+#pragma once
+
+struct D3D_SHADER_MACRO {
+	LPCSTR Name;
+	LPCSTR Definition;
+};
+
+struct ID3DBlob;
+
+namespace DirectX {
+	struct XMFLOAT4 {
+		float x, y, z, w;
+	};
+}
@@ -0,0 +1,66 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+// The part of the Windows SDK header that Source/Helper.h and Source/ColorLut.cpp need.
+
+#pragma once
+
+typedef enum _D3DFORMAT {
+	D3DFMT_UNKNOWN      = 0,
+	D3DFMT_A8R8G8B8     = 21,
+	D3DFMT_X8R8G8B8     = 22,
+	D3DFMT_A2B10G10R10  = 31,
+	D3DFMT_A2R10G10B10  = 35,
+	D3DFMT_A16B16G16R16 = 36,
+	D3DFMT_L8           = 50,
+	D3DFMT_A8L8         = 51,
+	D3DFMT_L16          = 81,
+	D3DFMT_FORCE_DWORD  = 0x7fffffff
+} D3DFORMAT;
+
+struct DXVA2_ValueRange;
+struct DXVA2_ProcAmpValues;
+
+enum DXVA2_VideoTransferFunction {
+	DXVA2_VideoTransFunc_Unknown = 0,
+	DXVA2_VideoTransFunc_10      = 1,
+	DXVA2_VideoTransFunc_18      = 2,
+	DXVA2_VideoTransFunc_20      = 3,
+	DXVA2_VideoTransFunc_22      = 4,
+	DXVA2_VideoTransFunc_709     = 5,
+	DXVA2_VideoTransFunc_240M    = 6,
+	DXVA2_VideoTransFunc_sRGB    = 7,
+	DXVA2_VideoTransFunc_28      = 8,
+};
+
+struct DXVA2_ExtendedFormat {
+	union {
+		struct {
+			UINT SampleFormat           : 8;
+			UINT VideoChromaSubsampling : 4;
+			UINT NominalRange           : 3;
+			UINT VideoTransferMatrix    : 3;
+			UINT VideoLighting          : 4;
+			UINT VideoPrimaries         : 5;
+			UINT VideoTransferFunction  : 5;
+		};
+		UINT value;
+	};
+};
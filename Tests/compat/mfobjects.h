@@ -0,0 +1,63 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+// The part of the Windows SDK headers that Source/Helper.h and Source/ColorLut.cpp need,
+// DXGI_FORMAT comes with them.
+
+#pragma once
+
+typedef enum DXGI_FORMAT {
+	DXGI_FORMAT_UNKNOWN            = 0,
+	DXGI_FORMAT_R16G16B16A16_FLOAT = 10,
+	DXGI_FORMAT_R16G16B16A16_UNORM = 11,
+	DXGI_FORMAT_R10G10B10A2_UNORM  = 24,
+	DXGI_FORMAT_R8G8B8A8_UNORM     = 28,
+	DXGI_FORMAT_R16G16_UNORM       = 35,
+	DXGI_FORMAT_R8G8_UNORM         = 49,
+	DXGI_FORMAT_R16_UNORM          = 56,
+	DXGI_FORMAT_R8_UNORM           = 61,
+	DXGI_FORMAT_B8G8R8A8_UNORM     = 87,
+	DXGI_FORMAT_AYUV               = 100,
+	DXGI_FORMAT_Y410               = 101,
+	DXGI_FORMAT_Y416               = 102,
+	DXGI_FORMAT_NV12               = 103,
+	DXGI_FORMAT_P010               = 104,
+	DXGI_FORMAT_P016               = 105,
+	DXGI_FORMAT_YUY2               = 107,
+	DXGI_FORMAT_Y210               = 108,
+	DXGI_FORMAT_Y216               = 109,
+	DXGI_FORMAT_FORCE_UINT         = 0xffffffff
+} DXGI_FORMAT;
+
+enum MFVideoTransferFunction {
+	MFVideoTransFunc_Log_100    = 9,
+	MFVideoTransFunc_Log_316    = 10,
+	MFVideoTransFunc_709_sym    = 11,
+	MFVideoTransFunc_2020_const = 12,
+	MFVideoTransFunc_2020       = 13,
+	MFVideoTransFunc_26         = 14,
+	MFVideoTransFunc_2084       = 15,
+	MFVideoTransFunc_HLG        = 16,
+};
+
+enum MFVideoPrimaries {
+	MFVideoPrimaries_BT709  = 2,
+	MFVideoPrimaries_BT2020 = 9,
+};
@@ -0,0 +1,137 @@
+/*
+* (C) 2025 see Authors.txt
+*
+* This file is part of MPC-BE.
+*
+* MPC-BE is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* MPC-BE is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+
+// Replaces the precompiled header of the renderer for the tests that build the headless
+// parts of Source/ without the Windows SDK, see CMakeLists.txt.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+typedef long           HRESULT;
+typedef int            BOOL;
+typedef int            LONG;
+typedef unsigned int   UINT;
+typedef unsigned char  BYTE;
+typedef unsigned short WORD;
+typedef unsigned long  DWORD;
+typedef const char*    LPCSTR;
+typedef const wchar_t* LPCWSTR;
+typedef void*          LPVOID;
+typedef void*          HANDLE;
+typedef int64_t        REFERENCE_TIME;
+
+struct GUID {
+	uint32_t Data1;
+	uint16_t Data2;
+	uint16_t Data3;
+	uint8_t  Data4[8];
+};
+#define DEFINE_GUID(name, l, w1, w2, b1, b2, b3, b4, b5, b6, b7, b8) \
+	inline constexpr GUID name = { l, w1, w2, { b1, b2, b3, b4, b5, b6, b7, b8 } }
+
+struct RECT {
+	LONG left;
+	LONG top;
+	LONG right;
+	LONG bottom;
+};
+
+// the declarations that Helper.h and Include/IMediaSideData.h need, nothing of them is called
+class CMediaType;
+struct AM_MEDIA_TYPE;
+struct BITMAPINFOHEADER;
+
+#define interface struct
+#define __declspec(x)
+#define STDMETHOD(method) virtual HRESULT method
+#define STDMETHOD_(type, method) virtual type method
+#define PURE = 0
+
+struct IUnknown {
+	virtual HRESULT QueryInterface(const GUID& riid, void** ppv) = 0;
+	virtual unsigned long AddRef() = 0;
+	virtual unsigned long Release() = 0;
+};
+
+int StringFromGUID2(const GUID& guid, wchar_t* str, int max);
+
+#define LOG_TRACE 4
+void DbgLogInfo(DWORD type, DWORD level, const wchar_t* str);
+
+#define _ReadWriteBarrier() __asm__ __volatile__("" ::: "memory")
+
+#define ZeroMemory(dst, size) memset((dst), 0, (size))
+#define UNITS 10000000 // DirectShow reftime.h
+
+#define __CRT_WIDE(s) L ## s
+#define _CRT_WIDE(s) __CRT_WIDE(s)
+
+#define S_OK         ((HRESULT)0)
+#define S_FALSE      ((HRESULT)1)
+#define E_FAIL       ((HRESULT)0x80004005L)
+#define E_ABORT      ((HRESULT)0x80004004L)
+#define E_INVALIDARG ((HRESULT)0x80070057L)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr)    (((HRESULT)(hr)) < 0)
+
+#if __has_include(<format>)
+#include <format>
+#else
+// g++ 12 has no <format>
+#include "compat/FormatFallback.h"
+#endif
+
+#define ASSERT(expr) assert(expr)
+#define __noop ((void)0)
+// the same as the release build of Utils/Util.h
+#define DLog(...) __noop
+#define DLogIf(f,...) __noop
+
+// the part of ATL's CComPtr that the tested code uses
+template <class T>
+class CComPtr
+{
+public:
+	T* p = nullptr;
+
+	CComPtr() = default;
+	CComPtr(T* lp) : p(lp) { if (p) p->AddRef(); }
+	CComPtr(const CComPtr&) = delete;
+	CComPtr& operator=(const CComPtr&) = delete;
+	~CComPtr() { Release(); }
+
+	T* operator->() const { return p; }
+	operator T*() const { return p; }
+
+	void Release() { if (T* tmp = p) { p = nullptr; tmp->Release(); } }
+	void Attach(T* lp) { Release(); p = lp; }
+	T* Detach() { T* tmp = p; p = nullptr; return tmp; }
+};